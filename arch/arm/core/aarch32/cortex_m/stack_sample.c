@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2020 Intel corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Stack sampling of the interrupted thread - ARM Cortex-M
+ *
+ * Threads run on the process stack, the exception frame stacked on entry
+ * of the timer interrupt holds the PC and LR of the interrupted thread.
+ * There is no frame pointer convention on Thumb, so the stack is not
+ * walked any further.
+ */
+
+#include <kernel.h>
+#include <arch/cpu.h>
+#include <arch/arm/aarch32/cortex_m/cmsis.h>
+
+size_t arch_stack_sample(uintptr_t *buf, size_t size)
+{
+	const z_arch_esf_t *esf;
+	size_t depth = 0;
+
+	/* The process stack is only the interrupted context if no other
+	 * exception is active.
+	 */
+	if (!(SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) || (size == 0)) {
+		return 0;
+	}
+
+	esf = (const z_arch_esf_t *)__get_PSP();
+	buf[depth++] = esf->basic.pc;
+	if (depth < size) {
+		buf[depth++] = esf->basic.lr;
+	}
+
+	return depth;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2020 Intel corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Static branch patching - ARM Cortex-M
+ *
+ * Branches are patched between a NOP.W and a B.W (encoding T4), both 32-bit
+ * Thumb-2 instructions. The code runs from RAM, there is no XIP support.
+ */
+
+#include <kernel.h>
+#include <arch/cpu.h>
+#include <arch/arm/aarch32/cortex_m/cmsis.h>
+#include <sys/static_key.h>
+
+#define NOP_W_HI	0xf3afU
+#define NOP_W_LO	0x8000U
+#define B_W_HI		0xf000U
+#define B_W_LO		0x9000U
+
+/* B.W reaches +/-16MB from the instruction */
+#define B_W_RANGE	(1 << 24)
+
+static void b_w_encode(uintptr_t code, uintptr_t target, uint16_t insn[2])
+{
+	/* The offset is relative to the PC, 4 bytes past the instruction */
+	int32_t off = (int32_t)(target - (code + 4));
+	uint32_t s = ((uint32_t)off >> 24) & 1U;
+	uint32_t i1 = ((uint32_t)off >> 23) & 1U;
+	uint32_t i2 = ((uint32_t)off >> 22) & 1U;
+	/* I1 = NOT(J1 XOR S), I2 = NOT(J2 XOR S) */
+	uint32_t j1 = ~(i1 ^ s) & 1U;
+	uint32_t j2 = ~(i2 ^ s) & 1U;
+
+	__ASSERT((off >= -B_W_RANGE) && (off < B_W_RANGE),
+		 "branch target out of range");
+
+	insn[0] = B_W_HI | (s << 10) | (((uint32_t)off >> 12) & 0x3ffU);
+	insn[1] = B_W_LO | (j1 << 13) | (j2 << 11) |
+		  (((uint32_t)off >> 1) & 0x7ffU);
+}
+
+void arch_static_branch_patch(const struct static_branch_entry *entry,
+			      bool enable)
+{
+	/* Clear the Thumb bit the assembler may set on code addresses */
+	uintptr_t code = entry->code & ~(uintptr_t)1;
+	volatile uint16_t *dst = (volatile uint16_t *)code;
+	uint16_t insn[2];
+	unsigned int key;
+
+	if (enable) {
+		b_w_encode(code, entry->target & ~(uintptr_t)1, insn);
+	} else {
+		insn[0] = NOP_W_HI;
+		insn[1] = NOP_W_LO;
+	}
+
+	key = arch_irq_lock();
+
+	dst[0] = insn[0];
+	dst[1] = insn[1];
+
+#if defined(__DCACHE_PRESENT) && (__DCACHE_PRESENT == 1U)
+	/* The instruction may straddle two cache lines */
+	SCB_CleanDCache_by_Addr((uint32_t *)(code & ~(uintptr_t)0x1f), 64);
+#endif
+#if defined(__ICACHE_PRESENT) && (__ICACHE_PRESENT == 1U)
+	SCB_InvalidateICache();
+#endif
+	__DSB();
+	__ISB();
+
+	arch_irq_unlock(key);
+}
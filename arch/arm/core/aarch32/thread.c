@@ -404,6 +404,7 @@ void arch_switch_to_main_thread(struct k_thread *main_thread,
 	start_of_main_stack = (char *)Z_STACK_PTR_ALIGN(start_of_main_stack);
 
 	_current = main_thread;
+	z_sched_usage_switch();
 #ifdef CONFIG_TRACING
 	sys_trace_thread_switched_in();
 #endif
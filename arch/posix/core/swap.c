@@ -47,6 +47,7 @@ int arch_swap(unsigned int key)
 
 
 	_current = _kernel.ready_q.cache;
+	z_sched_usage_switch();
 
 	/*
 	 * Here a "real" arch would load all processor registers for the thread
@@ -84,6 +85,7 @@ void arch_switch_to_main_thread(struct k_thread *main_thread,
 	sys_trace_thread_switched_out();
 
 	_current = _kernel.ready_q.cache;
+	z_sched_usage_switch();
 
 	sys_trace_thread_switched_in();
 
@@ -23,6 +23,7 @@
 #include <tracing/tracing.h>
 #include <kswap.h>
 #include <arch/x86/ia32/segmentation.h>
+#include <drivers/interrupt_controller/sysapic.h>
 
 extern void z_SpuriousIntHandler(void *handler);
 extern void z_SpuriousIntNoErrCodeHandler(void *handler);
@@ -238,3 +239,35 @@ void z_x86_dynamic_irq_handler(uint8_t stub_idx)
 	dyn_irq_list[stub_idx].handler(dyn_irq_list[stub_idx].param);
 }
 #endif /* CONFIG_X86_DYNAMIC_IRQ_STUBS > 0 */
+
+#ifdef CONFIG_IRQ_STATS
+/* IRQ of each vector plus one, 0 until the vector is first seen */
+static uint8_t vector_to_irq[256];
+
+/*
+ * _interrupt_enter() only knows the ISR of the interrupt. Find its IRQ from
+ * the vector being serviced by the local APIC, mapped back through
+ * _irq_to_interrupt_vector[]. Interrupts without an IRQ line, such as
+ * irq_offload(), are accounted to CONFIG_MAX_IRQ_LINES, which is ignored.
+ */
+void z_x86_irq_stats_enter(void)
+{
+	int vector = z_irq_controller_isr_vector_get();
+	unsigned int irq = CONFIG_MAX_IRQ_LINES;
+
+	if (vector >= 0) {
+		if (vector_to_irq[vector] == 0U) {
+			for (irq = 0U; irq < CONFIG_MAX_IRQ_LINES; irq++) {
+				if (_irq_to_interrupt_vector[irq] == vector) {
+					vector_to_irq[vector] = irq + 1U;
+					break;
+				}
+			}
+		} else {
+			irq = vector_to_irq[vector] - 1U;
+		}
+	}
+
+	z_irq_stats_enter(irq);
+}
+#endif /* CONFIG_IRQ_STATS */
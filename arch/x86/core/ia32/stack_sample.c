@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2020 Intel corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file Stack sampling of the interrupted thread - IA-32 implementation
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <kernel_internal.h>
+
+/* Thread context saved by _interrupt_enter(), its address is stored at the
+ * base of the interrupt stack when a thread is interrupted.
+ */
+struct int_frame {
+	uint32_t edi;
+	uint32_t ecx;
+	uint32_t edx;
+	uint32_t eax;
+	uint32_t eip;
+	uint32_t cs;
+	uint32_t eflags;
+};
+
+static bool in_irq_stack(uintptr_t addr)
+{
+	uintptr_t top = (uintptr_t)_kernel.cpus[0].irq_stack;
+
+	return (addr < top) && (addr >= (top - CONFIG_ISR_STACK_SIZE));
+}
+
+static bool in_thread_stack(const struct k_thread *thread, uintptr_t addr)
+{
+	return (addr >= thread->stack_info.start) &&
+	       (addr < (thread->stack_info.start + thread->stack_info.size));
+}
+
+size_t arch_stack_sample(uintptr_t *buf, size_t size)
+{
+	const struct int_frame *frame;
+	uintptr_t *fp;
+	size_t depth = 0;
+
+	/* Nested interrupts do not switch stacks */
+	if ((_kernel.cpus[0].nested != 1) || (size == 0)) {
+		return 0;
+	}
+
+	frame = (const struct int_frame *)
+		((uintptr_t *)_kernel.cpus[0].irq_stack)[-1];
+	buf[depth++] = frame->eip;
+
+	/* EBP is not touched by _interrupt_enter(), the outermost frame on
+	 * the interrupt stack links to the frame of the interrupted thread.
+	 */
+	fp = __builtin_frame_address(0);
+	while (in_irq_stack((uintptr_t)fp)) {
+		fp = (uintptr_t *)fp[0];
+	}
+
+	while ((depth < size) && in_thread_stack(_current, (uintptr_t)fp)) {
+		buf[depth++] = fp[1];
+
+		/* Callers are found towards the stack base */
+		if (fp[0] <= (uintptr_t)fp) {
+			break;
+		}
+		fp = (uintptr_t *)fp[0];
+	}
+
+	return depth;
+}
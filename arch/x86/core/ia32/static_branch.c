@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Intel corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file Static branch patching - IA-32 implementation
+ */
+
+#include <kernel.h>
+#include <kernel_arch_data.h>
+#include <string.h>
+#include <sys/static_key.h>
+
+#define JMP_REL32	0xe9
+#define INSN_SIZE	5
+
+static const uint8_t nop5[INSN_SIZE] = { 0x0f, 0x1f, 0x44, 0x00, 0x00 };
+
+void arch_static_branch_patch(const struct static_branch_entry *entry,
+			      bool enable)
+{
+	uint8_t insn[INSN_SIZE];
+	unsigned int key;
+	uint32_t cr0;
+
+	if (enable) {
+		int32_t rel = (int32_t)(entry->target -
+					(entry->code + INSN_SIZE));
+
+		insn[0] = JMP_REL32;
+		(void)memcpy(&insn[1], &rel, sizeof(rel));
+	} else {
+		(void)memcpy(insn, nop5, sizeof(insn));
+	}
+
+	/* Kernel text is mapped read-only, let supervisor writes through
+	 * while patching. The processor snoops stores to code which is
+	 * being executed, no explicit flush is needed.
+	 */
+	key = arch_irq_lock();
+
+	__asm__ volatile("movl %%cr0, %0" : "=r" (cr0));
+	__asm__ volatile("movl %0, %%cr0" : : "r" (cr0 & ~CR0_WP) : "memory");
+
+	(void)memcpy((void *)entry->code, insn, sizeof(insn));
+
+	__asm__ volatile("movl %0, %%cr0" : : "r" (cr0) : "memory");
+
+	arch_irq_unlock(key);
+}
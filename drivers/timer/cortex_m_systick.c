@@ -6,6 +6,7 @@
 #include <drivers/timer/system_timer.h>
 #include <sys_clock.h>
 #include <spinlock.h>
+#include <kernel_structs.h>
 #include <arch/arm/aarch32/cortex_m/cmsis.h>
 
 #define COUNTER_MAX 0x00ffffff
@@ -118,6 +119,9 @@ void z_clock_isr(void *arg)
 	ARG_UNUSED(arg);
 	uint32_t dticks;
 
+	/* Not entered through _isr_wrapper, account the ISR here */
+	z_sched_usage_isr_enter();
+
 	/* Update overflow_cyc and clear COUNTFLAG by invoking elapsed() */
 	elapsed();
 
@@ -146,6 +150,8 @@ void z_clock_isr(void *arg)
 	} else {
 		z_clock_announce(1);
 	}
+
+	z_sched_usage_isr_exit();
 	z_arm_int_exit();
 }
 
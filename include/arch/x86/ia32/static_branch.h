@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief IA-32 static branches
+ *
+ * A disabled branch is a 5 byte no-op, patched into a 5 byte relative jump
+ * when its key is enabled.
+ */
+
+#ifndef ZEPHYR_INCLUDE_ARCH_X86_IA32_STATIC_BRANCH_H_
+#define ZEPHYR_INCLUDE_ARCH_X86_IA32_STATIC_BRANCH_H_
+
+#ifndef _ASMLANGUAGE
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct static_key;
+
+static ALWAYS_INLINE bool arch_static_branch(struct static_key *key)
+{
+	__asm__ goto("1: .byte 0x0f, 0x1f, 0x44, 0x00, 0x00\n\t"
+		     ".pushsection ._static_branch_entry.static.0, \"a\"\n\t"
+		     ".balign 4\n\t"
+		     ".long 1b, %l[taken], %c0\n\t"
+		     ".popsection\n\t"
+		     : : "i" (key) : : taken);
+
+	return false;
+taken:
+	return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ASMLANGUAGE */
+
+#endif /* ZEPHYR_INCLUDE_ARCH_X86_IA32_STATIC_BRANCH_H_ */
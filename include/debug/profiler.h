@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_DEBUG_PROFILER_H_
+#define ZEPHYR_INCLUDE_DEBUG_PROFILER_H_
+
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup profiler Sampling profiler
+ *  @brief Module for finding where CPU time is spent
+ *
+ *  A timer periodically samples the program counter of the interrupted
+ *  thread and, when supported by the architecture, a short call stack
+ *  found by walking the frame pointers. Identical stacks are counted in a
+ *  table of each CPU.
+ *
+ *  If the architecture can not sample the interrupted context, the entry
+ *  point of the interrupted thread is recorded instead.
+ *  @{
+ */
+
+/** Sampled call stack and the number of times it was seen */
+struct profiler_stack {
+	/** Interrupted thread */
+	const struct k_thread *thread;
+	/** Number of samples */
+	uint32_t count;
+	/** Number of valid entries in @a pcs */
+	uint32_t depth;
+	/** Program counter followed by the return addresses */
+	uintptr_t pcs[CONFIG_PROFILER_STACK_DEPTH];
+};
+
+/** @brief Profiler stack callback function
+ *
+ *  @param stack Sampled stack, a copy valid during the call.
+ *  @param cpu CPU which took the samples.
+ *  @param user_data User data given to profiler_foreach().
+ */
+typedef void (*profiler_cb)(const struct profiler_stack *stack, uint8_t cpu,
+			    void *user_data);
+
+/** @brief Start sampling
+ *
+ *  @param period Sampling period.
+ *
+ *  @retval 0 on success.
+ *  @retval -EALREADY if the profiler is already running.
+ */
+int profiler_start(k_timeout_t period);
+
+/** @brief Stop sampling
+ *
+ *  @retval 0 on success.
+ *  @retval -EALREADY if the profiler is not running.
+ */
+int profiler_stop(void);
+
+/** @brief Discard all samples */
+void profiler_reset(void);
+
+/** @brief Call a function for every sampled stack
+ *
+ *  @param cb The callback function handler.
+ *  @param user_data User data passed to the callback.
+ */
+void profiler_foreach(profiler_cb cb, void *user_data);
+
+/** @brief Get the number of samples which did not fit in the stack tables
+ *
+ *  @return Number of lost samples.
+ */
+uint32_t profiler_lost_get(void);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_DEBUG_PROFILER_H_ */
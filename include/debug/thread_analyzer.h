@@ -29,6 +29,13 @@ struct thread_analyzer_info {
 	size_t stack_size;
 	/** Stack size in used */
 	size_t stack_used;
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	/** Cycles spent running since the thread was created */
+	uint64_t exec_cycles;
+	/** CPU usage over the last window, in percent */
+	unsigned int utilization;
+#endif
 };
 
 /** @brief Thread analyzer stack size callback function
@@ -409,6 +409,58 @@ static inline unsigned int irq_parent_level_3(unsigned int irq)
  */
 #define irq_is_enabled(irq) arch_irq_is_enabled(irq)
 
+#ifdef CONFIG_IRQ_STATS
+/** Distribution of a duration, in hardware cycles */
+struct irq_duration {
+	/** Number of samples */
+	uint32_t count;
+	/** Shortest sample */
+	uint32_t min_cycles;
+	/** Longest sample */
+	uint32_t max_cycles;
+	/** Sum of the samples, divide by count for the average */
+	uint64_t total_cycles;
+};
+
+/** Statistics of an IRQ, see irq_stats_get() */
+struct irq_stats {
+	/** Run time of the ISR, excluding the interrupts nested in it */
+	struct irq_duration run;
+	/** Number of times the ISR preempted another ISR */
+	uint32_t nested;
+	/** Cycles from the ISR entry to a thread it woke with k_sem_give()
+	 * running
+	 */
+	struct irq_duration wakeup;
+};
+
+/**
+ * @brief Get the statistics of an IRQ
+ *
+ * The ISR is timed with k_cycle_get_32() from its entry in the common
+ * interrupt wrapper to its exit.
+ *
+ * @param irq IRQ line.
+ * @param stats Returned statistics.
+ *
+ * @retval 0 on success
+ * @retval -EINVAL Invalid IRQ line
+ */
+int irq_stats_get(unsigned int irq, struct irq_stats *stats);
+
+/**
+ * @brief Get the deepest interrupt nesting seen
+ *
+ * @return Maximum number of interrupts handled at once on a CPU.
+ */
+unsigned int irq_stats_max_nesting_get(void);
+
+/**
+ * @brief Clear the statistics of all IRQs
+ */
+void irq_stats_reset(void);
+#endif /* CONFIG_IRQ_STATS */
+
 /**
  * @}
  */
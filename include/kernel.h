@@ -553,6 +553,46 @@ struct _thread_userspace_local_data {
 };
 #endif
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/* Runtime accounting of a thread, maintained by kernel/usage.c */
+struct _thread_runtime_stats {
+	/* Cycles spent running since the thread was created */
+	uint64_t execution_cycles;
+
+	/* Cycles spent running in the current and previous windows */
+	uint64_t window_cycles;
+	uint64_t last_window_cycles;
+
+	/* Window the window_cycles belong to */
+	uint32_t window;
+};
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
+
+#ifdef CONFIG_IRQ_STATS
+/** Wakeup of a thread by an interrupt, see k_thread_irq_wakeup_get() */
+struct k_irq_wakeup {
+	/** IRQ whose handler woke the thread */
+	unsigned int irq;
+	/** Cycles from the ISR entry to k_sem_give() */
+	uint32_t give_cycles;
+	/** Cycles from k_sem_give() to the thread running */
+	uint32_t run_cycles;
+};
+
+/* Interrupt wakeups of a thread, maintained by kernel/irq_stats.c */
+struct _thread_irq_wakeup {
+	/* IRQ, ISR entry and k_sem_give() times of a pending wakeup */
+	unsigned int irq;
+	uint32_t isr_start;
+	uint32_t give;
+	bool pending;
+
+	/* Last complete wakeup, valid if has_last is set */
+	bool has_last;
+	struct k_irq_wakeup last;
+};
+#endif /* CONFIG_IRQ_STATS */
+
 /**
  * @ingroup thread_apis
  * Thread Structure
@@ -606,6 +646,16 @@ struct k_thread {
 	struct _thread_stack_info stack_info;
 #endif /* CONFIG_THREAD_STACK_INFO */
 
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+	/** Runtime statistics */
+	struct _thread_runtime_stats rt_stats;
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
+
+#if defined(CONFIG_IRQ_STATS)
+	/** Interrupt wakeups */
+	struct _thread_irq_wakeup irq_wakeup;
+#endif /* CONFIG_IRQ_STATS */
+
 #if defined(CONFIG_USERSPACE)
 	/** memory domain info of the thread */
 	struct _mem_domain_info mem_domain_info;
@@ -1530,6 +1580,73 @@ __syscall int k_thread_name_copy(k_tid_t thread_id, char *buf,
  */
 const char *k_thread_state_str(k_tid_t thread_id);
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/** Runtime statistics of a thread, see k_thread_runtime_stats_get() */
+typedef struct {
+	/** Cycles spent running since the thread was created */
+	uint64_t execution_cycles;
+	/** Cycles spent running during the last complete window */
+	uint64_t window_cycles;
+	/** Length of a window in cycles, 0 if windows are disabled */
+	uint64_t window_length;
+} k_thread_runtime_stats_t;
+
+/**
+ * @brief Get the runtime statistics of a thread
+ *
+ * Time is accounted in hardware cycles, see k_cycle_get_32(), when a
+ * thread is switched out. The time the thread spent running since it was
+ * last switched in is included for the thread currently running on the
+ * calling CPU only.
+ *
+ * @param thread Thread ID
+ * @param stats Returned statistics
+ * @retval 0 on success
+ * @retval -EINVAL Invalid argument
+ */
+int k_thread_runtime_stats_get(k_tid_t thread,
+			       k_thread_runtime_stats_t *stats);
+
+/**
+ * @brief Get the CPU utilization of a thread
+ *
+ * Utilization is measured over the last complete window of
+ * CONFIG_THREAD_RUNTIME_STATS_WINDOW milliseconds.
+ *
+ * @param thread Thread ID
+ * @return Percentage of the window the thread spent running, 0 if windows
+ *         are disabled.
+ */
+uint32_t k_thread_runtime_utilization_get(k_tid_t thread);
+
+/**
+ * @brief Get the runtime statistics of a CPU
+ *
+ * @param cpu CPU index, less than CONFIG_MP_NUM_CPUS
+ * @param stats Returned statistics
+ * @retval 0 on success
+ * @retval -EINVAL Invalid argument
+ */
+int k_cpu_runtime_stats_get(int cpu, struct k_cpu_runtime_stats *stats);
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
+
+#ifdef CONFIG_IRQ_STATS
+/**
+ * @brief Get the last interrupt wakeup of a thread
+ *
+ * Reports the last time the thread was made ready by k_sem_give() called
+ * from an ISR, and then ran: the IRQ, the cycles from the ISR entry to
+ * k_sem_give() and from k_sem_give() to the thread running.
+ *
+ * @param thread Thread ID
+ * @param wakeup Returned wakeup
+ * @retval 0 on success
+ * @retval -EINVAL Invalid argument
+ * @retval -ENODATA The thread was never woken by an interrupt
+ */
+int k_thread_irq_wakeup_get(k_tid_t thread, struct k_irq_wakeup *wakeup);
+#endif /* CONFIG_IRQ_STATS */
+
 /**
  * @}
  */
@@ -99,6 +99,16 @@ struct _ready_q {
 
 typedef struct _ready_q _ready_q_t;
 
+/** Runtime statistics of a CPU, see k_cpu_runtime_stats_get() */
+struct k_cpu_runtime_stats {
+	/** Cycles accounted since boot */
+	uint64_t total_cycles;
+	/** Cycles spent in idle threads */
+	uint64_t idle_cycles;
+	/** Cycles spent in interrupt handlers */
+	uint64_t isr_cycles;
+};
+
 struct _cpu {
 	/* nested interrupt count */
 	uint32_t nested;
@@ -128,6 +138,15 @@ struct _cpu {
 	/* True when _current is allowed to context switch */
 	uint8_t swap_ok;
 #endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	/* runtime accounting, see kernel/usage.c */
+	struct k_thread *usage_thread;
+	uint32_t usage_start;
+	uint32_t usage_isr_nested;
+	atomic_t usage_seq;
+	struct k_cpu_runtime_stats usage;
+#endif
 };
 
 typedef struct _cpu _cpu_t;
@@ -270,6 +289,35 @@ struct k_heap {
 	struct k_spinlock lock;
 };
 
+/* thread runtime accounting hooks, called by the scheduler and the
+ * interrupt entry/exit code of each architecture
+ */
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+void z_sched_usage_switch(void);
+void z_sched_usage_isr_enter(void);
+void z_sched_usage_isr_exit(void);
+#else
+static inline void z_sched_usage_switch(void) { }
+static inline void z_sched_usage_isr_enter(void) { }
+static inline void z_sched_usage_isr_exit(void) { }
+#endif
+
+/* interrupt accounting hooks, called by the interrupt entry/exit code of
+ * each architecture, k_sem_give() and the scheduler
+ */
+#ifdef CONFIG_IRQ_STATS
+void z_irq_stats_enter(unsigned int irq);
+void z_irq_stats_exit(void);
+void z_irq_stats_wakeup(struct k_thread *thread);
+void z_irq_stats_resumed(void);
+#else
+static inline void z_irq_stats_wakeup(struct k_thread *thread)
+{
+	ARG_UNUSED(thread);
+}
+static inline void z_irq_stats_resumed(void) { }
+#endif
+
 #endif /* _ASMLANGUAGE */
 
 #endif /* ZEPHYR_KERNEL_INCLUDE_KERNEL_STRUCTS_H_ */
@@ -41,6 +41,8 @@ struct log_backend_api {
 	void (*dropped)(const struct log_backend *const backend, uint32_t cnt);
 	void (*panic)(const struct log_backend *const backend);
 	void (*init)(void);
+	void (*filter_changed)(const struct log_backend *const backend,
+			       uint32_t src_id, uint32_t level);
 };
 
 /**
@@ -167,6 +169,27 @@ static inline void log_backend_dropped(const struct log_backend *const backend,
 	}
 }
 
+/**
+ * @brief Notify backend about a change of its filter for a source.
+ *
+ * Function is optional. It is called only for an active backend, and only
+ * when its runtime filter for the source actually changes.
+ *
+ * @param[in] backend  Pointer to the backend instance.
+ * @param[in] src_id   Source ID.
+ * @param[in] level    New severity level.
+ */
+static inline void log_backend_filter_changed(
+					const struct log_backend *const backend,
+					uint32_t src_id, uint32_t level)
+{
+	__ASSERT_NO_MSG(backend != NULL);
+
+	if (backend->api->filter_changed != NULL) {
+		backend->api->filter_changed(backend, src_id, level);
+	}
+}
+
 /**
  * @brief Reconfigure backend to panic mode.
  *
@@ -259,9 +259,11 @@ static inline char z_log_minimal_level_to_char(int level)
 /******************************************************************************/
 #define __LOG(_level, _id, _filter, ...)				       \
 	do {								       \
-		bool is_user_context = _is_user_context();		       \
-									       \
 		if (Z_LOG_CONST_LEVEL_CHECK(_level)) {			       \
+			/* Read only for enabled levels, reading the mode */   \
+			/* of the CPU is not free with user space. */	       \
+			bool is_user_context = _is_user_context();	       \
+									       \
 			if (IS_ENABLED(CONFIG_LOG_MINIMAL)) {		       \
 				Z_LOG_TO_PRINTK(_level, __VA_ARGS__);	       \
 			} else if (is_user_context ||			       \
@@ -312,9 +314,11 @@ static inline char z_log_minimal_level_to_char(int level)
 /******************************************************************************/
 #define __LOG_HEXDUMP(_level, _id, _filter, _data, _length, _str)	       \
 	do {								       \
-		bool is_user_context = _is_user_context();		       \
-									       \
 		if (Z_LOG_CONST_LEVEL_CHECK(_level)) {			       \
+			/* Read only for enabled levels, reading the mode */   \
+			/* of the CPU is not free with user space. */	       \
+			bool is_user_context = _is_user_context();	       \
+									       \
 			if (IS_ENABLED(CONFIG_LOG_MINIMAL)) {		       \
 				Z_LOG_TO_PRINTK(_level, "%s", _str);	       \
 				log_minimal_hexdump_print(_level,	       \
@@ -680,6 +684,15 @@ void __printf_like(2, 3) log_from_user(struct log_msg_ids src_level,
  */
 uint32_t z_log_get_s_mask(const char *str, uint32_t nargs);
 
+/**
+ * @brief Check if address is in read only section.
+ *
+ * @param addr Address.
+ *
+ * @return True if address identified within read only section.
+ */
+bool z_log_is_rodata(const void *addr);
+
 /* Internal function used by log_from_user(). */
 __syscall void z_log_string_from_user(uint32_t src_level_val, const char *str);
 
@@ -715,9 +728,11 @@ __syscall void z_log_hexdump_from_user(uint32_t src_level_val,
 
 #define __LOG_VA(_level, _id, _filter, _str, _valist, _argnum, _strdup_action) \
 	do {								       \
-		bool is_user_context = _is_user_context();		       \
-									       \
 		if (Z_LOG_CONST_LEVEL_CHECK(_level)) {			       \
+			/* Read only for enabled levels, reading the mode */   \
+			/* of the CPU is not free with user space. */	       \
+			bool is_user_context = _is_user_context();	       \
+									       \
 			if (IS_ENABLED(CONFIG_LOG_MINIMAL)) {		       \
 				if (IS_ENABLED(CONFIG_LOG_PRINTK)) {	       \
 					log_printk(_str, _valist);	       \
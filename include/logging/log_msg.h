@@ -466,6 +466,69 @@ struct log_msg *log_msg_create_n(const char *str,
 				 log_arg_t *args,
 				 uint32_t nargs);
 
+/** @brief Create a packaged standard log message.
+ *
+ *  @note Internal use only, requires CONFIG_LOG_MSG_PACKAGED.
+ *
+ *  @param str   String.
+ *  @param args  Array with arguments.
+ *  @param nargs Number of arguments.
+ *  @param smask Mask of string arguments to copy into the message. Strings
+ *               duplicated with log_strdup() are released once copied.
+ *
+ *  @return Pointer to allocated head of the message or NULL.
+ */
+struct log_msg *z_log_msg_pkg_create(const char *str, log_arg_t *args,
+				     uint32_t nargs, uint32_t smask);
+
+/** @brief Create a packaged hexdump log message.
+ *
+ *  @note Internal use only, requires CONFIG_LOG_MSG_PACKAGED.
+ *
+ *  @param str    String.
+ *  @param data   Data.
+ *  @param length Data length, already saturated.
+ *
+ *  @return Pointer to allocated head of the message or NULL.
+ */
+struct log_msg *z_log_msg_pkg_hexdump_create(const char *str,
+					     const uint8_t *data,
+					     uint32_t length);
+
+/** @brief Make a packaged message visible to the log processing.
+ *
+ *  @note Internal use only, requires CONFIG_LOG_MSG_PACKAGED.
+ *
+ *  @param msg Message.
+ */
+void z_log_msg_commit(struct log_msg *msg);
+
+/** @brief Claim the oldest committed packaged message.
+ *
+ *  @note Internal use only, requires CONFIG_LOG_MSG_PACKAGED.
+ *
+ *  @return Message or NULL if none is pending.
+ */
+struct log_msg *z_log_msg_claim(void);
+
+/** @brief Check if a packaged message can be claimed.
+ *
+ *  @note Internal use only, requires CONFIG_LOG_MSG_PACKAGED.
+ *
+ *  @return true if a message is pending.
+ */
+bool z_log_msg_pending(void);
+
+/** @brief Check if a buffer belongs to a packaged message.
+ *
+ *  @note Internal use only, requires CONFIG_LOG_MSG_PACKAGED.
+ *
+ *  @param buf Buffer.
+ *
+ *  @return true if the buffer is in the message ring.
+ */
+bool z_log_msg_pkg_owns(const void *buf);
+
 /**
  * @}
  */
@@ -50,6 +50,10 @@ extern "C" {
  */
 #define LOG_OUTPUT_FLAG_FORMAT_SYST		BIT(7)
 
+/** @brief Flag forcing binary dictionary based format, see log_output_dict.h
+ */
+#define LOG_OUTPUT_FLAG_FORMAT_DICT		BIT(8)
+
 /**
  * @brief Prototype of the function processing output data.
  *
@@ -70,6 +74,10 @@ struct log_output_control_block {
 	atomic_t offset;
 	void *ctx;
 	const char *hostname;
+#if defined(CONFIG_LOG_DICTIONARY_ENABLE)
+	/* Dictionary records written, paces the sync records. */
+	uint32_t record_cnt;
+#endif
 };
 
 /** @brief Log_output instance structure. */
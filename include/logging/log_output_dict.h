@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_
+#define ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_
+
+#include <logging/log_output.h>
+#include <logging/log_msg.h>
+#include <stdarg.h>
+#include <sys/util.h>
+#include <toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dictionary based log output
+ * @defgroup log_output_dict Dictionary based log output
+ * @ingroup log_output
+ * @{
+ *
+ * Messages are not formatted on the device. Instead, a binary record with
+ * the format string address, the source ID, the timestamp and the raw
+ * arguments is sent. The host resolves addresses using a database
+ * generated from the ELF file and formats the messages, see
+ * scripts/logging/dictionary.
+ *
+ * All fields are in target byte order. Records start with a type byte,
+ * the low nibble holding the record type and the high nibble the level.
+ *
+ * String arguments located outside of read only memory are sent inline:
+ * the argument is sent as NULL, followed by the NUL terminated string.
+ */
+
+/** @brief Version of the record format. */
+#define LOG_DICT_VERSION 1
+
+/** @brief Sync record, sent first and then periodically. */
+#define LOG_DICT_TYPE_SYNC	0xF
+/** @brief Standard message record. */
+#define LOG_DICT_TYPE_STD	0x1
+/** @brief Hexdump message record. */
+#define LOG_DICT_TYPE_HEXDUMP	0x2
+/** @brief Dropped messages record. */
+#define LOG_DICT_TYPE_DROPPED	0x3
+
+/** @brief Magic following the sync record type byte. */
+#define LOG_DICT_MAGIC "ZLG"
+
+/** @brief Sync record. */
+struct log_dict_sync {
+	uint8_t type;
+	char magic[3];
+	uint8_t version;
+	uint8_t ptr_size;
+	uint8_t arg_size;
+	uint8_t reserved;
+	uint32_t timestamp_freq;
+} __packed;
+
+/** @brief Common header of message records.
+ *
+ * A standard message is followed by the number of arguments (one byte),
+ * the format string address and the arguments. A hexdump message is
+ * followed by the metadata string address, the data length (two bytes)
+ * and the data.
+ */
+struct log_dict_hdr {
+	uint8_t type;
+	uint8_t domain_id;
+	uint16_t source_id;
+	uint32_t timestamp;
+} __packed;
+
+/** @brief Dropped messages record. */
+struct log_dict_dropped {
+	uint8_t type;
+	uint16_t cnt;
+} __packed;
+
+/** @brief Process log message to a dictionary record.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param msg Log message.
+ * @param flags Optional flags.
+ */
+void log_output_msg_dict_process(const struct log_output *log_output,
+				 struct log_msg *msg, uint32_t flags);
+
+/** @brief Process log string to a dictionary record.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param src_level Log source and level structure.
+ * @param timestamp Timestamp.
+ * @param fmt String.
+ * @param ap String arguments.
+ * @param flags Optional flags.
+ */
+void log_output_string_dict_process(const struct log_output *log_output,
+				    struct log_msg_ids src_level,
+				    uint32_t timestamp, const char *fmt,
+				    va_list ap, uint32_t flags);
+
+/** @brief Process hexdump to a dictionary record.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param src_level Log source and level structure.
+ * @param timestamp Timestamp.
+ * @param metadata String associated with the data.
+ * @param data Data.
+ * @param length Data length.
+ * @param flags Optional flags.
+ */
+void log_output_hexdump_dict_process(const struct log_output *log_output,
+				     struct log_msg_ids src_level,
+				     uint32_t timestamp, const char *metadata,
+				     const uint8_t *data, uint32_t length,
+				     uint32_t flags);
+
+/** @brief Process dropped messages indication to a dictionary record.
+ *
+ * @param log_output Pointer to the log output instance.
+ * @param cnt Number of dropped messages.
+ */
+void log_output_dropped_dict_process(const struct log_output *log_output,
+				     uint32_t cnt);
+
+/** @brief Set the timestamp frequency reported in the sync record.
+ *
+ * @param freq Frequency in Hz.
+ */
+void log_output_dict_timestamp_freq_set(uint32_t freq);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_LOGGING_LOG_OUTPUT_DICT_H_ */
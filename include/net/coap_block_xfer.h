@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ *
+ * @brief CoAP block-wise transfer engine
+ *
+ * Transfers a resource of arbitrary size as a sequence of Block2 (download)
+ * or Block1 (upload) requests [RFC7959], keeping up to a window of blocks in
+ * flight at the same time instead of waiting a full round trip per block.
+ *
+ * The engine does not own a socket: requests are handed to a send callback
+ * and received packets are fed in with coap_block_xfer_input(). Blocks are
+ * retransmitted by coap_block_xfer_process(), downloaded blocks are
+ * reordered and delivered in sequence to a write callback.
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_COAP_BLOCK_XFER_H_
+#define ZEPHYR_INCLUDE_NET_COAP_BLOCK_XFER_H_
+
+#include <net/coap.h>
+
+/**
+ * @addtogroup coap COAP Library
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Length of the tokens used by the block-wise transfer requests. */
+#define COAP_BLOCK_XFER_TOKEN_LEN 8
+
+/**
+ * @brief Size of the buffer needed by a block-wise transfer.
+ *
+ * @param req_len Room for the CoAP header and the options of a request,
+ *        plus the block payload for an upload.
+ * @param block_size Block size of the transfer.
+ * @param window Number of blocks in flight, 0 for an upload.
+ */
+#define COAP_BLOCK_XFER_BUF_SIZE(req_len, block_size, window) \
+	((req_len) + (window) * (1 << ((block_size) + 4)))
+
+struct coap_block_xfer;
+
+/**
+ * @brief Option added to every request of a block-wise transfer, such as
+ * Uri-Path or Proxy-Uri.
+ */
+struct coap_block_xfer_option {
+	const void *value;
+	uint16_t code;
+	uint16_t len;
+};
+
+/**
+ * @brief Callbacks of a block-wise transfer.
+ */
+struct coap_block_xfer_cb {
+	/**
+	 * Send a request, or an empty ACK to a separate response.
+	 * Return 0 or a negative error code.
+	 */
+	int (*send)(struct coap_block_xfer *xfer, const uint8_t *data,
+		    size_t len);
+
+	/**
+	 * Download only. Consume the payload of the block at @a offset.
+	 * Blocks are delivered in order, @a last is set on the final one.
+	 * A negative return value aborts the transfer.
+	 */
+	int (*write)(struct coap_block_xfer *xfer, size_t offset,
+		     const uint8_t *data, size_t len, bool last);
+
+	/**
+	 * Upload only. Fill @a data with up to @a len bytes of the resource
+	 * starting at @a offset. Return the number of bytes read or a
+	 * negative error code. May be called again for the same offset when
+	 * a block is retransmitted.
+	 */
+	int (*read)(struct coap_block_xfer *xfer, size_t offset,
+		    uint8_t *data, size_t len);
+
+	/**
+	 * Called once, when the transfer completes (@a result 0) or fails
+	 * (negative error code).
+	 */
+	void (*done)(struct coap_block_xfer *xfer, int result);
+};
+
+/**
+ * @brief Parameters of a block-wise transfer.
+ */
+struct coap_block_xfer_config {
+	/** Transfer callbacks. */
+	const struct coap_block_xfer_cb *cb;
+
+	/** Options added to every request, in ascending order of code. */
+	const struct coap_block_xfer_option *options;
+	size_t num_options;
+
+	/**
+	 * Work buffer, see COAP_BLOCK_XFER_BUF_SIZE(). A download keeps the
+	 * blocks received out of order at the end of the buffer.
+	 */
+	uint8_t *buf;
+	size_t buf_len;
+
+	/**
+	 * COAP_METHOD_GET for a Block2 download, COAP_METHOD_PUT or
+	 * COAP_METHOD_POST for a Block1 upload.
+	 */
+	uint8_t method;
+
+	/** Preferred block size, the server may negotiate it down. */
+	enum coap_block_size block_size;
+
+	/** Maximum number of blocks in flight. */
+	uint8_t window;
+
+	/** Upload only, total size of the resource. */
+	size_t total_size;
+
+	/** Application specific data. */
+	void *user_data;
+};
+
+/** @cond INTERNAL_HIDDEN */
+struct coap_block_xfer_slot {
+	int64_t t0;
+	int32_t timeout;
+	uint32_t num;
+	uint16_t id;
+	uint16_t len;
+	uint8_t token[COAP_BLOCK_XFER_TOKEN_LEN];
+	uint8_t state;
+	uint8_t retries;
+};
+/** @endcond */
+
+/**
+ * @brief Block-wise transfer context.
+ */
+struct coap_block_xfer {
+	/** Total size of the resource, 0 if not known yet. */
+	size_t total_size;
+
+	/** Number of bytes delivered (download) or acknowledged (upload). */
+	size_t transferred;
+
+	/** Application specific data. */
+	void *user_data;
+
+	/** @cond INTERNAL_HIDDEN */
+	const struct coap_block_xfer_cb *cb;
+	const struct coap_block_xfer_option *options;
+	size_t num_options;
+	uint8_t *buf;
+	size_t req_len;
+	uint32_t next_num;
+	uint32_t done_num;
+	uint32_t last_num;
+	uint32_t max_num;
+	uint32_t size_num;
+	int result;
+	uint8_t method;
+	uint8_t block_size;
+	uint8_t window;
+	bool started;
+	bool finished;
+	struct coap_block_xfer_slot slots[CONFIG_COAP_BLOCK_XFER_WINDOW_MAX];
+	/** @endcond */
+};
+
+/**
+ * @brief Initialize a block-wise transfer.
+ *
+ * @param xfer Transfer context to initialize
+ * @param config Transfer parameters, the options and the buffer must stay
+ * valid during the transfer
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_block_xfer_init(struct coap_block_xfer *xfer,
+			 const struct coap_block_xfer_config *config);
+
+/**
+ * @brief Send the first request of a block-wise transfer.
+ *
+ * The first block is transferred alone so that the server can negotiate the
+ * block size and report the resource size, the window opens afterwards.
+ *
+ * @param xfer Transfer context
+ *
+ * @return 0 in case of success or negative in case of error.
+ */
+int coap_block_xfer_start(struct coap_block_xfer *xfer);
+
+/**
+ * @brief Handle a packet received from the server.
+ *
+ * Packets that do not belong to the transfer are ignored.
+ *
+ * @param xfer Transfer context
+ * @param data Received packet
+ * @param len Length of the received packet
+ *
+ * @return 0 in case of success or negative in case of error, in which case
+ * the transfer is aborted.
+ */
+int coap_block_xfer_input(struct coap_block_xfer *xfer, uint8_t *data,
+			  uint16_t len);
+
+/**
+ * @brief Retransmit the requests that timed out.
+ *
+ * @param xfer Transfer context
+ *
+ * @return Time in milliseconds until this function should be called again,
+ * INT32_MAX if nothing is in flight, or a negative error code, in which case
+ * the transfer is aborted.
+ */
+int32_t coap_block_xfer_process(struct coap_block_xfer *xfer);
+
+/**
+ * @brief Abort a block-wise transfer.
+ *
+ * The done callback is called with -ECANCELED unless the transfer has
+ * already finished.
+ *
+ * @param xfer Transfer context
+ */
+void coap_block_xfer_abort(struct coap_block_xfer *xfer);
+
+/**
+ * @brief Check whether a block-wise transfer has finished.
+ *
+ * @param xfer Transfer context
+ *
+ * @return true if the transfer completed or failed.
+ */
+static inline bool coap_block_xfer_finished(const struct coap_block_xfer *xfer)
+{
+	return xfer->finished;
+}
+
+#if defined(CONFIG_STREAM_FLASH)
+/**
+ * @brief Write callback storing a download in flash.
+ *
+ * Can be used as the write callback of a download whose user_data points
+ * to an initialized struct stream_flash_ctx. The last block flushes the
+ * stream.
+ */
+int coap_block_xfer_stream_flash_write(struct coap_block_xfer *xfer,
+				       size_t offset, const uint8_t *data,
+				       size_t len, bool last);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_COAP_BLOCK_XFER_H_ */
@@ -216,6 +216,11 @@ struct dns_resolve_context {
 		 * cannot be used to find correct pending query.
 		 */
 		uint16_t query_hash;
+
+		/** If set, this query shares the DNS request of the given
+		 * pending query for the same name instead of sending its own.
+		 */
+		struct dns_pending_query *leader;
 	} queries[CONFIG_DNS_NUM_CONCUR_QUERIES];
 
 	/** Is this context in use */
@@ -399,6 +404,59 @@ static inline int dns_cancel_addr_info(uint16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+/**
+ * @typedef dns_cache_cb_t
+ * @brief Callback used while iterating over the DNS cache.
+ *
+ * @param name Cached DNS name.
+ * @param type Query type of the cached answer.
+ * @param status DNS_EAI_ALLDONE if the name has addresses, DNS_EAI_NODATA
+ * for a negative answer.
+ * @param addrs Cached addresses.
+ * @param count Number of cached addresses.
+ * @param ttl Remaining time to live of the answer in seconds.
+ * @param user_data A valid pointer to user data or NULL
+ */
+typedef void (*dns_cache_cb_t)(const char *name,
+			       enum dns_query_type type,
+			       enum dns_resolve_status status,
+			       const struct dns_addrinfo *addrs,
+			       int count,
+			       uint32_t ttl,
+			       void *user_data);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * @brief Go through all the valid DNS cache entries.
+ *
+ * @param cb User supplied callback function to call.
+ * @param user_data User specified data.
+ *
+ * @return Number of cache entries.
+ */
+int dns_cache_foreach(dns_cache_cb_t cb, void *user_data);
+
+/**
+ * @brief Remove all the entries from the DNS cache.
+ *
+ * @return Number of removed entries.
+ */
+int dns_cache_flush(void);
+#else
+static inline int dns_cache_foreach(dns_cache_cb_t cb, void *user_data)
+{
+	ARG_UNUSED(cb);
+	ARG_UNUSED(user_data);
+
+	return 0;
+}
+
+static inline int dns_cache_flush(void)
+{
+	return 0;
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 /**
  * @}
  */
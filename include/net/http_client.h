@@ -176,6 +176,9 @@ struct http_client_internal_data {
 
 	/** Request timeout */
 	k_timeout_t timeout;
+
+	/** Set if the request timed out, which closes the socket */
+	bool timed_out;
 };
 
 /**
@@ -285,6 +288,110 @@ struct http_request {
 int http_client_req(int sock, struct http_request *req,
 		    int32_t timeout, void *user_data);
 
+/**
+ * @brief Send several HTTP requests on a connection without waiting for the
+ * responses in between (HTTP/1.1 pipelining). The responses are then
+ * received in order, each one being delivered to the callbacks of its
+ * request. Bytes received past the end of a response are carried over to
+ * the receive buffer of the next request, so the receive buffers must either
+ * be the same buffer or be large enough to hold one network read.
+ *
+ * Only requests that are safe to repeat (GET, HEAD, ...) should be
+ * pipelined, and their payloads should be small as they are all sent before
+ * the first response is read.
+ *
+ * @param sock Socket id of the connection.
+ * @param reqs Array of HTTP requests
+ * @param count Number of requests in the array
+ * @param timeout Max timeout to wait for each response, in milliseconds.
+ * @param user_data User specified data that is passed to the callbacks.
+ *
+ * @return <0 if sending failed, otherwise the number of complete responses
+ *         received.
+ */
+int http_client_req_pipeline(int sock, struct http_request *reqs[],
+			     size_t count, int32_t timeout, void *user_data);
+
+/**
+ * @brief Send one chunk of a request body using the chunked transfer
+ * coding. This is meant to be called from the payload callback of a request
+ * that has a zero payload_len and a "Transfer-Encoding: chunked" header, so
+ * that the body is streamed without knowing its length beforehand.
+ * A zero length chunk ends the body.
+ *
+ * @param sock Socket id of the connection.
+ * @param data Chunk data
+ * @param len Chunk length, 0 for the last chunk
+ *
+ * @return <0 if error, >=0 amount of data sent to the server
+ */
+int http_client_send_chunk(int sock, const uint8_t *data, size_t len);
+
+/** Value of http_client_endpoint::sec_tag for a plain TCP connection */
+#define HTTP_CLIENT_NO_TLS -1
+
+/**
+ * HTTP server end point, used as the key of pooled connections.
+ */
+struct http_client_endpoint {
+	/** Host name or numeric address of the server */
+	const char *host;
+
+	/** Server port */
+	uint16_t port;
+
+	/** TLS credential tag, or HTTP_CLIENT_NO_TLS */
+	int sec_tag;
+};
+
+/**
+ * @brief Get a connection to an HTTP server from the connection pool.
+ * An idle connection to the same host, port and TLS credential tag is
+ * reused if the server did not close it, otherwise a new connection is
+ * opened. Connections idle for longer than
+ * CONFIG_HTTP_CLIENT_POOL_IDLE_TIMEOUT seconds are closed.
+ *
+ * @param ep Server end point
+ *
+ * @return <0 if error, otherwise the socket of the connection.
+ */
+int http_client_pool_get(const struct http_client_endpoint *ep);
+
+/**
+ * @brief Give a connection back to the connection pool.
+ *
+ * @param sock Socket returned by http_client_pool_get()
+ * @param reuse Keep the connection open for later requests. This should
+ *        only be set when the last response was received completely and
+ *        the server did not ask to close the connection.
+ *
+ * @return 0 if ok, -ENOENT if the socket is not part of the pool.
+ */
+int http_client_pool_put(int sock, bool reuse);
+
+/**
+ * @brief Close all the idle connections of the connection pool.
+ */
+void http_client_pool_flush(void);
+
+/**
+ * @brief Do a HTTP request on a pooled connection. This works like
+ * http_client_req() except that the connection is taken from the pool and
+ * kept open afterwards if the server allows it. A request sent on a
+ * reused connection that the server closed meanwhile is sent again on a new
+ * connection, unless it has a payload callback.
+ *
+ * @param ep Server end point
+ * @param req HTTP request information
+ * @param timeout Max timeout to wait for the data, in milliseconds.
+ * @param user_data User specified data that is passed to the callback.
+ *
+ * @return <0 if error, >=0 amount of data sent to the server
+ */
+int http_client_pool_req(const struct http_client_endpoint *ep,
+			 struct http_request *req, int32_t timeout,
+			 void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -106,6 +106,13 @@ struct lwm2m_ctx {
 	 */
 	bool handle_separate_response;
 
+	/** Optional handler taking over all the packets received on this
+	 *  context instead of the engine's request and reply processing.
+	 *  NOTE: Used by the firmware pull block-wise transfer.
+	 */
+	void (*recv_cb)(struct lwm2m_ctx *client_ctx, uint8_t *buf,
+			uint16_t len);
+
 	/** Socket File Descriptor */
 	int sock_fd;
 };
@@ -331,6 +331,62 @@ struct mqtt_client;
 typedef void (*mqtt_evt_cb_t)(struct mqtt_client *client,
 			      const struct mqtt_evt *evt);
 
+/** @brief State of a publish message in the in-flight window. */
+enum mqtt_inflight_state {
+	/** PUBLISH sent, waiting for PUBACK (QoS 1) or PUBREC (QoS 2). */
+	MQTT_INFLIGHT_PUBLISHED,
+
+	/** PUBREC received, waiting for PUBCOMP (QoS 2). */
+	MQTT_INFLIGHT_RECEIVED,
+};
+
+/** @brief QoS 1 or QoS 2 publish message tracked in the in-flight window. */
+struct mqtt_inflight {
+	/** Topic and payload of the message. The application shall keep
+	 *  them valid until the message leaves the window.
+	 */
+	struct mqtt_publish_message message;
+
+	/** Message id of the publish message. */
+	uint16_t message_id;
+
+	/** State of the message, see @ref mqtt_inflight_state. */
+	uint8_t state;
+
+	/** Retain flag of the publish message. */
+	uint8_t retain_flag : 1;
+
+	/** Internal. Entry is in use. */
+	uint8_t in_use : 1;
+};
+
+/** @brief In-flight window change reported to the session store. */
+enum mqtt_session_store_op {
+	/** Message entered the window. */
+	MQTT_SESSION_STORE_ADD,
+
+	/** Message state changed. */
+	MQTT_SESSION_STORE_UPDATE,
+
+	/** Message was acknowledged and left the window. */
+	MQTT_SESSION_STORE_REMOVE,
+};
+
+/**
+ * @brief Persistent session store hook, called on every in-flight window
+ *        change so that the application can save the window and restore
+ *        it with @ref mqtt_inflight_restore after a reboot.
+ *
+ * @param[in] client Identifies the client for which the window changed.
+ * @param[in] entry Message that changed.
+ * @param[in] op Type of the change.
+ *
+ * @note Called with the client locked, shall not call MQTT API functions.
+ */
+typedef void (*mqtt_session_store_cb_t)(struct mqtt_client *client,
+					const struct mqtt_inflight *entry,
+					enum mqtt_session_store_op op);
+
 /** @brief TLS configuration for secure MQTT transports. */
 struct mqtt_sec_config {
 	/** Indicates the preference for peer verification. */
@@ -525,6 +581,14 @@ struct mqtt_client {
 	 *  Default is 1.
 	 */
 	uint8_t clean_session : 1;
+
+#if defined(CONFIG_MQTT_INFLIGHT_WINDOW)
+	/** QoS 1 and QoS 2 publish messages not fully acknowledged yet. */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_WINDOW_SIZE];
+
+	/** Optional persistent session store hook. Can be NULL. */
+	mqtt_session_store_cb_t session_store;
+#endif
 };
 
 /**
@@ -586,11 +650,66 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
+ * @note With :option:`CONFIG_MQTT_INFLIGHT_WINDOW`, QoS 1 and QoS 2
+ *       messages are kept in the in-flight window until acknowledged,
+ *       and are sent again after a reconnection. The topic and the
+ *       payload shall stay valid until then. -EAGAIN is returned when
+ *       the window is full, call @ref mqtt_input to process the pending
+ *       acknowledgments.
+ *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to publish several messages with a single transport write.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] params Array of publish message parameters. Shall not be NULL.
+ * @param[in] count Number of messages in the array.
+ *
+ * @note Up to :option:`CONFIG_MQTT_PUBLISH_BATCH_MAX` messages, as many
+ *       as their headers fit in the tx buffer, are sent per write. With
+ *       the in-flight window enabled either all the messages are
+ *       accepted or -EAGAIN is returned.
+ *
+ * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_publish_batch(struct mqtt_client *client,
+		       const struct mqtt_publish_param *params, size_t count);
+
+#if defined(CONFIG_MQTT_INFLIGHT_WINDOW)
+/**
+ * @brief API to get the number of messages in the in-flight window.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ *
+ * @return Number of QoS 1 and QoS 2 messages not fully acknowledged yet,
+ *         or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_inflight_count(struct mqtt_client *client);
+
+/**
+ * @brief API to restore an in-flight window entry saved by the persistent
+ *        session store hook.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in] entry Saved entry. Shall not be NULL.
+ *
+ * @note Shall be called after @ref mqtt_client_init and before
+ *       @ref mqtt_connect. Restored messages are sent when the connection
+ *       is established.
+ *
+ * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ */
+int mqtt_inflight_restore(struct mqtt_client *client,
+			  const struct mqtt_inflight *entry);
+#endif
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
@@ -250,6 +250,12 @@ __net_socket struct net_context {
 	net_pkt_get_pool_func_t data_pool;
 #endif /* CONFIG_NET_CONTEXT_NET_PKT_POOL */
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+	/** Reserved TX packets and data buffers for this context.
+	 */
+	struct net_pkt_reserve *pkt_reserve;
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 #if defined(CONFIG_NET_TCP1)
 	/** TCP connection information */
 	struct net_tcp *tcp;
@@ -1044,11 +1050,40 @@ int net_context_recv(struct net_context *context,
 int net_context_update_recv_wnd(struct net_context *context,
 				int32_t delta);
 
+/**
+ * @brief Send a network buffer chain
+ *
+ * @details The data in @a frags is sent as is, after the protocol headers
+ * for UDP, or queued in the send buffer of a TCP connection. TCP segments
+ * are copied out of the send buffer when they are transmitted. The
+ * function takes over the reference to @a frags, also when it fails.
+ * Only UDP and, with CONFIG_NET_TCP2, TCP contexts are supported.
+ *
+ * @param context The network context to use.
+ * @param frags Network buffer chain holding the data.
+ * @param dst_addr Destination address, NULL to use the connected peer.
+ *        Not used for TCP.
+ * @param addrlen Length of the address.
+ * @param cb Caller-supplied callback function.
+ * @param timeout Timeout for the packet allocation.
+ * @param user_data Caller-supplied user data.
+ *
+ * @return Number of bytes queued, < 0 if error
+ */
+int net_context_send_buf(struct net_context *context,
+			 struct net_buf *frags,
+			 const struct sockaddr *dst_addr,
+			 socklen_t addrlen,
+			 net_context_send_cb_t cb,
+			 k_timeout_t timeout,
+			 void *user_data);
+
 enum net_context_option {
 	NET_OPT_PRIORITY	= 1,
 	NET_OPT_TIMESTAMP	= 2,
 	NET_OPT_TXTIME		= 3,
 	NET_OPT_SOCKS5		= 4,
+	NET_OPT_TCP_CONGESTION	= 5,
 };
 
 /**
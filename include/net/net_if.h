@@ -452,11 +452,21 @@ struct net_if {
 #if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
 	/** Network statistics related to this network interface */
 	struct net_stats stats;
+
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+	/** Network statistics of this interface updated by each CPU */
+	struct net_stats_cpu stats_cpu[CONFIG_MP_NUM_CPUS];
+#endif
 #endif /* CONFIG_NET_STATISTICS_PER_INTERFACE */
 
 	/** Network interface instance configuration */
 	struct net_if_config config;
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+	/** Reserved RX packets and data buffers */
+	struct net_pkt_reserve *pkt_reserve;
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 #if defined(CONFIG_NET_POWER_MANAGEMENT)
 	/** Keep track of packets pending in traffic queues. This is
 	 * needed to avoid putting network device driver to sleep if
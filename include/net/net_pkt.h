@@ -186,6 +186,13 @@ struct net_pkt {
 				     */
 #endif
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+	uint8_t reserve_rx        : 1; /* Was this pkt allocated for RX.
+				     * A reservation slab is shared by
+				     * both directions.
+				     */
+#endif
+
 	union {
 		/* IPv6 hop limit or IPv4 ttl for this network packet.
 		 * The value is shared between IPv6 and IPv4.
@@ -1040,6 +1047,78 @@ static inline bool net_pkt_is_being_overwritten(struct net_pkt *pkt)
 	NET_BUF_POOL_DEFINE(name, count, CONFIG_NET_BUF_DATA_SIZE,	\
 			    CONFIG_NET_BUF_USER_DATA_SIZE, NULL)
 
+/** Packet and buffer allocation statistics of a pool. */
+struct net_pkt_pool_stats {
+	/** Number of packets allocated from the pool. */
+	atomic_t pkt_alloc;
+
+	/** Number of packets borrowed from the global pool, only
+	 *  used by reservations.
+	 */
+	atomic_t pkt_borrow;
+
+	/** Number of packet allocations that failed. */
+	atomic_t pkt_fail;
+
+	/** Number of data buffers allocated from the pool. */
+	atomic_t buf_alloc;
+
+	/** Number of data buffers borrowed from the global pool, only
+	 *  used by reservations.
+	 */
+	atomic_t buf_borrow;
+
+	/** Number of data buffer allocations that failed. */
+	atomic_t buf_fail;
+};
+
+/**
+ * @brief Reserved net_pkt slab and data pool.
+ *
+ * A reservation guarantees a minimum number of packets and data buffers
+ * to a network context (for TX) or to a network interface (for RX). Once
+ * the reservation is exhausted, allocations borrow from the global pools.
+ * Freed packets and buffers return to the slab or pool they were
+ * allocated from.
+ */
+struct net_pkt_reserve {
+	/** Internal list node. */
+	sys_snode_t node;
+
+	/** Reserved packets. */
+	struct k_mem_slab *slab;
+
+	/** Reserved data buffers. */
+	struct net_buf_pool *pool;
+
+	/** Reservation name. */
+	const char *name;
+
+	/** Allocation statistics. */
+	struct net_pkt_pool_stats stats;
+};
+
+/**
+ * @brief Define a net_pkt reservation
+ *
+ * Defines a net_pkt slab and a data fragment pool used by the reservation.
+ * Attach the reservation to a network context with
+ * :c:func:`net_pkt_reserve_attach_context` or to a network interface with
+ * :c:func:`net_pkt_reserve_attach_iface`.
+ *
+ * @param _name Name of the reservation.
+ * @param pkt_count Number of reserved net_pkt.
+ * @param buf_count Number of reserved net_buf.
+ */
+#define NET_PKT_RESERVE_DEFINE(_name, pkt_count, buf_count)		\
+	NET_PKT_SLAB_DEFINE(_name##_slab, pkt_count);			\
+	NET_PKT_DATA_POOL_DEFINE(_name##_pool, buf_count);		\
+	struct net_pkt_reserve _name = {				\
+		.slab = &_name##_slab,					\
+		.pool = &_name##_pool,					\
+		.name = STRINGIFY(_name),				\
+	}
+
 /** @cond INTERNAL_HIDDEN */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC) || \
@@ -1285,6 +1364,54 @@ void net_pkt_get_info(struct k_mem_slab **rx,
 		      struct net_buf_pool **rx_data,
 		      struct net_buf_pool **tx_data);
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+/**
+ * @brief Get allocation statistics of the global RX and TX pools.
+ *
+ * @param rx Pointer to RX statistics is returned.
+ * @param tx Pointer to TX statistics is returned.
+ */
+void net_pkt_get_pool_stats(struct net_pkt_pool_stats **rx,
+			    struct net_pkt_pool_stats **tx);
+
+/**
+ * @brief Attach a reservation to a network context.
+ *
+ * Packets and data buffers sent by the context are allocated from the
+ * reservation first. The same reservation can be shared by several
+ * contexts.
+ *
+ * @param context Network context.
+ * @param reserve Reservation, or NULL to detach the current one.
+ */
+void net_pkt_reserve_attach_context(struct net_context *context,
+				    struct net_pkt_reserve *reserve);
+
+/**
+ * @brief Attach a reservation to a network interface.
+ *
+ * Packets and data buffers received on the interface are allocated from
+ * the reservation first.
+ *
+ * @param iface Network interface.
+ * @param reserve Reservation, or NULL to detach the current one.
+ */
+void net_pkt_reserve_attach_iface(struct net_if *iface,
+				  struct net_pkt_reserve *reserve);
+
+typedef void (*net_pkt_reserve_cb_t)(struct net_pkt_reserve *reserve,
+				     void *user_data);
+
+/**
+ * @brief Go through all the attached reservations and call callback
+ * for each of them.
+ *
+ * @param cb User-supplied callback function to call.
+ * @param user_data User specified data.
+ */
+void net_pkt_reserve_foreach(net_pkt_reserve_cb_t cb, void *user_data);
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 /** @cond INTERNAL_HIDDEN */
 
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
@@ -1327,6 +1454,14 @@ struct net_pkt *net_pkt_alloc_from_slab_debug(struct k_mem_slab *slab,
 #define net_pkt_alloc_from_slab(_slab, _timeout)			\
 	net_pkt_alloc_from_slab_debug(_slab, _timeout, __func__, __LINE__)
 
+struct net_pkt *net_pkt_alloc_from_reserve_debug(
+					struct net_pkt_reserve *reserve,
+					k_timeout_t timeout,
+					const char *caller, int line);
+#define net_pkt_alloc_from_reserve(_reserve, _timeout)			\
+	net_pkt_alloc_from_reserve_debug(_reserve, _timeout,		\
+					 __func__, __LINE__)
+
 struct net_pkt *net_pkt_rx_alloc_debug(k_timeout_t timeout,
 				       const char *caller, int line);
 #define net_pkt_rx_alloc(_timeout)				\
@@ -1417,6 +1552,23 @@ struct net_pkt *net_pkt_alloc_from_slab(struct k_mem_slab *slab,
 					k_timeout_t timeout);
 #endif
 
+/**
+ * @brief Allocate an initialized net_pkt for TX from a reservation
+ *
+ * @details The packet is taken from the reservation slab if available,
+ *          otherwise it is borrowed from the global TX slab.
+ *          Only net_context should be using this.
+ *
+ * @param reserve The reservation to use for allocating the packet
+ * @param timeout Maximum time to wait for an allocation.
+ *
+ * @return a pointer to a newly allocated net_pkt on success, NULL otherwise.
+ */
+#if !defined(NET_PKT_DEBUG_ENABLED)
+struct net_pkt *net_pkt_alloc_from_reserve(struct net_pkt_reserve *reserve,
+					   k_timeout_t timeout);
+#endif
+
 /**
  * @brief Allocate an initialized net_pkt for RX
  *
@@ -17,6 +17,9 @@
 #include <zephyr/types.h>
 #include <net/net_core.h>
 #include <net/net_mgmt.h>
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+#include <stats/stats_cpu.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -202,6 +205,17 @@ struct net_stats_ipv6_mld {
 	net_stats_t drop;
 };
 
+/**
+ * @brief DNS resolver cache statistics
+ */
+struct net_stats_dns {
+	/** Number of names resolved from the cache */
+	net_stats_t cache_hit;
+
+	/** Number of names that needed a DNS query */
+	net_stats_t cache_miss;
+};
+
 /**
  * @brief Network packet transfer times for calculating average TX time
  */
@@ -300,6 +314,11 @@ struct net_stats {
 	struct net_stats_ipv6_mld ipv6_mld;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_DNS)
+	/** DNS resolver cache statistics */
+	struct net_stats_dns dns;
+#endif
+
 #if NET_TC_COUNT > 1
 	/** Traffic class statistics */
 	struct net_stats_tc tc;
@@ -326,6 +345,25 @@ struct net_stats {
 #endif
 };
 
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+/**
+ * @brief Network statistics updated by one CPU.
+ *
+ * The counters are summed over all CPUs when read. Traffic class
+ * priorities and power management statistics are not split per CPU.
+ */
+struct net_stats_cpu {
+	/** Counters of the CPU */
+	struct net_stats stats;
+
+	/* Pads the copy to whole cache lines. Not aligned, as network
+	 * interfaces are kept in an array in a linker section.
+	 */
+	uint8_t pad[ROUND_UP(sizeof(struct net_stats), STATS_CPU_ALIGN) -
+		    sizeof(struct net_stats)];
+};
+#endif
+
 /**
  * @brief Ethernet error statistics
  */
@@ -56,6 +56,8 @@ struct zsock_pollfd {
 #define ZSOCK_MSG_PEEK 0x02
 /** zsock_recv/zsock_send: Override operation to non-blocking */
 #define ZSOCK_MSG_DONTWAIT 0x40
+/** zsock_recvmmsg: Do not wait for more messages once one was received */
+#define ZSOCK_MSG_WAITFORONE 0x10000
 
 /* Well-known values, e.g. from Linux man 2 shutdown:
  * "The constants SHUT_RD, SHUT_WR, SHUT_RDWR have the value 0, 1, 2,
@@ -119,6 +121,31 @@ struct zsock_pollfd {
  *    - 1 - server
  */
 #define TLS_DTLS_ROLE 6
+/** Socket option to control TLS session caching on a socket. It accepts and
+ *  returns an integer with one of the TLS_SESSION_CACHE_* values.
+ *  On a TLS client, the session negotiated with a peer is stored after a
+ *  successful handshake, keyed by peer address and hostname, and offered on
+ *  the next connect() to the same peer. On a listening TLS socket, the option
+ *  enables the server session cache for accepted connections.
+ *  By default, session caching is disabled.
+ */
+#define TLS_SESSION_CACHE 7
+/** Write-only socket option to purge all TLS session resumption state, that
+ *  is client and server session caches and the session ticket keys. The option
+ *  value is ignored.
+ */
+#define TLS_SESSION_CACHE_PURGE 8
+/** Write-only socket option to control RFC 5077 session tickets on a socket.
+ *  It accepts an integer, 0 to disable and 1 to enable session tickets.
+ *  If not set, TLS clients use mbedTLS default behavior and TLS servers do
+ *  not issue session tickets.
+ */
+#define TLS_SESSION_TICKETS 9
+/** Read-only socket option to read TLS session resumption statistics. It
+ *  returns a struct tls_session_stats. The statistics are system-wide, not
+ *  per socket.
+ */
+#define TLS_SESSION_STATS 10
 
 /** @} */
 
@@ -131,6 +158,33 @@ struct zsock_pollfd {
 #define TLS_DTLS_ROLE_CLIENT 0 /**< Client role in a DTLS session. */
 #define TLS_DTLS_ROLE_SERVER 1 /**< Server role in a DTLS session. */
 
+/* Valid values for TLS_SESSION_CACHE option */
+#define TLS_SESSION_CACHE_DISABLED 0 /**< Disable TLS session caching. */
+#define TLS_SESSION_CACHE_ENABLED 1 /**< Enable TLS session caching. */
+
+/** TLS session resumption statistics, see TLS_SESSION_STATS option. */
+struct tls_session_stats {
+	/** Number of completed client handshakes. */
+	uint32_t client_handshakes;
+
+	/** Number of client handshakes that resumed a cached session. */
+	uint32_t client_resumed;
+
+	/** Number of completed server handshakes. */
+	uint32_t server_handshakes;
+
+	/** Number of server handshakes that resumed a session from the server
+	 *  session cache or from a session ticket.
+	 */
+	uint32_t server_resumed;
+
+	/** Number of client sessions currently cached. */
+	uint32_t client_cached;
+
+	/** Number of client sessions evicted to make room for new ones. */
+	uint32_t client_evicted;
+};
+
 struct zsock_addrinfo {
 	struct zsock_addrinfo *ai_next;
 	int ai_flags;
@@ -351,6 +405,54 @@ static inline ssize_t zsock_send(int sock, const void *buf, size_t len,
 __syscall ssize_t zsock_sendmsg(int sock, const struct msghdr *msg,
 				int flags);
 
+/**
+ * @brief Send multiple messages with a single call
+ *
+ * @details
+ * @rst
+ * Send each message of @a msgvec as if by ``zsock_sendmsg()``, storing
+ * the number of bytes sent in its ``msg_len``. Compared to a loop of
+ * ``zsock_sendmsg()`` calls, the socket is looked up and, with
+ * :option:`CONFIG_USERSPACE`, the system call is entered only once.
+ * See `Linux man page
+ * <https://man7.org/linux/man-pages/man2/sendmmsg.2.html>`__
+ * for the description of the interface.
+ * This function is also exposed as ``sendmmsg()``
+ * if :option:`CONFIG_NET_SOCKETS_POSIX_NAMES` is defined.
+ * @endrst
+ *
+ * @return Number of messages sent, which is less than @a vlen if sending
+ *	   a message failed, or -1 with errno set if no message was sent.
+ */
+__syscall int zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags);
+
+/**
+ * @brief Receive multiple datagrams with a single call
+ *
+ * @details
+ * @rst
+ * Receive up to @a vlen datagrams. Each datagram is received into the
+ * first ``msg_iov`` entry of its message, with the source address in
+ * ``msg_name`` if set, and its length stored in ``msg_len``.
+ *
+ * @a timeout covers the whole batch: the call returns once @a vlen
+ * datagrams were received or the timeout expired, in milliseconds,
+ * -1 meaning forever. With ``ZSOCK_MSG_WAITFORONE``, the call returns
+ * as soon as no more datagrams are immediately available after the first
+ * one. With ``ZSOCK_MSG_DONTWAIT`` or a non-blocking socket, only the
+ * datagrams already queued are returned.
+ *
+ * Unlike Linux ``recvmmsg()``, the timeout is given in milliseconds, as for
+ * ``zsock_poll()``, so this function is not exposed under a POSIX name.
+ * @endrst
+ *
+ * @return Number of datagrams received, or -1 with errno set if none was
+ *	   received (EAGAIN if the timeout expired).
+ */
+__syscall int zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			     unsigned int vlen, int flags, int timeout);
+
 /**
  * @brief Receive data from an arbitrary network address
  *
@@ -385,6 +487,68 @@ static inline ssize_t zsock_recv(int sock, void *buf, size_t max_len,
 	return zsock_recvfrom(sock, buf, max_len, flags, NULL, NULL);
 }
 
+#if defined(CONFIG_NET_SOCKETS_ZEROCOPY)
+struct net_buf;
+
+/**
+ * @brief Receive data as a net_buf fragment chain, without copying it
+ *
+ * @details
+ * The received data is handed over in the network buffers it arrived
+ * in. The caller owns the returned chain and must release it with
+ * net_buf_unref() once done, as the buffers are taken from the network
+ * RX pool.
+ *
+ * For a stream socket, whole fragments are returned as long as they fit
+ * into @a max_len, the rest stays queued for the next call. For
+ * a datagram socket the whole datagram is returned and it stays queued
+ * if it is larger than @a max_len. In both cases the call fails with
+ * EMSGSIZE if not even the first fragment fits. ZSOCK_MSG_PEEK is not
+ * supported.
+ *
+ * This function can be called only from supervisor threads and only on
+ * native sockets.
+ *
+ * @param sock Socket descriptor
+ * @param frags Returns the received fragment chain
+ * @param max_len Maximum number of bytes to receive
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ * @param src_addr Source address of the data, can be NULL
+ * @param addrlen Length of @a src_addr, updated with the actual length
+ *
+ * @return Number of bytes received, 0 on EOF, -1 on error with errno set
+ */
+ssize_t zsock_recv_buf(int sock, struct net_buf **frags, size_t max_len,
+		       int flags, struct sockaddr *src_addr,
+		       socklen_t *addrlen);
+
+/**
+ * @brief Send a net_buf fragment chain
+ *
+ * @details
+ * The socket takes over the caller's reference to @a frags, both on
+ * success and on failure. The buffers must have been allocated from
+ * a pool which is not released before the data has been sent. A datagram
+ * socket sends the chain without copying it, as a single datagram after
+ * the protocol headers. A stream socket queues the chain in its send
+ * buffer without copying it, but each TCP segment is still copied out of
+ * that buffer when it is transmitted.
+ *
+ * This function can be called only from supervisor threads and only on
+ * native UDP and (with CONFIG_NET_TCP2) TCP sockets.
+ *
+ * @param sock Socket descriptor
+ * @param frags Fragment chain to send
+ * @param flags ZSOCK_MSG_DONTWAIT or 0
+ * @param dest_addr Destination address, NULL for a connected socket
+ * @param addrlen Length of @a dest_addr
+ *
+ * @return Number of bytes sent, -1 on error with errno set
+ */
+ssize_t zsock_send_buf(int sock, struct net_buf *frags, int flags,
+		       const struct sockaddr *dest_addr, socklen_t addrlen);
+#endif /* CONFIG_NET_SOCKETS_ZEROCOPY */
+
 /**
  * @brief Control blocking/non-blocking mode of a socket
  *
@@ -685,6 +849,12 @@ static inline ssize_t sendmsg(int sock, const struct msghdr *message,
 	return zsock_sendmsg(sock, message, flags);
 }
 
+static inline int sendmmsg(int sock, struct mmsghdr *msgvec,
+			   unsigned int vlen, int flags)
+{
+	return zsock_sendmmsg(sock, msgvec, vlen, flags);
+}
+
 static inline ssize_t recvfrom(int sock, void *buf, size_t max_len, int flags,
 			       struct sockaddr *src_addr, socklen_t *addrlen)
 {
@@ -765,6 +935,7 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 
 #define MSG_PEEK ZSOCK_MSG_PEEK
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
+#define MSG_WAITFORONE ZSOCK_MSG_WAITFORONE
 
 #define SHUT_RD ZSOCK_SHUT_RD
 #define SHUT_WR ZSOCK_SHUT_WR
@@ -795,6 +966,8 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 /* Socket options for IPPROTO_TCP level */
 /** sockopt: Disable TCP buffering (ignored, for compatibility) */
 #define TCP_NODELAY 1
+/** sockopt: Congestion control algorithm of the connection, given by name */
+#define TCP_CONGESTION 13
 
 /* Socket options for IPPROTO_IPV6 level */
 /** sockopt: Don't support IPv4 access (ignored, for compatibility) */
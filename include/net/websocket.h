@@ -171,6 +171,78 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 		       uint32_t *message_type, uint64_t *remaining, int32_t timeout);
 
+/**
+ * Maximum number of payload buffers that can be given to
+ * websocket_send_msg_iov() in one call.
+ */
+#define WEBSOCKET_MAX_IOV 8
+
+/**
+ * @brief Send websocket msg to peer from a scatter/gather list.
+ *
+ * @details The function will automatically add websocket header to the
+ * message and send the header and the payload buffers with a single
+ * sendmsg() call without copying the payload. If masking is requested, the
+ * payload buffers are masked in place, so their content is not preserved.
+ *
+ * @param ws_sock Websocket id returned by websocket_connect().
+ * @param iov Payload buffers to send.
+ * @param iovcnt Number of payload buffers, at most WEBSOCKET_MAX_IOV.
+ * @param opcode Operation code (text, binary, ping, pong, close)
+ * @param mask Mask the data, see RFC 6455 for details
+ * @param final Is this final message for this message send. See
+ *        websocket_send_msg() for details.
+ * @param timeout How long to try to send the message. The value is in
+ *        milliseconds. Value SYS_FOREVER_MS means to wait forever.
+ *
+ * @return <0 if error, >=0 amount of payload bytes sent
+ */
+int websocket_send_msg_iov(int ws_sock, struct iovec *iov, size_t iovcnt,
+			   enum websocket_opcode opcode, bool mask, bool final,
+			   int32_t timeout);
+
+/**
+ * Websocket frame information returned by websocket_recv_frames().
+ */
+struct websocket_frame {
+	/** Start of the frame payload in the user supplied buffer. */
+	uint8_t *data;
+
+	/** Length of the payload returned for this frame. */
+	size_t len;
+
+	/** Type of the message, see WEBSOCKET_FLAG_* values. */
+	uint32_t message_type;
+
+	/** How much there is data left in the message after this frame. */
+	uint64_t remaining;
+};
+
+/**
+ * @brief Receive several websocket frames from peer with one call.
+ *
+ * @details The function waits at most timeout milliseconds for the first
+ * frame and then returns all the frames that are already available without
+ * blocking. The payloads are stored back to back into buf and described by
+ * the frames array. A frame that does not fit into the buffer is returned
+ * partially, and the rest of it is returned by the next call.
+ *
+ * @param ws_sock Websocket id returned by websocket_connect().
+ * @param buf Buffer where websocket data is read.
+ * @param buf_len Length of the data buffer.
+ * @param frames Array where the frame information is stored.
+ * @param max_frames Number of entries in the frames array.
+ * @param timeout How long to wait for the first frame.
+ *        The value is in milliseconds. Value SYS_FOREVER_MS means to wait
+ *        forever.
+ *
+ * @return <0 if error, 0 if the connection is closed, >0 number of frames
+ *         stored into the frames array
+ */
+int websocket_recv_frames(int ws_sock, uint8_t *buf, size_t buf_len,
+			  struct websocket_frame *frames, size_t max_frames,
+			  int32_t timeout);
+
 /**
  * @brief Close websocket.
  *
@@ -8,6 +8,7 @@
 #define SHELL_RTT_H__
 
 #include <shell/shell.h>
+#include <sys/atomic.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,6 +20,11 @@ struct shell_rtt {
 	shell_transport_handler_t handler;
 	struct k_timer timer;
 	void *context;
+	/* Set when the up buffer was full, TX_RDY is then signaled by the
+	 * timer so that the write is retried.
+	 */
+	atomic_t tx_pending;
+	uint32_t tx_retries;
 };
 
 #define SHELL_RTT_DEFINE(_name)					\
@@ -8,6 +8,7 @@
 #define SHELL_TELNET_H__
 
 #include <shell/shell.h>
+#include <sys/ring_buffer.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,15 +16,6 @@ extern "C" {
 
 extern const struct shell_transport_api shell_telnet_transport_api;
 
-/** Line buffer structure. */
-struct shell_telnet_line_buf {
-	/** Line buffer. */
-	char buf[CONFIG_SHELL_TELNET_LINE_BUF_SIZE];
-
-	/** Current line length. */
-	uint16_t len;
-};
-
 /** TELNET-based shell transport. */
 struct shell_telnet {
 	/** Handler function registered by shell. */
@@ -32,8 +24,11 @@ struct shell_telnet {
 	/** Context registered by shell. */
 	void *shell_context;
 
-	/** Buffer for outgoing line. */
-	struct shell_telnet_line_buf line_out;
+	/** Ring buffer for outgoing data. */
+	struct ring_buf tx_ringbuf;
+
+	/** Storage of the outgoing data ring buffer. */
+	uint8_t tx_buf[CONFIG_SHELL_TELNET_TX_BUF_SIZE];
 
 	/** Network context of TELNET client. */
 	struct net_context *client_ctx;
@@ -41,12 +36,17 @@ struct shell_telnet {
 	/** RX packet FIFO. */
 	struct k_fifo rx_fifo;
 
-	/** The delayed work is used to send non-lf terminated output that has
-	 *  been around for "too long". This will prove to be useful
-	 *  to send the shell prompt for instance.
+	/** The delayed work sends the buffered output. It is submitted
+	 *  immediately once a line or a full line buffer is queued, otherwise
+	 *  non-lf terminated output is sent once it has been around for
+	 *  "too long". This will prove to be useful to send the shell prompt
+	 *  for instance.
 	 */
 	struct k_delayed_work send_work;
 
+	/** If set, the work discards the buffered output. */
+	atomic_t tx_discard;
+
 	/** If set, no output is sent to the TELNET client. */
 	bool output_lock;
 };
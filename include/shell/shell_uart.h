@@ -32,24 +32,27 @@ struct shell_uart_ctrl_blk {
 #endif /* CONFIG_MCUMGR_SMP_SHELL */
 };
 
-#ifdef CONFIG_SHELL_BACKEND_SERIAL_INTERRUPT_DRIVEN
+#if defined(CONFIG_SHELL_BACKEND_SERIAL_INTERRUPT_DRIVEN) || \
+	defined(CONFIG_SHELL_BACKEND_SERIAL_ASYNC)
 #define UART_SHELL_TX_RINGBUF_DECLARE(_name, _size) \
 	RING_BUF_DECLARE(_name##_tx_ringbuf, _size)
 
 #define UART_SHELL_TX_BUF_DECLARE(_name) \
 	uint8_t _name##_txbuf[SHELL_UART_TX_BUF_SIZE]
 
-#define UART_SHELL_RX_TIMER_DECLARE(_name) /* Empty */
-
 #define UART_SHELL_TX_RINGBUF_PTR(_name) (&_name##_tx_ringbuf)
 
-#define UART_SHELL_RX_TIMER_PTR(_name) NULL
-
-#else /* CONFIG_SHELL_BACKEND_SERIAL_INTERRUPT_DRIVEN */
+#else
 #define UART_SHELL_TX_RINGBUF_DECLARE(_name, _size) /* Empty */
 #define UART_SHELL_TX_BUF_DECLARE(_name) /* Empty */
-#define UART_SHELL_RX_TIMER_DECLARE(_name) static struct k_timer _name##_timer
 #define UART_SHELL_TX_RINGBUF_PTR(_name) NULL
+#endif
+
+#ifdef CONFIG_SHELL_BACKEND_SERIAL_INTERRUPT_DRIVEN
+#define UART_SHELL_RX_TIMER_DECLARE(_name) /* Empty */
+#define UART_SHELL_RX_TIMER_PTR(_name) NULL
+#else /* CONFIG_SHELL_BACKEND_SERIAL_INTERRUPT_DRIVEN */
+#define UART_SHELL_RX_TIMER_DECLARE(_name) static struct k_timer _name##_timer
 #define UART_SHELL_RX_TIMER_PTR(_name) (&_name##_timer)
 #endif /* CONFIG_SHELL_BACKEND_SERIAL_INTERRUPT_DRIVEN */
 
@@ -46,6 +46,12 @@
  *     s<stat-idx>
  *
  * E.g., "s0", "s1", etc.
+ *
+ * When CONFIG_STATS_PER_CPU is defined, each CPU counts in its own copy of
+ * the entries and the copies are summed when read.  Entries must then be
+ * read with STATS_GET() or stats_entry_get(), and written with STATS_SET().
+ * The entries at the offsets reported by stats_walk() hold the values as of
+ * the last stats_walk() or stats_snapshot() call.
  */
 
 #ifndef ZEPHYR_INCLUDE_STATS_STATS_H_
@@ -53,6 +59,9 @@
 
 #include <stddef.h>
 #include <zephyr/types.h>
+#ifdef CONFIG_STATS_PER_CPU
+#include <stats/stats_cpu.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,7 +95,15 @@ struct stats_hdr {
 /**
  * @brief Ends a stats group struct definition.
  */
+#ifdef CONFIG_STATS_PER_CPU
+#define STATS_SECT_END				\
+			uint8_t s_end[0];	\
+		} __aligned(STATS_CPU_ALIGN)	\
+		s_cpu[CONFIG_MP_NUM_CPUS + 1];	\
+	}
+#else
 #define STATS_SECT_END }
+#endif
 
 /* The following macros depend on whether CONFIG_STATS is defined.  If it is
  * not defined, then invocations of these macros get compiled out.
@@ -98,10 +115,30 @@ struct stats_hdr {
  *
  * @param group__               The stats group struct name.
  */
+#ifdef CONFIG_STATS_PER_CPU
+/* The entries are repeated for every CPU, s_cpu[0] holds the snapshot
+ * read through the offsets reported by stats_walk().
+ */
+#define STATS_SECT_START(group__)  \
+	STATS_SECT_DECL(group__) { \
+		struct stats_hdr s_hdr; \
+		struct {
+
+#define Z_STATS_ENTRY(var__) s_cpu[0].var__
+
+#define Z_STATS_ENTRIES_SIZE(group__) \
+	((size_t)((group__).s_cpu[0].s_end - (uint8_t *)&(group__).s_cpu[0]))
+#else
 #define STATS_SECT_START(group__)  \
 	STATS_SECT_DECL(group__) { \
 		struct stats_hdr s_hdr;
 
+#define Z_STATS_ENTRY(var__) var__
+
+#define Z_STATS_ENTRIES_SIZE(group__) \
+	(sizeof(group__) - sizeof(struct stats_hdr))
+#endif
+
 /**
  * @brief Declares a 32-bit stat entry inside a group struct.
  *
@@ -140,8 +177,18 @@ struct stats_hdr {
  * @param var__                 The statistic entry to increase.
  * @param n__                   The amount to increase the statistic entry by.
  */
+#ifdef CONFIG_STATS_PER_CPU
+#define STATS_INCN(group__, var__, n__)					\
+	do {								\
+		unsigned int key__ = arch_irq_lock();			\
+									\
+		(group__).s_cpu[stats_cpu_id() + 1].var__ += (n__);	\
+		arch_irq_unlock(key__);					\
+	} while (false)
+#else
 #define STATS_INCN(group__, var__, n__)	\
 	((group__).var__ += (n__))
+#endif
 
 /**
  * @brief Increments a statistic entry.
@@ -165,7 +212,40 @@ struct stats_hdr {
  * @param var__                 The statistic entry to clear.
  */
 #define STATS_CLEAR(group__, var__) \
-	((group__).var__ = 0)
+	STATS_SET(group__, var__, 0)
+
+/**
+ * @brief Reads a statistic entry.
+ *
+ * @param group__               The group containing the entry to read.
+ * @param var__                 The statistic entry to read.
+ */
+#ifdef CONFIG_STATS_PER_CPU
+#define STATS_GET(group__, var__)					\
+	((__typeof__((group__).Z_STATS_ENTRY(var__)))			\
+	 stats_entry_get(&(group__).s_hdr,				\
+			 offsetof(__typeof__(group__), Z_STATS_ENTRY(var__))))
+#else
+#define STATS_GET(group__, var__) \
+	((group__).var__)
+#endif
+
+/**
+ * @brief Sets a statistic entry to the specified value.
+ *
+ * @param group__               The group containing the entry to set.
+ * @param var__                 The statistic entry to set.
+ * @param val__                 The new value of the statistic entry.
+ */
+#ifdef CONFIG_STATS_PER_CPU
+#define STATS_SET(group__, var__, val__)				  \
+	stats_entry_set(&(group__).s_hdr,				  \
+			offsetof(__typeof__(group__), Z_STATS_ENTRY(var__)), \
+			(val__))
+#else
+#define STATS_SET(group__, var__, val__) \
+	((group__).var__ = (val__))
+#endif
 
 #define STATS_SIZE_16 (sizeof(uint16_t))
 #define STATS_SIZE_32 (sizeof(uint32_t))
@@ -173,7 +253,7 @@ struct stats_hdr {
 
 #define STATS_SIZE_INIT_PARMS(group__, size__) \
 	(size__),			       \
-	((sizeof(group__)) - sizeof(struct stats_hdr)) / (size__)
+	Z_STATS_ENTRIES_SIZE(group__) / (size__)
 
 /**
  * @brief Initializes and registers a statistics group.
@@ -193,7 +273,7 @@ struct stats_hdr {
 	stats_init_and_reg(						 \
 		&(group__).s_hdr,					 \
 		(size__),						 \
-		(sizeof(group__) - sizeof(struct stats_hdr)) / (size__), \
+		Z_STATS_ENTRIES_SIZE(group__) / (size__),		 \
 		STATS_NAME_INIT_PARMS(group__),				 \
 		(name__))
 
@@ -266,6 +346,46 @@ int stats_init_and_reg(struct stats_hdr *hdr, uint8_t size, uint16_t cnt,
  */
 void stats_reset(struct stats_hdr *shdr);
 
+/**
+ * @brief Reads a statistic entry.
+ *
+ * Sums the counts of all CPUs if CONFIG_STATS_PER_CPU is defined.  The sum
+ * wraps around at the size of the entry, like a single counter would.
+ *
+ * @param hdr                   The statistics group containing the entry.
+ * @param off                   The offset of the entry, from `hdr`.
+ *
+ * @return                      The value of the entry.
+ */
+uint64_t stats_entry_get(struct stats_hdr *hdr, uint16_t off);
+
+/**
+ * @brief Sets a statistic entry.
+ *
+ * Increments made by other CPUs at the same time may be lost.
+ *
+ * @param hdr                   The statistics group containing the entry.
+ * @param off                   The offset of the entry, from `hdr`.
+ * @param val                   The new value of the entry.
+ */
+void stats_entry_set(struct stats_hdr *hdr, uint16_t off, uint64_t val);
+
+/**
+ * @brief Takes a snapshot of all entries in a statistics group.
+ *
+ * Reads every entry of the group in one pass, without blocking the code
+ * updating the entries.  If CONFIG_STATS_PER_CPU is defined the snapshot is
+ * also stored in the entries at the offsets reported by stats_walk().
+ *
+ * @param hdr                   The statistics group to read.
+ * @param values                Buffer for the entry values, in entry order.
+ *                                  May be NULL if `cnt` is zero.
+ * @param cnt                   The number of values the buffer can hold.
+ *
+ * @return                      The number of values stored in `values`.
+ */
+int stats_snapshot(struct stats_hdr *hdr, uint64_t *values, uint16_t cnt);
+
 /** @typedef stats_walk_fn
  * @brief Function that gets applied to every stat entry during a walk.
  *
@@ -350,6 +470,8 @@ struct stats_hdr *stats_group_find(const char *name);
 #define STATS_INCN(group__, var__, n__)
 #define STATS_INC(group__, var__)
 #define STATS_CLEAR(group__, var__)
+#define STATS_GET(group__, var__) (0)
+#define STATS_SET(group__, var__, val__)
 #define STATS_INIT_AND_REG(group__, size__, name__) (0)
 
 #endif /* !CONFIG_STATS */
@@ -362,7 +484,8 @@ struct stats_hdr *stats_group_find(const char *name);
 	const struct stats_name_map STATS_NAME_MAP_NAME(sectname__)[] = {
 
 #define STATS_NAME(sectname__, entry__)	\
-	{ offsetof(STATS_SECT_DECL(sectname__), entry__), #entry__ },
+	{ offsetof(STATS_SECT_DECL(sectname__), Z_STATS_ENTRY(entry__)), \
+	  #entry__ },
 
 #define STATS_NAME_END(sectname__) }
 
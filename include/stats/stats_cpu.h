@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Helpers for counters sharded per CPU
+ *
+ * A sharded counter keeps one copy of its value per CPU. Each CPU only
+ * writes its own copy, with interrupts locked, so that updates need neither
+ * atomic operations nor a shared cache line. Readers sum the copies of all
+ * CPUs.
+ */
+
+#ifndef ZEPHYR_INCLUDE_STATS_STATS_CPU_H_
+#define ZEPHYR_INCLUDE_STATS_STATS_CPU_H_
+
+#include <kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Alignment of the copies of different CPUs
+ *
+ * Keeps the copies in separate cache lines on the supported SMP
+ * platforms.
+ */
+#ifdef CONFIG_SMP
+#define STATS_CPU_ALIGN 64
+#else
+#define STATS_CPU_ALIGN 4
+#endif
+
+/**
+ * @brief Get the index of the shard of the current CPU
+ *
+ * Must be called with interrupts locked so that the calling thread can not
+ * migrate before it is done with the shard.
+ *
+ * @return Index of the current CPU.
+ */
+static inline unsigned int stats_cpu_id(void)
+{
+#ifdef CONFIG_SMP
+	return arch_curr_cpu()->id;
+#else
+	return 0;
+#endif
+}
+
+/**
+ * @brief Read a 64-bit shard written by another CPU
+ *
+ * The shard is updated with two stores on 32-bit CPUs, the read is
+ * repeated until two reads agree so that a half-updated value is never
+ * returned.
+ *
+ * @param shard Shard to read.
+ *
+ * @return Value of the shard.
+ */
+static inline uint64_t stats_cpu_read64(const volatile uint64_t *shard)
+{
+	uint64_t val;
+
+#if defined(CONFIG_SMP) && !defined(CONFIG_64BIT)
+	do {
+		val = *shard;
+	} while (val != *shard);
+#else
+	val = *shard;
+#endif
+
+	return val;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_STATS_STATS_CPU_H_ */
@@ -710,6 +710,54 @@ size_t arch_cache_line_size_get(void);
 #endif
 /** @} */
 
+/**
+ * @defgroup arch-profiling Architecture-specific profiling APIs
+ * @ingroup arch-interface
+ * @{
+ */
+
+#ifdef CONFIG_ARCH_HAS_STACK_SAMPLE
+/**
+ * @brief Sample the call stack of the interrupted thread
+ *
+ * Called from the system timer interrupt. Stores the program counter of
+ * the thread interrupted by it, followed by the return addresses found by
+ * walking its frame pointer chain.
+ *
+ * @param buf Buffer for the addresses, innermost first
+ * @param size Number of entries in @a buf
+ * @return Number of addresses stored, 0 if no thread was interrupted
+ */
+size_t arch_stack_sample(uintptr_t *buf, size_t size);
+#endif /* CONFIG_ARCH_HAS_STACK_SAMPLE */
+
+/** @} */
+
+/**
+ * @defgroup arch-static-branch Architecture-specific static branch APIs
+ * @ingroup arch-interface
+ * @{
+ */
+
+#ifdef CONFIG_ARCH_HAS_STATIC_BRANCH
+struct static_branch_entry;
+
+/**
+ * @brief Patch a static branch
+ *
+ * Rewrites the instruction emitted by arch_static_branch() at
+ * @a entry into a jump to the conditional code, or back into a no-op.
+ * The new instruction must be visible to all CPUs on return.
+ *
+ * @param entry Static branch to patch
+ * @param enable True to jump to the conditional code
+ */
+void arch_static_branch_patch(const struct static_branch_entry *entry,
+			      bool enable);
+#endif /* CONFIG_ARCH_HAS_STATIC_BRANCH */
+
+/** @} */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
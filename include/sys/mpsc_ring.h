@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Lock-free multi producer, single consumer ring of variable size
+ *	  records.
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_MPSC_RING_H_
+#define ZEPHYR_INCLUDE_SYS_MPSC_RING_H_
+
+#include <kernel.h>
+#include <sys/atomic.h>
+#include <sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Multi producer, single consumer ring
+ * @defgroup mpsc_ring_apis MPSC ring APIs
+ * @ingroup kernel_apis
+ * @{
+ *
+ * Records are stored contiguously in the ring, each one preceded by a one
+ * word header. Producers reserve space with a compare and swap on the head
+ * index, fill the record in place and commit it, so they never take a lock
+ * and can run in any context, including ISRs and on several CPUs at once.
+ * The consumer claims committed records in the order they were reserved.
+ * A claimed record may be freed out of order; its space is given back to
+ * producers once all older records are freed as well.
+ *
+ * Only one context may claim records at a time, records can be freed from
+ * any context.
+ */
+
+/** @brief Ring storage unit. Records are aligned to it. */
+typedef uintptr_t mpsc_ring_word_t;
+
+/**
+ * @brief A structure to represent a MPSC ring
+ */
+struct mpsc_ring {
+	mpsc_ring_word_t *buf; /**< Storage, size words long */
+	uint32_t mask;	       /**< Modulo mask, size is a power of 2 */
+	atomic_t head;	       /**< Producers reserve from here */
+	atomic_t tail;	       /**< First word not given back yet */
+	atomic_t rd;	       /**< Next record to claim */
+	atomic_t reclaiming;   /**< Set while space is given back */
+	atomic_t dropped;      /**< Failed allocations */
+};
+
+/**
+ * @brief Statically define and initialize a MPSC ring.
+ *
+ * @param name Name of the ring.
+ * @param pow Ring size exponent, the ring holds 2^pow words.
+ */
+#define MPSC_RING_DEFINE_POW2(name, pow)				\
+	static mpsc_ring_word_t _mpsc_ring_data_##name[BIT(pow)];	\
+	struct mpsc_ring name = {					\
+		.buf = _mpsc_ring_data_##name,				\
+		.mask = BIT(pow) - 1,					\
+	}
+
+/**
+ * @brief Initialize a MPSC ring.
+ *
+ * Only the largest power of 2 number of words that fits in the buffer is
+ * used.
+ *
+ * @param ring Address of the ring.
+ * @param data Ring storage, aligned to @ref mpsc_ring_word_t.
+ * @param size Size of the storage in bytes.
+ */
+void mpsc_ring_init(struct mpsc_ring *ring, void *data, size_t size);
+
+/**
+ * @brief Reserve a record.
+ *
+ * The record is invisible to the consumer until it is committed.
+ *
+ * @param ring Address of the ring.
+ * @param len Record length in bytes.
+ *
+ * @return Record address aligned to @ref mpsc_ring_word_t, or NULL if the
+ *	   ring does not have enough free space.
+ */
+void *mpsc_ring_alloc(struct mpsc_ring *ring, size_t len);
+
+/**
+ * @brief Commit a record returned by mpsc_ring_alloc().
+ *
+ * @param ring Address of the ring.
+ * @param data Record address.
+ */
+void mpsc_ring_commit(struct mpsc_ring *ring, void *data);
+
+/**
+ * @brief Claim the oldest committed record.
+ *
+ * Records that were freed before being committed are skipped. A record
+ * that is reserved but not committed yet holds back all newer records.
+ *
+ * @param ring Address of the ring.
+ * @param len If not NULL, set to the length of the record in bytes,
+ *	      rounded up to whole words.
+ *
+ * @return Record address or NULL if no committed record is pending.
+ */
+void *mpsc_ring_claim(struct mpsc_ring *ring, size_t *len);
+
+/**
+ * @brief Free a record.
+ *
+ * Both claimed and uncommitted records can be freed, in any order and from
+ * any context.
+ *
+ * @param ring Address of the ring.
+ * @param data Record address.
+ */
+void mpsc_ring_free(struct mpsc_ring *ring, void *data);
+
+/**
+ * @brief Check whether the next record can be claimed.
+ *
+ * @param ring Address of the ring.
+ *
+ * @return true if the oldest unclaimed record is committed or freed.
+ */
+bool mpsc_ring_is_pending(struct mpsc_ring *ring);
+
+/**
+ * @brief Get the number of failed allocations since the last call.
+ *
+ * @param ring Address of the ring.
+ *
+ * @return Number of failed allocations.
+ */
+static inline uint32_t mpsc_ring_dropped_get(struct mpsc_ring *ring)
+{
+	return (uint32_t)atomic_set(&ring->dropped, 0);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_SYS_MPSC_RING_H_ */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Static keys
+ *
+ * A static key is a flag which is read very often, on hot paths, and
+ * changed very rarely. Code tests a key with static_branch_unlikely().
+ *
+ * With CONFIG_STATIC_BRANCH_PATCHING, the test compiles to a no-op
+ * instruction which static_key_enable() patches into a jump to the
+ * conditional code, and static_key_disable() back to a no-op. A disabled
+ * key then costs a single no-op instruction and no data access. Elsewhere
+ * the test reads the key and branches, predicted as not taken.
+ *
+ * Keys are disabled at boot.
+ */
+
+#ifndef ZEPHYR_INCLUDE_SYS_STATIC_KEY_H_
+#define ZEPHYR_INCLUDE_SYS_STATIC_KEY_H_
+
+#include <sys/atomic.h>
+#include <toolchain.h>
+#include <stdbool.h>
+#include <zephyr/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup static_key_apis Static Key APIs
+ * @ingroup kernel_apis
+ * @{
+ */
+
+/** @brief Static key */
+struct static_key {
+	/** @cond INTERNAL_HIDDEN */
+	atomic_t enabled;
+	/** @endcond */
+};
+
+/** @cond INTERNAL_HIDDEN */
+
+/* Location of a static branch, emitted by arch_static_branch() in the
+ * static_branch_entry iterable section.
+ */
+struct static_branch_entry {
+	/* Address of the patched instruction */
+	uintptr_t code;
+	/* Address of the conditional code */
+	uintptr_t target;
+	struct static_key *key;
+};
+
+/** @endcond */
+
+#ifdef CONFIG_STATIC_BRANCH_PATCHING
+#if defined(CONFIG_X86)
+#include <arch/x86/ia32/static_branch.h>
+#elif defined(CONFIG_ARM)
+#include <arch/arm/aarch32/static_branch.h>
+#endif
+#endif
+
+/**
+ * @brief Statically define a static key
+ *
+ * @param name Name of the key.
+ */
+#define STATIC_KEY_DEFINE(name) \
+	struct static_key name = { .enabled = ATOMIC_INIT(0) }
+
+/**
+ * @brief Get the state of a static key
+ *
+ * @param key Static key.
+ *
+ * @return true if the key is enabled.
+ */
+static inline bool static_key_enabled(struct static_key *key)
+{
+	return atomic_get(&key->enabled) != 0;
+}
+
+/**
+ * @brief Test a static key on a hot path
+ *
+ * Must be given the address of a statically defined key, for the branch
+ * to be patched.
+ *
+ * @param key Static key.
+ *
+ * @return true if the key is enabled.
+ */
+static ALWAYS_INLINE bool static_branch_unlikely(struct static_key *key)
+{
+#ifdef CONFIG_STATIC_BRANCH_PATCHING
+	return arch_static_branch(key);
+#else
+	return unlikely(static_key_enabled(key));
+#endif
+}
+
+/**
+ * @brief Enable a static key
+ *
+ * Takes the branches of the key. Patching the code takes time
+ * proportional to the number of static branches in the image, do not
+ * call from hot paths.
+ *
+ * @param key Static key.
+ */
+void static_key_enable(struct static_key *key);
+
+/**
+ * @brief Disable a static key
+ *
+ * @param key Static key.
+ */
+void static_key_disable(struct static_key *key);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_SYS_STATIC_KEY_H_ */
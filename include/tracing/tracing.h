@@ -18,6 +18,46 @@
 #define SYS_TRACE_ID_SEMA_GIVE               (5u + SYS_TRACE_ID_OFFSET)
 #define SYS_TRACE_ID_SEMA_TAKE               (6u + SYS_TRACE_ID_OFFSET)
 
+#ifdef CONFIG_TRACING_STATIC_KEYS
+#include <sys/static_key.h>
+
+/* Runtime switches of the tracepoint categories */
+extern struct static_key tracing_key_thread;
+extern struct static_key tracing_key_isr;
+extern struct static_key tracing_key_idle;
+extern struct static_key tracing_key_ipc;
+
+/**
+ * @brief Make a tracing call if its category is enabled
+ *
+ * @param category Tracepoint category: thread, isr, idle or ipc
+ * @param call Call to the tracing hook
+ */
+#define SYS_TRACE_POINT(category, call)					\
+	do {								\
+		if (static_branch_unlikely(&tracing_key_##category)) {	\
+			call;						\
+		}							\
+	} while (false)
+
+/**
+ * @brief Enable or disable a tracepoint category
+ *
+ * @param name Category name: thread, isr, idle or ipc
+ * @param enable True to enable the category
+ *
+ * @return 0 on success, -EINVAL if the category is unknown.
+ */
+int tracing_category_set(const char *name, bool enable);
+
+/**
+ * @brief Enable or disable all tracepoint categories
+ *
+ * @param enable True to enable the categories
+ */
+void tracing_categories_set(bool enable);
+#endif /* CONFIG_TRACING_STATIC_KEYS */
+
 #ifdef CONFIG_SEGGER_SYSTEMVIEW
 #include "tracing_sysview.h"
 
@@ -114,10 +114,12 @@ static ALWAYS_INLINE unsigned int do_swap(unsigned int key,
 		}
 #endif
 		_current_cpu->current = new_thread;
+		z_sched_usage_switch();
 		wait_for_switch(new_thread);
 		arch_switch(new_thread->switch_handle,
 			     &old_thread->switch_handle);
 		sys_trace_thread_switched_in();
+		z_irq_stats_resumed();
 	}
 
 	if (is_spinlock) {
@@ -162,6 +164,7 @@ static inline int z_swap_irqlock(unsigned int key)
 #ifndef CONFIG_ARM
 	sys_trace_thread_switched_in();
 #endif
+	z_irq_stats_resumed();
 	return ret;
 }
 
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <spinlock.h>
+#include <string.h>
+#include <sys/util.h>
+
+/* Interrupt accounting. The interrupt entry code of each architecture
+ * pushes the IRQ and its entry time on a per-CPU stack, and the exit code
+ * pops it and charges the elapsed cycles, less the time spent in the
+ * interrupts nested in it, to the IRQ.
+ *
+ * A thread woken by k_sem_give() in an ISR records the IRQ and its entry
+ * time, and charges the wakeup latency to the IRQ when it next resumes
+ * from z_swap().
+ */
+
+#ifdef CONFIG_X86
+#define NUM_IRQS CONFIG_MAX_IRQ_LINES
+#else
+#define NUM_IRQS CONFIG_NUM_IRQS
+#endif
+
+#define MAX_NESTING CONFIG_IRQ_STATS_MAX_NESTING
+
+struct irq_frame {
+	unsigned int irq;
+	uint32_t start;
+	/* Cycles spent in the interrupts nested in this one */
+	uint32_t nested_cycles;
+};
+
+struct irq_stack {
+	struct irq_frame frames[MAX_NESTING];
+	/* Number of interrupts being handled, may exceed MAX_NESTING */
+	uint32_t depth;
+};
+
+static struct k_spinlock irq_stats_lock;
+static struct irq_stack irq_stacks[CONFIG_MP_NUM_CPUS];
+static struct irq_stats irq_stats[NUM_IRQS];
+static unsigned int irq_max_nesting;
+
+static void duration_add(struct irq_duration *duration, uint32_t cycles)
+{
+	if (duration->count == 0U) {
+		duration->min_cycles = cycles;
+		duration->max_cycles = cycles;
+	} else {
+		duration->min_cycles = MIN(duration->min_cycles, cycles);
+		duration->max_cycles = MAX(duration->max_cycles, cycles);
+	}
+
+	duration->count++;
+	duration->total_cycles += cycles;
+}
+
+void z_irq_stats_enter(unsigned int irq)
+{
+	k_spinlock_key_t key = k_spin_lock(&irq_stats_lock);
+	struct irq_stack *stack = &irq_stacks[_current_cpu->id];
+	uint32_t depth = stack->depth++;
+
+	irq_max_nesting = MAX(irq_max_nesting, stack->depth);
+
+	if ((depth != 0U) && (irq < NUM_IRQS)) {
+		irq_stats[irq].nested++;
+	}
+
+	if (depth < MAX_NESTING) {
+		struct irq_frame *frame = &stack->frames[depth];
+
+		frame->irq = irq;
+		frame->nested_cycles = 0U;
+		frame->start = k_cycle_get_32();
+	}
+
+	k_spin_unlock(&irq_stats_lock, key);
+}
+
+void z_irq_stats_exit(void)
+{
+	uint32_t now = k_cycle_get_32();
+	k_spinlock_key_t key = k_spin_lock(&irq_stats_lock);
+	struct irq_stack *stack = &irq_stacks[_current_cpu->id];
+	struct irq_frame *frame;
+	uint32_t cycles;
+
+	__ASSERT_NO_MSG(stack->depth != 0U);
+	stack->depth--;
+
+	if (stack->depth >= MAX_NESTING) {
+		/* Not timed */
+		goto out;
+	}
+
+	frame = &stack->frames[stack->depth];
+	cycles = now - frame->start;
+
+	if (frame->irq < NUM_IRQS) {
+		duration_add(&irq_stats[frame->irq].run,
+			     cycles - frame->nested_cycles);
+	}
+
+	if (stack->depth != 0U) {
+		frame[-1].nested_cycles += cycles;
+	}
+
+out:
+	k_spin_unlock(&irq_stats_lock, key);
+}
+
+void z_irq_stats_wakeup(struct k_thread *thread)
+{
+	k_spinlock_key_t key = k_spin_lock(&irq_stats_lock);
+	struct irq_stack *stack = &irq_stacks[_current_cpu->id];
+	struct irq_frame *frame;
+
+	if ((stack->depth == 0U) || (stack->depth > MAX_NESTING)) {
+		/* Not called from a timed ISR */
+		goto out;
+	}
+
+	frame = &stack->frames[stack->depth - 1U];
+
+	thread->irq_wakeup.irq = frame->irq;
+	thread->irq_wakeup.isr_start = frame->start;
+	thread->irq_wakeup.give = k_cycle_get_32();
+	thread->irq_wakeup.pending = true;
+
+out:
+	k_spin_unlock(&irq_stats_lock, key);
+}
+
+void z_irq_stats_resumed(void)
+{
+	struct _thread_irq_wakeup *wakeup = &_current->irq_wakeup;
+	uint32_t now;
+	k_spinlock_key_t key;
+
+	if (likely(!wakeup->pending)) {
+		return;
+	}
+
+	now = k_cycle_get_32();
+	key = k_spin_lock(&irq_stats_lock);
+
+	wakeup->pending = false;
+	wakeup->has_last = true;
+	wakeup->last.irq = wakeup->irq;
+	wakeup->last.give_cycles = wakeup->give - wakeup->isr_start;
+	wakeup->last.run_cycles = now - wakeup->give;
+
+	if (wakeup->irq < NUM_IRQS) {
+		duration_add(&irq_stats[wakeup->irq].wakeup,
+			     now - wakeup->isr_start);
+	}
+
+	k_spin_unlock(&irq_stats_lock, key);
+}
+
+int irq_stats_get(unsigned int irq, struct irq_stats *stats)
+{
+	k_spinlock_key_t key;
+
+	if ((irq >= NUM_IRQS) || (stats == NULL)) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&irq_stats_lock);
+	*stats = irq_stats[irq];
+	k_spin_unlock(&irq_stats_lock, key);
+
+	return 0;
+}
+
+unsigned int irq_stats_max_nesting_get(void)
+{
+	return irq_max_nesting;
+}
+
+void irq_stats_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&irq_stats_lock);
+
+	(void)memset(irq_stats, 0, sizeof(irq_stats));
+	irq_max_nesting = 0U;
+
+	k_spin_unlock(&irq_stats_lock, key);
+}
+
+int k_thread_irq_wakeup_get(k_tid_t thread, struct k_irq_wakeup *wakeup)
+{
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	if ((thread == NULL) || (wakeup == NULL)) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&irq_stats_lock);
+
+	if (thread->irq_wakeup.has_last) {
+		*wakeup = thread->irq_wakeup.last;
+	} else {
+		ret = -ENODATA;
+	}
+
+	k_spin_unlock(&irq_stats_lock, key);
+
+	return ret;
+}
@@ -113,6 +113,7 @@ void z_impl_k_sem_give(struct k_sem *sem)
 
 	if (thread != NULL) {
 		arch_thread_return_value_set(thread, 0);
+		z_irq_stats_wakeup(thread);
 		z_ready_thread(thread);
 	} else {
 		sem->count += (sem->count != sem->limit) ? 1U : 0U;
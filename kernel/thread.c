@@ -544,6 +544,13 @@ void z_setup_new_thread(struct k_thread *new_thread,
 #ifdef CONFIG_SCHED_CPU_MASK
 	new_thread->base.cpu_mask = -1;
 #endif
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	(void)memset(&new_thread->rt_stats, 0, sizeof(new_thread->rt_stats));
+#endif
+#ifdef CONFIG_IRQ_STATS
+	(void)memset(&new_thread->irq_wakeup, 0,
+		     sizeof(new_thread->irq_wakeup));
+#endif
 #ifdef CONFIG_ARCH_HAS_CUSTOM_SWAP_TO_MAIN
 	/* _current may be null if the dummy thread is not used */
 	if (!_current) {
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <ksched.h>
+#include <init.h>
+#include <sys/util.h>
+
+/* Runtime accounting. Each CPU remembers the thread it last charged and the
+ * cycle counter at that point. On every context switch and interrupt entry
+ * and exit the elapsed cycles are charged to that thread, or to the CPU
+ * interrupt time while handling an interrupt, and accounting restarts.
+ *
+ * Charging only touches the local CPU and the thread it runs, with
+ * interrupts locked, and takes no lock. Each CPU makes its usage_seq odd
+ * while it updates the counters, readers copy them and retry until they
+ * saw no update in progress.
+ */
+
+#define WINDOW_MS CONFIG_THREAD_RUNTIME_STATS_WINDOW
+
+#if WINDOW_MS > 0
+/* Incremented at the end of every window. Threads fold their window
+ * counters lazily when they are charged.
+ */
+static atomic_t usage_window;
+
+static void window_roll(struct _thread_runtime_stats *stats)
+{
+	uint32_t window = (uint32_t)atomic_get(&usage_window);
+
+	if (stats->window == window) {
+		return;
+	}
+
+	/* Nothing ran during the last window if more than one passed */
+	if ((stats->window + 1U) == window) {
+		stats->last_window_cycles = stats->window_cycles;
+	} else {
+		stats->last_window_cycles = 0U;
+	}
+
+	stats->window_cycles = 0U;
+	stats->window = window;
+}
+
+/* Cycles of the last complete window, without folding the counters */
+static uint64_t last_window_cycles(const struct _thread_runtime_stats *stats)
+{
+	uint32_t window = (uint32_t)atomic_get(&usage_window);
+
+	if (stats->window == window) {
+		return stats->last_window_cycles;
+	}
+
+	if ((stats->window + 1U) == window) {
+		return stats->window_cycles;
+	}
+
+	return 0U;
+}
+#endif
+
+static void usage_add(struct _cpu *cpu, uint32_t cycles)
+{
+	struct k_thread *thread = cpu->usage_thread;
+
+	cpu->usage.total_cycles += cycles;
+
+	if (cpu->usage_isr_nested != 0U) {
+		cpu->usage.isr_cycles += cycles;
+		return;
+	}
+
+	if (thread == NULL) {
+		/* Nothing scheduled yet, i.e. early boot */
+		return;
+	}
+
+	if (z_is_idle_thread_object(thread)) {
+		cpu->usage.idle_cycles += cycles;
+	}
+
+	thread->rt_stats.execution_cycles += cycles;
+#if WINDOW_MS > 0
+	window_roll(&thread->rt_stats);
+	thread->rt_stats.window_cycles += cycles;
+#endif
+}
+
+/* Called with interrupts locked, on the CPU being charged */
+static void usage_charge(struct _cpu *cpu)
+{
+	uint32_t now = k_cycle_get_32();
+	uint32_t cycles = now - cpu->usage_start;
+
+	cpu->usage_start = now;
+
+	atomic_inc(&cpu->usage_seq);
+	usage_add(cpu, cycles);
+	atomic_inc(&cpu->usage_seq);
+}
+
+static void usage_charge_local(void)
+{
+	unsigned int key = arch_irq_lock();
+
+	usage_charge(_current_cpu);
+
+	arch_irq_unlock(key);
+}
+
+/* Snapshot the update sequence of every CPU, waiting for updates in
+ * progress to complete.
+ */
+static void usage_seq_begin(uint32_t *seqs)
+{
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		do {
+			seqs[i] = (uint32_t)atomic_get(&_kernel.cpus[i].usage_seq);
+		} while ((seqs[i] & 1U) != 0U);
+	}
+}
+
+static bool usage_seq_retry(const uint32_t *seqs)
+{
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		if ((uint32_t)atomic_get(&_kernel.cpus[i].usage_seq) !=
+		    seqs[i]) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void z_sched_usage_switch(void)
+{
+	unsigned int key = arch_irq_lock();
+	struct _cpu *cpu = _current_cpu;
+
+	usage_charge(cpu);
+	cpu->usage_thread = cpu->current;
+
+	arch_irq_unlock(key);
+}
+
+void z_sched_usage_isr_enter(void)
+{
+	unsigned int key = arch_irq_lock();
+	struct _cpu *cpu = _current_cpu;
+
+	usage_charge(cpu);
+	cpu->usage_isr_nested++;
+
+	arch_irq_unlock(key);
+}
+
+void z_sched_usage_isr_exit(void)
+{
+	unsigned int key = arch_irq_lock();
+	struct _cpu *cpu = _current_cpu;
+
+	usage_charge(cpu);
+	__ASSERT_NO_MSG(cpu->usage_isr_nested != 0U);
+	cpu->usage_isr_nested--;
+
+	arch_irq_unlock(key);
+}
+
+int k_thread_runtime_stats_get(k_tid_t thread,
+			       k_thread_runtime_stats_t *stats)
+{
+	uint32_t seqs[CONFIG_MP_NUM_CPUS];
+
+	if ((thread == NULL) || (stats == NULL)) {
+		return -EINVAL;
+	}
+
+	/* Include the time since the last switch on this CPU */
+	usage_charge_local();
+
+	/* The thread may be charged by any CPU it runs on */
+	do {
+		usage_seq_begin(seqs);
+
+		stats->execution_cycles = thread->rt_stats.execution_cycles;
+#if WINDOW_MS > 0
+		stats->window_cycles = last_window_cycles(&thread->rt_stats);
+#endif
+	} while (usage_seq_retry(seqs));
+
+#if WINDOW_MS > 0
+	stats->window_length = k_ms_to_cyc_floor64(WINDOW_MS);
+#else
+	stats->window_cycles = 0U;
+	stats->window_length = 0U;
+#endif
+
+	return 0;
+}
+
+uint32_t k_thread_runtime_utilization_get(k_tid_t thread)
+{
+	k_thread_runtime_stats_t stats;
+	uint64_t percent;
+
+	if ((k_thread_runtime_stats_get(thread, &stats) != 0) ||
+	    (stats.window_length == 0U)) {
+		return 0U;
+	}
+
+	percent = (stats.window_cycles * 100U) / stats.window_length;
+
+	return (uint32_t)MIN(percent, 100U);
+}
+
+int k_cpu_runtime_stats_get(int cpu, struct k_cpu_runtime_stats *stats)
+{
+	uint32_t seqs[CONFIG_MP_NUM_CPUS];
+	unsigned int key;
+
+	if ((cpu < 0) || (cpu >= CONFIG_MP_NUM_CPUS) || (stats == NULL)) {
+		return -EINVAL;
+	}
+
+	key = arch_irq_lock();
+	if (cpu == _current_cpu->id) {
+		usage_charge(_current_cpu);
+	}
+	arch_irq_unlock(key);
+
+	do {
+		usage_seq_begin(seqs);
+		*stats = _kernel.cpus[cpu].usage;
+	} while (usage_seq_retry(seqs));
+
+	return 0;
+}
+
+#if WINDOW_MS > 0
+/* Runs in the timer interrupt. Where the architecture reports interrupt
+ * entry, the interrupted thread was charged then and the charge here
+ * only accounts interrupt time, otherwise it closes the window of the
+ * interrupted thread. Threads running on the other CPUs are folded at
+ * their next charge, so the cycles they ran since their previous charge
+ * count in the new window.
+ */
+static void usage_window_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	usage_charge_local();
+	atomic_inc(&usage_window);
+}
+
+static K_TIMER_DEFINE(usage_timer, usage_window_expiry, NULL);
+
+static int usage_init(struct device *dev)
+{
+	ARG_UNUSED(dev);
+
+	k_timer_start(&usage_timer, K_MSEC(WINDOW_MS), K_MSEC(WINDOW_MS));
+
+	return 0;
+}
+
+SYS_INIT(usage_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#endif /* WINDOW_MS > 0 */
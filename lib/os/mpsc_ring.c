@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <sys/mpsc_ring.h>
+#include <string.h>
+
+/* Every record starts with a header word. Its low bits hold the flags below
+ * and the rest the record length in words, header included. A zero header
+ * means the space is reserved but the producer did not write the header
+ * yet, which is why given back space is cleared.
+ */
+#define HDR_VALID BIT(0) /* Committed */
+#define HDR_SKIP  BIT(1) /* Padding up to the end of the ring */
+#define HDR_FREE  BIT(2) /* Freed, space can be given back */
+#define HDR_LEN_SHIFT 3
+
+#define WORD_SIZE sizeof(mpsc_ring_word_t)
+
+static inline atomic_t *hdr_get(struct mpsc_ring *ring, uint32_t idx)
+{
+	return (atomic_t *)&ring->buf[idx & ring->mask];
+}
+
+static inline uint32_t hdr_len(atomic_val_t hdr)
+{
+	return (uint32_t)hdr >> HDR_LEN_SHIFT;
+}
+
+static inline uint32_t ring_size(struct mpsc_ring *ring)
+{
+	return ring->mask + 1;
+}
+
+/* Give back the space of freed records, oldest first. Runs from whichever
+ * context frees or claims first, the others skip it.
+ */
+static void reclaim(struct mpsc_ring *ring)
+{
+	uint32_t tail, rd, len;
+	atomic_val_t hdr;
+
+	if (!atomic_cas(&ring->reclaiming, 0, 1)) {
+		return;
+	}
+
+	tail = (uint32_t)atomic_get(&ring->tail);
+	rd = (uint32_t)atomic_get(&ring->rd);
+
+	while (tail != rd) {
+		hdr = atomic_get(hdr_get(ring, tail));
+		if (!(hdr & HDR_FREE)) {
+			break;
+		}
+
+		len = hdr_len(hdr);
+		(void)memset(&ring->buf[tail & ring->mask], 0, len * WORD_SIZE);
+		tail += len;
+	}
+
+	atomic_set(&ring->tail, (atomic_val_t)tail);
+	atomic_clear(&ring->reclaiming);
+}
+
+void mpsc_ring_init(struct mpsc_ring *ring, void *data, size_t size)
+{
+	uint32_t words = size / WORD_SIZE;
+
+	__ASSERT_NO_MSG(words > 1);
+
+	/* Round down to a power of 2 */
+	while (words & (words - 1)) {
+		words &= words - 1;
+	}
+
+	ring->buf = data;
+	ring->mask = words - 1;
+	atomic_clear(&ring->head);
+	atomic_clear(&ring->tail);
+	atomic_clear(&ring->rd);
+	atomic_clear(&ring->reclaiming);
+	atomic_clear(&ring->dropped);
+
+	(void)memset(data, 0, words * WORD_SIZE);
+}
+
+void *mpsc_ring_alloc(struct mpsc_ring *ring, size_t len)
+{
+	uint32_t words = 1 + ceiling_fraction(len, WORD_SIZE);
+	uint32_t head, tail, pad, room;
+	bool retried = false;
+
+	if (words > ring_size(ring)) {
+		goto drop;
+	}
+
+	for (;;) {
+		head = (uint32_t)atomic_get(&ring->head);
+		tail = (uint32_t)atomic_get(&ring->tail);
+
+		/* A record never wraps, the space up to the end of the ring
+		 * is padded if the record does not fit there.
+		 */
+		room = ring_size(ring) - (head & ring->mask);
+		pad = (words > room) ? room : 0;
+
+		if ((head + pad + words - tail) > ring_size(ring)) {
+			if (retried) {
+				goto drop;
+			}
+
+			reclaim(ring);
+			retried = true;
+			continue;
+		}
+
+		if (atomic_cas(&ring->head, (atomic_val_t)head,
+			       (atomic_val_t)(head + pad + words))) {
+			break;
+		}
+	}
+
+	if (pad) {
+		atomic_set(hdr_get(ring, head),
+			   (pad << HDR_LEN_SHIFT) | HDR_SKIP | HDR_VALID);
+		head += pad;
+	}
+
+	atomic_set(hdr_get(ring, head), words << HDR_LEN_SHIFT);
+
+	return &ring->buf[(head & ring->mask) + 1];
+
+drop:
+	atomic_inc(&ring->dropped);
+
+	return NULL;
+}
+
+void mpsc_ring_commit(struct mpsc_ring *ring, void *data)
+{
+	mpsc_ring_word_t *word = (mpsc_ring_word_t *)data - 1;
+
+	(void)atomic_or((atomic_t *)word, HDR_VALID);
+}
+
+void *mpsc_ring_claim(struct mpsc_ring *ring, size_t *len)
+{
+	uint32_t rd = (uint32_t)atomic_get(&ring->rd);
+	atomic_val_t hdr;
+	void *data = NULL;
+
+	while (rd != (uint32_t)atomic_get(&ring->head)) {
+		hdr = atomic_get(hdr_get(ring, rd));
+
+		if (hdr & HDR_FREE) {
+			/* Dropped by its producer before being committed */
+			rd += hdr_len(hdr);
+			continue;
+		}
+
+		if (!(hdr & HDR_VALID)) {
+			break;
+		}
+
+		if (hdr & HDR_SKIP) {
+			(void)atomic_or(hdr_get(ring, rd), HDR_FREE);
+			rd += hdr_len(hdr);
+			continue;
+		}
+
+		data = &ring->buf[(rd & ring->mask) + 1];
+		if (len != NULL) {
+			*len = (hdr_len(hdr) - 1) * WORD_SIZE;
+		}
+
+		rd += hdr_len(hdr);
+		break;
+	}
+
+	atomic_set(&ring->rd, (atomic_val_t)rd);
+	reclaim(ring);
+
+	return data;
+}
+
+void mpsc_ring_free(struct mpsc_ring *ring, void *data)
+{
+	mpsc_ring_word_t *word = (mpsc_ring_word_t *)data - 1;
+
+	(void)atomic_or((atomic_t *)word, HDR_FREE);
+	reclaim(ring);
+}
+
+bool mpsc_ring_is_pending(struct mpsc_ring *ring)
+{
+	uint32_t rd = (uint32_t)atomic_get(&ring->rd);
+
+	if (rd == (uint32_t)atomic_get(&ring->head)) {
+		return false;
+	}
+
+	return (atomic_get(hdr_get(ring, rd)) & (HDR_VALID | HDR_FREE)) != 0;
+}
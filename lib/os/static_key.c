@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <kernel.h>
+#include <spinlock.h>
+#include <sys/static_key.h>
+
+/* Serializes updates of a key with patching its branches, so that the
+ * code always matches the state of the key.
+ */
+static struct k_spinlock static_key_lock;
+
+static void static_key_set(struct static_key *key, bool enable)
+{
+	k_spinlock_key_t k = k_spin_lock(&static_key_lock);
+
+	if (atomic_set(&key->enabled, enable) == (atomic_val_t)enable) {
+		/* No change */
+		goto out;
+	}
+
+#ifdef CONFIG_STATIC_BRANCH_PATCHING
+	Z_STRUCT_SECTION_FOREACH(static_branch_entry, entry) {
+		if (entry->key == key) {
+			arch_static_branch_patch(entry, enable);
+		}
+	}
+#endif
+
+out:
+	k_spin_unlock(&static_key_lock, k);
+}
+
+void static_key_enable(struct static_key *key)
+{
+	static_key_set(key, true);
+}
+
+void static_key_disable(struct static_key *key)
+{
+	static_key_set(key, false);
+}
@@ -39,6 +39,12 @@ LOG_MODULE_REGISTER(net_coap_server_sample, LOG_LEVEL_DBG);
 
 #define NUM_PENDINGS 3
 
+/* Number of datagrams received or sent with a single socket call */
+#define COAP_BATCH 8
+
+/* How often the request rate is logged */
+#define STATS_PERIOD_MS 10000
+
 /* CoAP socket fd */
 static int sock;
 
@@ -56,6 +62,25 @@ static struct coap_resource *resource_to_notify;
 
 static struct k_delayed_work retransmit_work;
 
+struct coap_batch {
+	uint8_t data[COAP_BATCH][MAX_COAP_MSG_LEN];
+	struct sockaddr addr[COAP_BATCH];
+	struct iovec iov[COAP_BATCH];
+	struct mmsghdr msgs[COAP_BATCH];
+	int count;
+};
+
+static struct coap_batch requests;
+static struct coap_batch replies;
+
+/* Replies sent while processing requests are batched, the ones sent from
+ * the work queue (retransmissions, notifications) are sent right away.
+ */
+static k_tid_t batch_thread;
+
+static uint32_t stats_start;
+static uint32_t stats_packets;
+
 #if defined(CONFIG_NET_IPV6)
 static bool join_coap_multicast_group(void)
 {
@@ -153,6 +178,44 @@ static int start_coap_server(void)
 }
 #endif
 
+static void init_coap_batch(struct coap_batch *batch)
+{
+	int i;
+
+	for (i = 0; i < COAP_BATCH; i++) {
+		batch->iov[i].iov_base = batch->data[i];
+		batch->iov[i].iov_len = sizeof(batch->data[i]);
+		batch->msgs[i].msg_hdr.msg_name = &batch->addr[i];
+		batch->msgs[i].msg_hdr.msg_namelen = sizeof(batch->addr[i]);
+		batch->msgs[i].msg_hdr.msg_iov = &batch->iov[i];
+		batch->msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	batch->count = 0;
+}
+
+static int flush_coap_replies(void)
+{
+	int sent = 0;
+	int r = 0;
+
+	while (sent < replies.count) {
+		r = sendmmsg(sock, &replies.msgs[sent], replies.count - sent,
+			     0);
+		if (r < 0) {
+			LOG_ERR("Failed to send %d", errno);
+			r = -errno;
+			break;
+		}
+
+		sent += r;
+	}
+
+	replies.count = 0;
+
+	return r;
+}
+
 static int send_coap_reply(struct coap_packet *cpkt,
 			   const struct sockaddr *addr,
 			   socklen_t addr_len)
@@ -161,6 +224,23 @@ static int send_coap_reply(struct coap_packet *cpkt,
 
 	net_hexdump("Response", cpkt->data, cpkt->offset);
 
+	if (k_current_get() == batch_thread) {
+		if (replies.count == COAP_BATCH) {
+			r = flush_coap_replies();
+			if (r < 0) {
+				return r;
+			}
+		}
+
+		memcpy(replies.data[replies.count], cpkt->data, cpkt->offset);
+		memcpy(&replies.addr[replies.count], addr, addr_len);
+		replies.iov[replies.count].iov_len = cpkt->offset;
+		replies.msgs[replies.count].msg_hdr.msg_namelen = addr_len;
+		replies.count++;
+
+		return cpkt->offset;
+	}
+
 	r = sendto(sock, cpkt->data, cpkt->offset, 0, addr, addr_len);
 	if (r < 0) {
 		LOG_ERR("Failed to send %d", errno);
@@ -1359,24 +1439,47 @@ end:
 	}
 }
 
+static void update_stats(int packets)
+{
+	uint32_t elapsed = k_uptime_get_32() - stats_start;
+
+	stats_packets += packets;
+
+	if (elapsed >= STATS_PERIOD_MS) {
+		LOG_INF("%u requests/s", stats_packets * 1000U / elapsed);
+		stats_packets = 0U;
+		stats_start += elapsed;
+	}
+}
+
 static int process_client_request(void)
 {
 	int received;
-	struct sockaddr client_addr;
-	socklen_t client_addr_len;
-	uint8_t request[MAX_COAP_MSG_LEN];
+	int i;
 
 	do {
-		client_addr_len = sizeof(client_addr);
-		received = recvfrom(sock, request, sizeof(request), 0,
-				    &client_addr, &client_addr_len);
+		for (i = 0; i < COAP_BATCH; i++) {
+			requests.msgs[i].msg_hdr.msg_namelen =
+				sizeof(requests.addr[i]);
+		}
+
+		received = zsock_recvmmsg(sock, requests.msgs, COAP_BATCH,
+					  MSG_WAITFORONE, -1);
 		if (received < 0) {
 			LOG_ERR("Connection error %d", errno);
 			return -errno;
 		}
 
-		process_coap_request(request, received, &client_addr,
-				     client_addr_len);
+		for (i = 0; i < received; i++) {
+			process_coap_request(requests.data[i],
+					     requests.msgs[i].msg_len,
+					     &requests.addr[i],
+					     requests.msgs[i].msg_hdr.msg_namelen);
+		}
+
+		flush_coap_replies();
+
+		update_stats(received);
 	} while (true);
 
 	return 0;
@@ -1405,6 +1508,11 @@ void main(void)
 	k_delayed_work_init(&retransmit_work, retransmit_request);
 	k_delayed_work_init(&observer_work, update_counter);
 
+	init_coap_batch(&requests);
+	init_coap_batch(&replies);
+	batch_thread = k_current_get();
+	stats_start = k_uptime_get_32();
+
 	while (1) {
 		r = process_client_request();
 		if (r < 0) {
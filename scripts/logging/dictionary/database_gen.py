@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+"""
+Generate the database used to decode dictionary based log output.
+
+The database holds the contents of the read only data sections of the ELF
+file, so that format strings and other string arguments can be read by
+address, and the log source names indexed by source ID.
+"""
+
+import sys
+import argparse
+import base64
+import json
+import struct
+from distutils.version import LooseVersion
+
+import elftools
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+from elftools.elf.constants import SH_FLAGS
+
+if LooseVersion(elftools.__version__) < LooseVersion('0.24'):
+    sys.exit("pyelftools is out of date, need version 0.24 or later")
+
+DB_VERSION = 1
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elffile", help="Zephyr ELF binary")
+    parser.add_argument("dbfile", help="output database file (JSON)")
+    return parser.parse_args()
+
+
+def get_symbols(elf):
+    for section in elf.iter_sections():
+        if isinstance(section, SymbolTableSection):
+            return {sym.name: sym.entry for sym in section.iter_symbols()}
+
+    raise LookupError("Could not find symbol table")
+
+
+# Bounds of the memory z_log_is_rodata() accepts, per architecture
+RODATA_BOUNDS = [
+    ("_image_rodata_start", "_image_rodata_end"),
+    ("_rodata_start", "_rodata_end"),
+    ("_image_rom_start", "_image_rom_end"),
+]
+
+
+def ro_sections(elf, syms):
+    """Initialized read only data sections, code is left out"""
+    start, end = 0, 0
+    for start_sym, end_sym in RODATA_BOUNDS:
+        if start_sym in syms and end_sym in syms:
+            start = syms[start_sym].st_value
+            end = syms[end_sym].st_value
+            break
+
+    for section in elf.iter_sections():
+        flags = section['sh_flags']
+        addr = section['sh_addr']
+        if (section['sh_type'] != 'SHT_PROGBITS' or
+                not flags & SH_FLAGS.SHF_ALLOC or
+                flags & (SH_FLAGS.SHF_WRITE | SH_FLAGS.SHF_EXECINSTR) or
+                section['sh_size'] == 0):
+            continue
+
+        # Without the bounds, fall back to the section name
+        if end > start:
+            if not start <= addr < end:
+                continue
+        elif "rodata" not in section.name:
+            continue
+
+        yield section
+
+
+def read_mem(elf, addr, size):
+    for section in elf.iter_sections():
+        start = section['sh_addr']
+        if section['sh_type'] == 'SHT_PROGBITS' and \
+                start <= addr < start + section['sh_size']:
+            offset = addr - start
+            return section.data()[offset:offset + size]
+
+    return None
+
+
+def read_string(elf, syms, addr):
+    for section in ro_sections(elf, syms):
+        start = section['sh_addr']
+        if start <= addr < start + section['sh_size']:
+            data = section.data()[addr - start:]
+            return data[:data.find(b'\0')].decode('utf-8', 'replace')
+
+    return "<unknown>"
+
+
+def log_sources(elf, syms):
+    """Source names in source ID order, see log_source_name_get()"""
+    if "__log_const_start" not in syms:
+        return []
+
+    start = syms["__log_const_start"].st_value
+    end = syms["__log_const_end"].st_value
+    ptr_size = elf.elfclass // 8
+    ptr_fmt = ("<" if elf.little_endian else ">") + \
+        ("I" if ptr_size == 4 else "Q")
+
+    # struct log_source_const_data size, including architecture padding
+    entry_size = 2 * ptr_size
+    for name, sym in syms.items():
+        if name.startswith("log_const_") and sym.st_size:
+            entry_size = sym.st_size
+            break
+
+    sources = []
+    for addr in range(start, end, entry_size):
+        data = read_mem(elf, addr, ptr_size)
+        name_addr = struct.unpack(ptr_fmt, data)[0]
+        sources.append(read_string(elf, syms, name_addr))
+
+    return sources
+
+
+def main():
+    args = parse_args()
+
+    with open(args.elffile, "rb") as fp:
+        elf = ELFFile(fp)
+        syms = get_symbols(elf)
+
+        db = {
+            "version": DB_VERSION,
+            "little_endian": elf.little_endian,
+            "ptr_size": elf.elfclass // 8,
+            "sources": log_sources(elf, syms),
+            "sections": [{
+                "name": section.name,
+                "start": section['sh_addr'],
+                "data": base64.b64encode(section.data()).decode('ascii'),
+            } for section in ro_sections(elf, syms)],
+        }
+
+    with open(args.dbfile, "w") as fp:
+        json.dump(db, fp)
+
+
+if __name__ == "__main__":
+    main()
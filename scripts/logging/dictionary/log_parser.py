@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+"""
+Decode dictionary based log output.
+
+Reads the binary stream produced with CONFIG_LOG_DICTIONARY_ENABLE, from a
+capture file or stdin, and prints the messages using the database generated
+at build time (log_dictionary.json in the build directory). The record
+format is described in include/logging/log_output_dict.h.
+"""
+
+import sys
+import argparse
+import base64
+import json
+import re
+import struct
+
+TYPE_STD = 0x1
+TYPE_HEXDUMP = 0x2
+TYPE_DROPPED = 0x3
+TYPE_SYNC = 0xF
+SYNC_MAGIC = bytes([TYPE_SYNC]) + b"ZLG"
+SYNC_VERSION = 1
+
+LEVELS = ["", "err", "wrn", "inf", "dbg"]
+
+HEXDUMP_BYTES_IN_LINE = 16
+
+# printf conversion: flags, width, precision, length modifier, conversion
+FMT_RE = re.compile(r"%([-+ #0]*)(\d*)(\.\d+)?(hh|h|ll|l|z|j|t|L)?([a-zA-Z%])")
+
+
+class ParseError(Exception):
+    pass
+
+
+class Database():
+    def __init__(self, path):
+        with open(path, "r") as fp:
+            db = json.load(fp)
+
+        self.endian = "<" if db["little_endian"] else ">"
+        self.ptr_size = db["ptr_size"]
+        self.sources = db["sources"]
+        self.sections = [(s["start"], base64.b64decode(s["data"]))
+                         for s in db["sections"]]
+
+    def string(self, addr):
+        for start, data in self.sections:
+            if start <= addr < start + len(data):
+                data = data[addr - start:]
+                end = data.find(b'\0')
+                return data[:end if end >= 0 else None].decode(
+                    'utf-8', 'replace')
+
+        return "<0x{:x}>".format(addr)
+
+    def source(self, source_id):
+        if source_id < len(self.sources):
+            return self.sources[source_id]
+
+        return "<source {}>".format(source_id)
+
+
+class Stream():
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, size):
+        if self.pos + size > len(self.data):
+            raise EOFError()
+
+        chunk = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return chunk
+
+    def unpack(self, fmt):
+        return struct.unpack(fmt, self.take(struct.calcsize(fmt)))
+
+    def cstring(self):
+        end = self.data.find(b'\0', self.pos)
+        if end < 0:
+            raise EOFError()
+
+        s = self.data[self.pos:end].decode('utf-8', 'replace')
+        self.pos = end + 1
+        return s
+
+    def resync(self):
+        """Skip to the next sync record, return False if there is none"""
+        pos = self.data.find(SYNC_MAGIC, self.pos)
+        if pos < 0:
+            return False
+
+        self.pos = pos
+        return True
+
+
+class Parser():
+    def __init__(self, db, out):
+        self.db = db
+        self.out = out
+        self.ptr_size = db.ptr_size
+        self.arg_size = db.ptr_size
+        self.freq = 0
+
+    def word_fmt(self, size):
+        return self.db.endian + ("I" if size == 4 else "Q")
+
+    def read_ptr(self, stream):
+        return stream.unpack(self.word_fmt(self.ptr_size))[0]
+
+    def read_str(self, stream):
+        addr = self.read_ptr(stream)
+        if addr == 0:
+            return stream.cstring()
+
+        return self.db.string(addr)
+
+    def timestamp(self, ts):
+        if not self.freq:
+            return "[{:08}]".format(ts)
+
+        us = ts * 1000000 // self.freq
+        ms, us = divmod(us, 1000)
+        s, ms = divmod(ms, 1000)
+        m, s = divmod(s, 60)
+        h, m = divmod(m, 60)
+        return "[{:02}:{:02}:{:02}.{:03},{:03}]".format(h, m, s, ms, us)
+
+    def prefix(self, level, source_id, ts):
+        return "{} <{}> {}: ".format(self.timestamp(ts), LEVELS[level],
+                                     self.db.source(source_id))
+
+    def format(self, fmt, stream, nargs):
+        """Format like printf, reading string arguments from the stream"""
+        arg_fmt = self.word_fmt(self.arg_size)
+        bits = 8 * self.arg_size
+        out = []
+        pos = 0
+        idx = 0
+
+        for m in FMT_RE.finditer(fmt):
+            out.append(fmt[pos:m.start()])
+            pos = m.end()
+            flags, width, prec, length, conv = m.groups()
+
+            if conv == '%':
+                out.append('%')
+                continue
+
+            if idx >= nargs:
+                out.append(m.group(0))
+                continue
+
+            idx += 1
+            spec = "%" + flags + width + (prec or "")
+            if conv == 's':
+                out.append((spec + "s") % self.read_str(stream))
+                continue
+
+            val = stream.unpack(arg_fmt)[0]
+            if conv in "di":
+                if val & (1 << (bits - 1)):
+                    val -= 1 << bits
+                out.append((spec + "d") % val)
+            elif conv == 'u':
+                out.append((spec + "d") % val)
+            elif conv in "xXoc":
+                out.append((spec + conv) % val)
+            elif conv == 'p':
+                out.append("0x%x" % val)
+            else:
+                out.append(m.group(0))
+
+        out.append(fmt[pos:])
+
+        # Arguments the format string does not reference
+        for _ in range(idx, nargs):
+            stream.unpack(arg_fmt)
+
+        return "".join(out)
+
+    def sync(self, stream):
+        magic = stream.take(len(SYNC_MAGIC))
+        version, ptr_size, arg_size, _, freq = stream.unpack(
+            self.db.endian + "BBBBI")
+        if magic != SYNC_MAGIC or version != SYNC_VERSION:
+            raise ParseError("unsupported stream version {}".format(version))
+
+        self.ptr_size = ptr_size
+        self.arg_size = arg_size
+        self.freq = freq
+
+    def record(self, stream):
+        rtype = stream.data[stream.pos]
+
+        if rtype == TYPE_SYNC:
+            self.sync(stream)
+            return
+
+        stream.take(1)
+        if rtype == TYPE_DROPPED:
+            cnt = stream.unpack(self.db.endian + "H")[0]
+            self.out.write("--- {} messages dropped ---\n".format(cnt))
+            return
+
+        level = rtype >> 4
+        rtype &= 0xF
+        _, source_id, ts = stream.unpack(self.db.endian + "BHI")
+
+        if level >= len(LEVELS):
+            raise ParseError("bad level {}".format(level))
+
+        if rtype == TYPE_STD:
+            nargs = stream.unpack("B")[0]
+            fmt = self.db.string(self.read_ptr(stream))
+            msg = self.format(fmt, stream, nargs)
+            if level == 0:
+                # Raw string, printk redirected to the logger
+                self.out.write(msg)
+            else:
+                self.out.write(self.prefix(level, source_id, ts) + msg + "\n")
+        elif rtype == TYPE_HEXDUMP:
+            metadata = self.read_str(stream)
+            length = stream.unpack(self.db.endian + "H")[0]
+            data = stream.take(length)
+            prefix = self.prefix(level, source_id, ts)
+            self.out.write(prefix + metadata + "\n")
+            for i in range(0, length, HEXDUMP_BYTES_IN_LINE):
+                line = data[i:i + HEXDUMP_BYTES_IN_LINE]
+                self.out.write(" " * len(prefix) +
+                               " ".join("{:02x}".format(b) for b in line) +
+                               "\n")
+        else:
+            raise ParseError("bad record type {}".format(rtype))
+
+    def parse(self, data):
+        stream = Stream(data)
+
+        if not stream.resync():
+            sys.exit("No sync record found")
+
+        while stream.pos < len(data):
+            start = stream.pos
+            try:
+                self.record(stream)
+            except EOFError:
+                break
+            except ParseError as e:
+                print("Skipping corrupted data: {}".format(e),
+                      file=sys.stderr)
+                stream.pos = start + 1
+                if not stream.resync():
+                    break
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dbfile", help="dictionary database file (JSON)")
+    parser.add_argument("logfile", nargs="?", default="-",
+                        help="captured binary log, stdin if omitted")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    db = Database(args.dbfile)
+
+    if args.logfile == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.logfile, "rb") as fp:
+            data = fp.read()
+
+    Parser(db, sys.stdout).parse(data)
+
+
+if __name__ == "__main__":
+    main()
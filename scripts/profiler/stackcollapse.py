@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+"""
+Convert the output of the "profiler dump" shell command to folded stacks.
+
+Addresses are resolved to function names using the symbol table of the
+Zephyr ELF file. Each output line holds a semicolon separated stack, from
+the thread down to the sampled function, followed by the sample count:
+
+    main;foo;bar 42
+
+This is the input format of flamegraph.pl and of most flame graph viewers.
+"""
+
+import sys
+import re
+import bisect
+import argparse
+from collections import Counter
+
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+# The thread is quoted, the greedy match keeps quotes within its name
+STACK_RE = re.compile(r'stack: (\d+) (\d+) "(.*)"((?: 0x[0-9a-fA-F]+)+)')
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elffile", help="Zephyr ELF binary")
+    parser.add_argument("dump", nargs="?", default="-",
+                        help="captured console output, stdin if omitted")
+    parser.add_argument("--per-cpu", action="store_true",
+                        help="start stacks with the CPU number")
+    parser.add_argument("--no-thread", action="store_true",
+                        help="do not start stacks with the thread")
+    return parser.parse_args()
+
+
+class Symbols():
+    def __init__(self, path):
+        funcs = {}
+
+        with open(path, "rb") as fp:
+            elf = ELFFile(fp)
+            # Thumb functions have the lowest address bit set
+            self.addr_mask = ~1 if elf['e_machine'] == 'EM_ARM' else ~0
+            for section in elf.iter_sections():
+                if not isinstance(section, SymbolTableSection):
+                    continue
+                for sym in section.iter_symbols():
+                    if (sym['st_info']['type'] == 'STT_FUNC' and
+                            sym['st_value'] != 0):
+                        addr = sym['st_value'] & self.addr_mask
+                        funcs[addr] = (sym.name, sym['st_size'])
+
+        self.addrs = sorted(funcs)
+        self.funcs = [funcs[addr] for addr in self.addrs]
+
+    def lookup(self, addr):
+        addr &= self.addr_mask
+        idx = bisect.bisect_right(self.addrs, addr) - 1
+        if idx >= 0:
+            name, size = self.funcs[idx]
+            if addr < self.addrs[idx] + max(size, 1):
+                return name
+
+        return "0x{:x}".format(addr)
+
+
+def main():
+    args = parse_args()
+    symbols = Symbols(args.elffile)
+
+    if args.dump == "-":
+        lines = sys.stdin
+    else:
+        lines = open(args.dump, "r", errors="replace")
+
+    folded = Counter()
+    for line in lines:
+        m = STACK_RE.search(line)
+        if not m:
+            continue
+
+        cpu, count, thread, pcs = m.groups()
+        pcs = [int(pc, 16) for pc in pcs.split()]
+
+        # Return addresses point after the call, look up the call itself
+        frames = [symbols.lookup(pcs[0])]
+        frames += [symbols.lookup(pc - 1) for pc in pcs[1:]]
+        frames.reverse()
+
+        if not args.no_thread:
+            # Semicolons separate the frames of folded stacks
+            frames.insert(0, thread.replace(";", "_"))
+        if args.per_cpu:
+            frames.insert(0, "cpu" + cpu)
+
+        folded[";".join(frames)] += int(count)
+
+    for stack, count in sorted(folded.items()):
+        print("{} {}".format(stack, count))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2020 Intel Corporation.
+#
+# SPDX-License-Identifier: Apache-2.0
+"""
+Split a CTF capture of per CPU tracing buffers into one stream file per CPU.
+
+With CONFIG_TRACING_PER_CPU_BUFFERS the device sends CTF packets of all CPUs
+interleaved on a single channel. Each packet starts with a header holding
+the CPU id, see subsys/tracing/include/tracing_buffer.h. Packets are written
+to <output>/channel0_<cpu>, together with the generated metadata.
+"""
+
+import os
+import sys
+import shutil
+import struct
+import argparse
+
+CTF_MAGIC = 0xC1FC1FC1
+# magic, stream_id, stream_instance_id, timestamp_begin, timestamp_end,
+# content_size, packet_size, events_discarded, cpu_id
+PACKET_HDR = struct.Struct("<IBBIIIIIB")
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", help="captured tracing data")
+    parser.add_argument("-m", "--metadata", required=True,
+                        help="CTF metadata, zephyr/ctf/metadata in the "
+                        "build directory")
+    parser.add_argument("-o", "--output", default="ctf",
+                        help="output trace directory")
+    return parser.parse_args()
+
+
+def packets(data):
+    """Yield (cpu, packet), skipping data which is not a packet"""
+    pos = 0
+    magic = struct.pack("<I", CTF_MAGIC)
+
+    while pos + PACKET_HDR.size <= len(data):
+        fields = PACKET_HDR.unpack_from(data, pos)
+        size = fields[5] // 8
+        if fields[0] != CTF_MAGIC or size < PACKET_HDR.size:
+            nxt = data.find(magic, pos + 1)
+            if nxt < 0:
+                break
+            print("Skipping {} bytes at offset {}".format(nxt - pos, pos),
+                  file=sys.stderr)
+            pos = nxt
+            continue
+
+        if pos + size > len(data):
+            print("Truncated packet at offset {}".format(pos),
+                  file=sys.stderr)
+            break
+
+        yield fields[2], data[pos:pos + size]
+        pos += size
+
+
+def main():
+    args = parse_args()
+
+    with open(args.capture, "rb") as fp:
+        data = fp.read()
+
+    os.makedirs(args.output, exist_ok=True)
+    shutil.copy(args.metadata, os.path.join(args.output, "metadata"))
+
+    streams = {}
+    for cpu, packet in packets(data):
+        if cpu not in streams:
+            path = os.path.join(args.output, "channel0_{}".format(cpu))
+            streams[cpu] = open(path, "wb")
+        streams[cpu].write(packet)
+
+    for cpu, fp in sorted(streams.items()):
+        print("CPU {}: {} bytes".format(cpu, fp.tell()))
+        fp.close()
+
+
+if __name__ == "__main__":
+    main()
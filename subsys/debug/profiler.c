@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ *  @brief Sampling profiler
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <spinlock.h>
+#include <debug/profiler.h>
+#ifdef CONFIG_PROFILER_SHELL
+#include <shell/shell.h>
+#endif
+
+struct profiler_cpu {
+	struct k_spinlock lock;
+	uint32_t lost;
+	struct profiler_stack stacks[CONFIG_PROFILER_MAX_STACKS];
+};
+
+static struct profiler_cpu profiler_cpus[CONFIG_MP_NUM_CPUS];
+static bool profiler_running;
+
+static uint32_t stack_hash(const struct profiler_stack *stack)
+{
+	uint32_t hash = 2166136261U;
+
+	/* FNV-1a over the words */
+	hash = (hash ^ (uint32_t)(uintptr_t)stack->thread) * 16777619U;
+	for (uint32_t i = 0; i < stack->depth; i++) {
+		hash = (hash ^ (uint32_t)stack->pcs[i]) * 16777619U;
+	}
+
+	return hash;
+}
+
+static bool stack_equal(const struct profiler_stack *a,
+			const struct profiler_stack *b)
+{
+	return (a->thread == b->thread) && (a->depth == b->depth) &&
+	       (memcmp(a->pcs, b->pcs, a->depth * sizeof(a->pcs[0])) == 0);
+}
+
+static void stack_add(struct profiler_cpu *cpu,
+		      const struct profiler_stack *sample)
+{
+	uint32_t idx = stack_hash(sample) % CONFIG_PROFILER_MAX_STACKS;
+
+	for (uint32_t i = 0; i < CONFIG_PROFILER_MAX_STACKS; i++) {
+		struct profiler_stack *stack = &cpu->stacks[idx];
+
+		if (stack->count == 0U) {
+			*stack = *sample;
+			stack->count = 1U;
+			return;
+		}
+
+		if (stack_equal(stack, sample)) {
+			stack->count++;
+			return;
+		}
+
+		idx = (idx + 1U) % CONFIG_PROFILER_MAX_STACKS;
+	}
+
+	cpu->lost++;
+}
+
+/* Runs in the system timer interrupt, on top of the sampled thread */
+static void profiler_sample(struct k_timer *timer)
+{
+	struct profiler_stack sample = {
+		.thread = _current,
+	};
+	struct profiler_cpu *cpu;
+	k_spinlock_key_t key;
+
+	ARG_UNUSED(timer);
+
+#ifdef CONFIG_PROFILER_STACK_SAMPLE
+	sample.depth = arch_stack_sample(sample.pcs, ARRAY_SIZE(sample.pcs));
+#endif
+	if (sample.depth == 0U) {
+		sample.pcs[0] = (uintptr_t)_current->entry.pEntry;
+		sample.depth = 1U;
+	}
+
+	cpu = &profiler_cpus[_current_cpu->id];
+
+	key = k_spin_lock(&cpu->lock);
+	stack_add(cpu, &sample);
+	k_spin_unlock(&cpu->lock, key);
+}
+
+static K_TIMER_DEFINE(profiler_timer, profiler_sample, NULL);
+
+int profiler_start(k_timeout_t period)
+{
+	if (profiler_running) {
+		return -EALREADY;
+	}
+
+	profiler_running = true;
+	k_timer_start(&profiler_timer, period, period);
+
+	return 0;
+}
+
+int profiler_stop(void)
+{
+	if (!profiler_running) {
+		return -EALREADY;
+	}
+
+	k_timer_stop(&profiler_timer);
+	profiler_running = false;
+
+	return 0;
+}
+
+void profiler_reset(void)
+{
+	k_spinlock_key_t key;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct profiler_cpu *cpu = &profiler_cpus[i];
+
+		key = k_spin_lock(&cpu->lock);
+		memset(cpu->stacks, 0, sizeof(cpu->stacks));
+		cpu->lost = 0U;
+		k_spin_unlock(&cpu->lock, key);
+	}
+}
+
+void profiler_foreach(profiler_cb cb, void *user_data)
+{
+	struct profiler_stack stack;
+	k_spinlock_key_t key;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		struct profiler_cpu *cpu = &profiler_cpus[i];
+
+		for (int j = 0; j < CONFIG_PROFILER_MAX_STACKS; j++) {
+			/* Copied so that sampling is not blocked by the
+			 * callback
+			 */
+			key = k_spin_lock(&cpu->lock);
+			stack = cpu->stacks[j];
+			k_spin_unlock(&cpu->lock, key);
+
+			if (stack.count != 0U) {
+				cb(&stack, i, user_data);
+			}
+		}
+	}
+}
+
+uint32_t profiler_lost_get(void)
+{
+	uint32_t lost = 0U;
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		lost += profiler_cpus[i].lost;
+	}
+
+	return lost;
+}
+
+#ifdef CONFIG_PROFILER_SHELL
+static int cmd_profiler_start(const struct shell *shell, size_t argc,
+			      char **argv)
+{
+	uint32_t period = CONFIG_PROFILER_PERIOD;
+	int err;
+
+	if (argc > 1) {
+		period = strtoul(argv[1], NULL, 10);
+		if (period == 0U) {
+			shell_error(shell, "Invalid period: %s", argv[1]);
+			return -EINVAL;
+		}
+	}
+
+	err = profiler_start(K_MSEC(period));
+	if (err) {
+		shell_error(shell, "Profiler already running");
+		return err;
+	}
+
+	return 0;
+}
+
+static int cmd_profiler_stop(const struct shell *shell, size_t argc,
+			     char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	if (profiler_stop()) {
+		shell_error(shell, "Profiler not running");
+		return -EALREADY;
+	}
+
+	return 0;
+}
+
+static int cmd_profiler_reset(const struct shell *shell, size_t argc,
+			      char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	profiler_reset();
+
+	return 0;
+}
+
+static void shell_stack_print(const struct profiler_stack *stack, uint8_t cpu,
+			      void *user_data)
+{
+	const struct shell *shell = user_data;
+	const char *name = k_thread_name_get((k_tid_t)stack->thread);
+
+	/* One line per stack, see scripts/profiler/stackcollapse.py. The
+	 * thread is quoted as its name may contain spaces.
+	 */
+	if ((name != NULL) && (name[0] != '\0')) {
+		shell_fprintf(shell, SHELL_NORMAL, "stack: %u %u \"%s\"", cpu,
+			      stack->count, name);
+	} else {
+		shell_fprintf(shell, SHELL_NORMAL, "stack: %u %u \"%p\"", cpu,
+			      stack->count, stack->thread);
+	}
+
+	for (uint32_t i = 0; i < stack->depth; i++) {
+		shell_fprintf(shell, SHELL_NORMAL, " 0x%lx",
+			      (unsigned long)stack->pcs[i]);
+	}
+
+	shell_fprintf(shell, SHELL_NORMAL, "\n");
+}
+
+static int cmd_profiler_dump(const struct shell *shell, size_t argc,
+			     char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	profiler_foreach(shell_stack_print, (void *)shell);
+	shell_print(shell, "lost: %u", profiler_lost_get());
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_profiler,
+	SHELL_CMD_ARG(start, NULL, "Start sampling [period ms].",
+		      cmd_profiler_start, 1, 1),
+	SHELL_CMD(stop, NULL, "Stop sampling.", cmd_profiler_stop),
+	SHELL_CMD(reset, NULL, "Discard samples.", cmd_profiler_reset),
+	SHELL_CMD(dump, NULL, "Print sampled stacks.", cmd_profiler_dump),
+	SHELL_SUBCMD_SET_END /* Array terminated. */
+);
+
+SHELL_CMD_REGISTER(profiler, &sub_profiler, "Sampling profiler", NULL);
+#endif /* CONFIG_PROFILER_SHELL */
@@ -39,12 +39,22 @@ static void thread_print_cb(struct thread_analyzer_info *info)
 {
 	unsigned int pcnt = (info->stack_used * 100U) / info->stack_size;
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	THREAD_ANALYZER_PRINT(
+		THREAD_ANALYZER_FMT(
+			" %-20s: unused %zu usage %zu / %zu (%zu %%),"
+			" CPU %u %%"),
+		THREAD_ANALYZER_VSTR(info->name),
+		info->stack_size - info->stack_used, info->stack_used,
+		info->stack_size, pcnt, info->utilization);
+#else
 	THREAD_ANALYZER_PRINT(
 		THREAD_ANALYZER_FMT(
 			" %-20s: unused %zu usage %zu / %zu (%zu %%)"),
 		THREAD_ANALYZER_VSTR(info->name),
 		info->stack_size - info->stack_used, info->stack_used,
 		info->stack_size, pcnt);
+#endif
 }
 
 static void thread_analyze_cb(const struct k_thread *cthread, void *user_data)
@@ -77,6 +87,17 @@ static void thread_analyze_cb(const struct k_thread *cthread, void *user_data)
 	info.name = name;
 	info.stack_size = size;
 	info.stack_used = size - unused;
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	k_thread_runtime_stats_t rt_stats;
+
+	info.exec_cycles = 0U;
+	if (k_thread_runtime_stats_get(thread, &rt_stats) == 0) {
+		info.exec_cycles = rt_stats.execution_cycles;
+	}
+	info.utilization = k_thread_runtime_utilization_get(thread);
+#endif
+
 	cb(&info);
 }
 
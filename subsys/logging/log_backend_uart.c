@@ -8,6 +8,7 @@
 #include <logging/log_core.h>
 #include <logging/log_msg.h>
 #include <logging/log_output.h>
+#include <logging/log_output_dict.h>
 #include "log_backend_std.h"
 #include <device.h>
 #include <drivers/uart.h>
@@ -28,11 +29,23 @@ static uint8_t buf;
 
 LOG_OUTPUT_DEFINE(log_output, char_out, &buf, 1);
 
+static uint32_t format_flag(void)
+{
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE)) {
+		return LOG_OUTPUT_FLAG_FORMAT_SYST;
+	}
+
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_UART_DICT_ENABLE)) {
+		return LOG_OUTPUT_FLAG_FORMAT_DICT;
+	}
+
+	return 0;
+}
+
 static void put(const struct log_backend *const backend,
 		struct log_msg *msg)
 {
-	uint32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
+	uint32_t flag = format_flag();
 
 	log_backend_std_put(&log_output, flag, msg);
 }
@@ -56,6 +69,11 @@ static void dropped(const struct log_backend *const backend, uint32_t cnt)
 {
 	ARG_UNUSED(backend);
 
+	if (IS_ENABLED(CONFIG_LOG_BACKEND_UART_DICT_ENABLE)) {
+		log_output_dropped_dict_process(&log_output, cnt);
+		return;
+	}
+
 	log_backend_std_dropped(&log_output, cnt);
 }
 
@@ -63,8 +81,7 @@ static void sync_string(const struct log_backend *const backend,
 		     struct log_msg_ids src_level, uint32_t timestamp,
 		     const char *fmt, va_list ap)
 {
-	uint32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
+	uint32_t flag = format_flag();
 
 	log_backend_std_sync_string(&log_output, flag, src_level,
 				    timestamp, fmt, ap);
@@ -74,8 +91,7 @@ static void sync_hexdump(const struct log_backend *const backend,
 			 struct log_msg_ids src_level, uint32_t timestamp,
 			 const char *metadata, const uint8_t *data, uint32_t length)
 {
-	uint32_t flag = IS_ENABLED(CONFIG_LOG_BACKEND_UART_SYST_ENABLE) ?
-		LOG_OUTPUT_FLAG_FORMAT_SYST : 0;
+	uint32_t flag = format_flag();
 
 	log_backend_std_sync_hexdump(&log_output, flag, src_level,
 				     timestamp, metadata, data, length);
@@ -105,14 +105,7 @@ uint32_t z_log_get_s_mask(const char *str, uint32_t nargs)
 	return mask;
 }
 
-/**
- * @brief Check if address is in read only section.
- *
- * @param addr Address.
- *
- * @return True if address identified within read only section.
- */
-static bool is_rodata(const void *addr)
+bool z_log_is_rodata(const void *addr)
 {
 #if defined(CONFIG_ARM) || defined(CONFIG_ARC) || defined(CONFIG_X86)
 	extern const char *_image_rodata_start[];
@@ -163,8 +156,10 @@ static void detect_missed_strdup(struct log_msg *msg)
 	while (mask) {
 		idx = 31 - __builtin_clz(mask);
 		str = (const char *)log_msg_arg_get(msg, idx);
-		if (!is_rodata(str) && !log_is_strdup(str) &&
-			(str != log_strdup_fail_msg)) {
+		if (!z_log_is_rodata(str) && !log_is_strdup(str) &&
+			(str != log_strdup_fail_msg) &&
+			!(IS_ENABLED(CONFIG_LOG_MSG_PACKAGED) &&
+			  z_log_msg_pkg_owns(str))) {
 			const char *src_name =
 				log_source_name_get(CONFIG_LOG_DOMAIN_ID,
 						    log_msg_source_id_get(msg));
@@ -191,11 +186,15 @@ static inline void msg_finalize(struct log_msg *msg,
 
 	atomic_inc(&buffered_cnt);
 
-	key = irq_lock();
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		z_log_msg_commit(msg);
+	} else {
+		key = irq_lock();
 
-	log_list_add_tail(&list, msg);
+		log_list_add_tail(&list, msg);
 
-	irq_unlock(key);
+		irq_unlock(key);
+	}
 
 	if (panic_mode) {
 		key = irq_lock();
@@ -213,10 +212,39 @@ static inline void msg_finalize(struct log_msg *msg,
 	}
 }
 
+/* Packaged messages carry their transient strings. Strings duplicated by the
+ * caller are copied into the message and the duplicates released at once.
+ */
+static void msg_pkg_log(const char *str, log_arg_t *args, uint32_t nargs,
+			struct log_msg_ids src_level)
+{
+	struct log_msg *msg;
+	uint32_t smask = 0U;
+
+	for (int i = 0; i < nargs; i++) {
+		if (log_is_strdup((void *)args[i])) {
+			smask |= BIT(i);
+		}
+	}
+
+	if (smask) {
+		smask &= z_log_get_s_mask(str, nargs);
+	}
+
+	msg = z_log_msg_pkg_create(str, args, nargs, smask);
+	if (msg == NULL) {
+		return;
+	}
+
+	msg_finalize(msg, src_level);
+}
+
 void log_0(const char *str, struct log_msg_ids src_level)
 {
 	if (IS_ENABLED(CONFIG_LOG_FRONTEND)) {
 		log_frontend_0(str, src_level);
+	} else if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		msg_pkg_log(str, NULL, 0, src_level);
 	} else {
 		struct log_msg *msg = log_msg_create_0(str);
 
@@ -233,6 +261,10 @@ void log_1(const char *str,
 {
 	if (IS_ENABLED(CONFIG_LOG_FRONTEND)) {
 		log_frontend_1(str, arg0, src_level);
+	} else if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		log_arg_t args[] = {arg0};
+
+		msg_pkg_log(str, args, ARRAY_SIZE(args), src_level);
 	} else {
 		struct log_msg *msg = log_msg_create_1(str, arg0);
 
@@ -250,6 +282,10 @@ void log_2(const char *str,
 {
 	if (IS_ENABLED(CONFIG_LOG_FRONTEND)) {
 		log_frontend_2(str, arg0, arg1, src_level);
+	} else if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		log_arg_t args[] = {arg0, arg1};
+
+		msg_pkg_log(str, args, ARRAY_SIZE(args), src_level);
 	} else {
 		struct log_msg *msg = log_msg_create_2(str, arg0, arg1);
 
@@ -269,6 +305,10 @@ void log_3(const char *str,
 {
 	if (IS_ENABLED(CONFIG_LOG_FRONTEND)) {
 		log_frontend_3(str, arg0, arg1, arg2, src_level);
+	} else if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		log_arg_t args[] = {arg0, arg1, arg2};
+
+		msg_pkg_log(str, args, ARRAY_SIZE(args), src_level);
 	} else {
 		struct log_msg *msg = log_msg_create_3(str, arg0, arg1, arg2);
 
@@ -287,6 +327,8 @@ void log_n(const char *str,
 {
 	if (IS_ENABLED(CONFIG_LOG_FRONTEND)) {
 		log_frontend_n(str, args, narg, src_level);
+	} else if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		msg_pkg_log(str, args, narg, src_level);
 	} else {
 		struct log_msg *msg = log_msg_create_n(str, args, narg);
 
@@ -377,6 +419,39 @@ uint32_t log_count_args(const char *fmt)
 	return args;
 }
 
+/* Copy the strings straight into the packaged message, without going
+ * through log_strdup() buffers.
+ */
+static void generic_pkg_log(struct log_msg_ids src_level, const char *fmt,
+			    log_arg_t *args, uint32_t nargs,
+			    enum log_strdup_action strdup_action)
+{
+	struct log_msg *msg;
+	uint32_t smask = 0U;
+	uint32_t mask;
+
+	if (strdup_action != LOG_STRDUP_SKIP) {
+		mask = z_log_get_s_mask(fmt, nargs);
+
+		while (mask) {
+			uint32_t idx = 31 - __builtin_clz(mask);
+
+			if (!z_log_is_rodata((const void *)args[idx])) {
+				smask |= BIT(idx);
+			}
+
+			mask &= ~BIT(idx);
+		}
+	}
+
+	msg = z_log_msg_pkg_create(fmt, args, nargs, smask);
+	if (msg == NULL) {
+		return;
+	}
+
+	msg_finalize(msg, src_level);
+}
+
 void log_generic(struct log_msg_ids src_level, const char *fmt, va_list ap,
 		 enum log_strdup_action strdup_action)
 {
@@ -404,6 +479,12 @@ void log_generic(struct log_msg_ids src_level, const char *fmt, va_list ap,
 			args[i] = va_arg(ap, log_arg_t);
 		}
 
+		if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+			generic_pkg_log(src_level, fmt, args, nargs,
+					strdup_action);
+			return;
+		}
+
 		if (strdup_action != LOG_STRDUP_SKIP) {
 			uint32_t mask = z_log_get_s_mask(fmt, nargs);
 
@@ -616,19 +697,11 @@ void z_vrfy_log_panic(void)
 #endif
 
 static bool msg_filter_check(struct log_backend const *backend,
-			     struct log_msg *msg)
+			     uint32_t filters, uint32_t level)
 {
 	if (IS_ENABLED(CONFIG_LOG_RUNTIME_FILTERING)) {
-		uint32_t backend_level;
-		uint32_t msg_level;
-
-		backend_level = log_filter_get(backend,
-					       log_msg_domain_id_get(msg),
-					       log_msg_source_id_get(msg),
-					       true /*enum RUNTIME, COMPILETIME*/);
-		msg_level = log_msg_level_get(msg);
-
-		return (msg_level <= backend_level);
+		return (level <= LOG_FILTER_SLOT_GET(&filters,
+					log_backend_id_get(backend)));
 	} else {
 		return true;
 	}
@@ -637,6 +710,8 @@ static bool msg_filter_check(struct log_backend const *backend,
 static void msg_process(struct log_msg *msg, bool bypass)
 {
 	struct log_backend const *backend;
+	uint32_t level = log_msg_level_get(msg);
+	uint32_t filters = 0U;
 
 	if (!bypass) {
 		if (IS_ENABLED(CONFIG_LOG_DETECT_MISSED_STRDUP) &&
@@ -644,11 +719,21 @@ static void msg_process(struct log_msg *msg, bool bypass)
 			detect_missed_strdup(msg);
 		}
 
+		/* Filters of all backends are packed in one word of the
+		 * source, read it once for all backends. Raw strings pass
+		 * any filter.
+		 */
+		if (IS_ENABLED(CONFIG_LOG_RUNTIME_FILTERING) &&
+		    (level != LOG_LEVEL_INTERNAL_RAW_STRING)) {
+			filters = *log_dynamic_filters_get(
+					log_msg_source_id_get(msg));
+		}
+
 		for (int i = 0; i < log_backend_count_get(); i++) {
 			backend = log_backend_get(i);
 
 			if (log_backend_is_active(backend) &&
-			    msg_filter_check(backend, msg)) {
+			    msg_filter_check(backend, filters, level)) {
 				log_backend_put(backend, msg);
 			}
 		}
@@ -677,10 +762,15 @@ bool z_impl_log_process(bool bypass)
 	if (!backend_attached && !bypass) {
 		return false;
 	}
-	unsigned int key = irq_lock();
 
-	msg = log_list_head_get(&list);
-	irq_unlock(key);
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		msg = z_log_msg_claim();
+	} else {
+		unsigned int key = irq_lock();
+
+		msg = log_list_head_get(&list);
+		irq_unlock(key);
+	}
 
 	if (msg != NULL) {
 		atomic_dec(&buffered_cnt);
@@ -691,6 +781,10 @@ bool z_impl_log_process(bool bypass)
 		dropped_notify();
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		return z_log_msg_pending();
+	}
+
 	return (log_list_head_peek(&list) != NULL);
 }
 
@@ -755,7 +849,7 @@ uint32_t z_impl_log_filter_set(struct log_backend const *const backend,
 	assert(src_id < log_sources_count());
 
 	if (IS_ENABLED(CONFIG_LOG_RUNTIME_FILTERING)) {
-		uint32_t new_aggr_filter;
+		uint32_t new_filters;
 
 		uint32_t *filters = log_dynamic_filters_get(src_id);
 
@@ -778,18 +872,29 @@ uint32_t z_impl_log_filter_set(struct log_backend const *const backend,
 
 			level = MIN(level, max);
 
-			LOG_FILTER_SLOT_SET(filters,
+			/* Update the filter word of the source with a single
+			 * store, and only if it changes, so that log calls
+			 * never see a stale aggregated level and neither the
+			 * word is written nor the backend notified when
+			 * nothing changes.
+			 */
+			new_filters = *filters;
+			LOG_FILTER_SLOT_SET(&new_filters,
 					    log_backend_id_get(backend),
 					    level);
+			LOG_FILTER_SLOT_SET(&new_filters,
+					    LOG_FILTER_AGGR_SLOT_IDX,
+					    max_filter_get(new_filters));
 
-			/* Once current backend filter is updated recalculate
-			 * aggregated maximal level
-			 */
-			new_aggr_filter = max_filter_get(*filters);
+			if (new_filters != *filters) {
+				*filters = new_filters;
 
-			LOG_FILTER_SLOT_SET(filters,
-					    LOG_FILTER_AGGR_SLOT_IDX,
-					    new_aggr_filter);
+				if (log_backend_is_active(backend)) {
+					log_backend_filter_changed(backend,
+								   src_id,
+								   level);
+				}
+			}
 		}
 	}
 
@@ -879,7 +984,7 @@ char *log_strdup(const char *str)
 	int err;
 
 	if (IS_ENABLED(CONFIG_LOG_IMMEDIATE) ||
-	    is_rodata(str) || _is_user_context()) {
+	    z_log_is_rodata(str) || _is_user_context()) {
 		return (char *)str;
 	}
 
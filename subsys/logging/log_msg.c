@@ -8,6 +8,7 @@
 #include <logging/log_msg.h>
 #include <logging/log_ctrl.h>
 #include <logging/log_core.h>
+#include <sys/mpsc_ring.h>
 #include <string.h>
 #include <assert.h>
 
@@ -40,13 +41,35 @@ BUILD_ASSERT((sizeof(union log_msg_head_data) ==
 #define MSG_SIZE sizeof(union log_msg_chunk)
 #define NUM_OF_MSGS (CONFIG_LOG_BUFFER_SIZE / MSG_SIZE)
 
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+/* Packaged messages are single contiguous records in a lock-free ring.
+ * Arguments and hexdump data follow the message header, never chained, and
+ * copied in strings follow the arguments.
+ */
+static struct mpsc_ring log_msg_ring;
+static uint8_t __noinit __aligned(sizeof(mpsc_ring_word_t))
+		log_msg_ring_buf[CONFIG_LOG_BUFFER_SIZE];
+
+/* Serializes claiming, which happens from the log thread and from producers
+ * discarding old messages in overflow mode.
+ */
+static struct k_spinlock log_msg_claim_lock;
+
+#define PKG_HDR_SIZE offsetof(struct log_msg, payload)
+#else
 struct k_mem_slab log_msg_pool;
 static uint8_t __noinit __aligned(sizeof(void *))
 		log_msg_pool_buf[CONFIG_LOG_BUFFER_SIZE];
+#endif
 
 void log_msg_pool_init(void)
 {
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+	mpsc_ring_init(&log_msg_ring, log_msg_ring_buf,
+		       sizeof(log_msg_ring_buf));
+#else
 	k_mem_slab_init(&log_msg_pool, log_msg_pool_buf, MSG_SIZE, NUM_OF_MSGS);
+#endif
 }
 
 /* Return true if interrupts were unlocked in the context of this call. */
@@ -71,9 +94,71 @@ static bool block_on_alloc(void)
 	return (!k_is_in_isr() && is_irq_unlocked());
 }
 
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+static struct log_msg *pkg_alloc(size_t len)
+{
+	struct log_msg *msg = mpsc_ring_alloc(&log_msg_ring, len);
+	bool more;
+
+	if (msg != NULL) {
+		return msg;
+	}
+
+	if (IS_ENABLED(CONFIG_LOG_MODE_OVERFLOW)) {
+		do {
+			more = log_process(true);
+			log_dropped();
+			msg = mpsc_ring_alloc(&log_msg_ring, len);
+		} while ((msg == NULL) && more);
+	} else {
+		log_dropped();
+	}
+
+	return msg;
+}
+
+static void pkg_init(struct log_msg *msg, uint8_t type)
+{
+	msg->hdr.ref_cnt = 1;
+	msg->hdr.params.raw = 0U;
+	msg->hdr.params.generic.type = type;
+	msg->hdr.ids.level = 0;
+	msg->hdr.ids.domain_id = 0;
+	msg->hdr.ids.source_id = 0;
+}
+
+void z_log_msg_commit(struct log_msg *msg)
+{
+	mpsc_ring_commit(&log_msg_ring, msg);
+}
+
+struct log_msg *z_log_msg_claim(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&log_msg_claim_lock);
+	struct log_msg *msg = mpsc_ring_claim(&log_msg_ring, NULL);
+
+	k_spin_unlock(&log_msg_claim_lock, key);
+
+	return msg;
+}
+
+bool z_log_msg_pending(void)
+{
+	return mpsc_ring_is_pending(&log_msg_ring);
+}
+
+bool z_log_msg_pkg_owns(const void *buf)
+{
+	return PART_OF_ARRAY(log_msg_ring_buf, (uint8_t *)buf);
+}
+#endif /* CONFIG_LOG_MSG_PACKAGED */
+
 union log_msg_chunk *log_msg_chunk_alloc(void)
 {
 	union log_msg_chunk *msg = NULL;
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+	msg = (union log_msg_chunk *)pkg_alloc(MSG_SIZE);
+#else
 	int err = k_mem_slab_alloc(&log_msg_pool, (void **)&msg,
 		   block_on_alloc()
 		   ? K_MSEC(CONFIG_LOG_BLOCK_IN_THREAD_TIMEOUT_MS)
@@ -82,6 +167,7 @@ union log_msg_chunk *log_msg_chunk_alloc(void)
 	if (err != 0) {
 		msg = log_msg_no_space_handle();
 	}
+#endif
 
 	return msg;
 }
@@ -91,6 +177,7 @@ void log_msg_get(struct log_msg *msg)
 	atomic_inc(&msg->hdr.ref_cnt);
 }
 
+#if !defined(CONFIG_LOG_MSG_PACKAGED)
 static void cont_free(struct log_msg_cont *cont)
 {
 	struct log_msg_cont *next;
@@ -101,6 +188,7 @@ static void cont_free(struct log_msg_cont *cont)
 		cont = next;
 	}
 }
+#endif
 
 static void msg_free(struct log_msg *msg)
 {
@@ -151,13 +239,26 @@ static void msg_free(struct log_msg *msg)
 		}
 	}
 
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+	mpsc_ring_free(&log_msg_ring, msg);
+#else
 	if (msg->hdr.params.generic.ext == 1) {
 		cont_free(msg->payload.ext.next);
 	}
 
 	k_mem_slab_free(&log_msg_pool, (void **)&msg);
+#endif
 }
 
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+union log_msg_chunk *log_msg_no_space_handle(void)
+{
+	/* A full ring is handled in pkg_alloc(), which needs the length. */
+	log_dropped();
+
+	return NULL;
+}
+#else
 union log_msg_chunk *log_msg_no_space_handle(void)
 {
 	union log_msg_chunk *msg = NULL;
@@ -178,6 +279,8 @@ union log_msg_chunk *log_msg_no_space_handle(void)
 	return msg;
 
 }
+#endif
+
 void log_msg_put(struct log_msg *msg)
 {
 	atomic_dec(&msg->hdr.ref_cnt);
@@ -221,8 +324,10 @@ log_arg_t log_msg_arg_get(struct log_msg *msg, uint32_t arg_idx)
 		return 0;
 	}
 
-	if (msg->hdr.params.std.nargs <= LOG_MSG_NARGS_SINGLE_CHUNK) {
-		arg = msg->payload.single.args[arg_idx];
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED) ||
+	    msg->hdr.params.std.nargs <= LOG_MSG_NARGS_SINGLE_CHUNK) {
+		/* Packaged arguments are contiguous past the head chunk. */
+		arg = ((log_arg_t *)msg->payload.single.args)[arg_idx];
 	} else {
 		arg = cont_arg_get(msg, arg_idx);
 	}
@@ -305,12 +410,98 @@ static void copy_args_to_msg(struct  log_msg *msg, log_arg_t *args, uint32_t nar
 	}
 }
 
+#if defined(CONFIG_LOG_MSG_PACKAGED)
+static void pkg_strdup_release(log_arg_t *args, uint32_t smask)
+{
+	uint32_t idx;
+
+	while (smask) {
+		idx = 31 - __builtin_clz(smask);
+		if (log_is_strdup((void *)args[idx])) {
+			log_free((void *)args[idx]);
+		}
+
+		smask &= ~BIT(idx);
+	}
+}
+
+struct log_msg *z_log_msg_pkg_create(const char *str, log_arg_t *args,
+				     uint32_t nargs, uint32_t smask)
+{
+	size_t slen[LOG_MAX_NARGS];
+	size_t len = PKG_HDR_SIZE + nargs * sizeof(log_arg_t);
+	struct log_msg *msg;
+	log_arg_t *pargs;
+	uint32_t mask;
+	uint32_t idx;
+	char *dst;
+
+	__ASSERT_NO_MSG(nargs < LOG_MAX_NARGS);
+
+	for (mask = smask; mask; mask &= ~BIT(idx)) {
+		idx = 31 - __builtin_clz(mask);
+		slen[idx] = strnlen((const char *)args[idx],
+				    CONFIG_LOG_STRDUP_MAX_STRING);
+		len += slen[idx] + 1;
+	}
+
+	msg = pkg_alloc(len);
+	if (msg == NULL) {
+		pkg_strdup_release(args, smask);
+		return NULL;
+	}
+
+	pkg_init(msg, LOG_MSG_TYPE_STD);
+	msg->str = str;
+	msg->hdr.params.std.nargs = nargs;
+
+	pargs = (log_arg_t *)msg->payload.single.args;
+	(void)memcpy(pargs, args, nargs * sizeof(log_arg_t));
+
+	/* Strings go after the arguments, which are repointed to them. */
+	dst = (char *)&pargs[nargs];
+	for (mask = smask; mask; mask &= ~BIT(idx)) {
+		idx = 31 - __builtin_clz(mask);
+		(void)memcpy(dst, (const char *)args[idx], slen[idx]);
+		dst[slen[idx]] = '\0';
+		pargs[idx] = (log_arg_t)dst;
+		dst += slen[idx] + 1;
+	}
+
+	pkg_strdup_release(args, smask);
+
+	return msg;
+}
+
+struct log_msg *z_log_msg_pkg_hexdump_create(const char *str,
+					     const uint8_t *data,
+					     uint32_t length)
+{
+	struct log_msg *msg = pkg_alloc(PKG_HDR_SIZE + length);
+
+	if (msg == NULL) {
+		return NULL;
+	}
+
+	pkg_init(msg, LOG_MSG_TYPE_HEXDUMP);
+	msg->hdr.params.hexdump.length = length;
+	msg->str = str;
+	(void)memcpy(msg->payload.single.bytes, data, length);
+
+	return msg;
+}
+#endif /* CONFIG_LOG_MSG_PACKAGED */
+
 struct log_msg *log_msg_create_n(const char *str, log_arg_t *args, uint32_t nargs)
 {
 	__ASSERT_NO_MSG(nargs < LOG_MAX_NARGS);
 
 	struct  log_msg *msg = NULL;
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		return z_log_msg_pkg_create(str, args, nargs, 0);
+	}
+
 	msg = msg_alloc(nargs);
 
 	if (msg != NULL) {
@@ -335,6 +526,10 @@ struct log_msg *log_msg_hexdump_create(const char *str,
 	length = (length > LOG_MSG_HEXDUMP_MAX_LENGTH) ?
 		 LOG_MSG_HEXDUMP_MAX_LENGTH : length;
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		return z_log_msg_pkg_hexdump_create(str, data, length);
+	}
+
 	msg = (struct log_msg *)log_msg_chunk_alloc();
 	if (msg == NULL) {
 		return NULL;
@@ -410,6 +605,18 @@ static void log_msg_hexdump_data_op(struct log_msg *msg,
 
 	req_len = *length;
 
+	if (IS_ENABLED(CONFIG_LOG_MSG_PACKAGED)) {
+		head_data = msg->payload.single.bytes;
+
+		if (put_op) {
+			(void)memcpy(&head_data[offset], data, req_len);
+		} else {
+			(void)memcpy(data, &head_data[offset], req_len);
+		}
+
+		return;
+	}
+
 	if (available_len > LOG_MSG_HEXDUMP_BYTES_SINGLE_CHUNK) {
 		chunk_len = LOG_MSG_HEXDUMP_BYTES_HEAD_CHUNK;
 		head_data = msg->payload.ext.data.bytes;
@@ -5,6 +5,7 @@
  */
 
 #include <logging/log_output.h>
+#include <logging/log_output_dict.h>
 #include <logging/log_ctrl.h>
 #include <logging/log.h>
 #include <assert.h>
@@ -538,6 +539,12 @@ void log_output_msg_process(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_msg_dict_process(log_output, msg, flags);
+		return;
+	}
+
 	prefix_offset = raw_string ?
 			0 : prefix_print(log_output, flags, std_msg, timestamp,
 					 level, domain_id, source_id);
@@ -586,6 +593,13 @@ void log_output_string(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_string_dict_process(log_output, src_level,
+					       timestamp, fmt, ap, flags);
+		return;
+	}
+
 	if (!raw_string) {
 		prefix_print(log_output, flags, true, timestamp,
 				level, domain_id, source_id);
@@ -629,6 +643,14 @@ void log_output_hexdump(const struct log_output *log_output,
 		return;
 	}
 
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE) &&
+	    flags & LOG_OUTPUT_FLAG_FORMAT_DICT) {
+		log_output_hexdump_dict_process(log_output, src_level,
+						timestamp, metadata, data,
+						length, flags);
+		return;
+	}
+
 	prefix_offset = prefix_print(log_output, flags, true, timestamp,
 				     level, domain_id, source_id);
 
@@ -670,6 +692,11 @@ void log_output_dropped_process(const struct log_output *log_output, uint32_t cn
 
 void log_output_timestamp_freq_set(uint32_t frequency)
 {
+	if (IS_ENABLED(CONFIG_LOG_DICTIONARY_ENABLE)) {
+		/* Host side scales raw timestamps itself */
+		log_output_dict_timestamp_freq_set(frequency);
+	}
+
 	timestamp_div = 1U;
 	/* There is no point to have frequency higher than 1MHz (ns are not
 	 * printed) and too high frequency leads to overflows in calculations.
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ctype.h>
+#include <string.h>
+#include <kernel.h>
+#include <logging/log.h>
+#include <logging/log_ctrl.h>
+#include <logging/log_output.h>
+#include <logging/log_output_dict.h>
+
+/* Maximum number of arguments read from a va_list */
+#define DICT_MAX_NARGS 15
+
+/* Records between sync records, lets the host attach to a running stream
+ * and recover from lost bytes.
+ */
+#define DICT_SYNC_PERIOD 64
+
+static uint32_t timestamp_freq;
+
+static void dict_write(const struct log_output *log_output,
+		       const void *data, size_t len)
+{
+	struct log_output_control_block *cb = log_output->control_block;
+	const uint8_t *src = data;
+
+	while (len) {
+		size_t part = MIN(len, log_output->size - cb->offset);
+
+		memcpy(&log_output->buf[cb->offset], src, part);
+		cb->offset += part;
+		src += part;
+		len -= part;
+
+		if (cb->offset == log_output->size) {
+			log_output_flush(log_output);
+		}
+	}
+}
+
+static void sync_write(const struct log_output *log_output)
+{
+	struct log_dict_sync sync = {
+		.type = LOG_DICT_TYPE_SYNC,
+		.magic = LOG_DICT_MAGIC,
+		.version = LOG_DICT_VERSION,
+		.ptr_size = sizeof(void *),
+		.arg_size = sizeof(log_arg_t),
+		.timestamp_freq = timestamp_freq,
+	};
+
+	if ((log_output->control_block->record_cnt++ %
+	     DICT_SYNC_PERIOD) != 0) {
+		return;
+	}
+
+	dict_write(log_output, &sync, sizeof(sync));
+}
+
+static void hdr_write(const struct log_output *log_output, uint8_t type,
+		      struct log_msg_ids src_level, uint32_t timestamp)
+{
+	struct log_dict_hdr hdr = {
+		.type = type | (src_level.level << 4),
+		.domain_id = src_level.domain_id,
+		.source_id = src_level.source_id,
+		.timestamp = timestamp,
+	};
+
+	sync_write(log_output);
+	dict_write(log_output, &hdr, sizeof(hdr));
+}
+
+/* Strings the host cannot read from the ELF file are sent inline. */
+static void str_write(const struct log_output *log_output, const char *str)
+{
+	const char *addr = str;
+
+	if ((str == NULL) || !z_log_is_rodata(str)) {
+		addr = NULL;
+	}
+
+	dict_write(log_output, &addr, sizeof(addr));
+
+	if (addr == NULL) {
+		str = (str == NULL) ? "(null)" : str;
+		dict_write(log_output, str, strlen(str) + 1);
+	}
+}
+
+static void args_write(const struct log_output *log_output, const char *fmt,
+		       log_arg_t *args, uint32_t nargs)
+{
+	uint32_t s_mask = z_log_get_s_mask(fmt, nargs);
+	uint8_t cnt = nargs;
+
+	dict_write(log_output, &cnt, sizeof(cnt));
+	dict_write(log_output, &fmt, sizeof(fmt));
+
+	for (uint32_t i = 0; i < nargs; i++) {
+		if (s_mask & BIT(i)) {
+			str_write(log_output, (const char *)args[i]);
+		} else {
+			dict_write(log_output, &args[i], sizeof(args[i]));
+		}
+	}
+}
+
+void log_output_msg_dict_process(const struct log_output *log_output,
+				 struct log_msg *msg, uint32_t flags)
+{
+	struct log_msg_ids src_level = msg->hdr.ids;
+	uint32_t timestamp = log_msg_timestamp_get(msg);
+
+	ARG_UNUSED(flags);
+
+	if (log_msg_is_std(msg)) {
+		uint32_t nargs = log_msg_nargs_get(msg);
+		log_arg_t args[LOG_MAX_NARGS];
+
+		for (uint32_t i = 0; i < nargs; i++) {
+			args[i] = log_msg_arg_get(msg, i);
+		}
+
+		hdr_write(log_output, LOG_DICT_TYPE_STD, src_level, timestamp);
+		args_write(log_output, log_msg_str_get(msg), args, nargs);
+	} else {
+		uint16_t len = msg->hdr.params.hexdump.length;
+		uint8_t buf[32];
+		uint32_t offset = 0;
+
+		hdr_write(log_output, LOG_DICT_TYPE_HEXDUMP, src_level,
+			  timestamp);
+		str_write(log_output, log_msg_str_get(msg));
+		dict_write(log_output, &len, sizeof(len));
+
+		while (offset < len) {
+			size_t part = sizeof(buf);
+
+			log_msg_hexdump_data_get(msg, buf, &part, offset);
+			if (part == 0) {
+				break;
+			}
+
+			dict_write(log_output, buf, part);
+			offset += part;
+		}
+	}
+
+	log_output_flush(log_output);
+}
+
+/* Walk the string the same way z_log_get_s_mask() does, reading an
+ * argument for each conversion. There is no argument count in immediate
+ * mode.
+ *
+ * Every argument is sent as one log_arg_t. Long long arguments are
+ * truncated to it on 32-bit targets, as in deferred mode. Floating point
+ * arguments cannot be encoded, a zero is sent in their place and the host
+ * prints the conversion as is. They are still read with their actual type
+ * so that the following arguments are not misread.
+ */
+static uint32_t va_args_get(const char *fmt, va_list ap, log_arg_t *args)
+{
+	uint32_t nargs = 0;
+	bool arm = false;
+	bool long_double = false;
+	int longs = 0;
+	char curr;
+
+	while ((curr = *fmt++) && (nargs < DICT_MAX_NARGS)) {
+		if (curr == '%') {
+			arm = !arm;
+			long_double = false;
+			longs = 0;
+		} else if (arm && strchr("hljztL", curr) != NULL) {
+			/* "hh" and "h" arguments are promoted to int */
+			if (curr == 'L') {
+				long_double = true;
+			} else if (curr == 'j') {
+				longs = 2;
+			} else if (curr != 'h') {
+				longs++;
+			}
+		} else if (arm && isalpha((int)curr)) {
+			if (strchr("aAeEfFgG", curr) != NULL) {
+				if (long_double) {
+					(void)va_arg(ap, long double);
+				} else {
+					(void)va_arg(ap, double);
+				}
+				args[nargs++] = 0;
+			} else if (longs > 1) {
+				args[nargs++] = (log_arg_t)va_arg(ap, long long);
+			} else if (longs || curr == 's' || curr == 'p') {
+				args[nargs++] = va_arg(ap, long);
+			} else if (curr == 'd' || curr == 'i') {
+				args[nargs++] = va_arg(ap, int);
+			} else {
+				args[nargs++] = va_arg(ap, unsigned int);
+			}
+			arm = false;
+		}
+	}
+
+	return nargs;
+}
+
+void log_output_string_dict_process(const struct log_output *log_output,
+				    struct log_msg_ids src_level,
+				    uint32_t timestamp, const char *fmt,
+				    va_list ap, uint32_t flags)
+{
+	log_arg_t args[DICT_MAX_NARGS];
+	uint32_t nargs = va_args_get(fmt, ap, args);
+
+	ARG_UNUSED(flags);
+
+	hdr_write(log_output, LOG_DICT_TYPE_STD, src_level, timestamp);
+	args_write(log_output, fmt, args, nargs);
+	log_output_flush(log_output);
+}
+
+void log_output_hexdump_dict_process(const struct log_output *log_output,
+				     struct log_msg_ids src_level,
+				     uint32_t timestamp, const char *metadata,
+				     const uint8_t *data, uint32_t length,
+				     uint32_t flags)
+{
+	uint16_t len = MIN(length, UINT16_MAX);
+
+	ARG_UNUSED(flags);
+
+	hdr_write(log_output, LOG_DICT_TYPE_HEXDUMP, src_level, timestamp);
+	str_write(log_output, metadata);
+	dict_write(log_output, &len, sizeof(len));
+	dict_write(log_output, data, len);
+	log_output_flush(log_output);
+}
+
+void log_output_dropped_dict_process(const struct log_output *log_output,
+				     uint32_t cnt)
+{
+	struct log_dict_dropped dropped = {
+		.type = LOG_DICT_TYPE_DROPPED,
+		.cnt = MIN(cnt, UINT16_MAX),
+	};
+
+	sync_write(log_output);
+	dict_write(log_output, &dropped, sizeof(dropped));
+	log_output_flush(log_output);
+}
+
+void log_output_dict_timestamp_freq_set(uint32_t freq)
+{
+	timestamp_freq = freq;
+}
@@ -44,8 +44,137 @@ static inline uint8_t get_6co_cid(struct net_icmpv6_nd_opt_6co *opt)
 }
 
 static struct net_6lo_context ctx_6co[CONFIG_NET_MAX_6LO_CONTEXTS];
+
+/* Contexts are looked up by a hash of the 64 bit prefix. Each bucket holds
+ * the index + 1 of the first context in the chain, 0 means empty.
+ */
+#define NET_6LO_CONTEXT_BUCKETS 8
+
+static uint8_t ctx_6co_bucket[NET_6LO_CONTEXT_BUCKETS];
+static uint8_t ctx_6co_next[CONFIG_NET_MAX_6LO_CONTEXTS];
 #endif
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+/* A cached flow maps the key header of a packet to its header in the other
+ * format. For compression the key is the IPv6 header without payload length
+ * plus the UDP ports, and the template is the IPHC encoding. For
+ * uncompression it is the other way around. The UDP checksum, when carried
+ * inline, is at the same offset in both formats so it is never cached.
+ */
+#define NET_6LO_FLOW_LLADDR_LEN 8 /* IIDs are derived from at most EUI-64 */
+
+struct net_6lo_flow {
+	struct net_if *iface;
+	uint8_t lladdr_src[NET_6LO_FLOW_LLADDR_LEN];
+	uint8_t lladdr_dst[NET_6LO_FLOW_LLADDR_LEN];
+	uint8_t lladdr_src_len;
+	uint8_t lladdr_dst_len;
+	uint8_t key_len;
+	uint8_t tmpl_len;
+	uint8_t key[NET_IPV6UDPH_LEN];
+	uint8_t tmpl[NET_IPV6UDPH_LEN];
+};
+
+struct net_6lo_flow_cache {
+	struct k_spinlock lock;
+	struct net_6lo_flow flows[CONFIG_NET_6LO_IPHC_CACHE_SIZE];
+};
+
+static struct net_6lo_flow_cache tx_flows;
+static struct net_6lo_flow_cache rx_flows;
+
+static uint32_t flow_hash(const uint8_t *key, size_t len)
+{
+	uint32_t hash = 2166136261U;
+
+	while (len--) {
+		hash = (hash ^ *key++) * 16777619U;
+	}
+
+	return hash;
+}
+
+static bool flow_match(struct net_6lo_flow *flow, struct net_pkt *pkt,
+		       const uint8_t *key, uint8_t key_len)
+{
+	struct net_linkaddr *src = net_pkt_lladdr_src(pkt);
+	struct net_linkaddr *dst = net_pkt_lladdr_dst(pkt);
+
+	return flow->key_len == key_len &&
+		flow->iface == net_pkt_iface(pkt) &&
+		flow->lladdr_src_len == src->len &&
+		flow->lladdr_dst_len == dst->len &&
+		!memcmp(flow->key, key, key_len) &&
+		!memcmp(flow->lladdr_src, src->addr, src->len) &&
+		!memcmp(flow->lladdr_dst, dst->addr, dst->len);
+}
+
+/* Copy the template of a cached flow to tmpl. Returns the template length
+ * or 0 if the flow is not cached.
+ */
+static uint8_t flow_lookup(struct net_6lo_flow_cache *cache,
+			   struct net_pkt *pkt, uint32_t hash,
+			   const uint8_t *key, uint8_t key_len, uint8_t *tmpl)
+{
+	struct net_6lo_flow *flow;
+	k_spinlock_key_t key_lock;
+	uint8_t len = 0U;
+
+	flow = &cache->flows[hash % CONFIG_NET_6LO_IPHC_CACHE_SIZE];
+
+	key_lock = k_spin_lock(&cache->lock);
+
+	if (flow_match(flow, pkt, key, key_len)) {
+		len = flow->tmpl_len;
+		memcpy(tmpl, flow->tmpl, len);
+	}
+
+	k_spin_unlock(&cache->lock, key_lock);
+
+	return len;
+}
+
+static void flow_store(struct net_6lo_flow_cache *cache, struct net_pkt *pkt,
+		       uint32_t hash, const uint8_t *key, uint8_t key_len,
+		       const uint8_t *tmpl, uint8_t tmpl_len)
+{
+	struct net_linkaddr *src = net_pkt_lladdr_src(pkt);
+	struct net_linkaddr *dst = net_pkt_lladdr_dst(pkt);
+	struct net_6lo_flow *flow;
+	k_spinlock_key_t key_lock;
+
+	if (src->len > sizeof(flow->lladdr_src) ||
+	    dst->len > sizeof(flow->lladdr_dst)) {
+		return;
+	}
+
+	flow = &cache->flows[hash % CONFIG_NET_6LO_IPHC_CACHE_SIZE];
+
+	key_lock = k_spin_lock(&cache->lock);
+
+	flow->iface = net_pkt_iface(pkt);
+	flow->lladdr_src_len = src->len;
+	flow->lladdr_dst_len = dst->len;
+	memcpy(flow->lladdr_src, src->addr, src->len);
+	memcpy(flow->lladdr_dst, dst->addr, dst->len);
+	flow->key_len = key_len;
+	flow->tmpl_len = tmpl_len;
+	memcpy(flow->key, key, key_len);
+	memcpy(flow->tmpl, tmpl, tmpl_len);
+
+	k_spin_unlock(&cache->lock, key_lock);
+}
+
+static void flow_flush(struct net_6lo_flow_cache *cache)
+{
+	k_spinlock_key_t key_lock;
+
+	key_lock = k_spin_lock(&cache->lock);
+	memset(cache->flows, 0, sizeof(cache->flows));
+	k_spin_unlock(&cache->lock, key_lock);
+}
+#endif /* CONFIG_NET_6LO_IPHC_CACHE */
+
 static const uint8_t udp_nhc_inline_size_table[] = {4, 3, 3, 1};
 
 static const uint8_t tf_inline_size_table[] = {4, 3, 1, 0};
@@ -172,6 +301,41 @@ static inline void set_6lo_context(struct net_if *iface, uint8_t index,
 	net_ipaddr_copy(&ctx_6co[index].prefix, &context->prefix);
 }
 
+static inline uint8_t get_6lo_context_bucket(const uint8_t *prefix)
+{
+	uint32_t hash = UNALIGNED_GET((uint32_t *)&prefix[0]) ^
+			UNALIGNED_GET((uint32_t *)&prefix[4]);
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return hash & (NET_6LO_CONTEXT_BUCKETS - 1);
+}
+
+static void rehash_6lo_contexts(void)
+{
+	uint8_t bucket;
+	uint8_t i;
+
+	(void)memset(ctx_6co_bucket, 0, sizeof(ctx_6co_bucket));
+
+	for (i = 0U; i < CONFIG_NET_MAX_6LO_CONTEXTS; i++) {
+		if (!ctx_6co[i].is_used) {
+			continue;
+		}
+
+		bucket = get_6lo_context_bucket(ctx_6co[i].prefix.s6_addr);
+		ctx_6co_next[i] = ctx_6co_bucket[bucket];
+		ctx_6co_bucket[bucket] = i + 1;
+	}
+
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	/* Cached headers might depend on the old contexts */
+	flow_flush(&tx_flows);
+	flow_flush(&rx_flows);
+#endif
+}
+
 void net_6lo_set_context(struct net_if *iface,
 			 struct net_icmpv6_nd_opt_6co *context)
 {
@@ -192,11 +356,13 @@ void net_6lo_set_context(struct net_if *iface,
 			/* Remove if lifetime is zero */
 			if (!context->lifetime) {
 				ctx_6co[i].is_used = false;
+				rehash_6lo_contexts();
 				return;
 			}
 
 			/* Update the context */
 			set_6lo_context(iface, i, context);
+			rehash_6lo_contexts();
 			return;
 		}
 	}
@@ -204,6 +370,7 @@ void net_6lo_set_context(struct net_if *iface,
 	/* Cache the context information. */
 	if (unused != -1) {
 		set_6lo_context(iface, unused, context);
+		rehash_6lo_contexts();
 		return;
 	}
 
@@ -235,15 +402,17 @@ get_6lo_context_by_addr(struct net_if *iface, struct in6_addr *addr)
 {
 	uint8_t i;
 
-	for (i = 0U; i < CONFIG_NET_MAX_6LO_CONTEXTS; i++) {
-		if (!ctx_6co[i].is_used) {
-			continue;
-		}
+	i = ctx_6co_bucket[get_6lo_context_bucket(addr->s6_addr)];
 
-		if (ctx_6co[i].iface == iface &&
-		    !memcmp(ctx_6co[i].prefix.s6_addr, addr->s6_addr, 8)) {
-			return &ctx_6co[i];
+	while (i) {
+		struct net_6lo_context *ctx = &ctx_6co[i - 1];
+
+		if (ctx->iface == iface &&
+		    !memcmp(ctx->prefix.s6_addr, addr->s6_addr, 8)) {
+			return ctx;
 		}
+
+		i = ctx_6co_next[i - 1];
 	}
 
 	return NULL;
@@ -729,6 +898,14 @@ static inline int compress_IPHC_header(struct net_pkt *pkt)
 	struct net_ipv6_hdr *ipv6 = NET_IPV6_HDR(pkt);
 	struct net_udp_hdr *udp;
 	uint8_t *inline_pos;
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	uint8_t key[NET_IPV6UDPH_LEN];
+	uint8_t tmpl[NET_IPV6UDPH_LEN];
+	uint8_t key_len = NET_IPV6H_LEN;
+	uint8_t *tmpl_end;
+	uint8_t tmpl_len;
+	uint32_t hash;
+#endif
 
 	if (pkt->frags->len < NET_IPV6H_LEN) {
 		NET_ERR("Invalid length %d, min %d",
@@ -743,6 +920,32 @@ static inline int compress_IPHC_header(struct net_pkt *pkt)
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	/* The compressed header ends where the uncompressed one did, or just
+	 * before the inlined UDP checksum which is left in place.
+	 */
+	tmpl_end = pkt->buffer->data + NET_IPV6H_LEN;
+
+	memcpy(key, ipv6, NET_IPV6H_LEN);
+	UNALIGNED_PUT(0, (uint16_t *)&key[offsetof(struct net_ipv6_hdr, len)]);
+
+	if (ipv6->nexthdr == IPPROTO_UDP) {
+		memcpy(&key[NET_IPV6H_LEN], tmpl_end,
+		       sizeof(udp->src_port) + sizeof(udp->dst_port));
+		key_len += sizeof(udp->src_port) + sizeof(udp->dst_port);
+		tmpl_end += NET_UDPH_LEN - sizeof(udp->chksum);
+	}
+
+	hash = flow_hash(key, key_len);
+
+	tmpl_len = flow_lookup(&tx_flows, pkt, hash, key, key_len, tmpl);
+	if (tmpl_len) {
+		inline_pos = tmpl_end - tmpl_len;
+		memcpy(inline_pos, tmpl, tmpl_len);
+		goto done;
+	}
+#endif
+
 	inline_pos = pkt->buffer->data + NET_IPV6H_LEN;
 
 	if (ipv6->nexthdr == IPPROTO_UDP) {
@@ -823,6 +1026,11 @@ sa_end:
 	iphc = htons(iphc);
 	memmove(inline_pos, &iphc, sizeof(iphc));
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	flow_store(&tx_flows, pkt, hash, key, key_len, inline_pos,
+		   tmpl_end - inline_pos);
+done:
+#endif
 	compressed = inline_pos - pkt->buffer->data;
 
 	net_buf_pull(pkt->buffer, compressed);
@@ -1324,6 +1532,14 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt)
 	struct net_6lo_context *src = NULL;
 	struct net_6lo_context *dst = NULL;
 #endif
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	uint8_t key[NET_IPV6UDPH_LEN];
+	uint8_t tmpl[NET_IPV6UDPH_LEN];
+	uint8_t tmpl_len;
+	uint16_t chksum = 0U;
+	uint8_t key_len;
+	uint32_t hash;
+#endif
 
 	iphc = ntohs(UNALIGNED_GET((uint16_t *)pkt->buffer->data));
 
@@ -1348,7 +1564,31 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt)
 			nhc_inline_size;
 	}
 
-	if (net_buf_tailroom(pkt->buffer) >= diff) {
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	/* The inlined UDP checksum is not part of the flow */
+	key_len = compressed_hdr_size;
+	if (nhc && !(nhc & NET_6LO_NHC_UDP_CHECKSUM)) {
+		key_len -= sizeof(chksum);
+		chksum = UNALIGNED_GET((uint16_t *)(pkt->buffer->data +
+						    key_len));
+	}
+
+	hash = flow_hash(pkt->buffer->data, key_len);
+
+	tmpl_len = flow_lookup(&rx_flows, pkt, hash, pkt->buffer->data,
+			       key_len, tmpl);
+	if (!tmpl_len) {
+		/* The key is overwritten when uncompressing in place */
+		memcpy(key, pkt->buffer->data, key_len);
+	}
+#endif
+
+	if (net_buf_headroom(pkt->buffer) >= diff) {
+		NET_DBG("Enough headroom. Uncompress inplace");
+		frag = pkt->buffer;
+		cursor = frag->data;
+		net_buf_push(frag, diff);
+	} else if (net_buf_tailroom(pkt->buffer) >= diff) {
 		NET_DBG("Enough tailroom. Uncompress inplace");
 		frag = pkt->buffer;
 		net_buf_add(frag, diff);
@@ -1368,6 +1608,22 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt)
 	}
 
 	ipv6 = (struct net_ipv6_hdr *)(frag->data);
+
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	if (tmpl_len) {
+		memcpy(frag->data, tmpl, tmpl_len);
+		net_pkt_set_ip_hdr_len(pkt, NET_IPV6H_LEN);
+
+		if (nhc) {
+			udp = (struct net_udp_hdr *)(frag->data +
+						     NET_IPV6H_LEN);
+			udp->chksum = chksum;
+		}
+
+		goto done;
+	}
+#endif
+
 	cursor += sizeof(iphc);
 
 	if (iphc & NET_6LO_IPHC_CID_1) {
@@ -1457,6 +1713,12 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt)
 		cursor = uncompress_nh_udp(nhc, cursor, udp);
 	}
 
+#if defined(CONFIG_NET_6LO_IPHC_CACHE)
+	flow_store(&rx_flows, pkt, hash, key, key_len, frag->data,
+		   nhc ? NET_IPV6UDPH_LEN - sizeof(udp->chksum) :
+		   NET_IPV6H_LEN);
+done:
+#endif
 	if (frag != pkt->buffer) {
 		/* Insert the fragment (this one holds uncompressed headers) */
 		net_pkt_frag_insert(pkt, frag);
@@ -1470,6 +1732,7 @@ static bool uncompress_IPHC_header(struct net_pkt *pkt)
 		udp->len = htons(len);
 
 		if (nhc & NET_6LO_NHC_UDP_CHECKSUM) {
+			udp->chksum = 0U;
 			udp->chksum = net_calc_chksum_udp(pkt);
 		}
 	}
@@ -142,6 +142,32 @@ static inline bool net_ipv6_is_nexthdr_upper_layer(uint8_t nexthdr)
 		nexthdr == IPPROTO_TCP);
 }
 
+/**
+ * @brief Hash an IPv6 address into a hash table bucket.
+ *
+ * @param addr IPv6 address
+ * @param bits Number of bits in the bucket index
+ *
+ * @return Bucket index between 0 and (1 << bits) - 1.
+ */
+static inline uint32_t net_ipv6_addr_hash(const struct in6_addr *addr,
+					  uint8_t bits)
+{
+	uint32_t hash;
+
+	if (bits == 0U) {
+		return 0;
+	}
+
+	hash = UNALIGNED_GET(&addr->s6_addr32[0]) ^
+		UNALIGNED_GET(&addr->s6_addr32[1]) ^
+		UNALIGNED_GET(&addr->s6_addr32[2]) ^
+		UNALIGNED_GET(&addr->s6_addr32[3]);
+
+	/* Fibonacci hashing, the top bits are the best mixed ones */
+	return (hash * 0x9e3779b1U) >> (32 - bits);
+}
+
 /**
  * @brief Create IPv6 packet in provided net_pkt.
  *
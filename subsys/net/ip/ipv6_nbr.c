@@ -97,6 +97,21 @@ NET_NBR_TABLE_INIT(NET_NBR_GLOBAL,
 		   net_neighbor_pool,
 		   net_neighbor_table_clear);
 
+/* Neighbors in use are indexed by their IPv6 address. The buckets and
+ * the collision chains hold indices to net_neighbor_pool.
+ */
+#define NBR_HASH_SIZE BIT(CONFIG_NET_IPV6_NBR_HASH_BITS)
+#define NBR_HASH_COUNT CONFIG_NET_IPV6_MAX_NEIGHBORS
+#define NBR_HASH_END 0xff
+
+BUILD_ASSERT(NBR_HASH_COUNT < NBR_HASH_END);
+
+static uint8_t nbr_hash[NBR_HASH_SIZE] = {
+	[0 ... (NBR_HASH_SIZE - 1)] = NBR_HASH_END
+};
+static uint8_t nbr_hash_next[NBR_HASH_COUNT];
+static struct k_spinlock nbr_hash_lock;
+
 const char *net_ipv6_nbr_state2str(enum net_ipv6_nbr_state state)
 {
 	switch (state) {
@@ -122,19 +137,60 @@ static inline struct net_nbr *get_nbr(int idx)
 	return &net_neighbor_pool[idx].nbr;
 }
 
+static inline int get_nbr_index(struct net_nbr *nbr)
+{
+	return ((uint8_t *)nbr - (uint8_t *)net_neighbor_pool) /
+		sizeof(net_neighbor_pool[0]);
+}
+
 static inline struct net_nbr *get_nbr_from_data(struct net_ipv6_nbr_data *data)
 {
-	int i;
+	struct net_nbr *nbr = CONTAINER_OF(data, struct net_nbr, __nbr);
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	if ((uintptr_t)nbr < (uintptr_t)get_nbr(0) ||
+	    (uintptr_t)nbr > (uintptr_t)get_nbr(NBR_HASH_COUNT - 1) ||
+	    nbr != get_nbr(get_nbr_index(nbr))) {
+		return NULL;
+	}
 
-		if (nbr->data == (uint8_t *)data) {
-			return nbr;
+	return nbr;
+}
+
+static void nbr_hash_add(struct net_nbr *nbr)
+{
+	uint32_t bucket = net_ipv6_addr_hash(&net_ipv6_nbr_data(nbr)->addr,
+					     CONFIG_NET_IPV6_NBR_HASH_BITS);
+	int idx = get_nbr_index(nbr);
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&nbr_hash_lock);
+
+	nbr_hash_next[idx] = nbr_hash[bucket];
+	nbr_hash[bucket] = idx;
+
+	k_spin_unlock(&nbr_hash_lock, key);
+}
+
+static void nbr_hash_remove(struct net_nbr *nbr)
+{
+	uint32_t bucket = net_ipv6_addr_hash(&net_ipv6_nbr_data(nbr)->addr,
+					     CONFIG_NET_IPV6_NBR_HASH_BITS);
+	uint8_t idx = get_nbr_index(nbr);
+	k_spinlock_key_t key;
+	uint8_t *prev;
+
+	key = k_spin_lock(&nbr_hash_lock);
+
+	for (prev = &nbr_hash[bucket]; *prev != NBR_HASH_END;
+	     prev = &nbr_hash_next[*prev]) {
+		if (*prev == idx) {
+			*prev = nbr_hash_next[idx];
+			nbr_hash_next[idx] = NBR_HASH_END;
+			break;
 		}
 	}
 
-	return NULL;
+	k_spin_unlock(&nbr_hash_lock, key);
 }
 
 static void ipv6_nbr_set_state(struct net_nbr *nbr,
@@ -259,10 +315,19 @@ static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 				  struct net_if *iface,
 				  const struct in6_addr *addr)
 {
-	int i;
+	uint32_t bucket = net_ipv6_addr_hash(addr,
+					     CONFIG_NET_IPV6_NBR_HASH_BITS);
+	struct net_nbr *found = NULL;
+	k_spinlock_key_t key;
+	uint8_t idx;
 
-	for (i = 0; i < CONFIG_NET_IPV6_MAX_NEIGHBORS; i++) {
-		struct net_nbr *nbr = get_nbr(i);
+	ARG_UNUSED(table);
+
+	key = k_spin_lock(&nbr_hash_lock);
+
+	for (idx = nbr_hash[bucket]; idx != NBR_HASH_END;
+	     idx = nbr_hash_next[idx]) {
+		struct net_nbr *nbr = get_nbr(idx);
 
 		if (!nbr->ref) {
 			continue;
@@ -273,11 +338,14 @@ static struct net_nbr *nbr_lookup(struct net_nbr_table *table,
 		}
 
 		if (net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr, addr)) {
-			return nbr;
+			found = nbr;
+			break;
 		}
 	}
 
-	return NULL;
+	k_spin_unlock(&nbr_hash_lock, key);
+
+	return found;
 }
 
 static inline void nbr_clear_ns_pending(struct net_ipv6_nbr_data *data)
@@ -430,6 +498,7 @@ static struct net_nbr *nbr_new(struct net_if *iface,
 	}
 
 	nbr_init(nbr, iface, addr, is_router, state);
+	nbr_hash_add(nbr);
 
 	NET_DBG("nbr %p iface %p/%d state %d IPv6 %s",
 		nbr, iface, net_if_get_by_iface(iface), state,
@@ -653,7 +722,7 @@ void net_neighbor_data_remove(struct net_nbr *nbr)
 {
 	NET_DBG("Neighbor %p removed", nbr);
 
-	return;
+	nbr_hash_remove(nbr);
 }
 
 void net_neighbor_table_clear(struct net_nbr_table *table)
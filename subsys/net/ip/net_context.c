@@ -1152,6 +1152,24 @@ static int get_context_proxy(struct net_context *context,
 #endif
 }
 
+static int get_context_tcp_congestion(struct net_context *context,
+				      void *value, size_t *len)
+{
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	if (!value || !len) {
+		return -EINVAL;
+	}
+
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
+		return -EINVAL;
+	}
+
+	return net_tcp_get_congestion(context, value, len);
+#else
+	return -ENOTSUP;
+#endif
+}
+
 #if defined(CONFIG_NET_CONTEXT_TIMESTAMP)
 int net_context_get_timestamp(struct net_context *context,
 			      struct net_pkt *pkt,
@@ -1308,6 +1326,28 @@ static struct net_pkt *context_alloc_pkt(struct net_context *context,
 		return pkt;
 	}
 #endif
+
+#if defined(CONFIG_NET_PKT_RESERVE)
+	if (context->pkt_reserve) {
+		pkt = net_pkt_alloc_from_reserve(context->pkt_reserve, timeout);
+		if (!pkt) {
+			return NULL;
+		}
+
+		net_pkt_set_iface(pkt, net_context_get_iface(context));
+		net_pkt_set_family(pkt, net_context_get_family(context));
+		net_pkt_set_context(pkt, context);
+
+		if (net_pkt_alloc_buffer(pkt, len,
+					 net_context_get_ip_proto(context),
+					 timeout)) {
+			net_pkt_unref(pkt);
+			return NULL;
+		}
+
+		return pkt;
+	}
+#endif
 	pkt = net_pkt_alloc_with_buffer(net_context_get_iface(context), len,
 					net_context_get_family(context),
 					net_context_get_ip_proto(context),
@@ -1722,6 +1762,126 @@ int net_context_sendto(struct net_context *context,
 	return ret;
 }
 
+int net_context_send_buf(struct net_context *context,
+			 struct net_buf *frags,
+			 const struct sockaddr *dst_addr,
+			 socklen_t addrlen,
+			 net_context_send_cb_t cb,
+			 k_timeout_t timeout,
+			 void *user_data)
+{
+	enum net_ip_protocol proto = net_context_get_ip_proto(context);
+	struct net_pkt *pkt = NULL;
+	size_t len = net_buf_frags_len(frags);
+	int ret;
+
+	NET_ASSERT(PART_OF_ARRAY(contexts, context));
+
+	k_mutex_lock(&context->lock, K_FOREVER);
+
+	if (!net_context_is_used(context)) {
+		ret = -EBADF;
+		goto fail;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_UDP) && proto == IPPROTO_UDP) {
+		if (!dst_addr) {
+			if (!(context->flags & NET_CONTEXT_REMOTE_ADDR_SET)) {
+				ret = -EDESTADDRREQ;
+				goto fail;
+			}
+
+			dst_addr = &context->remote;
+			addrlen = sizeof(context->remote);
+		}
+
+		if (dst_addr->sa_family != net_context_get_family(context)) {
+			ret = -EAFNOSUPPORT;
+			goto fail;
+		}
+
+		/* The packet buffer only holds the protocol headers */
+		pkt = context_alloc_pkt(context, 0, timeout);
+		if (!pkt) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+
+		ret = context_setup_udp_packet(context, pkt, NULL, 0, NULL,
+					       dst_addr, addrlen);
+		if (ret < 0) {
+			goto fail;
+		}
+
+		net_pkt_append_buffer(pkt, frags);
+		frags = NULL;
+
+		context_finalize_packet(context, pkt);
+	} else if (IS_ENABLED(CONFIG_NET_TCP2) && proto == IPPROTO_TCP) {
+		pkt = net_pkt_alloc_on_iface(net_context_get_iface(context),
+					     timeout);
+		if (!pkt) {
+			ret = -ENOMEM;
+			goto fail;
+		}
+
+		net_pkt_set_family(pkt, net_context_get_family(context));
+		net_pkt_set_context(pkt, context);
+		net_pkt_append_buffer(pkt, frags);
+		frags = NULL;
+		net_pkt_cursor_init(pkt);
+	} else {
+		ret = -EOPNOTSUPP;
+		goto fail;
+	}
+
+	context->send_cb = cb;
+	context->user_data = user_data;
+
+	if (IS_ENABLED(CONFIG_NET_CONTEXT_PRIORITY)) {
+		uint8_t priority;
+
+		get_context_priority(context, &priority, NULL);
+		net_pkt_set_priority(pkt, priority);
+	}
+
+	if (proto == IPPROTO_UDP) {
+		ret = net_send_data(pkt);
+	} else {
+		/* TCP takes over the data buffers and releases the packet,
+		 * unless there is no connection.
+		 */
+		ret = net_tcp_queue_data(context, pkt);
+		if (ret != -ENOTCONN) {
+			pkt = NULL;
+		}
+
+		if (ret == 0) {
+			ret = net_tcp_send_data(context, cb, user_data);
+		}
+	}
+
+	if (ret < 0) {
+		goto fail;
+	}
+
+	k_mutex_unlock(&context->lock);
+
+	return len;
+fail:
+	if (pkt) {
+		net_pkt_unref(pkt);
+	}
+
+	if (frags) {
+		net_buf_unref(frags);
+	}
+
+	k_mutex_unlock(&context->lock);
+
+	return ret;
+}
+
 enum net_verdict net_context_packet_received(struct net_conn *conn,
 					     struct net_pkt *pkt,
 					     union net_ip_header *ip_hdr,
@@ -2085,6 +2245,20 @@ static int set_context_proxy(struct net_context *context,
 #endif
 }
 
+static int set_context_tcp_congestion(struct net_context *context,
+				      const void *value, size_t len)
+{
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	if (net_context_get_ip_proto(context) != IPPROTO_TCP) {
+		return -EINVAL;
+	}
+
+	return net_tcp_set_congestion(context, value, len);
+#else
+	return -ENOTSUP;
+#endif
+}
+
 int net_context_set_option(struct net_context *context,
 			   enum net_context_option option,
 			   const void *value, size_t len)
@@ -2112,6 +2286,9 @@ int net_context_set_option(struct net_context *context,
 	case NET_OPT_SOCKS5:
 		ret = set_context_proxy(context, value, len);
 		break;
+	case NET_OPT_TCP_CONGESTION:
+		ret = set_context_tcp_congestion(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -2146,6 +2323,9 @@ int net_context_get_option(struct net_context *context,
 	case NET_OPT_SOCKS5:
 		ret = get_context_proxy(context, value, len);
 		break;
+	case NET_OPT_TCP_CONGESTION:
+		ret = get_context_tcp_congestion(context, value, len);
+		break;
 	}
 
 	k_mutex_unlock(&context->lock);
@@ -74,6 +74,31 @@ static struct {
 	struct net_if_ipv6 ipv6;
 	struct net_if *iface;
 } ipv6_addresses[CONFIG_NET_IF_MAX_IPV6_COUNT];
+
+#if CONFIG_NET_IF_IPV6_ADDR_HASH_BITS > 0
+/* Unicast and multicast addresses of all the interfaces are indexed by
+ * address. The buckets and the collision chains hold address slots,
+ * a slot being the ipv6_addresses index times the number of addresses
+ * per interface plus the address index.
+ */
+#define IPV6_ADDR_HASH_SIZE BIT(CONFIG_NET_IF_IPV6_ADDR_HASH_BITS)
+#define IPV6_ADDR_HASH_END 0xffff
+#define IPV6_UCAST_SLOTS (CONFIG_NET_IF_MAX_IPV6_COUNT * NET_IF_MAX_IPV6_ADDR)
+#define IPV6_MCAST_SLOTS (CONFIG_NET_IF_MAX_IPV6_COUNT * NET_IF_MAX_IPV6_MADDR)
+
+BUILD_ASSERT(IPV6_UCAST_SLOTS < IPV6_ADDR_HASH_END);
+BUILD_ASSERT(IPV6_MCAST_SLOTS < IPV6_ADDR_HASH_END);
+
+static uint16_t ipv6_ucast_hash[IPV6_ADDR_HASH_SIZE] = {
+	[0 ... (IPV6_ADDR_HASH_SIZE - 1)] = IPV6_ADDR_HASH_END
+};
+static uint16_t ipv6_ucast_hash_next[IPV6_UCAST_SLOTS];
+static uint16_t ipv6_mcast_hash[IPV6_ADDR_HASH_SIZE] = {
+	[0 ... (IPV6_ADDR_HASH_SIZE - 1)] = IPV6_ADDR_HASH_END
+};
+static uint16_t ipv6_mcast_hash_next[IPV6_MCAST_SLOTS];
+static struct k_spinlock ipv6_addr_hash_lock;
+#endif /* CONFIG_NET_IF_IPV6_ADDR_HASH_BITS > 0 */
 #endif /* CONFIG_NET_IPV6 */
 
 #if defined(CONFIG_NET_NATIVE_IPV4)
@@ -305,6 +330,9 @@ void net_if_stats_reset(struct net_if *iface)
 	Z_STRUCT_SECTION_FOREACH(net_if, tmp) {
 		if (iface == tmp) {
 			memset(&iface->stats, 0, sizeof(iface->stats));
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+			memset(iface->stats_cpu, 0, sizeof(iface->stats_cpu));
+#endif
 			return;
 		}
 	}
@@ -317,6 +345,9 @@ void net_if_stats_reset_all(void)
 
 	Z_STRUCT_SECTION_FOREACH(net_if, iface) {
 		memset(&iface->stats, 0, sizeof(iface->stats));
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+		memset(iface->stats_cpu, 0, sizeof(iface->stats_cpu));
+#endif
 	}
 #endif
 }
@@ -1139,6 +1170,105 @@ static inline void iface_ipv6_nd_init(void)
 #define iface_ipv6_nd_init(...)
 #endif /* CONFIG_NET_IPV6_ND */
 
+#if CONFIG_NET_IF_IPV6_ADDR_HASH_BITS > 0
+static inline int ipv6_config_index(struct net_if_ipv6 *ipv6)
+{
+	return ((uint8_t *)ipv6 - (uint8_t *)&ipv6_addresses[0].ipv6) /
+		sizeof(ipv6_addresses[0]);
+}
+
+static inline uint16_t ipv6_ucast_slot(struct net_if_ipv6 *ipv6, int i)
+{
+	return ipv6_config_index(ipv6) * NET_IF_MAX_IPV6_ADDR + i;
+}
+
+static inline uint16_t ipv6_mcast_slot(struct net_if_ipv6 *ipv6, int i)
+{
+	return ipv6_config_index(ipv6) * NET_IF_MAX_IPV6_MADDR + i;
+}
+
+static void ipv6_addr_hash_add(uint16_t *hash, uint16_t *next,
+			       uint16_t slot, const struct in6_addr *addr)
+{
+	uint32_t bucket = net_ipv6_addr_hash(addr,
+					     CONFIG_NET_IF_IPV6_ADDR_HASH_BITS);
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&ipv6_addr_hash_lock);
+
+	next[slot] = hash[bucket];
+	hash[bucket] = slot;
+
+	k_spin_unlock(&ipv6_addr_hash_lock, key);
+}
+
+static void ipv6_addr_hash_rm(uint16_t *hash, uint16_t *next,
+			      uint16_t slot, const struct in6_addr *addr)
+{
+	uint32_t bucket = net_ipv6_addr_hash(addr,
+					     CONFIG_NET_IF_IPV6_ADDR_HASH_BITS);
+	k_spinlock_key_t key;
+	uint16_t *prev;
+
+	key = k_spin_lock(&ipv6_addr_hash_lock);
+
+	for (prev = &hash[bucket]; *prev != IPV6_ADDR_HASH_END;
+	     prev = &next[*prev]) {
+		if (*prev == slot) {
+			*prev = next[slot];
+			next[slot] = IPV6_ADDR_HASH_END;
+			break;
+		}
+	}
+
+	k_spin_unlock(&ipv6_addr_hash_lock, key);
+}
+
+struct net_if_addr *net_if_ipv6_addr_lookup(const struct in6_addr *addr,
+					    struct net_if **ret)
+{
+	uint32_t bucket = net_ipv6_addr_hash(addr,
+					     CONFIG_NET_IF_IPV6_ADDR_HASH_BITS);
+	struct net_if_addr *found = NULL;
+	k_spinlock_key_t key;
+	uint16_t slot;
+
+	key = k_spin_lock(&ipv6_addr_hash_lock);
+
+	for (slot = ipv6_ucast_hash[bucket]; slot != IPV6_ADDR_HASH_END;
+	     slot = ipv6_ucast_hash_next[slot]) {
+		int idx = slot / NET_IF_MAX_IPV6_ADDR;
+		struct net_if *iface = ipv6_addresses[idx].iface;
+		struct net_if_addr *ifaddr =
+			&ipv6_addresses[idx].ipv6.unicast[slot %
+							  NET_IF_MAX_IPV6_ADDR];
+
+		if (!iface || !ifaddr->is_used ||
+		    ifaddr->address.family != AF_INET6) {
+			continue;
+		}
+
+		if (net_ipv6_addr_cmp(&ifaddr->address.in6_addr, addr)) {
+			if (ret) {
+				*ret = iface;
+			}
+
+			found = ifaddr;
+			break;
+		}
+	}
+
+	k_spin_unlock(&ipv6_addr_hash_lock, key);
+
+	return found;
+}
+#else
+/* Without the index, addresses written directly to the unicast[] and
+ * mcast[] slots are found too.
+ */
+#define ipv6_addr_hash_add(...)
+#define ipv6_addr_hash_rm(...)
+
 struct net_if_addr *net_if_ipv6_addr_lookup(const struct in6_addr *addr,
 					    struct net_if **ret)
 {
@@ -1172,6 +1302,7 @@ struct net_if_addr *net_if_ipv6_addr_lookup(const struct in6_addr *addr,
 
 	return NULL;
 }
+#endif /* CONFIG_NET_IF_IPV6_ADDR_HASH_BITS > 0 */
 
 struct net_if_addr *net_if_ipv6_addr_lookup_by_iface(struct net_if *iface,
 						     struct in6_addr *addr)
@@ -1451,6 +1582,9 @@ struct net_if_addr *net_if_ipv6_addr_add(struct net_if *iface,
 		net_if_addr_init(&ipv6->unicast[i], addr, addr_type,
 				 vlifetime);
 
+		ipv6_addr_hash_add(ipv6_ucast_hash, ipv6_ucast_hash_next,
+				   ipv6_ucast_slot(ipv6, i), addr);
+
 		NET_DBG("[%d] interface %p address %s type %s added", i,
 			iface, log_strdup(net_sprint_ipv6_addr(addr)),
 			net_addr_type2str(addr_type));
@@ -1517,6 +1651,9 @@ bool net_if_ipv6_addr_rm(struct net_if *iface, const struct in6_addr *addr)
 			}
 		}
 
+		ipv6_addr_hash_rm(ipv6_ucast_hash, ipv6_ucast_hash_next,
+				  ipv6_ucast_slot(ipv6, i), addr);
+
 		ipv6->unicast[i].is_used = false;
 
 		net_ipv6_addr_create_solicited_node(addr, &maddr);
@@ -1636,6 +1773,9 @@ struct net_if_mcast_addr *net_if_ipv6_maddr_add(struct net_if *iface,
 		ipv6->mcast[i].address.family = AF_INET6;
 		memcpy(&ipv6->mcast[i].address.in6_addr, addr, 16);
 
+		ipv6_addr_hash_add(ipv6_mcast_hash, ipv6_mcast_hash_next,
+				   ipv6_mcast_slot(ipv6, i), addr);
+
 		NET_DBG("[%d] interface %p address %s added", i, iface,
 			log_strdup(net_sprint_ipv6_addr(addr)));
 
@@ -1669,6 +1809,9 @@ bool net_if_ipv6_maddr_rm(struct net_if *iface, const struct in6_addr *addr)
 			continue;
 		}
 
+		ipv6_addr_hash_rm(ipv6_mcast_hash, ipv6_mcast_hash_next,
+				  ipv6_mcast_slot(ipv6, i), addr);
+
 		ipv6->mcast[i].is_used = false;
 
 		NET_DBG("[%d] interface %p address %s removed",
@@ -1685,6 +1828,50 @@ bool net_if_ipv6_maddr_rm(struct net_if *iface, const struct in6_addr *addr)
 	return false;
 }
 
+#if CONFIG_NET_IF_IPV6_ADDR_HASH_BITS > 0
+struct net_if_mcast_addr *net_if_ipv6_maddr_lookup(const struct in6_addr *maddr,
+						   struct net_if **ret)
+{
+	uint32_t bucket = net_ipv6_addr_hash(maddr,
+					     CONFIG_NET_IF_IPV6_ADDR_HASH_BITS);
+	struct net_if_mcast_addr *found = NULL;
+	k_spinlock_key_t key;
+	uint16_t slot;
+
+	key = k_spin_lock(&ipv6_addr_hash_lock);
+
+	for (slot = ipv6_mcast_hash[bucket]; slot != IPV6_ADDR_HASH_END;
+	     slot = ipv6_mcast_hash_next[slot]) {
+		int idx = slot / NET_IF_MAX_IPV6_MADDR;
+		struct net_if *iface = ipv6_addresses[idx].iface;
+		struct net_if_mcast_addr *ifmaddr =
+			&ipv6_addresses[idx].ipv6.mcast[slot %
+							NET_IF_MAX_IPV6_MADDR];
+
+		if (!iface || (ret && *ret && iface != *ret)) {
+			continue;
+		}
+
+		if (!ifmaddr->is_used ||
+		    ifmaddr->address.family != AF_INET6) {
+			continue;
+		}
+
+		if (net_ipv6_addr_cmp(&ifmaddr->address.in6_addr, maddr)) {
+			if (ret) {
+				*ret = iface;
+			}
+
+			found = ifmaddr;
+			break;
+		}
+	}
+
+	k_spin_unlock(&ipv6_addr_hash_lock, key);
+
+	return found;
+}
+#else
 struct net_if_mcast_addr *net_if_ipv6_maddr_lookup(const struct in6_addr *maddr,
 						   struct net_if **ret)
 {
@@ -1721,6 +1908,7 @@ struct net_if_mcast_addr *net_if_ipv6_maddr_lookup(const struct in6_addr *maddr,
 
 	return NULL;
 }
+#endif /* CONFIG_NET_IF_IPV6_ADDR_HASH_BITS > 0 */
 
 void net_if_mcast_mon_register(struct net_if_mcast_monitor *mon,
 			       struct net_if *iface,
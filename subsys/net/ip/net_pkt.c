@@ -128,6 +128,192 @@ NET_BUF_POOL_VAR_DEFINE(tx_bufs, CONFIG_NET_BUF_TX_COUNT,
 
 #endif /* CONFIG_NET_BUF_FIXED_DATA_SIZE */
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+static struct net_pkt_pool_stats rx_stats;
+static struct net_pkt_pool_stats tx_stats;
+
+/* Reservations attached to a context or an interface */
+static sys_slist_t reserve_list;
+static K_MUTEX_DEFINE(reserve_lock);
+
+static struct net_pkt_pool_stats *slab_stats(struct k_mem_slab *slab)
+{
+	if (slab == &tx_pkts) {
+		return &tx_stats;
+	} else if (slab == &rx_pkts) {
+		return &rx_stats;
+	}
+
+	return NULL;
+}
+
+static struct net_pkt_pool_stats *pool_stats(struct net_buf_pool *pool)
+{
+	if (pool == &tx_bufs) {
+		return &tx_stats;
+	} else if (pool == &rx_bufs) {
+		return &rx_stats;
+	}
+
+	return NULL;
+}
+
+/* A reservation slab serves both directions, so the direction the
+ * packet was allocated for is what decides which owner it belongs to:
+ * the interface reservation on RX, the context reservation on TX.
+ */
+static inline bool pkt_is_rx(struct net_pkt *pkt)
+{
+	return pkt->slab == &rx_pkts || pkt->reserve_rx;
+}
+
+/* Find the reservation covering the packet, and the global data pool
+ * it borrows from.
+ */
+static struct net_pkt_reserve *pkt_get_reserve(struct net_pkt *pkt,
+					       struct net_buf_pool **pool)
+{
+	struct net_pkt_reserve *reserve = NULL;
+
+	if (pkt_is_rx(pkt)) {
+		if (net_pkt_iface(pkt)) {
+			reserve = net_pkt_iface(pkt)->pkt_reserve;
+		}
+
+		if (reserve && (pkt->slab == reserve->slab ||
+				pkt->slab == &rx_pkts)) {
+			*pool = &rx_bufs;
+			return reserve;
+		}
+
+		return NULL;
+	}
+
+	if (pkt->context) {
+		reserve = pkt->context->pkt_reserve;
+	}
+
+	if (reserve && (pkt->slab == reserve->slab ||
+			pkt->slab == &tx_pkts)) {
+		*pool = &tx_bufs;
+		return reserve;
+	}
+
+	return NULL;
+}
+
+/* Take the packet from the reservation first, and borrow it from the
+ * global slab once the reservation is exhausted.
+ */
+static int pkt_slab_alloc(struct net_pkt_reserve *reserve,
+			  struct k_mem_slab **slab, struct net_pkt **pkt,
+			  k_timeout_t timeout)
+{
+	struct net_pkt_pool_stats *stats = slab_stats(*slab);
+	int ret;
+
+	if (reserve) {
+		ret = k_mem_slab_alloc(reserve->slab, (void **)pkt, K_NO_WAIT);
+		if (!ret) {
+			atomic_inc(&reserve->stats.pkt_alloc);
+			*slab = reserve->slab;
+			return 0;
+		}
+	}
+
+	ret = k_mem_slab_alloc(*slab, (void **)pkt, timeout);
+	if (!ret) {
+		if (reserve) {
+			atomic_inc(&reserve->stats.pkt_borrow);
+		}
+
+		if (stats) {
+			atomic_inc(&stats->pkt_alloc);
+		}
+	} else {
+		if (reserve) {
+			atomic_inc(&reserve->stats.pkt_fail);
+		}
+
+		if (stats) {
+			atomic_inc(&stats->pkt_fail);
+		}
+	}
+
+	return ret;
+}
+
+void net_pkt_get_pool_stats(struct net_pkt_pool_stats **rx,
+			    struct net_pkt_pool_stats **tx)
+{
+	if (rx) {
+		*rx = &rx_stats;
+	}
+
+	if (tx) {
+		*tx = &tx_stats;
+	}
+}
+
+static void reserve_register(struct net_pkt_reserve *reserve)
+{
+	struct net_pkt_reserve *tmp;
+
+	if (!reserve) {
+		return;
+	}
+
+	k_mutex_lock(&reserve_lock, K_FOREVER);
+
+	/* A reservation can be shared, keep it on the list only once */
+	SYS_SLIST_FOR_EACH_CONTAINER(&reserve_list, tmp, node) {
+		if (tmp == reserve) {
+			goto out;
+		}
+	}
+
+	sys_slist_append(&reserve_list, &reserve->node);
+
+out:
+	k_mutex_unlock(&reserve_lock);
+}
+
+void net_pkt_reserve_attach_context(struct net_context *context,
+				    struct net_pkt_reserve *reserve)
+{
+	NET_ASSERT(context);
+
+	reserve_register(reserve);
+	context->pkt_reserve = reserve;
+}
+
+void net_pkt_reserve_attach_iface(struct net_if *iface,
+				  struct net_pkt_reserve *reserve)
+{
+	NET_ASSERT(iface);
+
+	reserve_register(reserve);
+	iface->pkt_reserve = reserve;
+}
+
+void net_pkt_reserve_foreach(net_pkt_reserve_cb_t cb, void *user_data)
+{
+	struct net_pkt_reserve *reserve;
+
+	k_mutex_lock(&reserve_lock, K_FOREVER);
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&reserve_list, reserve, node) {
+		cb(reserve, user_data);
+	}
+
+	k_mutex_unlock(&reserve_lock);
+}
+#else
+#define pkt_is_rx(pkt) ((pkt)->slab == &rx_pkts)
+#define pkt_slab_alloc(reserve, slab, pkt, timeout)			\
+	k_mem_slab_alloc(*(slab), (void **)(pkt), timeout)
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 /* Allocation tracking is only available if separately enabled */
 #if defined(CONFIG_NET_DEBUG_NET_PKT_ALLOC)
 struct net_pkt_alloc {
@@ -426,7 +612,7 @@ struct net_buf *net_pkt_get_frag(struct net_pkt *pkt,
 	}
 #endif /* CONFIG_NET_CONTEXT_NET_PKT_POOL */
 
-	if (pkt->slab == &rx_pkts) {
+	if (pkt_is_rx(pkt)) {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 		return net_pkt_get_reserve_rx_data_debug(timeout,
 							 caller, line);
@@ -846,14 +1032,81 @@ void net_pkt_print(void)
 
 /* New allocator and API starts here */
 
+static inline struct net_buf *pkt_pool_alloc(struct net_buf_pool *pool,
+					     size_t size, k_timeout_t timeout)
+{
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+	ARG_UNUSED(size);
+
+	return net_buf_alloc_fixed(pool, timeout);
+#else
+	return net_buf_alloc_len(pool, size, timeout);
+#endif
+}
+
+#if defined(CONFIG_NET_PKT_RESERVE)
+/* Take the buffer from the reservation first, and borrow it from the
+ * global pool once the reservation is exhausted.
+ */
+static struct net_buf *pkt_buf_alloc(struct net_pkt_reserve *reserve,
+				     struct net_buf_pool *pool,
+				     size_t size, k_timeout_t timeout)
+{
+	struct net_pkt_pool_stats *stats = pool_stats(pool);
+	struct net_buf *buf;
+
+	if (reserve) {
+		buf = pkt_pool_alloc(reserve->pool, size, K_NO_WAIT);
+		if (buf) {
+			/* Reserved buffers have a fixed size, with variable
+			 * size buffers the data has to fit in one of them.
+			 */
+			if (IS_ENABLED(CONFIG_NET_BUF_FIXED_DATA_SIZE) ||
+			    buf->size >= size) {
+				atomic_inc(&reserve->stats.buf_alloc);
+				return buf;
+			}
+
+			net_buf_unref(buf);
+		}
+	}
+
+	buf = pkt_pool_alloc(pool, size, timeout);
+	if (buf) {
+		if (reserve) {
+			atomic_inc(&reserve->stats.buf_borrow);
+		}
+
+		if (stats) {
+			atomic_inc(&stats->buf_alloc);
+		}
+	} else {
+		if (reserve) {
+			atomic_inc(&reserve->stats.buf_fail);
+		}
+
+		if (stats) {
+			atomic_inc(&stats->buf_fail);
+		}
+	}
+
+	return buf;
+}
+#else
+#define pkt_buf_alloc(reserve, pool, size, timeout)			\
+	pkt_pool_alloc(pool, size, timeout)
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 #if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
 
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
+					struct net_pkt_reserve *reserve,
 					size_t size, k_timeout_t timeout,
 					const char *caller, int line)
 #else
 static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
+					struct net_pkt_reserve *reserve,
 					size_t size, k_timeout_t timeout)
 #endif
 {
@@ -864,7 +1117,7 @@ static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
 	while (size) {
 		struct net_buf *new;
 
-		new = net_buf_alloc_fixed(pool, timeout);
+		new = pkt_buf_alloc(reserve, pool, size, timeout);
 		if (!new) {
 			goto error;
 		}
@@ -917,16 +1170,18 @@ error:
 
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
 static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
+					struct net_pkt_reserve *reserve,
 					size_t size, k_timeout_t timeout,
 					const char *caller, int line)
 #else
 static struct net_buf *pkt_alloc_buffer(struct net_buf_pool *pool,
+					struct net_pkt_reserve *reserve,
 					size_t size, k_timeout_t timeout)
 #endif
 {
 	struct net_buf *buf;
 
-	buf = net_buf_alloc_len(pool, size, timeout);
+	buf = pkt_buf_alloc(reserve, pool, size, timeout);
 
 #if CONFIG_NET_PKT_LOG_LEVEL >= LOG_LEVEL_DBG
 	NET_FRAG_CHECK_IF_NOT_IN_USE(buf, buf->ref + 1);
@@ -1104,6 +1359,7 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 #endif
 {
 	uint64_t end = z_timeout_end_calc(timeout);
+	struct net_pkt_reserve *reserve = NULL;
 	struct net_buf_pool *pool = NULL;
 	size_t alloc_len = 0;
 	size_t hdr_len = 0;
@@ -1138,6 +1394,12 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 		pool = get_data_pool(pkt->context);
 	}
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+	if (!pool) {
+		reserve = pkt_get_reserve(pkt, &pool);
+	}
+#endif
+
 	if (!pool) {
 		pool = pkt->slab == &tx_pkts ? &tx_bufs : &rx_bufs;
 	}
@@ -1154,9 +1416,10 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 	}
 
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	buf = pkt_alloc_buffer(pool, alloc_len, timeout, caller, line);
+	buf = pkt_alloc_buffer(pool, reserve, alloc_len, timeout,
+			       caller, line);
 #else
-	buf = pkt_alloc_buffer(pool, alloc_len, timeout);
+	buf = pkt_alloc_buffer(pool, reserve, alloc_len, timeout);
 #endif
 
 	if (!buf) {
@@ -1175,12 +1438,17 @@ int net_pkt_alloc_buffer(struct net_pkt *pkt,
 }
 
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, k_timeout_t timeout,
+static struct net_pkt *pkt_alloc(struct k_mem_slab *slab,
+				 struct net_pkt_reserve *reserve,
+				 k_timeout_t timeout,
 				 const char *caller, int line)
 #else
-static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, k_timeout_t timeout)
+static struct net_pkt *pkt_alloc(struct k_mem_slab *slab,
+				 struct net_pkt_reserve *reserve,
+				 k_timeout_t timeout)
 #endif
 {
+	struct k_mem_slab *pkt_slab = slab;
 	struct net_pkt *pkt;
 	int ret;
 
@@ -1188,7 +1456,7 @@ static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, k_timeout_t timeout)
 		timeout = K_NO_WAIT;
 	}
 
-	ret = k_mem_slab_alloc(slab, (void **)&pkt, timeout);
+	ret = pkt_slab_alloc(reserve, &pkt_slab, &pkt, timeout);
 	if (ret) {
 		return NULL;
 	}
@@ -1196,7 +1464,12 @@ static struct net_pkt *pkt_alloc(struct k_mem_slab *slab, k_timeout_t timeout)
 	memset(pkt, 0, sizeof(struct net_pkt));
 
 	pkt->atomic_ref = ATOMIC_INIT(1);
-	pkt->slab = slab;
+	pkt->slab = pkt_slab;
+
+#if defined(CONFIG_NET_PKT_RESERVE)
+	/* Remember the direction, pkt_slab may be a shared reservation */
+	pkt->reserve_rx = (slab == &rx_pkts);
+#endif
 
 	if (IS_ENABLED(CONFIG_NET_IPV6)) {
 		net_pkt_set_ipv6_next_hdr(pkt, 255);
@@ -1242,9 +1515,9 @@ struct net_pkt *net_pkt_alloc(k_timeout_t timeout)
 #endif
 {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	return pkt_alloc(&tx_pkts, timeout, caller, line);
+	return pkt_alloc(&tx_pkts, NULL, timeout, caller, line);
 #else
-	return pkt_alloc(&tx_pkts, timeout);
+	return pkt_alloc(&tx_pkts, NULL, timeout);
 #endif
 }
 
@@ -1262,9 +1535,30 @@ struct net_pkt *net_pkt_alloc_from_slab(struct k_mem_slab *slab,
 	}
 
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	return pkt_alloc(slab, timeout, caller, line);
+	return pkt_alloc(slab, NULL, timeout, caller, line);
+#else
+	return pkt_alloc(slab, NULL, timeout);
+#endif
+}
+
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+struct net_pkt *net_pkt_alloc_from_reserve_debug(
+					struct net_pkt_reserve *reserve,
+					k_timeout_t timeout,
+					const char *caller, int line)
+#else
+struct net_pkt *net_pkt_alloc_from_reserve(struct net_pkt_reserve *reserve,
+					   k_timeout_t timeout)
+#endif
+{
+	if (!reserve) {
+		return NULL;
+	}
+
+#if NET_LOG_LEVEL >= LOG_LEVEL_DBG
+	return pkt_alloc(&tx_pkts, reserve, timeout, caller, line);
 #else
-	return pkt_alloc(slab, timeout);
+	return pkt_alloc(&tx_pkts, reserve, timeout);
 #endif
 }
 
@@ -1276,9 +1570,9 @@ struct net_pkt *net_pkt_rx_alloc(k_timeout_t timeout)
 #endif
 {
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	return pkt_alloc(&rx_pkts, timeout, caller, line);
+	return pkt_alloc(&rx_pkts, NULL, timeout, caller, line);
 #else
-	return pkt_alloc(&rx_pkts, timeout);
+	return pkt_alloc(&rx_pkts, NULL, timeout);
 #endif
 }
 
@@ -1294,12 +1588,19 @@ static struct net_pkt *pkt_alloc_on_iface(struct k_mem_slab *slab,
 
 #endif
 {
+	struct net_pkt_reserve *reserve = NULL;
 	struct net_pkt *pkt;
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+	if (iface && slab == &rx_pkts) {
+		reserve = iface->pkt_reserve;
+	}
+#endif
+
 #if NET_LOG_LEVEL >= LOG_LEVEL_DBG
-	pkt = pkt_alloc(slab, timeout, caller, line);
+	pkt = pkt_alloc(slab, reserve, timeout, caller, line);
 #else
-	pkt = pkt_alloc(slab, timeout);
+	pkt = pkt_alloc(slab, reserve, timeout);
 #endif
 
 	if (pkt) {
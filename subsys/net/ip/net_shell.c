@@ -969,6 +969,18 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	}
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_DNS)
+	if (!iface) {
+		net_stats_t total = GET_STAT(iface, dns.cache_hit) +
+				    GET_STAT(iface, dns.cache_miss);
+
+		PR("DNS cache hit  %d\tmiss\t%d\thit rate %d%%\n",
+		   GET_STAT(iface, dns.cache_hit),
+		   GET_STAT(iface, dns.cache_miss),
+		   total ? GET_STAT(iface, dns.cache_hit) * 100U / total : 0);
+	}
+#endif
+
 	PR("Bytes received %u\n", GET_STAT(iface, bytes.received));
 	PR("Bytes sent     %u\n", GET_STAT(iface, bytes.sent));
 	PR("Processing err %d\n", GET_STAT(iface, processing_error));
@@ -1641,6 +1653,72 @@ static int cmd_net_dns_cancel(const struct shell *shell, size_t argc,
 	return 0;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+static void dns_cache_cb(const char *name, enum dns_query_type type,
+			 enum dns_resolve_status status,
+			 const struct dns_addrinfo *addrs, int count,
+			 uint32_t ttl, void *user_data)
+{
+	struct net_shell_user_data *data = user_data;
+	const struct shell *shell = data->shell;
+	int i;
+
+	PR("%s %s ttl %u s%s\n", name,
+	   type == DNS_QUERY_TYPE_AAAA ? "AAAA" : "A", ttl,
+	   status == DNS_EAI_NODATA ? " (no address)" : "");
+
+	for (i = 0; i < count; i++) {
+		if (addrs[i].ai_family == AF_INET) {
+			PR("	%s\n", net_sprint_ipv4_addr(
+				   &net_sin(&addrs[i].ai_addr)->sin_addr));
+		} else if (addrs[i].ai_family == AF_INET6) {
+			PR("	%s\n", net_sprint_ipv6_addr(
+				   &net_sin6(&addrs[i].ai_addr)->sin6_addr));
+		}
+	}
+}
+#endif
+
+static int cmd_net_dns_cache(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct net_shell_user_data user_data;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	user_data.shell = shell;
+
+	if (!dns_cache_foreach(dns_cache_cb, &user_data)) {
+		PR("DNS cache is empty.\n");
+	}
+#else
+	PR_INFO("Set %s to enable %s support.\n", "CONFIG_DNS_RESOLVER_CACHE",
+		"DNS cache");
+#endif
+
+	return 0;
+}
+
+static int cmd_net_dns_flush(const struct shell *shell, size_t argc,
+			     char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	PR("Removed %d DNS cache entries.\n", dns_cache_flush());
+#else
+	PR_INFO("Set %s to enable %s support.\n", "CONFIG_DNS_RESOLVER_CACHE",
+		"DNS cache");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns_query(const struct shell *shell, size_t argc,
 			     char *argv[])
 {
@@ -2658,6 +2736,27 @@ static void context_info(struct net_context *context, void *user_data)
 }
 #endif /* CONFIG_NET_OFFLOAD || CONFIG_NET_NATIVE */
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+static void pool_stats_print(const struct shell *shell, const char *name,
+			     struct net_pkt_pool_stats *stats)
+{
+	PR("%-16s%u\t%u\t%u\t%u\t%u\t%u\n", name,
+	   (uint32_t)atomic_get(&stats->pkt_alloc),
+	   (uint32_t)atomic_get(&stats->pkt_borrow),
+	   (uint32_t)atomic_get(&stats->pkt_fail),
+	   (uint32_t)atomic_get(&stats->buf_alloc),
+	   (uint32_t)atomic_get(&stats->buf_borrow),
+	   (uint32_t)atomic_get(&stats->buf_fail));
+}
+
+static void reserve_info(struct net_pkt_reserve *reserve, void *user_data)
+{
+	const struct shell *shell = user_data;
+
+	pool_stats_print(shell, reserve->name, &reserve->stats);
+}
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 {
 	ARG_UNUSED(argc);
@@ -2666,6 +2765,9 @@ static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 #if defined(CONFIG_NET_OFFLOAD) || defined(CONFIG_NET_NATIVE)
 	struct k_mem_slab *rx, *tx;
 	struct net_buf_pool *rx_data, *tx_data;
+#if defined(CONFIG_NET_PKT_RESERVE)
+	struct net_pkt_pool_stats *rx_stats, *tx_stats;
+#endif
 
 	net_pkt_get_info(&rx, &tx, &rx_data, &tx_data);
 
@@ -2715,6 +2817,17 @@ static int cmd_net_mem(const struct shell *shell, size_t argc, char *argv[])
 			PR("No external memory pools found.\n");
 		}
 	}
+
+#if defined(CONFIG_NET_PKT_RESERVE)
+	net_pkt_get_pool_stats(&rx_stats, &tx_stats);
+
+	PR("\nPool allocations (pkt alloc/borrow/fail, "
+	   "buf alloc/borrow/fail):\n");
+	pool_stats_print(shell, "RX", rx_stats);
+	pool_stats_print(shell, "TX", tx_stats);
+
+	net_pkt_reserve_foreach(reserve_info, (void *)shell);
+#endif /* CONFIG_NET_PKT_RESERVE */
 #else
 	PR_INFO("Set %s to enable %s support.\n",
 		"CONFIG_NET_OFFLOAD or CONFIG_NET_NATIVE", "memory usage");
@@ -4276,8 +4389,12 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_arp,
 );
 
 SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
+	SHELL_CMD(cache, NULL, "Show the cached DNS answers.",
+		  cmd_net_dns_cache),
 	SHELL_CMD(cancel, NULL, "Cancel all pending requests.",
 		  cmd_net_dns_cancel),
+	SHELL_CMD(flush, NULL, "Remove all the cached DNS answers.",
+		  cmd_net_dns_flush),
 	SHELL_CMD(query, NULL,
 		  "'net dns <hostname> [A or AAAA]' queries IPv4 address "
 		  "(default) or IPv6 address for a host name.",
@@ -29,6 +29,98 @@ LOG_MODULE_REGISTER(net_stats, NET_LOG_LEVEL);
  */
 struct net_stats net_stats = { 0 };
 
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+struct net_stats_cpu net_stats_cpu[CONFIG_MP_NUM_CPUS]
+	__aligned(STATS_CPU_ALIGN);
+
+static void stats_add(net_stats_t *dst, const net_stats_t *src, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i] += src[i];
+	}
+}
+
+#define ADD_STATS(_dst, _src, _s)				\
+	stats_add((net_stats_t *)&(_dst)->_s,			\
+		  (const net_stats_t *)&(_src)->_s,		\
+		  sizeof((_dst)->_s) / sizeof(net_stats_t))
+
+/* Sums the copies of the counters updated by each CPU. Copies that are
+ * being updated are read as they are, the sum is not a consistent
+ * snapshot across counters.
+ */
+void net_stats_collect(struct net_if *iface, struct net_stats *stats)
+{
+	const struct net_stats_cpu *cpu = GET_STAT_CPU(iface);
+
+#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
+	*stats = iface ? iface->stats : net_stats;
+#else
+	*stats = net_stats;
+#endif
+
+	for (int i = 0; i < CONFIG_MP_NUM_CPUS; i++) {
+		const struct net_stats *src = &cpu[i].stats;
+
+		ADD_STATS(stats, src, processing_error);
+		ADD_STATS(stats, src, bytes);
+		ADD_STATS(stats, src, ip_errors);
+#if defined(CONFIG_NET_STATISTICS_IPV6)
+		ADD_STATS(stats, src, ipv6);
+#endif
+#if defined(CONFIG_NET_STATISTICS_IPV4)
+		ADD_STATS(stats, src, ipv4);
+#endif
+#if defined(CONFIG_NET_STATISTICS_ICMP)
+		ADD_STATS(stats, src, icmp);
+#endif
+#if defined(CONFIG_NET_STATISTICS_TCP)
+		ADD_STATS(stats, src, tcp);
+#endif
+#if defined(CONFIG_NET_STATISTICS_UDP)
+		ADD_STATS(stats, src, udp);
+#endif
+#if defined(CONFIG_NET_STATISTICS_IPV6_ND)
+		ADD_STATS(stats, src, ipv6_nd);
+#endif
+#if defined(CONFIG_NET_STATISTICS_MLD)
+		ADD_STATS(stats, src, ipv6_mld);
+#endif
+#if defined(CONFIG_NET_STATISTICS_DNS)
+		ADD_STATS(stats, src, dns);
+#endif
+#if NET_TC_COUNT > 1
+		for (int tc = 0; tc < NET_TC_TX_COUNT; tc++) {
+			stats->tc.sent[tc].tx_time.sum +=
+				src->tc.sent[tc].tx_time.sum;
+			stats->tc.sent[tc].tx_time.count +=
+				src->tc.sent[tc].tx_time.count;
+			stats->tc.sent[tc].pkts += src->tc.sent[tc].pkts;
+			stats->tc.sent[tc].bytes += src->tc.sent[tc].bytes;
+		}
+
+		for (int tc = 0; tc < NET_TC_RX_COUNT; tc++) {
+			stats->tc.recv[tc].rx_time.sum +=
+				src->tc.recv[tc].rx_time.sum;
+			stats->tc.recv[tc].rx_time.count +=
+				src->tc.recv[tc].rx_time.count;
+			stats->tc.recv[tc].pkts += src->tc.recv[tc].pkts;
+			stats->tc.recv[tc].bytes += src->tc.recv[tc].bytes;
+		}
+#endif
+#if defined(CONFIG_NET_CONTEXT_TIMESTAMP) || \
+	defined(CONFIG_NET_PKT_TXTIME_STATS)
+		stats->tx_time.sum += src->tx_time.sum;
+		stats->tx_time.count += src->tx_time.count;
+#endif
+#if defined(CONFIG_NET_PKT_RXTIME_STATS)
+		stats->rx_time.sum += src->rx_time.sum;
+		stats->rx_time.count += src->rx_time.count;
+#endif
+	}
+}
+#endif /* CONFIG_NET_STATISTICS_PER_CPU */
+
 #if defined(CONFIG_NET_STATISTICS_PERIODIC_OUTPUT)
 
 #define PRINT_STATISTICS_INTERVAL (30 * MSEC_PER_SEC)
@@ -234,20 +326,26 @@ void net_print_statistics(void)
 
 #if defined(CONFIG_NET_STATISTICS_USER_API)
 
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+static K_MUTEX_DEFINE(collected_lock);
+static struct net_stats collected;
+#endif
+
 static int net_stats_get(uint32_t mgmt_request, struct net_if *iface,
 			 void *data, size_t len)
 {
+#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
+	struct net_stats *base = iface ? &iface->stats : &net_stats;
+#else
+	struct net_stats *base = &net_stats;
+#endif
 	size_t len_chk = 0;
 	void *src = NULL;
 
 	switch (NET_MGMT_GET_COMMAND(mgmt_request)) {
 	case NET_REQUEST_STATS_CMD_GET_ALL:
 		len_chk = sizeof(struct net_stats);
-#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
-		src = iface ? &iface->stats : &net_stats;
-#else
-		src = &net_stats;
-#endif
+		src = base;
 		break;
 	case NET_REQUEST_STATS_CMD_GET_PROCESSING_ERROR:
 		len_chk = sizeof(net_stats_t);
@@ -309,7 +407,18 @@ static int net_stats_get(uint32_t mgmt_request, struct net_if *iface,
 		return -EINVAL;
 	}
 
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+	/* Copy the same field out of the sum of the CPU copies */
+	k_mutex_lock(&collected_lock, K_FOREVER);
+
+	net_stats_collect(iface, &collected);
+	memcpy(data, (uint8_t *)&collected +
+	       ((uint8_t *)src - (uint8_t *)base), len);
+
+	k_mutex_unlock(&collected_lock);
+#else
 	memcpy(data, src, len);
+#endif
 
 	return 0;
 }
@@ -372,4 +481,7 @@ void net_stats_reset(struct net_if *iface)
 
 	net_if_stats_reset_all();
 	memset(&net_stats, 0, sizeof(net_stats));
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+	memset(net_stats_cpu, 0, sizeof(net_stats_cpu));
+#endif
 }
@@ -19,18 +19,61 @@ extern struct net_stats net_stats;
 
 #if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
 #define SET_STAT(cmd) (cmd)
-#define GET_STAT(iface, s) (iface ? iface->stats.s : net_stats.s)
 #define GET_STAT_ADDR(iface, s) (iface ? &iface->stats.s : &net_stats.s)
 #else
 #define SET_STAT(cmd)
-#define GET_STAT(iface, s) (net_stats.s)
-#define GET_STAT_ADDR(iface, s) (&GET_STAT(iface, s))
+#define GET_STAT_ADDR(iface, s) (&net_stats.s)
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_PER_CPU)
+extern struct net_stats_cpu net_stats_cpu[CONFIG_MP_NUM_CPUS];
+
+#if defined(CONFIG_NET_STATISTICS_PER_INTERFACE)
+#define GET_STAT_CPU(iface) (iface ? iface->stats_cpu : net_stats_cpu)
+#else
+#define GET_STAT_CPU(iface) (net_stats_cpu)
+#endif
+
+/* The counters are updated in the copy of the current CPU, while the
+ * values that are set rather than counted stay in the shared statistics.
+ */
+#define GET_STAT(iface, s)						\
+	({								\
+		const struct net_stats_cpu *cpu__ = GET_STAT_CPU(iface); \
+		__typeof__(net_stats.s) sum__ = *GET_STAT_ADDR(iface, s); \
+									\
+		for (int i__ = 0; i__ < CONFIG_MP_NUM_CPUS; i__++) {	\
+			sum__ += cpu__[i__].stats.s;			\
+		}							\
+		sum__;							\
+	})
+
+#define UPDATE_STAT_GLOBAL(cmd)						\
+	{ unsigned int key__ = arch_irq_lock();				\
+	  (net_stats_cpu[stats_cpu_id()].cmd);				\
+	  arch_irq_unlock(key__); }
+#define UPDATE_STAT(_iface, _cmd)					\
+	{ unsigned int key__;						\
+	  NET_ASSERT(_iface);						\
+	  key__ = arch_irq_lock();					\
+	  (net_stats_cpu[stats_cpu_id()]._cmd);				\
+	  SET_STAT(_iface->stats_cpu[stats_cpu_id()]._cmd);		\
+	  arch_irq_unlock(key__); }
+
+void net_stats_collect(struct net_if *iface, struct net_stats *stats);
+#else
+#define GET_STAT(iface, s) (*GET_STAT_ADDR(iface, s))
+
 #define UPDATE_STAT_GLOBAL(cmd) (net_##cmd)
 #define UPDATE_STAT(_iface, _cmd) \
 	{ NET_ASSERT(_iface); (UPDATE_STAT_GLOBAL(_cmd)); \
 	  SET_STAT(_iface->_cmd); }
+#endif /* CONFIG_NET_STATISTICS_PER_CPU */
+
+/* For the values that are set rather than counted */
+#define UPDATE_STAT_SHARED(_iface, _cmd) \
+	{ NET_ASSERT(_iface); (net_##_cmd); \
+	  SET_STAT(_iface->_cmd); }
 /* Core stats */
 
 static inline void net_stats_update_processing_error(struct net_if *iface)
@@ -318,6 +361,22 @@ static inline void net_stats_update_ipv6_mld_drop(struct net_if *iface)
 #define net_stats_update_ipv6_mld_drop(iface)
 #endif /* CONFIG_NET_STATISTICS_MLD */
 
+#if defined(CONFIG_NET_STATISTICS_DNS) && defined(CONFIG_NET_NATIVE)
+/* The DNS cache is not tied to any network interface */
+static inline void net_stats_update_dns_cache_hit(void)
+{
+	UPDATE_STAT_GLOBAL(stats.dns.cache_hit++);
+}
+
+static inline void net_stats_update_dns_cache_miss(void)
+{
+	UPDATE_STAT_GLOBAL(stats.dns.cache_miss++);
+}
+#else
+#define net_stats_update_dns_cache_hit()
+#define net_stats_update_dns_cache_miss()
+#endif /* CONFIG_NET_STATISTICS_DNS */
+
 #if (defined(CONFIG_NET_CONTEXT_TIMESTAMP) || \
 	defined(CONFIG_NET_PKT_TXTIME_STATS)) && defined(CONFIG_NET_STATISTICS)
 static inline void net_stats_update_tx_time(struct net_if *iface,
@@ -365,7 +424,7 @@ static inline void net_stats_update_tc_sent_bytes(struct net_if *iface,
 static inline void net_stats_update_tc_sent_priority(struct net_if *iface,
 						     uint8_t tc, uint8_t priority)
 {
-	UPDATE_STAT(iface, stats.tc.sent[tc].priority = priority);
+	UPDATE_STAT_SHARED(iface, stats.tc.sent[tc].priority = priority);
 }
 
 #if (defined(CONFIG_NET_CONTEXT_TIMESTAMP) || \
@@ -423,7 +482,7 @@ static inline void net_stats_update_tc_recv_bytes(struct net_if *iface,
 static inline void net_stats_update_tc_recv_priority(struct net_if *iface,
 						     uint8_t tc, uint8_t priority)
 {
-	UPDATE_STAT(iface, stats.tc.recv[tc].priority = priority);
+	UPDATE_STAT_SHARED(iface, stats.tc.recv[tc].priority = priority);
 }
 #else
 #define net_stats_update_tc_sent_pkt(iface, tc)
@@ -470,7 +529,7 @@ static inline void net_stats_update_tc_rx_time(struct net_if *iface,
 static inline void net_stats_add_suspend_start_time(struct net_if *iface,
 						    uint32_t time)
 {
-	UPDATE_STAT(iface, stats.pm.start_time = time);
+	UPDATE_STAT_SHARED(iface, stats.pm.start_time = time);
 }
 
 static inline void net_stats_add_suspend_end_time(struct net_if *iface,
@@ -479,10 +538,10 @@ static inline void net_stats_add_suspend_end_time(struct net_if *iface,
 	uint32_t diff_time =
 		k_cyc_to_ms_floor32(time - GET_STAT(iface, pm.start_time));
 
-	UPDATE_STAT(iface, stats.pm.start_time = 0);
-	UPDATE_STAT(iface, stats.pm.last_suspend_time = diff_time);
-	UPDATE_STAT(iface, stats.pm.suspend_count++);
-	UPDATE_STAT(iface, stats.pm.overall_suspend_time += diff_time);
+	UPDATE_STAT_SHARED(iface, stats.pm.start_time = 0);
+	UPDATE_STAT_SHARED(iface, stats.pm.last_suspend_time = diff_time);
+	UPDATE_STAT_SHARED(iface, stats.pm.suspend_count++);
+	UPDATE_STAT_SHARED(iface, stats.pm.overall_suspend_time += diff_time);
 }
 #else
 #define net_stats_add_suspend_start_time(iface, time)
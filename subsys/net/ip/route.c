@@ -33,10 +33,40 @@ LOG_MODULE_REGISTER(net_route, CONFIG_NET_ROUTE_LOG_LEVEL);
 #define NET_ROUTE_EXTRA_DATA_SIZE 0
 #endif
 
-/* We keep track of the routes in a separate list so that we can remove
- * the oldest routes (at tail) if needed.
+/* Routes are indexed by a path-compressed binary (Patricia) trie keyed
+ * on the route prefix. Every route adds at most one leaf and one branch
+ * node, so twice the number of routes is always enough nodes.
  */
-static sys_slist_t routes;
+#define ROUTE_TRIE_NODES (2 * CONFIG_NET_MAX_ROUTES)
+
+struct route_trie_node {
+	/** Free list linkage */
+	sys_snode_t node;
+
+	/** Sub-tries continuing with a 0 or 1 bit after the prefix */
+	atomic_ptr_t child[2];
+
+	/** Routes to exactly this prefix, NULL for a branch node */
+	atomic_ptr_t routes;
+
+	/** Prefix with the bits after prefix_len cleared */
+	struct in6_addr prefix;
+
+	/** Prefix length in bits */
+	uint8_t prefix_len;
+};
+
+static struct route_trie_node route_trie_nodes[ROUTE_TRIE_NODES];
+static sys_slist_t route_trie_free;
+static atomic_ptr_t route_trie_root;
+
+/* Lookups do not take any lock. Writers are serialized by the mutex and
+ * bump the sequence number whenever something is unlinked from the trie,
+ * so that a lookup that raced with a removal (and might have followed a
+ * recycled node) is restarted.
+ */
+static atomic_t route_trie_seq;
+static K_MUTEX_DEFINE(route_trie_lock);
 
 static void net_route_nexthop_remove(struct net_nbr *nbr)
 {
@@ -236,6 +266,255 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 	return 0;
 }
 
+static inline int prefix_bit(const struct in6_addr *addr, uint8_t bit)
+{
+	return (addr->s6_addr[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+static uint8_t prefix_common_len(const struct in6_addr *a,
+				 const struct in6_addr *b,
+				 uint8_t max_len)
+{
+	uint8_t len = 0U;
+	int i;
+
+	for (i = 0; i < sizeof(a->s6_addr) && len < max_len; i++) {
+		uint8_t diff = a->s6_addr[i] ^ b->s6_addr[i];
+
+		if (diff) {
+			len += __builtin_clz(diff) - 24;
+			break;
+		}
+
+		len += 8U;
+	}
+
+	return MIN(len, max_len);
+}
+
+static struct route_trie_node *route_trie_node_alloc(
+	const struct in6_addr *prefix, uint8_t prefix_len)
+{
+	struct route_trie_node *node;
+	sys_snode_t *snode;
+	int i;
+
+	snode = sys_slist_get(&route_trie_free);
+	if (!snode) {
+		return NULL;
+	}
+
+	node = CONTAINER_OF(snode, struct route_trie_node, node);
+
+	atomic_ptr_set(&node->child[0], NULL);
+	atomic_ptr_set(&node->child[1], NULL);
+	atomic_ptr_set(&node->routes, NULL);
+
+	for (i = 0; i < sizeof(node->prefix.s6_addr); i++) {
+		if (prefix_len >= (i + 1) * 8) {
+			node->prefix.s6_addr[i] = prefix->s6_addr[i];
+		} else if (prefix_len > i * 8) {
+			node->prefix.s6_addr[i] = prefix->s6_addr[i] &
+				(0xff << (8 - (prefix_len - i * 8)));
+		} else {
+			node->prefix.s6_addr[i] = 0U;
+		}
+	}
+
+	node->prefix_len = prefix_len;
+
+	return node;
+}
+
+static inline void route_trie_node_free(struct route_trie_node *node)
+{
+	/* Recycle the node as late as possible so that concurrent lookups
+	 * rarely need to restart.
+	 */
+	sys_slist_append(&route_trie_free, &node->node);
+}
+
+static int route_trie_insert(struct net_route_entry *route)
+{
+	atomic_ptr_t *link = &route_trie_root;
+	struct route_trie_node *node, *leaf, *branch;
+	uint8_t len = route->prefix_len;
+	uint8_t common = 0U;
+	int ret = 0;
+
+	k_mutex_lock(&route_trie_lock, K_FOREVER);
+
+	while ((node = atomic_ptr_get(link)) != NULL) {
+		common = prefix_common_len(&route->addr, &node->prefix,
+					   MIN(len, node->prefix_len));
+		if (common < node->prefix_len) {
+			break;
+		}
+
+		if (node->prefix_len == len) {
+			/* Same prefix via another interface */
+			route->trie_next = atomic_ptr_get(&node->routes);
+			atomic_ptr_set(&node->routes, route);
+			goto out;
+		}
+
+		link = &node->child[prefix_bit(&route->addr,
+					       node->prefix_len)];
+	}
+
+	leaf = route_trie_node_alloc(&route->addr, len);
+	if (!leaf) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	route->trie_next = NULL;
+	atomic_ptr_set(&leaf->routes, route);
+
+	if (node && common == len) {
+		/* The new prefix covers the existing sub-trie */
+		atomic_ptr_set(&leaf->child[prefix_bit(&node->prefix, len)],
+			       node);
+	} else if (node) {
+		/* The prefixes diverge at bit common */
+		branch = route_trie_node_alloc(&route->addr, common);
+		if (!branch) {
+			route_trie_node_free(leaf);
+			ret = -ENOMEM;
+			goto out;
+		}
+
+		atomic_ptr_set(&branch->child[prefix_bit(&node->prefix,
+							 common)], node);
+		atomic_ptr_set(&branch->child[prefix_bit(&route->addr,
+							 common)], leaf);
+		leaf = branch;
+	}
+
+	/* The new nodes are complete, publish them with a single store */
+	atomic_ptr_set(link, leaf);
+
+out:
+	k_mutex_unlock(&route_trie_lock);
+
+	return ret;
+}
+
+static void route_trie_remove(struct net_route_entry *route)
+{
+	atomic_ptr_t *link = &route_trie_root, *parent_link = NULL;
+	struct route_trie_node *node, *parent = NULL, *child;
+	struct net_route_entry *prev;
+
+	k_mutex_lock(&route_trie_lock, K_FOREVER);
+
+	while ((node = atomic_ptr_get(link)) != NULL &&
+	       node->prefix_len < route->prefix_len) {
+		parent_link = link;
+		parent = node;
+		link = &node->child[prefix_bit(&route->addr,
+					       node->prefix_len)];
+	}
+
+	if (!node || node->prefix_len != route->prefix_len) {
+		goto out;
+	}
+
+	prev = atomic_ptr_get(&node->routes);
+	if (prev == route) {
+		atomic_ptr_set(&node->routes, route->trie_next);
+	} else {
+		while (prev && prev->trie_next != route) {
+			prev = prev->trie_next;
+		}
+
+		if (!prev) {
+			goto out;
+		}
+
+		prev->trie_next = route->trie_next;
+	}
+
+	if (atomic_ptr_get(&node->routes)) {
+		goto unlinked;
+	}
+
+	/* A node with two children is still needed as a branch node */
+	child = atomic_ptr_get(&node->child[0]);
+	if (!child) {
+		child = atomic_ptr_get(&node->child[1]);
+	} else if (atomic_ptr_get(&node->child[1])) {
+		goto unlinked;
+	}
+
+	atomic_ptr_set(link, child);
+	route_trie_node_free(node);
+
+	/* If a leaf was removed, its parent branch node has only one child
+	 * left and can be replaced by it.
+	 */
+	if (!child && parent && !atomic_ptr_get(&parent->routes)) {
+		child = atomic_ptr_get(&parent->child[0]);
+		if (!child) {
+			child = atomic_ptr_get(&parent->child[1]);
+		}
+
+		atomic_ptr_set(parent_link, child);
+		route_trie_node_free(parent);
+	}
+
+unlinked:
+	atomic_inc(&route_trie_seq);
+
+out:
+	k_mutex_unlock(&route_trie_lock);
+}
+
+static struct net_route_entry *route_trie_lookup(struct net_if *iface,
+						 struct in6_addr *dst)
+{
+	struct net_route_entry *route, *found;
+	struct route_trie_node *node;
+	atomic_val_t seq;
+	int depth, i;
+
+	do {
+		seq = atomic_get(&route_trie_seq);
+		found = NULL;
+		node = atomic_ptr_get(&route_trie_root);
+
+		/* The bounds only matter if we raced with a removal, in
+		 * which case the result is discarded anyway.
+		 */
+		for (depth = 0; node && depth <= 128; depth++) {
+			if (prefix_common_len(dst, &node->prefix,
+					      node->prefix_len) <
+			    node->prefix_len) {
+				break;
+			}
+
+			route = atomic_ptr_get(&node->routes);
+
+			for (i = 0; route && i < CONFIG_NET_MAX_ROUTES; i++) {
+				if (!iface || route->iface == iface) {
+					found = route;
+					break;
+				}
+
+				route = route->trie_next;
+			}
+
+			if (node->prefix_len >= 128) {
+				break;
+			}
+
+			node = atomic_ptr_get(
+				&node->child[prefix_bit(dst, node->prefix_len)]);
+		}
+	} while (seq != atomic_get(&route_trie_seq));
+
+	return found;
+}
 
 #define net_route_info(str, route, dst)					\
 	do {								\
@@ -250,42 +529,41 @@ static int nbr_nexthop_put(struct net_nbr *nbr)
 			route->iface);					\
 	} } while (0)
 
-/* Route was accessed, so place it in front of the routes list */
+/* Route was accessed, so it is not a candidate for removal */
 static inline void update_route_access(struct net_route_entry *route)
 {
-	sys_slist_find_and_remove(&routes, &route->node);
-	sys_slist_prepend(&routes, &route->node);
+	route->last_used = k_uptime_get_32();
 }
 
-struct net_route_entry *net_route_lookup(struct net_if *iface,
-					 struct in6_addr *dst)
+static struct net_route_entry *get_oldest_route(void)
 {
-	struct net_route_entry *route, *found = NULL;
-	uint8_t longest_match = 0U;
+	struct net_route_entry *route, *oldest = NULL;
 	int i;
 
-	for (i = 0; i < CONFIG_NET_MAX_ROUTES && longest_match < 128; i++) {
+	for (i = 0; i < CONFIG_NET_MAX_ROUTES; i++) {
 		struct net_nbr *nbr = get_nbr(i);
 
 		if (!nbr->ref) {
 			continue;
 		}
 
-		if (iface && nbr->iface != iface) {
-			continue;
-		}
-
 		route = net_route_data(nbr);
 
-		if (route->prefix_len >= longest_match &&
-		    net_ipv6_is_prefix((uint8_t *)dst,
-				       (uint8_t *)&route->addr,
-				       route->prefix_len)) {
-			found = route;
-			longest_match = route->prefix_len;
+		if (!oldest ||
+		    (int32_t)(route->last_used - oldest->last_used) < 0) {
+			oldest = route;
 		}
 	}
 
+	return oldest;
+}
+
+struct net_route_entry *net_route_lookup(struct net_if *iface,
+					 struct in6_addr *dst)
+{
+	struct net_route_entry *found;
+
+	found = route_trie_lookup(iface, dst);
 	if (found) {
 		net_route_info("Found", found, dst);
 
@@ -352,14 +630,12 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 
 	nbr = nbr_new(iface, addr, prefix_len);
 	if (!nbr) {
-		/* Remove the oldest route and try again */
-		sys_snode_t *last = sys_slist_peek_tail(&routes);
-
-		sys_slist_find_and_remove(&routes, last);
-
-		route = CONTAINER_OF(last,
-				     struct net_route_entry,
-				     node);
+		/* Remove the least recently used route and try again */
+		route = get_oldest_route();
+		if (!route) {
+			NET_ERR("Neighbor route alloc failed!");
+			return NULL;
+		}
 
 		if (CONFIG_NET_ROUTE_LOG_LEVEL >= LOG_LEVEL_DBG) {
 			struct in6_addr *tmp;
@@ -401,7 +677,7 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	route = net_route_data(nbr);
 	route->iface = iface;
 
-	sys_slist_prepend(&routes, &route->node);
+	update_route_access(route);
 
 	tmp = nbr_nexthop_get(iface, nexthop);
 
@@ -412,6 +688,12 @@ struct net_route_entry *net_route_add(struct net_if *iface,
 	sys_slist_init(&route->nexthop);
 	sys_slist_prepend(&route->nexthop, &nexthop_route->node);
 
+	if (route_trie_insert(route) < 0) {
+		NET_ERR("Route trie node alloc failed!");
+		net_route_del(route);
+		return NULL;
+	}
+
 	net_route_info("Added", route, addr);
 
 #if defined(CONFIG_NET_MGMT_EVENT_INFO)
@@ -454,13 +736,13 @@ int net_route_del(struct net_route_entry *route)
 	net_mgmt_event_notify(NET_EVENT_IPV6_ROUTE_DEL, route->iface);
 #endif
 
-	sys_slist_find_and_remove(&routes, &route->node);
-
 	nbr = net_route_get_nbr(route);
 	if (!nbr) {
 		return -ENOENT;
 	}
 
+	route_trie_remove(route);
+
 	net_route_info("Deleted", route, &route->addr);
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&route->nexthop, nexthop_route, node) {
@@ -853,6 +1135,12 @@ int net_route_packet_if(struct net_pkt *pkt, struct net_if *iface)
 
 void net_route_init(void)
 {
+	int i;
+
+	for (i = 0; i < ROUTE_TRIE_NODES; i++) {
+		sys_slist_append(&route_trie_free, &route_trie_nodes[i].node);
+	}
+
 	NET_DBG("Allocated %d routing entries (%zu bytes)",
 		CONFIG_NET_MAX_ROUTES, sizeof(net_route_entries_pool));
 
@@ -41,12 +41,16 @@ struct net_route_nexthop {
  * @brief Route entry to a specific neighbor.
  */
 struct net_route_entry {
-	/** Node information. The routes are also in separate list in
-	 * order to keep track which one of them is the oldest so that
-	 * we can remove it if we run out of available routes.
-	 * The oldest one is the last entry in the list.
+	/** Next route to the same prefix (via another network interface)
+	 * in the route trie.
 	 */
-	sys_snode_t node;
+	struct net_route_entry *trie_next;
+
+	/** Uptime in milliseconds when the route was last used. This is
+	 * used to remove the least recently used route if we run out of
+	 * available routes.
+	 */
+	uint32_t last_used;
 
 	/** List of neighbors that the routes go through. */
 	sys_slist_t nexthop;
@@ -12,6 +12,7 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #include <stdlib.h>
 #include <zephyr.h>
 #include <random/rand32.h>
+#include <sys/byteorder.h>
 #include <net/net_pkt.h>
 #include <net/net_context.h>
 #include <net/udp.h>
@@ -22,9 +23,18 @@ LOG_MODULE_REGISTER(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
 #include "net_private.h"
 #include "tcp2_priv.h"
 
+/* Advertise a third of the receive buffers, the other connections and
+ * the stack need the rest.
+ */
+#if defined(CONFIG_NET_BUF_FIXED_DATA_SIZE)
+#define TCP_RECV_WINDOW (CONFIG_NET_BUF_RX_COUNT * CONFIG_NET_BUF_DATA_SIZE / 3)
+#else
+#define TCP_RECV_WINDOW (CONFIG_NET_BUF_DATA_POOL_SIZE / 3)
+#endif
+
 static int tcp_rto = CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT;
 static int tcp_retries = 3;
-static int tcp_window = NET_IPV6_MTU;
+static int tcp_window = MAX(TCP_RECV_WINDOW, NET_IPV6_MTU);
 
 static sys_slist_t tcp_conns = SYS_SLIST_STATIC_INIT(&tcp_conns);
 
@@ -279,6 +289,13 @@ static void tcp_send_queue_flush(struct tcp *conn)
 	}
 }
 
+static void tcp_ooo_flush(struct tcp *conn)
+{
+	while (conn->ooo_count) {
+		tcp_pkt_unref(conn->ooo[--conn->ooo_count].pkt);
+	}
+}
+
 static int tcp_conn_unref(struct tcp *conn)
 {
 	int key, ref_count = atomic_get(&conn->ref_count);
@@ -324,6 +341,8 @@ static int tcp_conn_unref(struct tcp *conn)
 	}
 	tcp_pkt_unref(conn->send_data);
 
+	tcp_ooo_flush(conn);
+
 	k_delayed_work_cancel(&conn->timewait_timer);
 
 	memset(conn, 0, sizeof(*conn));
@@ -471,11 +490,11 @@ static bool tcp_options_check(struct tcp_options *recv_options,
 	bool result = len > 0 && ((len % 4) == 0) ? true : false;
 	uint8_t *options = tcp_options_get(pkt, len);
 	uint8_t opt, opt_len;
+	int i;
 
 	NET_DBG("len=%zd", len);
 
-	recv_options->mss_found = false;
-	recv_options->wnd_found = false;
+	memset(recv_options, 0, sizeof(*recv_options));
 
 	for ( ; len >= 1; options += opt_len, len -= opt_len) {
 		opt = options[0];
@@ -519,8 +538,34 @@ static bool tcp_options_check(struct tcp_options *recv_options,
 				goto end;
 			}
 
-			recv_options->window = opt;
+			recv_options->window = MIN(options[2],
+						   TCP_WINDOW_SCALE_MAX);
 			recv_options->wnd_found = true;
+			NET_DBG("WSCALE=%hu", (uint16_t)recv_options->window);
+			break;
+		case TCPOPT_SACK_PERM:
+			if (opt_len != 2) {
+				result = false;
+				goto end;
+			}
+
+			recv_options->sack_perm_found = true;
+			break;
+		case TCPOPT_SACK:
+			if (((opt_len - 2) % 8) != 0 ||
+			    (opt_len - 2) / 8 > TCP_SACK_MAX_BLOCKS) {
+				result = false;
+				goto end;
+			}
+
+			recv_options->sack_count = (opt_len - 2) / 8;
+
+			for (i = 0; i < recv_options->sack_count; i++) {
+				recv_options->sack[i].left =
+					sys_get_be32(options + 2 + i * 8);
+				recv_options->sack[i].right =
+					sys_get_be32(options + 6 + i * 8);
+			}
 			break;
 		default:
 			continue;
@@ -534,10 +579,75 @@ end:
 	return result;
 }
 
-static size_t tcp_data_get(struct tcp *conn, struct net_pkt *pkt)
+/* Window scale and SACK-permitted are negotiated on the SYN exchange only,
+ * the SACK blocks are refreshed by every incoming segment.
+ */
+static void tcp_options_update(struct tcp *conn, struct tcphdr *th,
+			       struct tcp_options *options)
 {
-	ssize_t len = tcp_data_len(pkt);
+	if ((th->th_flags & SYN) &&
+	    (conn->state == TCP_LISTEN || conn->state == TCP_SYN_SENT)) {
+		conn->recv_options = *options;
+
+		conn->wscale_ok = IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+			options->wnd_found;
+		conn->send_wscale = conn->wscale_ok ? options->window : 0;
+		conn->sack_ok = IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+			options->sack_perm_found;
+
+		NET_DBG("conn: %p wscale=%hu/%hu sack=%hu", conn,
+			(uint16_t)conn->send_wscale,
+			(uint16_t)conn->recv_wscale, conn->sack_ok);
+		return;
+	}
+
+	conn->recv_options.sack_count = conn->sack_ok ?
+		options->sack_count : 0;
+	memcpy(conn->recv_options.sack, options->sack,
+	       sizeof(options->sack));
+}
 
+static uint32_t tcp_send_win_get(struct tcp *conn, struct tcphdr *th)
+{
+	uint32_t win = ntohs(th->th_win);
+
+	/* RFC 7323, 2.2: the window field of a SYN segment is never scaled */
+	if (conn->wscale_ok && !(th->th_flags & SYN)) {
+		win <<= conn->send_wscale;
+	}
+
+	return win;
+}
+
+static uint16_t tcp_recv_win_get(struct tcp *conn, uint8_t flags)
+{
+	uint32_t win = conn->recv_win;
+
+	if (conn->wscale_ok && !(flags & SYN)) {
+		win >>= conn->recv_wscale;
+	}
+
+	return MIN(win, UINT16_MAX);
+}
+
+static uint8_t tcp_wscale(void)
+{
+	uint8_t shift = 0;
+
+	while (shift < TCP_WINDOW_SCALE_MAX &&
+	       ((uint32_t)tcp_window >> shift) > UINT16_MAX) {
+		shift++;
+	}
+
+	return shift;
+}
+
+/* Deliver the last len bytes of the segment data, the bytes before them
+ * have already been delivered with an overlapping segment.
+ */
+static ssize_t tcp_data_tail_get(struct tcp *conn, struct net_pkt *pkt,
+				 ssize_t len)
+{
 	if (tcp_recv_cb) {
 		tcp_recv_cb(conn, pkt);
 		goto out;
@@ -567,6 +677,92 @@ static size_t tcp_data_get(struct tcp *conn, struct net_pkt *pkt)
 	return len;
 }
 
+static size_t tcp_data_get(struct tcp *conn, struct net_pkt *pkt)
+{
+	return tcp_data_tail_get(conn, pkt, tcp_data_len(pkt));
+}
+
+/* Hold a segment received above conn->ack, the held segments are
+ * kept sorted by their sequence number.
+ */
+static void tcp_ooo_add(struct tcp *conn, struct net_pkt *pkt, uint32_t seq,
+			size_t len)
+{
+	struct tcp_ooo_segment *seg;
+	int i;
+
+	for (i = 0; i < conn->ooo_count; i++) {
+		if (net_tcp_seq_greater(conn->ooo[i].seq, seq)) {
+			break;
+		}
+	}
+
+	conn->ooo_last = seq;
+
+	/* Overlaps are dropped, the peer will retransmit the data */
+	if (i > 0 && net_tcp_seq_greater(conn->ooo[i - 1].seq +
+					 conn->ooo[i - 1].len, seq)) {
+		conn->ooo_last = conn->ooo[i - 1].seq;
+		return;
+	}
+
+	if (i < conn->ooo_count &&
+	    net_tcp_seq_greater(seq + len, conn->ooo[i].seq)) {
+		return;
+	}
+
+	if (conn->ooo_count == TCP_OOO_MAX_SEGMENTS) {
+		NET_DBG("conn: %p out-of-order queue full", conn);
+		return;
+	}
+
+	pkt = tcp_pkt_clone(pkt);
+	if (!pkt) {
+		return;
+	}
+
+	memmove(&conn->ooo[i + 1], &conn->ooo[i],
+		(conn->ooo_count - i) * sizeof(conn->ooo[0]));
+
+	seg = &conn->ooo[i];
+	seg->pkt = pkt;
+	seg->seq = seq;
+	seg->len = len;
+
+	conn->ooo_count++;
+
+	NET_DBG("conn: %p held seq=%u len=%zu", conn, seq, len);
+}
+
+/* Deliver the held segments made contiguous by the advanced conn->ack.
+ * A segment overlapping conn->ack is trimmed, its new bytes have been
+ * SACKed already so the peer would not resend them before its RTO.
+ */
+static void tcp_ooo_deliver(struct tcp *conn)
+{
+	struct tcp_ooo_segment *seg = &conn->ooo[0];
+
+	while (conn->ooo_count && !net_tcp_seq_greater(seg->seq, conn->ack)) {
+		uint32_t end = seg->seq + seg->len;
+
+		if (net_tcp_seq_greater(end, conn->ack)) {
+			size_t len = end - conn->ack;
+
+			if (tcp_data_tail_get(conn, seg->pkt, len) < 0) {
+				break;
+			}
+
+			conn_ack(conn, + len);
+		}
+
+		tcp_pkt_unref(seg->pkt);
+
+		conn->ooo_count--;
+		memmove(&conn->ooo[0], &conn->ooo[1],
+			conn->ooo_count * sizeof(conn->ooo[0]));
+	}
+}
+
 static int tcp_finalize_pkt(struct net_pkt *pkt)
 {
 	net_pkt_cursor_init(pkt);
@@ -582,8 +778,81 @@ static int tcp_finalize_pkt(struct net_pkt *pkt)
 	return -EINVAL;
 }
 
+/* Build the SACK option out of the held out-of-order segments,
+ * the block with the most recently received segment goes first
+ * as required by RFC 2018, 4.
+ */
+static size_t tcp_sack_option_build(struct tcp *conn, uint8_t *options)
+{
+	struct tcp_sack_block blocks[TCP_SACK_MAX_BLOCKS];
+	int i, count = 0, first = 0;
+	size_t len = 0;
+
+	for (i = 0; i < conn->ooo_count; i++) {
+		struct tcp_ooo_segment *seg = &conn->ooo[i];
+
+		if (count && blocks[count - 1].right == seg->seq) {
+			blocks[count - 1].right += seg->len;
+		} else {
+			blocks[count].left = seg->seq;
+			blocks[count].right = seg->seq + seg->len;
+			count++;
+		}
+
+		if (seg->seq == conn->ooo_last) {
+			first = count - 1;
+		}
+	}
+
+	options[len++] = TCPOPT_NOP;
+	options[len++] = TCPOPT_NOP;
+	options[len++] = TCPOPT_SACK;
+	options[len++] = 2 + count * 8;
+
+	for (i = 0; i < count; i++) {
+		struct tcp_sack_block *block = &blocks[(first + i) % count];
+
+		sys_put_be32(block->left, options + len);
+		sys_put_be32(block->right, options + len + 4);
+		len += 8;
+	}
+
+	return len;
+}
+
+/* Returns the length of the options, always a multiple of 4 */
+static size_t tcp_options_build(struct tcp *conn, uint8_t flags,
+				uint8_t *options)
+{
+	bool syn_ack = (flags & (SYN | ACK)) == (SYN | ACK);
+	size_t len = 0;
+
+	if (flags & SYN) {
+		/* On SYN-ACK, reply only with what the peer has offered */
+		if (IS_ENABLED(CONFIG_NET_TCP_WINDOW_SCALE) &&
+		    (!syn_ack || conn->wscale_ok)) {
+			options[len++] = TCPOPT_NOP;
+			options[len++] = TCPOPT_WINDOW;
+			options[len++] = 3;
+			options[len++] = conn->recv_wscale;
+		}
+
+		if (IS_ENABLED(CONFIG_NET_TCP_SACK) &&
+		    (!syn_ack || conn->sack_ok)) {
+			options[len++] = TCPOPT_NOP;
+			options[len++] = TCPOPT_NOP;
+			options[len++] = TCPOPT_SACK_PERM;
+			options[len++] = 2;
+		}
+	} else if ((flags & ACK) && conn->sack_ok && conn->ooo_count) {
+		len = tcp_sack_option_build(conn, options);
+	}
+
+	return len;
+}
+
 static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, uint8_t flags,
-			  uint32_t seq)
+			  uint32_t seq, size_t options_len)
 {
 	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
 	struct tcphdr *th;
@@ -598,9 +867,9 @@ static int tcp_header_add(struct tcp *conn, struct net_pkt *pkt, uint8_t flags,
 	th->th_sport = conn->src.sin.sin_port;
 	th->th_dport = conn->dst.sin.sin_port;
 
-	th->th_off = 5;
+	th->th_off = 5 + options_len / 4;
 	th->th_flags = flags;
-	th->th_win = htons(conn->recv_win);
+	th->th_win = htons(tcp_recv_win_get(conn, flags));
 	th->th_seq = htonl(seq);
 
 	if (ACK & flags) {
@@ -630,10 +899,12 @@ static int ip_header_add(struct tcp *conn, struct net_pkt *pkt)
 static void tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 			uint32_t seq)
 {
+	uint8_t options[40]; /* TCP header max options size is 40 */
+	size_t options_len = tcp_options_build(conn, flags, options);
 	struct net_pkt *pkt;
 	int ret;
 
-	pkt = tcp_pkt_alloc(conn, sizeof(struct tcphdr));
+	pkt = tcp_pkt_alloc(conn, sizeof(struct tcphdr) + options_len);
 	if (!pkt) {
 		goto out;
 	}
@@ -651,12 +922,20 @@ static void tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 		goto out;
 	}
 
-	ret = tcp_header_add(conn, pkt, flags, seq);
+	ret = tcp_header_add(conn, pkt, flags, seq, options_len);
 	if (ret < 0) {
 		tcp_pkt_unref(pkt);
 		goto out;
 	}
 
+	if (options_len) {
+		ret = net_pkt_write(pkt, options, options_len);
+		if (ret < 0) {
+			tcp_pkt_unref(pkt);
+			goto out;
+		}
+	}
+
 	ret = tcp_finalize_pkt(pkt);
 	if (ret < 0) {
 		tcp_pkt_unref(pkt);
@@ -714,9 +993,15 @@ static void tcp_pkt_peek(struct net_pkt *to, struct net_pkt *from, size_t pos,
 	net_pkt_copy(to, from, len);
 }
 
+/* The usable window, limited by the peer and by the congestion control */
+static uint32_t tcp_send_win(struct tcp *conn)
+{
+	return MIN(conn->send_win, tcp_cc_window(conn));
+}
+
 static bool tcp_window_full(struct tcp *conn)
 {
-	bool window_full = !(conn->unacked_len < conn->send_win);
+	bool window_full = !((uint32_t)conn->unacked_len < tcp_send_win(conn));
 
 	NET_DBG("conn: %p window_full=%hu", conn, window_full);
 
@@ -741,27 +1026,44 @@ static int tcp_unsent_len(struct tcp *conn)
 	return unsent_len;
 }
 
-static int tcp_send_data(struct tcp *conn)
+/* Send len bytes at the offset pos of the send_data */
+static int tcp_send_segment(struct tcp *conn, int pos, int len)
 {
-	int ret = 0;
-	int pos, len;
 	struct net_pkt *pkt;
 
-	pos = conn->unacked_len;
-	len = MIN3(conn->send_data_total - conn->unacked_len,
-		   conn->send_win - conn->unacked_len,
-		   conn_mss(conn));
-
 	pkt = tcp_pkt_alloc(conn, len);
 	if (!pkt) {
 		NET_ERR("conn: %p packet allocation failed, len=%d", conn, len);
-		ret = -ENOBUFS;
-		goto out;
+		return -ENOBUFS;
 	}
 
 	tcp_pkt_peek(pkt, conn->send_data, pos, len);
 
-	tcp_out_ext(conn, PSH | ACK, pkt, conn->seq + conn->unacked_len);
+	tcp_out_ext(conn, PSH | ACK, pkt, conn->seq + pos);
+
+	return 0;
+}
+
+static int tcp_send_data(struct tcp *conn)
+{
+	int ret;
+	int len;
+
+	len = MIN3((int)conn->send_data_total - conn->unacked_len,
+		   (int)tcp_send_win(conn) - conn->unacked_len,
+		   conn_mss(conn));
+
+	ret = tcp_send_segment(conn, conn->unacked_len, len);
+	if (ret < 0) {
+		goto out;
+	}
+
+	/* Time one segment per RTT, never a retransmitted one (Karn) */
+	if (conn->data_mode == TCP_DATA_MODE_SEND && !conn->rtt_measuring) {
+		conn->rtt_measuring = true;
+		conn->rtt_seq = conn->seq + conn->unacked_len + len;
+		conn->rtt_start = k_uptime_get_32();
+	}
 
 	conn->unacked_len += len;
  out:
@@ -770,6 +1072,162 @@ static int tcp_send_data(struct tcp *conn)
 	return ret;
 }
 
+/* RFC 6298, 2: update the RTO once the timed segment has been acked */
+static void tcp_rtt_update(struct tcp *conn)
+{
+	uint32_t rtt;
+
+	if (!conn->rtt_measuring ||
+	    net_tcp_seq_greater(conn->rtt_seq, conn->seq)) {
+		return;
+	}
+
+	conn->rtt_measuring = false;
+
+	rtt = k_uptime_get_32() - conn->rtt_start;
+
+	if (!conn->rtt_valid) {
+		conn->srtt = rtt;
+		conn->rttvar = rtt / 2;
+		conn->rtt_valid = true;
+	} else {
+		uint32_t delta = conn->srtt > rtt ? conn->srtt - rtt :
+			rtt - conn->srtt;
+
+		conn->rttvar = (3 * conn->rttvar + delta) / 4;
+		conn->srtt = (7 * conn->srtt + rtt) / 8;
+	}
+
+	conn->rto = MIN(MAX(conn->srtt + MAX(1, 4 * conn->rttvar),
+			    TCP_RTO_MIN), TCP_RTO_MAX);
+
+	tcp_cc_rtt(conn, rtt);
+
+	NET_DBG("conn: %p rtt=%u srtt=%u rttvar=%u rto=%u", conn, rtt,
+		conn->srtt, conn->rttvar, conn->rto);
+}
+
+/* Retransmit up to one MSS of the first hole at or above rexmit_next.
+ * With SACK, the ranges reported by the peer in its latest ACK are
+ * skipped and only the holes below the SACKed data are retransmitted.
+ */
+static bool tcp_retransmit_hole(struct tcp *conn)
+{
+	struct tcp_options *options = &conn->recv_options;
+	uint32_t start = conn->rexmit_next;
+	uint32_t end = conn->seq + conn->unacked_len;
+	bool moved, sacked_above = false;
+	int i, len;
+
+	if (net_tcp_seq_greater(conn->seq, start)) {
+		start = conn->seq;
+	}
+
+	do {
+		moved = false;
+
+		for (i = 0; i < options->sack_count; i++) {
+			struct tcp_sack_block *block = &options->sack[i];
+
+			if (!net_tcp_seq_greater(block->left, start) &&
+			    net_tcp_seq_greater(block->right, start)) {
+				start = block->right;
+				moved = true;
+			}
+		}
+	} while (moved);
+
+	for (i = 0; i < options->sack_count; i++) {
+		struct tcp_sack_block *block = &options->sack[i];
+
+		if (net_tcp_seq_greater(block->left, start) &&
+		    net_tcp_seq_greater(end, block->left)) {
+			end = block->left;
+			sacked_above = true;
+		}
+	}
+
+	/* Past the highest SACKed byte nothing is known to be lost */
+	if (options->sack_count && !sacked_above && start != conn->seq) {
+		return false;
+	}
+
+	len = MIN((int)(end - start), conn_mss(conn));
+	if (len <= 0 || tcp_send_segment(conn, start - conn->seq, len) < 0) {
+		return false;
+	}
+
+	NET_DBG("conn: %p retransmit seq=%u len=%d", conn, start, len);
+
+	conn->rexmit_next = start + len;
+
+	return true;
+}
+
+/* RFC 5681, 3.2 and RFC 6582: fast retransmit on the third duplicate ACK */
+static void tcp_dup_ack(struct tcp *conn)
+{
+	if (!IS_ENABLED(CONFIG_NET_TCP_FAST_RETRANSMIT) ||
+	    conn->data_mode == TCP_DATA_MODE_RESEND) {
+		return;
+	}
+
+	if (conn->dup_acks < UINT8_MAX) {
+		conn->dup_acks++;
+	}
+
+	NET_DBG("conn: %p dup_acks=%hu", conn, (uint16_t)conn->dup_acks);
+
+	if (conn->in_recovery) {
+		/* Every further duplicate ACK reports a segment which has
+		 * left the network, use it to fill the next SACK hole.
+		 */
+		tcp_cc_dup_ack(conn);
+
+		if (conn->sack_ok) {
+			tcp_retransmit_hole(conn);
+		}
+		return;
+	}
+
+	if (conn->dup_acks == TCP_DUPACK_THRESHOLD) {
+		tcp_cc_loss(conn, false);
+
+		conn->in_recovery = true;
+		conn->recover = conn->seq + conn->unacked_len;
+		conn->rexmit_next = conn->seq;
+		conn->rtt_measuring = false;
+
+		tcp_retransmit_hole(conn);
+	}
+}
+
+/* Called when the cumulative ACK has advanced by acked bytes */
+static void tcp_recovery_ack(struct tcp *conn, uint32_t acked)
+{
+	conn->dup_acks = 0;
+
+	tcp_cc_ack(conn, acked);
+
+	if (!conn->in_recovery) {
+		return;
+	}
+
+	if (!net_tcp_seq_greater(conn->recover, conn->seq)) {
+		NET_DBG("conn: %p recovery done", conn);
+		conn->in_recovery = false;
+		tcp_cc_recovery_end(conn);
+		return;
+	}
+
+	/* Partial ACK, the next hole is lost as well */
+	if (!conn->sack_ok) {
+		conn->rexmit_next = conn->seq;
+	}
+
+	tcp_retransmit_hole(conn);
+}
+
 /* Send all queued but unsent data from the send_data packet by packet
  * until the receiver's window is full. */
 static int tcp_send_queued_data(struct tcp *conn)
@@ -804,7 +1262,8 @@ static int tcp_send_queued_data(struct tcp *conn)
 
 	if (subscribe) {
 		conn->send_data_retries = 0;
-		k_delayed_work_submit(&conn->send_data_timer, K_MSEC(tcp_rto));
+		k_delayed_work_submit(&conn->send_data_timer,
+				      K_MSEC(conn->rto));
 	}
  out:
 	return ret;
@@ -823,12 +1282,27 @@ static void tcp_resend_data(struct k_work *work)
 		goto out;
 	}
 
+	/* RFC 5681, 3.1: ssthresh is set on the first retransmission only */
+	if (conn->send_data_retries == 0) {
+		tcp_cc_loss(conn, true);
+	}
+
 	conn->data_mode = TCP_DATA_MODE_RESEND;
 	conn->unacked_len = 0;
+
+	/* RFC 2018, 8: after a timeout, forget what the peer has SACKed */
+	conn->in_recovery = false;
+	conn->dup_acks = 0;
+	conn->rtt_measuring = false;
+	conn->recv_options.sack_count = 0;
+
 	tcp_send_data(conn);
 
+	/* RFC 6298, 5.5: back off the timer */
+	conn->rto = MIN(conn->rto * 2, TCP_RTO_MAX);
+
 	conn->send_data_retries++;
-	k_delayed_work_submit(&conn->send_data_timer, K_MSEC(tcp_rto));
+	k_delayed_work_submit(&conn->send_data_timer, K_MSEC(conn->rto));
  out:
 	if (conn_unref) {
 		tcp_conn_unref(conn);
@@ -868,6 +1342,9 @@ static struct tcp *tcp_conn_alloc(void)
 	conn->state = TCP_LISTEN;
 
 	conn->recv_win = tcp_window;
+	conn->recv_wscale = tcp_wscale();
+
+	conn->rto = tcp_rto;
 
 	conn->seq = (IS_ENABLED(CONFIG_NET_TEST_PROTOCOL) ||
 		     IS_ENABLED(CONFIG_NET_TEST)) ? 0 : sys_rand32_get();
@@ -1079,6 +1556,7 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 	struct tcphdr *th = pkt ? th_get(pkt) : NULL;
 	uint8_t next = 0, fl = th ? th->th_flags : 0;
 	size_t tcp_options_len = th ? (th->th_off - 5) * 4 : 0;
+	struct tcp_options options = { 0 };
 	size_t len;
 
 	k_mutex_lock(&conn->lock, K_FOREVER);
@@ -1091,7 +1569,7 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 		goto next_state;
 	}
 
-	if (tcp_options_len && !tcp_options_check(&conn->recv_options, pkt,
+	if (tcp_options_len && !tcp_options_check(&options, pkt,
 						  tcp_options_len)) {
 		NET_DBG("DROP: Invalid TCP option list");
 		tcp_out(conn, RST);
@@ -1100,7 +1578,8 @@ static void tcp_in(struct tcp *conn, struct net_pkt *pkt)
 	}
 
 	if (th) {
-		conn->send_win = ntohs(th->th_win);
+		tcp_options_update(conn, th, &options);
+		conn->send_win = tcp_send_win_get(conn, th);
 	}
 
 	if (FL(&fl, &, RST)) {
@@ -1129,6 +1608,7 @@ next_state:
 			next = TCP_ESTABLISHED;
 			net_context_set_state(conn->context,
 					      NET_CONTEXT_CONNECTED);
+			tcp_cc_init(conn);
 
 			if (len) {
 				if (tcp_data_get(conn, pkt) < 0) {
@@ -1157,6 +1637,7 @@ next_state:
 			next = TCP_ESTABLISHED;
 			net_context_set_state(conn->context,
 					      NET_CONTEXT_CONNECTED);
+			tcp_cc_init(conn);
 			tcp_out(conn, ACK);
 		}
 		break;
@@ -1194,6 +1675,8 @@ next_state:
 			conn->unacked_len -= len_acked;
 			conn_seq(conn, + len_acked);
 
+			tcp_rtt_update(conn);
+
 			conn_send_data_dump(conn);
 
 			if (!k_delayed_work_remaining_get(&conn->send_data_timer)) {
@@ -1210,11 +1693,22 @@ next_state:
 			}
 			conn->data_mode = TCP_DATA_MODE_SEND;
 
+			tcp_recovery_ack(conn, len_acked);
+
 			if (tcp_send_queued_data(conn) < 0) {
 				tcp_out(conn, RST);
 				conn_state(conn, TCP_CLOSED);
 				break;
 			}
+		} else if (th && !len && conn->unacked_len &&
+			   th_ack(th) == conn->seq &&
+			   !(th->th_flags & (SYN | FIN))) {
+			tcp_dup_ack(conn);
+
+			/* The inflated window might allow new data */
+			if (conn->in_recovery) {
+				tcp_send_queued_data(conn);
+			}
 		}
 
 		if (th && len) {
@@ -1223,9 +1717,16 @@ next_state:
 					break;
 				}
 				conn_ack(conn, + len);
+				tcp_ooo_deliver(conn);
 				tcp_out(conn, ACK);
 			} else if (net_tcp_seq_greater(conn->ack, th_seq(th))) {
 				tcp_out(conn, ACK); /* peer has resent */
+			} else {
+				/* RFC 5681, 4.2: ack out-of-order data at once */
+				if (conn->sack_ok) {
+					tcp_ooo_add(conn, pkt, th_seq(th), len);
+				}
+				tcp_out(conn, ACK);
 			}
 		}
 		break;
@@ -1365,6 +1866,47 @@ int net_tcp_queue_data(struct net_context *context, struct net_pkt *pkt)
 	return ret;
 }
 
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+int net_tcp_set_congestion(struct net_context *context, const char *name,
+			   size_t len)
+{
+	struct tcp *conn = context->tcp;
+	int ret;
+
+	if (!conn) {
+		return -ENOTCONN;
+	}
+
+	k_mutex_lock(&conn->lock, K_FOREVER);
+	ret = tcp_cc_set(conn, name, len);
+	k_mutex_unlock(&conn->lock);
+
+	return ret;
+}
+
+int net_tcp_get_congestion(struct net_context *context, char *name,
+			   size_t *len)
+{
+	struct tcp *conn = context->tcp;
+	const char *cc_name;
+
+	if (!conn) {
+		return -ENOTCONN;
+	}
+
+	cc_name = tcp_cc_name(conn);
+
+	if (*len <= strlen(cc_name)) {
+		return -EINVAL;
+	}
+
+	*len = strlen(cc_name) + 1;
+	memcpy(name, cc_name, *len);
+
+	return 0;
+}
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
+
 /* net context is about to send out queued data - inform caller only */
 int net_tcp_send_data(struct net_context *context, net_context_send_cb_t cb,
 		      void *user_data)
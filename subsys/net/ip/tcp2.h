@@ -97,6 +97,31 @@ int net_tcp_queue(struct net_context *context, const void *buf, size_t len,
 		  const struct msghdr *msghdr);
 /* TODO: split into 2 functions, conn -> context, queue -> send? */
 
+/**
+ * @brief Select the congestion control algorithm of a connection
+ *
+ * @param context	Network context
+ * @param name		Algorithm name, e.g. "newreno", "cubic" or "vegas"
+ * @param len		Length of the name
+ *
+ * @return 0 if ok, -ENOENT if the algorithm is not available,
+ *	   < 0 on other errors
+ */
+int net_tcp_set_congestion(struct net_context *context, const char *name,
+			   size_t len);
+
+/**
+ * @brief Get the name of the congestion control algorithm of a connection
+ *
+ * @param context	Network context
+ * @param name		Buffer for the NUL terminated name
+ * @param len		Size of the buffer, updated with the name length
+ *
+ * @return 0 if ok, < 0 if error
+ */
+int net_tcp_get_congestion(struct net_context *context, char *name,
+			   size_t *len);
+
 /* The following functions are provided solely for the compatibility
  * with the old TCP
  */
@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* TCP congestion control: the generic part of the loss recovery
+ * (RFC 5681, RFC 6582) and the NewReno, CUBIC and Vegas algorithms.
+ * All windows are in bytes, all times in milliseconds.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_tcp, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <zephyr.h>
+#include <string.h>
+#include <net/net_pkt.h>
+#include <net/net_context.h>
+#include "net_private.h"
+#include "tcp2_priv.h"
+
+/* RFC 6928, 2: the initial window */
+static uint32_t tcp_cc_initial_window(struct tcp *conn)
+{
+	uint32_t mss = conn_mss(conn);
+
+	return MIN(10 * mss, MAX(2 * mss, 14600U));
+}
+
+/* RFC 5681, 3.1: the slow start, returns false in congestion avoidance */
+static bool tcp_cc_slow_start(struct tcp *conn, uint32_t acked)
+{
+	if (conn->cwnd >= conn->ssthresh) {
+		return false;
+	}
+
+	conn->cwnd += MIN(acked, (uint32_t)conn_mss(conn));
+
+	return true;
+}
+
+/* RFC 5681, 3.1: equation (4) */
+static uint32_t tcp_cc_half_flight(struct tcp *conn)
+{
+	return MAX((uint32_t)conn->unacked_len / 2,
+		   2U * (uint32_t)conn_mss(conn));
+}
+
+static void newreno_init(struct tcp *conn)
+{
+	conn->cwnd = tcp_cc_initial_window(conn);
+	conn->ssthresh = UINT32_MAX;
+	conn->cwnd_acked = 0;
+}
+
+static void newreno_on_ack(struct tcp *conn, uint32_t acked)
+{
+	if (tcp_cc_slow_start(conn, acked)) {
+		return;
+	}
+
+	/* Appropriate byte counting (RFC 3465): one MSS per window acked */
+	conn->cwnd_acked += acked;
+
+	if (conn->cwnd_acked >= conn->cwnd) {
+		conn->cwnd_acked -= conn->cwnd;
+		conn->cwnd += conn_mss(conn);
+	}
+}
+
+static void newreno_on_loss(struct tcp *conn, bool timeout)
+{
+	conn->ssthresh = tcp_cc_half_flight(conn);
+	conn->cwnd_acked = 0;
+
+	if (timeout) {
+		conn->cwnd = conn_mss(conn);
+	} else {
+		conn->cwnd = conn->ssthresh + 3 * conn_mss(conn);
+	}
+}
+
+static const struct tcp_cc_ops tcp_cc_newreno = {
+	.name = "newreno",
+	.init = newreno_init,
+	.on_ack = newreno_on_ack,
+	.on_loss = newreno_on_loss,
+};
+
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+/* RFC 8312, 5: C = 0.4 and beta = 0.7 */
+#define CUBIC_BETA_NUM 7
+#define CUBIC_BETA_DEN 10
+#define CUBIC_DT_MAX 100000 /* keeps the cube within 64 bits */
+
+static uint32_t cubic_cbrt(uint64_t x)
+{
+	uint32_t root = 0;
+	int bit;
+
+	for (bit = 20; bit >= 0; bit--) {
+		uint64_t probe = root | BIT(bit);
+
+		if (probe * probe * probe <= x) {
+			root = probe;
+		}
+	}
+
+	return root;
+}
+
+static void cubic_init(struct tcp *conn)
+{
+	newreno_init(conn);
+
+	memset(&conn->cc_data.cubic, 0, sizeof(conn->cc_data.cubic));
+}
+
+static void cubic_epoch_start(struct tcp *conn)
+{
+	struct tcp_cc_cubic *cubic = &conn->cc_data.cubic;
+	uint32_t mss = conn_mss(conn);
+
+	cubic->in_epoch = true;
+	cubic->epoch_start = k_uptime_get_32();
+	cubic->w_est = conn->cwnd;
+
+	if (conn->cwnd < cubic->w_max) {
+		/* K = cbrt((W_max - cwnd) / C), in ms */
+		cubic->k = cubic_cbrt((uint64_t)(cubic->w_max - conn->cwnd) *
+				      2500000000ULL / mss);
+		cubic->origin = cubic->w_max;
+	} else {
+		cubic->k = 0;
+		cubic->origin = conn->cwnd;
+	}
+}
+
+static void cubic_on_ack(struct tcp *conn, uint32_t acked)
+{
+	struct tcp_cc_cubic *cubic = &conn->cc_data.cubic;
+	uint32_t mss = conn_mss(conn);
+	int64_t dt, offset;
+	uint32_t target;
+
+	if (tcp_cc_slow_start(conn, acked)) {
+		return;
+	}
+
+	if (!cubic->in_epoch) {
+		cubic_epoch_start(conn);
+	}
+
+	/* RFC 8312, 4.1: W_cubic(t + RTT) */
+	dt = (int64_t)(k_uptime_get_32() - cubic->epoch_start) +
+		conn->srtt - cubic->k;
+	dt = MIN(MAX(dt, -CUBIC_DT_MAX), CUBIC_DT_MAX);
+
+	offset = (4 * dt * dt * dt / 10000) * mss / 1000000;
+
+	target = MAX((int64_t)cubic->origin + offset, (int64_t)conn->cwnd);
+	target = MIN(target, conn->cwnd + conn->cwnd / 2);
+
+	/* RFC 8312, 4.2: the TCP-friendly region */
+	cubic->w_est += (uint64_t)9 * mss * acked / (17 * conn->cwnd);
+
+	if (cubic->w_est > target) {
+		target = cubic->w_est;
+	}
+
+	/* RFC 8312, 4.3: (target - cwnd) / cwnd per acked segment */
+	conn->cwnd_acked += (uint64_t)(target - conn->cwnd) * acked /
+		conn->cwnd;
+
+	if (conn->cwnd_acked >= mss) {
+		conn->cwnd += conn->cwnd_acked;
+		conn->cwnd_acked = 0;
+	}
+}
+
+static void cubic_on_loss(struct tcp *conn, bool timeout)
+{
+	struct tcp_cc_cubic *cubic = &conn->cc_data.cubic;
+	uint32_t mss = conn_mss(conn);
+
+	/* RFC 8312, 4.6: fast convergence */
+	if (conn->cwnd < cubic->w_max) {
+		cubic->w_max = conn->cwnd * (CUBIC_BETA_DEN + CUBIC_BETA_NUM) /
+			(2 * CUBIC_BETA_DEN);
+	} else {
+		cubic->w_max = conn->cwnd;
+	}
+
+	cubic->in_epoch = false;
+
+	conn->ssthresh = MAX(conn->cwnd * CUBIC_BETA_NUM / CUBIC_BETA_DEN,
+			     2 * mss);
+	conn->cwnd_acked = 0;
+
+	if (timeout) {
+		conn->cwnd = mss;
+	} else {
+		conn->cwnd = conn->ssthresh + 3 * mss;
+	}
+}
+
+static const struct tcp_cc_ops tcp_cc_cubic = {
+	.name = "cubic",
+	.init = cubic_init,
+	.on_ack = cubic_on_ack,
+	.on_loss = cubic_on_loss,
+};
+#endif /* CONFIG_NET_TCP_CC_CUBIC */
+
+#if defined(CONFIG_NET_TCP_CC_VEGAS)
+/* Segments queued in the network, kept between alpha and beta */
+#define VEGAS_ALPHA 2
+#define VEGAS_BETA 4
+#define VEGAS_GAMMA 1
+
+static void vegas_round_start(struct tcp *conn)
+{
+	struct tcp_cc_vegas *vegas = &conn->cc_data.vegas;
+
+	vegas->round_end = conn->seq + conn->unacked_len;
+	vegas->min_rtt = UINT32_MAX;
+	vegas->rtt_count = 0;
+}
+
+static void vegas_init(struct tcp *conn)
+{
+	newreno_init(conn);
+
+	conn->cc_data.vegas.base_rtt = UINT32_MAX;
+	vegas_round_start(conn);
+}
+
+static void vegas_on_rtt(struct tcp *conn, uint32_t rtt)
+{
+	struct tcp_cc_vegas *vegas = &conn->cc_data.vegas;
+
+	rtt = MAX(rtt, 1U);
+
+	vegas->base_rtt = MIN(vegas->base_rtt, rtt);
+	vegas->min_rtt = MIN(vegas->min_rtt, rtt);
+	vegas->rtt_count++;
+}
+
+static void vegas_on_ack(struct tcp *conn, uint32_t acked)
+{
+	struct tcp_cc_vegas *vegas = &conn->cc_data.vegas;
+	uint32_t mss = conn_mss(conn);
+	uint32_t queued;
+
+	if (net_tcp_seq_greater(vegas->round_end, conn->seq)) {
+		/* Mid-round, only the slow start grows the window */
+		tcp_cc_slow_start(conn, acked);
+		return;
+	}
+
+	if (!vegas->rtt_count) {
+		/* No RTT sample in this round, behave as NewReno */
+		newreno_on_ack(conn, acked);
+		vegas_round_start(conn);
+		return;
+	}
+
+	/* Bytes queued in the network: cwnd * (rtt - base_rtt) / rtt */
+	queued = (uint64_t)conn->cwnd * (vegas->min_rtt - vegas->base_rtt) /
+		vegas->min_rtt;
+
+	if (conn->cwnd < conn->ssthresh) {
+		if (queued > VEGAS_GAMMA * mss) {
+			/* Leave the slow start before a queue builds up */
+			conn->ssthresh = MAX(conn->cwnd - queued, 2 * mss);
+			conn->cwnd = conn->ssthresh;
+		} else {
+			tcp_cc_slow_start(conn, acked);
+		}
+	} else if (queued > VEGAS_BETA * mss) {
+		conn->cwnd = MAX(conn->cwnd - mss, 2 * mss);
+		conn->ssthresh = MIN(conn->ssthresh, conn->cwnd);
+	} else if (queued < VEGAS_ALPHA * mss) {
+		conn->cwnd += mss;
+	}
+
+	vegas_round_start(conn);
+}
+
+static void vegas_on_loss(struct tcp *conn, bool timeout)
+{
+	newreno_on_loss(conn, timeout);
+
+	vegas_round_start(conn);
+}
+
+static const struct tcp_cc_ops tcp_cc_vegas = {
+	.name = "vegas",
+	.init = vegas_init,
+	.on_ack = vegas_on_ack,
+	.on_loss = vegas_on_loss,
+	.on_rtt = vegas_on_rtt,
+};
+#endif /* CONFIG_NET_TCP_CC_VEGAS */
+
+static const struct tcp_cc_ops *tcp_cc_algorithms[] = {
+	&tcp_cc_newreno,
+#if defined(CONFIG_NET_TCP_CC_CUBIC)
+	&tcp_cc_cubic,
+#endif
+#if defined(CONFIG_NET_TCP_CC_VEGAS)
+	&tcp_cc_vegas,
+#endif
+};
+
+static const struct tcp_cc_ops *tcp_cc_find(const char *name, size_t len)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(tcp_cc_algorithms); i++) {
+		const char *cc_name = tcp_cc_algorithms[i]->name;
+
+		if (strlen(cc_name) == len && !strncmp(cc_name, name, len)) {
+			return tcp_cc_algorithms[i];
+		}
+	}
+
+	return NULL;
+}
+
+void tcp_cc_init(struct tcp *conn)
+{
+	if (!conn->cc) {
+		conn->cc = tcp_cc_find(CONFIG_NET_TCP_CC_DEFAULT,
+				       strlen(CONFIG_NET_TCP_CC_DEFAULT));
+		if (!conn->cc) {
+			NET_WARN("Unknown congestion control %s",
+				 CONFIG_NET_TCP_CC_DEFAULT);
+			conn->cc = &tcp_cc_newreno;
+		}
+	}
+
+	conn->cc->init(conn);
+
+	NET_DBG("conn: %p cc=%s cwnd=%u", conn, conn->cc->name, conn->cwnd);
+}
+
+int tcp_cc_set(struct tcp *conn, const char *name, size_t len)
+{
+	const struct tcp_cc_ops *cc;
+
+	/* Accept a NUL terminated name as well */
+	len = strnlen(name, len);
+
+	cc = tcp_cc_find(name, len);
+	if (!cc) {
+		return -ENOENT;
+	}
+
+	conn->cc = cc;
+
+	if (conn->state == TCP_ESTABLISHED) {
+		tcp_cc_init(conn);
+	}
+
+	return 0;
+}
+
+const char *tcp_cc_name(struct tcp *conn)
+{
+	return conn->cc ? conn->cc->name : CONFIG_NET_TCP_CC_DEFAULT;
+}
+
+void tcp_cc_ack(struct tcp *conn, uint32_t acked)
+{
+	if (!conn->cc) {
+		return;
+	}
+
+	if (conn->in_recovery) {
+		/* RFC 6582, 3.2, step 5: deflate by the amount acked */
+		conn->cwnd = conn->cwnd > acked ? conn->cwnd - acked : 0;
+
+		if (acked >= conn_mss(conn)) {
+			conn->cwnd += conn_mss(conn);
+		}
+		return;
+	}
+
+	conn->cc->on_ack(conn, acked);
+}
+
+void tcp_cc_rtt(struct tcp *conn, uint32_t rtt)
+{
+	if (conn->cc && conn->cc->on_rtt) {
+		conn->cc->on_rtt(conn, rtt);
+	}
+}
+
+void tcp_cc_dup_ack(struct tcp *conn)
+{
+	/* RFC 6582, 3.2, step 3: inflate by the segment that has left */
+	if (conn->cc) {
+		conn->cwnd += conn_mss(conn);
+	}
+}
+
+void tcp_cc_loss(struct tcp *conn, bool timeout)
+{
+	if (conn->cc) {
+		conn->cc->on_loss(conn, timeout);
+	}
+
+	NET_DBG("conn: %p %s cwnd=%u ssthresh=%u", conn,
+		timeout ? "timeout" : "fast retransmit", conn->cwnd,
+		conn->ssthresh);
+}
+
+void tcp_cc_recovery_end(struct tcp *conn)
+{
+	/* RFC 6582, 3.2, step 4: the full ACK deflates the window */
+	if (conn->cc) {
+		conn->cwnd = MIN(conn->ssthresh,
+				 MAX((uint32_t)conn->unacked_len,
+				     (uint32_t)conn_mss(conn)) +
+				 conn_mss(conn));
+	}
+}
+
+uint32_t tcp_cc_window(struct tcp *conn)
+{
+	if (!conn->cc) {
+		return UINT32_MAX;
+	}
+
+	return conn->cc->cwnd ? conn->cc->cwnd(conn) : conn->cwnd;
+}
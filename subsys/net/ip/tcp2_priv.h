@@ -96,7 +96,7 @@
 #define conn_send_data_dump(_conn)					\
 ({									\
 	NET_DBG("conn: %p total=%zd, unacked_len=%d, "			\
-		"send_win=%hu, mss=%hu",				\
+		"send_win=%u, mss=%hu",					\
 		(_conn), net_pkt_get_len((_conn)->send_data),		\
 		conn->unacked_len, conn->send_win,			\
 		conn_mss((_conn)));					\
@@ -110,6 +110,26 @@
 #define TCPOPT_NOP	1
 #define TCPOPT_MAXSEG	2
 #define TCPOPT_WINDOW	3
+#define TCPOPT_SACK_PERM 4
+#define TCPOPT_SACK	5
+
+/* RFC 7323, 2.3: the shift count is limited to 14 */
+#define TCP_WINDOW_SCALE_MAX 14
+
+/* Without timestamps, 4 SACK blocks fit into the 40 bytes option space */
+#define TCP_SACK_MAX_BLOCKS 4
+
+/* Number of out-of-order segments held for the SACK receiver */
+#define TCP_OOO_MAX_SEGMENTS TCP_SACK_MAX_BLOCKS
+
+/* RFC 5681, 3.2: the duplicate ACK threshold for the fast retransmit */
+#define TCP_DUPACK_THRESHOLD 3
+
+/* RFC 6298 retransmission timeout bounds, in milliseconds. The computed
+ * RTO is rounded up to 1 second (2.4) to avoid spurious retransmissions.
+ */
+#define TCP_RTO_MIN 1000
+#define TCP_RTO_MAX 60000
 
 enum pkt_addr {
 	TCP_EP_SRC = 1,
@@ -169,11 +189,58 @@ union tcp_endpoint {
 	struct sockaddr_in6 sin6;
 };
 
+struct tcp_sack_block {
+	uint32_t left;
+	uint32_t right;
+};
+
 struct tcp_options {
 	uint16_t mss;
-	uint16_t window;
+	uint8_t window; /* window scale shift count */
+	uint8_t sack_count;
+	struct tcp_sack_block sack[TCP_SACK_MAX_BLOCKS];
 	bool mss_found : 1;
 	bool wnd_found : 1;
+	bool sack_perm_found : 1;
+};
+
+struct tcp_ooo_segment {
+	struct net_pkt *pkt;
+	uint32_t seq;
+	uint32_t len;
+};
+
+struct tcp;
+
+/* Congestion control algorithm, see tcp2_cc.c */
+struct tcp_cc_ops {
+	const char *name;
+	/* Set up the congestion window once the connection is established */
+	void (*init)(struct tcp *conn);
+	/* New data has been acked outside of the loss recovery */
+	void (*on_ack)(struct tcp *conn, uint32_t acked);
+	/* A loss was detected by duplicate ACKs or by a timeout */
+	void (*on_loss)(struct tcp *conn, bool timeout);
+	/* Optional, a new RTT sample in milliseconds */
+	void (*on_rtt)(struct tcp *conn, uint32_t rtt);
+	/* Optional, the congestion window if it differs from conn->cwnd */
+	uint32_t (*cwnd)(struct tcp *conn);
+};
+
+struct tcp_cc_cubic {
+	uint32_t w_max;
+	uint32_t w_est;
+	uint32_t origin;
+	uint32_t k; /* ms */
+	uint32_t epoch_start; /* ms */
+	bool in_epoch;
+};
+
+struct tcp_cc_vegas {
+	uint32_t base_rtt;
+	uint32_t min_rtt;
+	uint32_t round_end; /* seq which ends the current round */
+	uint16_t rtt_count;
 };
 
 struct tcp { /* TCP connection */
@@ -186,9 +253,37 @@ struct tcp { /* TCP connection */
 	uint32_t ack;
 	union tcp_endpoint src;
 	union tcp_endpoint dst;
-	uint16_t recv_win;
-	uint16_t send_win;
+	uint32_t recv_win;
+	uint32_t send_win;
+	uint8_t send_wscale; /* shift applied to the peer's window */
+	uint8_t recv_wscale; /* shift applied to our advertised window */
+	bool wscale_ok : 1;
+	bool sack_ok : 1;
+	bool rtt_measuring : 1;
+	bool rtt_valid : 1;
+	bool in_recovery : 1;
 	struct tcp_options recv_options;
+	uint32_t rtt_seq; /* segment end being timed for the RTT sample */
+	uint32_t rtt_start;
+	uint32_t srtt; /* smoothed RTT, ms */
+	uint32_t rttvar; /* RTT variation, ms */
+	uint32_t rto; /* retransmission timeout, ms */
+	uint32_t recover; /* NewReno recovery point, RFC 6582 */
+	uint32_t rexmit_next; /* next seq to retransmit while recovering */
+	uint8_t dup_acks;
+	uint8_t ooo_count;
+	uint32_t ooo_last; /* seq of the most recent out-of-order segment */
+	struct tcp_ooo_segment ooo[TCP_OOO_MAX_SEGMENTS];
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+	const struct tcp_cc_ops *cc;
+	uint32_t cwnd;
+	uint32_t ssthresh;
+	uint32_t cwnd_acked; /* bytes acked during congestion avoidance */
+	union {
+		struct tcp_cc_cubic cubic;
+		struct tcp_cc_vegas vegas;
+	} cc_data;
+#endif
 	struct k_delayed_work send_timer;
 	sys_slist_t send_queue;
 	struct k_delayed_work send_data_timer;
@@ -222,3 +317,23 @@ struct tcp { /* TCP connection */
 
 #define FL(_fl, _op, _mask, _args...)					\
 	_flags(_fl, _op, _mask, strlen("" #_args) ? _args : true)
+
+#if defined(CONFIG_NET_TCP_CONGESTION_CONTROL)
+void tcp_cc_init(struct tcp *conn);
+int tcp_cc_set(struct tcp *conn, const char *name, size_t len);
+const char *tcp_cc_name(struct tcp *conn);
+void tcp_cc_ack(struct tcp *conn, uint32_t acked);
+void tcp_cc_rtt(struct tcp *conn, uint32_t rtt);
+void tcp_cc_dup_ack(struct tcp *conn);
+void tcp_cc_loss(struct tcp *conn, bool timeout);
+void tcp_cc_recovery_end(struct tcp *conn);
+uint32_t tcp_cc_window(struct tcp *conn);
+#else
+#define tcp_cc_init(...)
+#define tcp_cc_ack(...)
+#define tcp_cc_rtt(...)
+#define tcp_cc_dup_ack(...)
+#define tcp_cc_loss(...)
+#define tcp_cc_recovery_end(...)
+#define tcp_cc_window(...) UINT32_MAX
+#endif /* CONFIG_NET_TCP_CONGESTION_CONTROL */
@@ -0,0 +1,726 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_coap, CONFIG_COAP_LOG_LEVEL);
+
+#include <stddef.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <zephyr.h>
+#include <zephyr/types.h>
+
+#include <net/net_core.h>
+#include <net/coap.h>
+#include <net/coap_block_xfer.h>
+
+#if defined(CONFIG_STREAM_FLASH)
+#include <storage/stream_flash.h>
+#endif
+
+/* Retransmission parameters as per RFC 7252, section 4.8, a separate
+ * response is waited for as long as a request is retransmitted.
+ */
+#define INIT_ACK_TIMEOUT	CONFIG_COAP_INIT_ACK_TIMEOUT_MS
+#define MAX_RETRANSMIT		4
+#define SEPARATE_TIMEOUT	(INIT_ACK_TIMEOUT * 16)
+
+/* Smallest room for the header and the options of a request */
+#define MIN_REQUEST_LEN		32
+
+#define UNKNOWN_NUM		UINT32_MAX
+
+#define BLOCK_VALUE(num, more, szx) \
+	(((num) << 4) | ((more) ? 0x08 : 0x00) | (szx))
+
+enum slot_state {
+	SLOT_FREE,
+	SLOT_SENT,
+	SLOT_SEPARATE,
+	SLOT_DONE,
+};
+
+struct block_option {
+	uint16_t code;
+	unsigned int value;
+};
+
+static inline uint16_t block_bytes(const struct coap_block_xfer *xfer)
+{
+	return coap_block_size_to_bytes(xfer->block_size);
+}
+
+static inline bool is_upload(const struct coap_block_xfer *xfer)
+{
+	return xfer->method != COAP_METHOD_GET;
+}
+
+static inline struct coap_block_xfer_slot *slot_get(
+	struct coap_block_xfer *xfer, uint32_t num)
+{
+	return &xfer->slots[num % xfer->window];
+}
+
+/* Blocks received out of order wait in the area following the request. */
+static inline uint8_t *slot_data(struct coap_block_xfer *xfer,
+				 struct coap_block_xfer_slot *slot)
+{
+	return xfer->buf + xfer->req_len +
+		(slot - xfer->slots) * block_bytes(xfer);
+}
+
+static struct coap_block_xfer_slot *slot_find_by_id(
+	struct coap_block_xfer *xfer, uint16_t id)
+{
+	int i;
+
+	for (i = 0; i < xfer->window; i++) {
+		if (xfer->slots[i].state != SLOT_FREE &&
+		    xfer->slots[i].id == id) {
+			return &xfer->slots[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct coap_block_xfer_slot *slot_find_by_token(
+	struct coap_block_xfer *xfer, const uint8_t *token, uint8_t tkl)
+{
+	int i;
+
+	if (tkl != COAP_BLOCK_XFER_TOKEN_LEN) {
+		return NULL;
+	}
+
+	for (i = 0; i < xfer->window; i++) {
+		if (xfer->slots[i].state != SLOT_FREE &&
+		    !memcmp(xfer->slots[i].token, token, tkl)) {
+			return &xfer->slots[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void finish(struct coap_block_xfer *xfer, int result)
+{
+	if (xfer->finished) {
+		return;
+	}
+
+	NET_DBG("Transfer finished, %zu bytes (%d)", xfer->transferred,
+		result);
+
+	xfer->finished = true;
+	xfer->result = result;
+	memset(xfer->slots, 0, sizeof(xfer->slots));
+
+	if (xfer->cb->done) {
+		xfer->cb->done(xfer, result);
+	}
+}
+
+/* Append the application options and the block options in ascending order */
+static int append_options(struct coap_block_xfer *xfer,
+			  struct coap_packet *request, uint32_t num)
+{
+	struct block_option own[2];
+	size_t i = 0, j = 0;
+	int count = 0;
+	bool more;
+	int r;
+
+	if (is_upload(xfer)) {
+		more = (num + 1) * block_bytes(xfer) < xfer->total_size;
+
+		own[count].code = COAP_OPTION_BLOCK1;
+		own[count++].value = BLOCK_VALUE(num, more, xfer->block_size);
+
+		if (num == 0U) {
+			own[count].code = COAP_OPTION_SIZE1;
+			own[count++].value = xfer->total_size;
+		}
+	} else {
+		own[count].code = COAP_OPTION_BLOCK2;
+		own[count++].value = BLOCK_VALUE(num, false, xfer->block_size);
+
+		/* Ask the server for the size of the resource */
+		if (num == 0U) {
+			own[count].code = COAP_OPTION_SIZE2;
+			own[count++].value = 0U;
+		}
+	}
+
+	while (i < xfer->num_options || j < count) {
+		if (j < count && (i == xfer->num_options ||
+				  own[j].code < xfer->options[i].code)) {
+			r = coap_append_option_int(request, own[j].code,
+						   own[j].value);
+			j++;
+		} else {
+			r = coap_packet_append_option(request,
+						      xfer->options[i].code,
+						      xfer->options[i].value,
+						      xfer->options[i].len);
+			i++;
+		}
+
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	return 0;
+}
+
+static int send_request(struct coap_block_xfer *xfer,
+			struct coap_block_xfer_slot *slot)
+{
+	struct coap_packet request;
+	size_t offset;
+	int len;
+	int r;
+
+	r = coap_packet_init(&request, xfer->buf, xfer->req_len, 1,
+			     COAP_TYPE_CON, COAP_BLOCK_XFER_TOKEN_LEN,
+			     slot->token, xfer->method, slot->id);
+	if (r < 0) {
+		return r;
+	}
+
+	r = append_options(xfer, &request, slot->num);
+	if (r < 0) {
+		return r;
+	}
+
+	offset = slot->num * block_bytes(xfer);
+
+	if (is_upload(xfer) && offset < xfer->total_size) {
+		len = MIN(block_bytes(xfer), xfer->total_size - offset);
+
+		r = coap_packet_append_payload_marker(&request);
+		if (r < 0) {
+			return r;
+		}
+
+		if (request.max_len - request.offset < len) {
+			return -ENOMEM;
+		}
+
+		/* Read the block straight into the request */
+		r = xfer->cb->read(xfer, offset, request.data + request.offset,
+				   len);
+		if (r < 0) {
+			return r;
+		}
+
+		if (r != len) {
+			return -EIO;
+		}
+
+		request.offset += len;
+	}
+
+	NET_DBG("Block %u, id %u, try %u", slot->num, slot->id,
+		slot->retries);
+
+	return xfer->cb->send(xfer, request.data, request.offset);
+}
+
+static int send_empty_ack(struct coap_block_xfer *xfer, uint16_t id)
+{
+	struct coap_packet ack;
+	int r;
+
+	r = coap_packet_init(&ack, xfer->buf, xfer->req_len, 1, COAP_TYPE_ACK,
+			     0, NULL, COAP_CODE_EMPTY, id);
+	if (r < 0) {
+		return r;
+	}
+
+	return xfer->cb->send(xfer, ack.data, ack.offset);
+}
+
+static int fill_window(struct coap_block_xfer *xfer)
+{
+	struct coap_block_xfer_slot *slot;
+	uint32_t window, limit;
+	int r;
+
+	/* Negotiate the block size on the first block before opening
+	 * the window.
+	 */
+	window = xfer->done_num > 0U ? xfer->window : 1U;
+	limit = MIN(xfer->last_num, MIN(xfer->max_num, xfer->size_num));
+
+	while (xfer->next_num <= limit &&
+	       xfer->next_num < xfer->done_num + window) {
+		slot = slot_get(xfer, xfer->next_num);
+
+		memset(slot, 0, sizeof(*slot));
+		slot->num = xfer->next_num;
+		slot->id = coap_next_id();
+		memcpy(slot->token, coap_next_token(), sizeof(slot->token));
+		slot->t0 = k_uptime_get();
+		slot->timeout = INIT_ACK_TIMEOUT;
+		slot->state = SLOT_SENT;
+
+		r = send_request(xfer, slot);
+		if (r < 0) {
+			return r;
+		}
+
+		xfer->next_num++;
+	}
+
+	return 0;
+}
+
+static int deliver(struct coap_block_xfer *xfer,
+		   struct coap_block_xfer_slot *slot,
+		   const uint8_t *data, size_t len)
+{
+	bool last = (slot->num == xfer->last_num);
+	int r;
+
+	if (is_upload(xfer)) {
+		xfer->transferred = MIN(xfer->total_size,
+					xfer->transferred + block_bytes(xfer));
+	} else {
+		r = xfer->cb->write(xfer, xfer->transferred, data, len, last);
+		if (r < 0) {
+			return r;
+		}
+
+		xfer->transferred += len;
+	}
+
+	slot->state = SLOT_FREE;
+	xfer->done_num++;
+
+	if (last) {
+		finish(xfer, 0);
+	}
+
+	return 0;
+}
+
+/* Deliver the blocks that are complete in order and refill the window */
+static int advance(struct coap_block_xfer *xfer)
+{
+	struct coap_block_xfer_slot *slot;
+	int r;
+
+	while (!xfer->finished) {
+		slot = slot_get(xfer, xfer->done_num);
+		if (slot->state != SLOT_DONE || slot->num != xfer->done_num) {
+			break;
+		}
+
+		r = deliver(xfer, slot, slot_data(xfer, slot), slot->len);
+		if (r < 0) {
+			return r;
+		}
+	}
+
+	if (xfer->finished) {
+		return 0;
+	}
+
+	/* The server refused a block following one that announced more */
+	if (xfer->done_num > xfer->max_num) {
+		return -EBADMSG;
+	}
+
+	return fill_window(xfer);
+}
+
+static int handle_block2(struct coap_block_xfer *xfer,
+			 struct coap_block_xfer_slot *slot,
+			 const struct coap_packet *response)
+{
+	uint8_t code = coap_header_get_code(response);
+	const uint8_t *payload;
+	uint16_t payload_len;
+	bool more = false;
+	int block, size;
+
+	if (code != COAP_RESPONSE_CODE_CONTENT) {
+		if ((code >> 5) == 4 && slot->num > 0U &&
+		    xfer->last_num == UNKNOWN_NUM) {
+			/* Speculative request past the end of the resource */
+			xfer->max_num = MIN(xfer->max_num, slot->num - 1U);
+			slot->state = SLOT_FREE;
+			return 0;
+		}
+
+		NET_DBG("Unexpected response %u.%02u to block %u",
+			code >> 5, code & 0x1f, slot->num);
+		return -ENOMSG;
+	}
+
+	payload = coap_packet_get_payload(response, &payload_len);
+
+	block = coap_get_option_int(response, COAP_OPTION_BLOCK2);
+	if (block >= 0) {
+		if (GET_BLOCK_NUM(block) != slot->num) {
+			return -EBADMSG;
+		}
+
+		if (GET_BLOCK_SIZE(block) != xfer->block_size) {
+			if (GET_BLOCK_SIZE(block) > xfer->block_size ||
+			    slot->num > 0U) {
+				return -EBADMSG;
+			}
+
+			xfer->block_size = GET_BLOCK_SIZE(block);
+		}
+
+		more = GET_MORE(block);
+
+		if (payload_len > block_bytes(xfer) ||
+		    (more && payload_len != block_bytes(xfer))) {
+			return -EBADMSG;
+		}
+	} else if (slot->num > 0U) {
+		return -EBADMSG;
+	}
+
+	size = coap_get_option_int(response, COAP_OPTION_SIZE2);
+	if (size > 0) {
+		xfer->total_size = size;
+		xfer->size_num = (size - 1) / block_bytes(xfer);
+	}
+
+	if (more) {
+		if (slot->num >= xfer->max_num) {
+			return -EBADMSG;
+		}
+
+		/* The size was only an estimate */
+		if (slot->num >= xfer->size_num) {
+			xfer->size_num = UNKNOWN_NUM;
+		}
+	} else {
+		xfer->last_num = slot->num;
+	}
+
+	if (slot->num == xfer->done_num) {
+		return deliver(xfer, slot, payload, payload_len);
+	}
+
+	memcpy(slot_data(xfer, slot), payload, payload_len);
+	slot->len = payload_len;
+	slot->state = SLOT_DONE;
+
+	return 0;
+}
+
+static int handle_block1(struct coap_block_xfer *xfer,
+			 struct coap_block_xfer_slot *slot,
+			 const struct coap_packet *response)
+{
+	uint8_t code = coap_header_get_code(response);
+	int block;
+
+	if ((code >> 5) != 2) {
+		NET_DBG("Unexpected response %u.%02u to block %u",
+			code >> 5, code & 0x1f, slot->num);
+		return -ENOMSG;
+	}
+
+	block = coap_get_option_int(response, COAP_OPTION_BLOCK1);
+	if (block >= 0) {
+		if (GET_BLOCK_NUM(block) != slot->num) {
+			return -EBADMSG;
+		}
+
+		if (GET_BLOCK_SIZE(block) != xfer->block_size) {
+			if (GET_BLOCK_SIZE(block) > xfer->block_size ||
+			    slot->num > 0U) {
+				return -EBADMSG;
+			}
+
+			/* The server kept the beginning of the first block */
+			xfer->block_size = GET_BLOCK_SIZE(block);
+			xfer->last_num = xfer->total_size ?
+				(xfer->total_size - 1) / block_bytes(xfer) : 0U;
+		}
+	}
+
+	if (slot->num == xfer->done_num) {
+		return deliver(xfer, slot, NULL, 0);
+	}
+
+	slot->state = SLOT_DONE;
+
+	return 0;
+}
+
+int coap_block_xfer_init(struct coap_block_xfer *xfer,
+			 const struct coap_block_xfer_config *config)
+{
+	const struct coap_block_xfer_cb *cb;
+	uint16_t bytes;
+	size_t blocks_len;
+
+	if (!xfer || !config || !config->cb || !config->cb->send ||
+	    !config->buf) {
+		return -EINVAL;
+	}
+
+	if (config->num_options && !config->options) {
+		return -EINVAL;
+	}
+
+	if (config->window == 0U ||
+	    config->window > CONFIG_COAP_BLOCK_XFER_WINDOW_MAX ||
+	    config->block_size > COAP_BLOCK_1024) {
+		return -EINVAL;
+	}
+
+	cb = config->cb;
+	bytes = coap_block_size_to_bytes(config->block_size);
+
+	memset(xfer, 0, sizeof(*xfer));
+
+	switch (config->method) {
+	case COAP_METHOD_GET:
+		if (!cb->write) {
+			return -EINVAL;
+		}
+
+		blocks_len = config->window * bytes;
+		if (config->buf_len < blocks_len + MIN_REQUEST_LEN) {
+			return -ENOMEM;
+		}
+
+		xfer->req_len = config->buf_len - blocks_len;
+		xfer->last_num = UNKNOWN_NUM;
+		break;
+
+	case COAP_METHOD_PUT:
+	case COAP_METHOD_POST:
+		if (!cb->read) {
+			return -EINVAL;
+		}
+
+		if (config->buf_len < bytes + MIN_REQUEST_LEN) {
+			return -ENOMEM;
+		}
+
+		xfer->req_len = config->buf_len;
+		xfer->total_size = config->total_size;
+		xfer->last_num = config->total_size ?
+			(config->total_size - 1) / bytes : 0U;
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	xfer->req_len = MIN(xfer->req_len, UINT16_MAX);
+	xfer->cb = cb;
+	xfer->options = config->options;
+	xfer->num_options = config->num_options;
+	xfer->buf = config->buf;
+	xfer->method = config->method;
+	xfer->block_size = config->block_size;
+	xfer->window = config->window;
+	xfer->max_num = UNKNOWN_NUM;
+	xfer->size_num = UNKNOWN_NUM;
+	xfer->user_data = config->user_data;
+
+	return 0;
+}
+
+int coap_block_xfer_start(struct coap_block_xfer *xfer)
+{
+	int r;
+
+	if (xfer->started) {
+		return -EALREADY;
+	}
+
+	xfer->started = true;
+
+	r = fill_window(xfer);
+	if (r < 0) {
+		finish(xfer, r);
+	}
+
+	return r;
+}
+
+int coap_block_xfer_input(struct coap_block_xfer *xfer, uint8_t *data,
+			  uint16_t len)
+{
+	struct coap_block_xfer_slot *slot;
+	struct coap_packet response;
+	uint8_t token[8];
+	uint8_t tkl, type;
+	uint16_t id;
+	int r;
+
+	if (xfer->finished) {
+		return 0;
+	}
+
+	r = coap_packet_parse(&response, data, len, NULL, 0);
+	if (r < 0) {
+		NET_DBG("Invalid packet (%d)", r);
+		return 0;
+	}
+
+	type = coap_header_get_type(&response);
+	id = coap_header_get_id(&response);
+	tkl = coap_header_get_token(&response, token);
+
+	if (type == COAP_TYPE_ACK || type == COAP_TYPE_RESET) {
+		slot = slot_find_by_id(xfer, id);
+		if (!slot || slot->state != SLOT_SENT) {
+			return 0;
+		}
+
+		if (type == COAP_TYPE_RESET) {
+			r = -ECONNRESET;
+			goto error;
+		}
+
+		/* Empty ACK, the response will follow separately */
+		if (coap_header_get_code(&response) == COAP_CODE_EMPTY) {
+			slot->state = SLOT_SEPARATE;
+			slot->t0 = k_uptime_get();
+			slot->timeout = SEPARATE_TIMEOUT;
+			return 0;
+		}
+
+		if (slot != slot_find_by_token(xfer, token, tkl)) {
+			return 0;
+		}
+	} else {
+		slot = slot_find_by_token(xfer, token, tkl);
+
+		if (type == COAP_TYPE_CON) {
+			r = send_empty_ack(xfer, id);
+			if (r < 0) {
+				goto error;
+			}
+		}
+
+		if (!slot) {
+			return 0;
+		}
+	}
+
+	/* Retransmitted response */
+	if (slot->state == SLOT_DONE) {
+		return 0;
+	}
+
+	if (is_upload(xfer)) {
+		r = handle_block1(xfer, slot, &response);
+	} else {
+		r = handle_block2(xfer, slot, &response);
+	}
+
+	if (r < 0) {
+		goto error;
+	}
+
+	r = advance(xfer);
+	if (r < 0) {
+		goto error;
+	}
+
+	return 0;
+
+error:
+	finish(xfer, r);
+	return r;
+}
+
+int32_t coap_block_xfer_process(struct coap_block_xfer *xfer)
+{
+	struct coap_block_xfer_slot *slot;
+	int32_t next = INT32_MAX;
+	int64_t remaining;
+	int64_t now;
+	int i, r;
+
+	if (xfer->finished) {
+		return next;
+	}
+
+	now = k_uptime_get();
+
+	for (i = 0; i < xfer->window; i++) {
+		slot = &xfer->slots[i];
+
+		if (slot->state != SLOT_SENT && slot->state != SLOT_SEPARATE) {
+			continue;
+		}
+
+		remaining = slot->t0 + slot->timeout - now;
+		if (remaining <= 0) {
+			if (slot->retries >= MAX_RETRANSMIT) {
+				NET_DBG("Block %u timed out", slot->num);
+				r = -ETIMEDOUT;
+				goto error;
+			}
+
+			/* A request whose separate response got lost is
+			 * sent again as a new message.
+			 */
+			if (slot->state == SLOT_SEPARATE) {
+				slot->id = coap_next_id();
+				slot->state = SLOT_SENT;
+				slot->timeout = INIT_ACK_TIMEOUT;
+			} else {
+				slot->timeout <<= 1;
+			}
+
+			slot->retries++;
+			slot->t0 = now;
+
+			r = send_request(xfer, slot);
+			if (r < 0) {
+				goto error;
+			}
+
+			remaining = slot->timeout;
+		}
+
+		next = MIN(next, remaining);
+	}
+
+	return next;
+
+error:
+	finish(xfer, r);
+	return r;
+}
+
+void coap_block_xfer_abort(struct coap_block_xfer *xfer)
+{
+	finish(xfer, -ECANCELED);
+}
+
+#if defined(CONFIG_STREAM_FLASH)
+int coap_block_xfer_stream_flash_write(struct coap_block_xfer *xfer,
+				       size_t offset, const uint8_t *data,
+				       size_t len, bool last)
+{
+	struct stream_flash_ctx *ctx = xfer->user_data;
+
+	ARG_UNUSED(offset);
+
+	return stream_flash_buffered_write(ctx, data, len, last);
+}
+#endif
@@ -0,0 +1,221 @@
+/** @file
+ * @brief DNS answer cache
+ *
+ * The cache is shared by all the DNS resolver contexts.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <kernel.h>
+#include <string.h>
+#include <strings.h>
+
+#include <net/dns_resolve.h>
+
+#include "dns_cache.h"
+#include "net_stats.h"
+
+#define DNS_CACHE_NAME_LEN CONFIG_DNS_RESOLVER_CACHE_NAME_LEN
+#define DNS_CACHE_MAX_ADDRS CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS
+
+struct dns_cache_entry {
+	/** Cached addresses */
+	struct dns_addrinfo addrs[DNS_CACHE_MAX_ADDRS];
+
+	/** Uptime in milliseconds when the answer expires */
+	int64_t expires;
+
+	/** DNS name, empty if the entry is not used */
+	char name[DNS_CACHE_NAME_LEN + 1];
+
+	/** Query type */
+	enum dns_query_type type;
+
+	/** DNS_EAI_ALLDONE or DNS_EAI_NODATA */
+	enum dns_resolve_status status;
+
+	/** Number of cached addresses */
+	uint8_t count;
+};
+
+static struct dns_cache_entry dns_cache[CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES];
+static K_MUTEX_DEFINE(dns_cache_lock);
+
+static inline bool entry_is_valid(struct dns_cache_entry *entry, int64_t now)
+{
+	return entry->name[0] != '\0' && entry->expires > now;
+}
+
+static struct dns_cache_entry *entry_find(const char *name,
+					  enum dns_query_type type)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		if (dns_cache[i].name[0] != '\0' &&
+		    dns_cache[i].type == type &&
+		    !strncasecmp(dns_cache[i].name, name,
+				 sizeof(dns_cache[i].name))) {
+			return &dns_cache[i];
+		}
+	}
+
+	return NULL;
+}
+
+bool dns_cache_find(const char *name, enum dns_query_type type,
+		    dns_resolve_cb_t cb, void *user_data)
+{
+	struct dns_addrinfo addrs[DNS_CACHE_MAX_ADDRS];
+	enum dns_resolve_status status;
+	struct dns_cache_entry *entry;
+	int count = 0;
+	int i;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	entry = entry_find(name, type);
+	if (!entry || !entry_is_valid(entry, k_uptime_get())) {
+		k_mutex_unlock(&dns_cache_lock);
+
+		net_stats_update_dns_cache_miss();
+
+		return false;
+	}
+
+	/* Copy the answer so that the callback is not called with the
+	 * lock held.
+	 */
+	count = entry->count;
+	status = entry->status;
+	memcpy(addrs, entry->addrs, count * sizeof(addrs[0]));
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	net_stats_update_dns_cache_hit();
+
+	NET_DBG("Cache hit for %s type %d (%d addresses)", log_strdup(name),
+		type, count);
+
+	for (i = 0; i < count; i++) {
+		cb(DNS_EAI_INPROGRESS, &addrs[i], user_data);
+	}
+
+	cb(status, NULL, user_data);
+
+	return true;
+}
+
+void dns_cache_add(const char *name, enum dns_query_type type,
+		   enum dns_resolve_status status,
+		   const struct dns_addrinfo *addrs, int count, uint32_t ttl)
+{
+	struct dns_cache_entry *entry;
+	int64_t now;
+	int i;
+
+	if (status == DNS_EAI_NODATA) {
+		ttl = CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL;
+		count = 0;
+	} else if (status != DNS_EAI_ALLDONE || count == 0) {
+		return;
+	}
+
+	/* A zero TTL means that the answer must not be cached */
+	if (ttl == 0U || strlen(name) > DNS_CACHE_NAME_LEN) {
+		return;
+	}
+
+	ttl = MIN(ttl, CONFIG_DNS_RESOLVER_CACHE_MAX_TTL);
+	count = MIN(count, DNS_CACHE_MAX_ADDRS);
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	entry = entry_find(name, type);
+	if (!entry) {
+		/* Use a free or expired entry, or replace the one that is
+		 * closest to expiry.
+		 */
+		for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+			if (!entry_is_valid(&dns_cache[i], now)) {
+				entry = &dns_cache[i];
+				break;
+			}
+
+			if (!entry || dns_cache[i].expires < entry->expires) {
+				entry = &dns_cache[i];
+			}
+		}
+	}
+
+	strcpy(entry->name, name);
+	entry->type = type;
+	entry->status = status;
+	entry->count = count;
+	entry->expires = now + ttl * MSEC_PER_SEC;
+	memcpy(entry->addrs, addrs, count * sizeof(addrs[0]));
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	NET_DBG("Cached %s type %d status %d (%d addresses) for %u s",
+		log_strdup(name), type, status, count, ttl);
+}
+
+int dns_cache_foreach(dns_cache_cb_t cb, void *user_data)
+{
+	struct dns_cache_entry *entry;
+	int64_t now;
+	int count = 0;
+	int i;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	now = k_uptime_get();
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		entry = &dns_cache[i];
+
+		if (!entry_is_valid(entry, now)) {
+			continue;
+		}
+
+		cb(entry->name, entry->type, entry->status, entry->addrs,
+		   entry->count,
+		   (uint32_t)((entry->expires - now) / MSEC_PER_SEC),
+		   user_data);
+
+		count++;
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	return count;
+}
+
+int dns_cache_flush(void)
+{
+	int count = 0;
+	int i;
+
+	k_mutex_lock(&dns_cache_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(dns_cache); i++) {
+		if (dns_cache[i].name[0] != '\0') {
+			dns_cache[i].name[0] = '\0';
+			count++;
+		}
+	}
+
+	k_mutex_unlock(&dns_cache_lock);
+
+	return count;
+}
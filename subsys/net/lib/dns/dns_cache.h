@@ -0,0 +1,67 @@
+/** @file
+ * @brief DNS answer cache
+ *
+ * This is not to be included by the application.
+ */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _DNS_CACHE_H_
+#define _DNS_CACHE_H_
+
+#include <zephyr/types.h>
+#include <stdbool.h>
+#include <net/dns_resolve.h>
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/**
+ * @brief Resolve a name from the cache.
+ *
+ * @details If a valid answer is cached, the callback is called for every
+ * cached address and then once more to mark the end of the results, just
+ * like when the answer is received from the network.
+ *
+ * @param name DNS name to look for.
+ * @param type Query type.
+ * @param cb Result callback.
+ * @param user_data User data passed to the callback.
+ *
+ * @return True if the name was found in the cache, false otherwise.
+ */
+bool dns_cache_find(const char *name, enum dns_query_type type,
+		    dns_resolve_cb_t cb, void *user_data);
+
+/**
+ * @brief Store an answer into the cache.
+ *
+ * @param name DNS name the answer is for.
+ * @param type Query type.
+ * @param status DNS_EAI_ALLDONE if addresses were found, DNS_EAI_NODATA
+ * for a negative answer. Other answers are not cached.
+ * @param addrs Received addresses.
+ * @param count Number of received addresses.
+ * @param ttl Smallest Time-To-Live of the received addresses in seconds.
+ */
+void dns_cache_add(const char *name, enum dns_query_type type,
+		   enum dns_resolve_status status,
+		   const struct dns_addrinfo *addrs, int count, uint32_t ttl);
+#else
+static inline bool dns_cache_find(const char *name, enum dns_query_type type,
+				  dns_resolve_cb_t cb, void *user_data)
+{
+	return false;
+}
+
+static inline void dns_cache_add(const char *name, enum dns_query_type type,
+				 enum dns_resolve_status status,
+				 const struct dns_addrinfo *addrs, int count,
+				 uint32_t ttl)
+{
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
+#endif /* _DNS_CACHE_H_ */
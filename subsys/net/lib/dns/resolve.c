@@ -25,6 +25,7 @@ LOG_MODULE_REGISTER(net_dns_resolve, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <net/net_mgmt.h>
 #include <net/dns_resolve.h>
 #include "dns_pack.h"
+#include "dns_cache.h"
 
 #define DNS_SERVER_COUNT CONFIG_DNS_RESOLVER_MAX_SERVERS
 #define SERVER_COUNT     (DNS_SERVER_COUNT + DNS_MAX_MCAST_SERVERS)
@@ -360,6 +361,132 @@ static inline int get_slot_by_id(struct dns_resolve_context *ctx,
 	return -ENOENT;
 }
 
+/* Find a pending query that has sent a DNS request for the same name */
+static struct dns_pending_query *get_leader(struct dns_resolve_context *ctx,
+					    const char *query,
+					    enum dns_query_type type)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].cb && !ctx->queries[i].leader &&
+		    ctx->queries[i].query_type == type &&
+		    !strcmp(ctx->queries[i].query, query)) {
+			return &ctx->queries[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct dns_pending_query *get_follower(struct dns_resolve_context *ctx,
+					      struct dns_pending_query *leader)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].cb && ctx->queries[i].leader == leader) {
+			return &ctx->queries[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Pick the id of a query sharing the request of another one. Queries are
+ * cancelled by id and answers are matched by id, so the id must not be
+ * used by another pending query. Id 0 is reserved for cached answers.
+ */
+static uint16_t follower_id_get(struct dns_resolve_context *ctx, int idx)
+{
+	uint16_t id;
+	int i;
+
+	do {
+		id = sys_rand32_get();
+
+		for (i = 0; id != 0U && i < CONFIG_DNS_NUM_CONCUR_QUERIES;
+		     i++) {
+			if (i != idx && ctx->queries[i].cb &&
+			    ctx->queries[i].id == id) {
+				id = 0U;
+			}
+		}
+	} while (id == 0U);
+
+	return id;
+}
+
+/* Pass the result to the query and to the queries sharing its request */
+static void query_cb(struct dns_resolve_context *ctx, int idx,
+		     enum dns_resolve_status status,
+		     struct dns_addrinfo *info)
+{
+	struct dns_pending_query *query = &ctx->queries[idx];
+	int i;
+
+	query->cb(status, info, query->user_data);
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].cb && ctx->queries[i].leader == query) {
+			ctx->queries[i].cb(status, info,
+					   ctx->queries[i].user_data);
+		}
+	}
+}
+
+/* Mark the end of the results and release the query slots */
+static void query_done(struct dns_resolve_context *ctx, int idx,
+		       enum dns_resolve_status status)
+{
+	struct dns_pending_query *query = &ctx->queries[idx];
+	int i;
+
+	if (k_delayed_work_remaining_get(&query->timer) > 0) {
+		k_delayed_work_cancel(&query->timer);
+	}
+
+	query_cb(ctx, idx, status, NULL);
+
+	query->cb = NULL;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (ctx->queries[i].leader == query) {
+			ctx->queries[i].cb = NULL;
+			ctx->queries[i].leader = NULL;
+		}
+	}
+}
+
+/* Callback of a query whose caller has gone away while other queries
+ * still wait for the answer to its DNS request.
+ */
+static void orphan_cb(enum dns_resolve_status status,
+		      struct dns_addrinfo *info,
+		      void *user_data)
+{
+	ARG_UNUSED(status);
+	ARG_UNUSED(info);
+	ARG_UNUSED(user_data);
+}
+
+static void orphan_update(struct dns_resolve_context *ctx,
+			  struct dns_pending_query *orphan)
+{
+	struct dns_pending_query *follower;
+
+	follower = get_follower(ctx, orphan);
+	if (!follower) {
+		query_done(ctx, orphan - ctx->queries, DNS_EAI_CANCELED);
+		return;
+	}
+
+	/* The query name of the cancelled caller might not be valid any
+	 * more, use the one of a caller that is still waiting.
+	 */
+	orphan->query = follower->query;
+}
+
 static int dns_read(struct dns_resolve_context *ctx,
 		    struct net_pkt *pkt,
 		    struct net_buf *dns_data,
@@ -368,9 +495,13 @@ static int dns_read(struct dns_resolve_context *ctx,
 		    uint16_t *query_hash)
 {
 	struct dns_addrinfo info = { 0 };
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	struct dns_addrinfo cache_addrs[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS];
+	uint32_t cache_ttl = UINT32_MAX;
+#endif
 	/* Helper struct to track the dns msg received from the server */
 	struct dns_msg_t dns_msg;
-	uint32_t ttl; /* RR ttl, so far it is not passed to caller */
+	uint32_t ttl; /* RR ttl, only passed to the cache */
 	uint8_t *src, *addr;
 	const char *query_name;
 	int address_size;
@@ -531,8 +662,15 @@ static int dns_read(struct dns_resolve_context *ctx,
 			memcpy(addr, src, address_size);
 
 		query_known:
-			ctx->queries[query_idx].cb(DNS_EAI_INPROGRESS, &info,
-					ctx->queries[query_idx].user_data);
+			query_cb(ctx, query_idx, DNS_EAI_INPROGRESS, &info);
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+			if (items < ARRAY_SIZE(cache_addrs)) {
+				cache_addrs[items] = info;
+			}
+
+			cache_ttl = MIN(cache_ttl, ttl);
+#endif
 			items++;
 			break;
 
@@ -595,14 +733,14 @@ static int dns_read(struct dns_resolve_context *ctx,
 		ret = DNS_EAI_ALLDONE;
 	}
 
-	if (k_delayed_work_remaining_get(&ctx->queries[query_idx].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[query_idx].timer);
-	}
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	dns_cache_add(ctx->queries[query_idx].query,
+		      ctx->queries[query_idx].query_type, ret, cache_addrs,
+		      items, cache_ttl);
+#endif
 
 	/* Marks the end of the results */
-	ctx->queries[query_idx].cb(ret, NULL,
-				   ctx->queries[query_idx].user_data);
-	ctx->queries[query_idx].cb = NULL;
+	query_done(ctx, query_idx, ret);
 
 	net_pkt_unref(pkt);
 
@@ -698,13 +836,8 @@ quit:
 		goto free_buf;
 	}
 
-	if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[i].timer);
-	}
-
 	/* Marks the end of the results */
-	ctx->queries[i].cb(ret, NULL, ctx->queries[i].user_data);
-	ctx->queries[i].cb = NULL;
+	query_done(ctx, i, ret);
 
 free_buf:
 	if (dns_data) {
@@ -797,6 +930,7 @@ static int dns_resolve_cancel_with_hash(struct dns_resolve_context *ctx,
 					uint16_t query_hash,
 					const char *query_name)
 {
+	struct dns_pending_query *query, *leader;
 	int i;
 
 	i = get_slot_by_id(ctx, dns_id, query_hash);
@@ -808,12 +942,35 @@ static int dns_resolve_cancel_with_hash(struct dns_resolve_context *ctx,
 		log_strdup(query_name), ctx->queries[i].query_type,
 		query_hash);
 
-	if (k_delayed_work_remaining_get(&ctx->queries[i].timer) > 0) {
-		k_delayed_work_cancel(&ctx->queries[i].timer);
+	query = &ctx->queries[i];
+
+	if (query->leader) {
+		/* This query only shares the request of another one */
+		leader = query->leader;
+
+		query->cb(DNS_EAI_CANCELED, NULL, query->user_data);
+		query->cb = NULL;
+		query->leader = NULL;
+
+		if (leader->cb == orphan_cb) {
+			orphan_update(ctx, leader);
+		}
+
+		return 0;
 	}
 
-	ctx->queries[i].cb(DNS_EAI_CANCELED, NULL, ctx->queries[i].user_data);
-	ctx->queries[i].cb = NULL;
+	if (get_follower(ctx, query)) {
+		/* Keep the request going for the queries sharing it */
+		query->cb(DNS_EAI_CANCELED, NULL, query->user_data);
+		query->cb = orphan_cb;
+		query->user_data = NULL;
+
+		orphan_update(ctx, query);
+
+		return 0;
+	}
+
+	query_done(ctx, i, DNS_EAI_CANCELED);
 
 	return 0;
 }
@@ -876,13 +1033,19 @@ static void query_timeout(struct k_work *work)
 	struct dns_pending_query *pending_query =
 		CONTAINER_OF(work, struct dns_pending_query, timer);
 
+	struct dns_resolve_context *ctx = pending_query->ctx;
+	int i;
+
 	NET_DBG("Query timeout DNS req %u type %d hash %u", pending_query->id,
 		pending_query->query_type, pending_query->query_hash);
 
-	(void)dns_resolve_cancel_with_hash(pending_query->ctx,
-					   pending_query->id,
-					   pending_query->query_hash,
-					   pending_query->query);
+	i = get_slot_by_id(ctx, pending_query->id, pending_query->query_hash);
+	if (i < 0) {
+		return;
+	}
+
+	/* The queries sharing this request time out too */
+	query_done(ctx, i, DNS_EAI_CANCELED);
 }
 
 int dns_resolve_name(struct dns_resolve_context *ctx,
@@ -893,6 +1056,7 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 		     void *user_data,
 		     int32_t timeout)
 {
+	struct dns_pending_query *leader;
 	k_timeout_t tout;
 	struct net_buf *dns_data = NULL;
 	struct net_buf *dns_qname = NULL;
@@ -965,11 +1129,21 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	}
 
 try_resolve:
+	if (dns_cache_find(query, type, cb, user_data)) {
+		if (dns_id) {
+			*dns_id = 0U;
+		}
+
+		return 0;
+	}
+
 	i = get_cb_slot(ctx);
 	if (i < 0) {
 		return -EAGAIN;
 	}
 
+	leader = get_leader(ctx, query, type);
+
 	ctx->queries[i].cb = cb;
 	ctx->queries[i].timeout = tout;
 	ctx->queries[i].query = query;
@@ -977,9 +1151,30 @@ try_resolve:
 	ctx->queries[i].user_data = user_data;
 	ctx->queries[i].ctx = ctx;
 	ctx->queries[i].query_hash = 0;
+	ctx->queries[i].leader = NULL;
 
 	k_delayed_work_init(&ctx->queries[i].timer, query_timeout);
 
+	if (leader) {
+		/* The same name is already being resolved, share the
+		 * answer instead of sending another request. The query
+		 * still gets an id of its own so that it can be cancelled
+		 * separately.
+		 */
+		ctx->queries[i].leader = leader;
+		ctx->queries[i].query_hash = leader->query_hash;
+		ctx->queries[i].id = follower_id_get(ctx, i);
+
+		if (dns_id) {
+			*dns_id = ctx->queries[i].id;
+		}
+
+		NET_DBG("Sharing DNS req %u for %s", leader->id,
+			log_strdup(query));
+
+		return 0;
+	}
+
 	dns_data = net_buf_alloc(&dns_msg_pool, ctx->buf_timeout);
 	if (!dns_data) {
 		ret = -ENOMEM;
@@ -23,6 +23,7 @@ LOG_MODULE_REGISTER(net_http, CONFIG_NET_HTTP_LOG_LEVEL);
 #include <net/net_ip.h>
 #include <net/socket.h>
 #include <net/http_client.h>
+#include <net/tls_credentials.h>
 
 #include "net_private.h"
 
@@ -358,11 +359,11 @@ static int on_message_complete(struct http_parser *parser)
 
 	req->internal.response.message_complete = 1;
 
-	if (req->internal.response.cb) {
-		req->internal.response.cb(&req->internal.response,
-					  HTTP_DATA_FINAL,
-					  req->internal.user_data);
-	}
+	/* Stop parsing here, anything after the end of the response belongs
+	 * to the next pipelined response. The response callback is called
+	 * by http_wait_data() once the length of the response is known.
+	 */
+	http_parser_pause(parser, 1);
 
 	return 0;
 }
@@ -412,16 +413,29 @@ static void http_client_init_parser(struct http_parser *parser,
 	settings->on_url = on_url;
 }
 
-static int http_wait_data(int sock, struct http_request *req)
+/* The first *pending bytes of the receive buffer were received past the end
+ * of the previous response on this connection. On return, *pending is the
+ * number of bytes received past the end of this response, moved to the
+ * start of the receive buffer.
+ */
+static int http_wait_data(int sock, struct http_request *req, size_t *pending)
 {
+	uint8_t *recv_buf = req->internal.response.recv_buf;
+	size_t recv_buf_len = req->internal.response.recv_buf_len;
 	int total_received = 0;
 	size_t offset = 0;
+	size_t parsed;
 	int received, ret;
 
 	do {
-		received = recv(sock, req->internal.response.recv_buf + offset,
-				req->internal.response.recv_buf_len - offset,
-				0);
+		if (*pending > 0) {
+			received = *pending;
+			*pending = 0;
+		} else {
+			received = recv(sock, recv_buf + offset,
+					recv_buf_len - offset, 0);
+		}
+
 		if (received == 0) {
 			/* Connection closed */
 			LOG_DBG("Connection closed");
@@ -435,25 +449,44 @@ static int http_wait_data(int sock, struct http_request *req)
 		} else {
 			req->internal.response.data_len += received;
 
-			(void)http_parser_execute(
+			parsed = http_parser_execute(
 				&req->internal.parser,
 				&req->internal.parser_settings,
-				req->internal.response.recv_buf + offset,
-				received);
+				recv_buf + offset, received);
 		}
 
 		total_received += received;
-		offset += received;
 
-		if (offset >= req->internal.response.recv_buf_len) {
-			offset = 0;
+		if (req->internal.response.message_complete) {
+			*pending = received - parsed;
+			req->internal.response.data_len -=
+				MIN(*pending, req->internal.response.data_len);
+
+			if (req->internal.response.cb) {
+				req->internal.response.cb(
+					&req->internal.response,
+					HTTP_DATA_FINAL,
+					req->internal.user_data);
+			}
+
+			memmove(recv_buf, recv_buf + offset + parsed, *pending);
+			ret = total_received - *pending;
+			break;
 		}
 
-		if (req->internal.response.message_complete) {
-			ret = total_received;
+		if (HTTP_PARSER_ERRNO(&req->internal.parser) != HPE_OK) {
+			LOG_DBG("Parse error (%s)",
+				http_errno_name(
+				HTTP_PARSER_ERRNO(&req->internal.parser)));
+			ret = -EBADMSG;
 			break;
 		}
 
+		offset += received;
+
+		if (offset >= recv_buf_len) {
+			offset = 0;
+		}
 	} while (true);
 
 	return ret;
@@ -467,15 +500,15 @@ static void http_timeout(struct k_work *work)
 	(void)close(data->sock);
 }
 
-int http_client_req(int sock, struct http_request *req,
-		    int32_t timeout, void *user_data)
+static int http_send_request(int sock, struct http_request *req,
+			     int32_t timeout, void *user_data)
 {
 	/* Utilize the network usage by sending data in bigger blocks */
 	char send_buf[MAX_SEND_BUF_LEN];
 	const size_t send_buf_max_len = sizeof(send_buf);
 	size_t send_buf_pos = 0;
 	int total_sent = 0;
-	int ret, total_recv, i;
+	int ret, i;
 	const char *method;
 
 	if (sock < 0 || req == NULL || req->response == NULL ||
@@ -656,6 +689,19 @@ int http_client_req(int sock, struct http_request *req,
 	http_client_init_parser(&req->internal.parser,
 				&req->internal.parser_settings);
 
+	return total_sent;
+
+out:
+	return ret;
+}
+
+static int http_recv_response(int sock, struct http_request *req,
+			      size_t *pending)
+{
+	int total_recv;
+
+	req->internal.timed_out = false;
+
 	if (!K_TIMEOUT_EQ(req->internal.timeout, K_FOREVER) &&
 	    !K_TIMEOUT_EQ(req->internal.timeout, K_NO_WAIT)) {
 		k_delayed_work_init(&req->internal.work, http_timeout);
@@ -664,7 +710,7 @@ int http_client_req(int sock, struct http_request *req,
 	}
 
 	/* Request is sent, now wait data to be received */
-	total_recv = http_wait_data(sock, req);
+	total_recv = http_wait_data(sock, req, pending);
 	if (total_recv < 0) {
 		NET_DBG("Wait data failure (%d)", total_recv);
 	} else {
@@ -672,12 +718,441 @@ int http_client_req(int sock, struct http_request *req,
 	}
 
 	if (!K_TIMEOUT_EQ(req->internal.timeout, K_FOREVER) &&
-	    !K_TIMEOUT_EQ(req->internal.timeout, K_NO_WAIT)) {
-		(void)k_delayed_work_cancel(&req->internal.work);
+	    !K_TIMEOUT_EQ(req->internal.timeout, K_NO_WAIT) &&
+	    k_delayed_work_cancel(&req->internal.work) != 0) {
+		/* http_timeout() ran, or is running, and closes the socket */
+		req->internal.timed_out = true;
 	}
 
+	return total_recv;
+}
+
+int http_client_req(int sock, struct http_request *req,
+		    int32_t timeout, void *user_data)
+{
+	size_t pending = 0;
+	int total_sent;
+
+	total_sent = http_send_request(sock, req, timeout, user_data);
+	if (total_sent < 0) {
+		return total_sent;
+	}
+
+	(void)http_recv_response(sock, req, &pending);
+
 	return total_sent;
+}
+
+int http_client_req_pipeline(int sock, struct http_request *reqs[],
+			     size_t count, int32_t timeout, void *user_data)
+{
+	size_t pending = 0;
+	int ret, i;
+
+	if (reqs == NULL || count == 0) {
+		return -EINVAL;
+	}
+
+	/* Send all the requests back to back, the server answers them in
+	 * order while the later requests are still in flight.
+	 */
+	for (i = 0; i < count; i++) {
+		ret = http_send_request(sock, reqs[i], timeout, user_data);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	for (i = 0; i < count; i++) {
+		if (pending > 0) {
+			if (pending > reqs[i]->recv_buf_len) {
+				NET_DBG("Pipelined data too long (%zd)",
+					pending);
+				break;
+			}
+
+			memmove(reqs[i]->recv_buf, reqs[i - 1]->recv_buf,
+				pending);
+		}
+
+		ret = http_recv_response(sock, reqs[i], &pending);
+		if (ret < 0 || !reqs[i]->internal.response.message_complete) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+int http_client_send_chunk(int sock, const uint8_t *data, size_t len)
+{
+	char chunk_header[sizeof("ffffffff" HTTP_CRLF)];
+	int ret, header_len;
+
+	header_len = snprintk(chunk_header, sizeof(chunk_header),
+			      "%x" HTTP_CRLF, (unsigned int)len);
+
+	ret = sendall(sock, chunk_header, header_len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (len > 0) {
+		ret = sendall(sock, data, len);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	ret = sendall(sock, HTTP_CRLF, sizeof(HTTP_CRLF) - 1);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return header_len + len + sizeof(HTTP_CRLF) - 1;
+}
+
+#if defined(CONFIG_HTTP_CLIENT_POOL)
+
+#define POOL_IDLE_TIMEOUT_MS \
+	(CONFIG_HTTP_CLIENT_POOL_IDLE_TIMEOUT * MSEC_PER_SEC)
+
+struct http_client_conn {
+	/* Server this connection goes to */
+	char host[CONFIG_HTTP_CLIENT_POOL_HOST_LEN];
+	uint16_t port;
+	int sec_tag;
+
+	/* Time the connection was returned to the pool */
+	int64_t idle_since;
+
+	/* Socket, -1 if the entry is free */
+	int sock;
+
+	/* Connection handed out by http_client_pool_get() */
+	bool in_use;
+};
+
+static struct http_client_conn conn_pool[CONFIG_HTTP_CLIENT_POOL_SIZE] = {
+	[0 ... (CONFIG_HTTP_CLIENT_POOL_SIZE - 1)] = {
+		.sock = -1,
+	},
+};
+
+static K_MUTEX_DEFINE(conn_pool_lock);
+
+static bool conn_matches(struct http_client_conn *conn,
+			 const struct http_client_endpoint *ep)
+{
+	return conn->port == ep->port && conn->sec_tag == ep->sec_tag &&
+	       strcmp(conn->host, ep->host) == 0;
+}
+
+static void conn_close(struct http_client_conn *conn)
+{
+	NET_DBG("Closing connection to %s:%u (sock %d)",
+		log_strdup(conn->host), conn->port, conn->sock);
+
+	(void)close(conn->sock);
+	conn->sock = -1;
+	conn->in_use = false;
+}
+
+/* An idle connection is only worth reusing if the server did not close it
+ * meanwhile. Anything readable at this point is either the end of the
+ * stream or data we cannot make sense of. poll() is used rather than
+ * peeking, which TLS sockets do not support.
+ */
+static bool conn_alive(struct http_client_conn *conn)
+{
+	struct pollfd fds = {
+		.fd = conn->sock,
+		.events = POLLIN,
+	};
+
+	return poll(&fds, 1, 0) == 0;
+}
+
+static int conn_resolve(const struct http_client_endpoint *ep,
+			struct sockaddr *addr, socklen_t *addrlen)
+{
+	if (!net_ipaddr_parse(ep->host, strlen(ep->host), addr)) {
+#if defined(CONFIG_DNS_RESOLVER)
+		struct addrinfo hints = {
+			.ai_socktype = SOCK_STREAM,
+		};
+		struct addrinfo *res;
+		int ret;
+
+		ret = getaddrinfo(ep->host, NULL, &hints, &res);
+		if (ret != 0) {
+			NET_DBG("Cannot resolve %s (%d)",
+				log_strdup(ep->host), ret);
+			return -EHOSTUNREACH;
+		}
+
+		memcpy(addr, res->ai_addr, res->ai_addrlen);
+		freeaddrinfo(res);
+#else
+		return -EHOSTUNREACH;
+#endif
+	}
+
+	if (addr->sa_family == AF_INET6) {
+		net_sin6(addr)->sin6_port = htons(ep->port);
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		net_sin(addr)->sin_port = htons(ep->port);
+		*addrlen = sizeof(struct sockaddr_in);
+	}
+
+	return 0;
+}
+
+static int conn_open(const struct http_client_endpoint *ep)
+{
+	struct sockaddr addr;
+	socklen_t addrlen;
+	int sock, ret;
+
+	ret = conn_resolve(ep, &addr, &addrlen);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (ep->sec_tag == HTTP_CLIENT_NO_TLS) {
+		sock = socket(addr.sa_family, SOCK_STREAM, IPPROTO_TCP);
+	} else {
+#if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
+		sec_tag_t sec_tag_list[] = { ep->sec_tag };
+
+		sock = socket(addr.sa_family, SOCK_STREAM, IPPROTO_TLS_1_2);
+		if (sock >= 0 &&
+		    (setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST,
+				sec_tag_list, sizeof(sec_tag_list)) < 0 ||
+		     setsockopt(sock, SOL_TLS, TLS_HOSTNAME, ep->host,
+				strlen(ep->host) + 1) < 0)) {
+			ret = -errno;
+			goto fail;
+		}
+#else
+		return -EPROTONOSUPPORT;
+#endif
+	}
+
+	if (sock < 0) {
+		return -errno;
+	}
+
+	if (connect(sock, &addr, addrlen) < 0) {
+		ret = -errno;
+		goto fail;
+	}
+
+	NET_DBG("New connection to %s:%u (sock %d)", log_strdup(ep->host),
+		ep->port, sock);
+
+	return sock;
+
+fail:
+	NET_DBG("Cannot connect to %s:%u (%d)", log_strdup(ep->host),
+		ep->port, ret);
+	(void)close(sock);
+	return ret;
+}
+
+static int pool_get(const struct http_client_endpoint *ep, bool *reused)
+{
+	struct http_client_conn *conn, *free_conn = NULL, *lru = NULL;
+	int64_t now = k_uptime_get();
+	int sock, i;
+
+	if (ep == NULL || ep->host == NULL ||
+	    strlen(ep->host) >= CONFIG_HTTP_CLIENT_POOL_HOST_LEN) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&conn_pool_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(conn_pool); i++) {
+		conn = &conn_pool[i];
+
+		if (conn->sock >= 0 && !conn->in_use &&
+		    now - conn->idle_since >= POOL_IDLE_TIMEOUT_MS) {
+			conn_close(conn);
+		}
+
+		if (conn->sock < 0) {
+			if (!conn->in_use && !free_conn) {
+				free_conn = conn;
+			}
+
+			continue;
+		}
+
+		if (conn->in_use) {
+			continue;
+		}
+
+		if (conn_matches(conn, ep)) {
+			if (conn_alive(conn)) {
+				conn->in_use = true;
+				k_mutex_unlock(&conn_pool_lock);
+
+				*reused = true;
+				return conn->sock;
+			}
+
+			conn_close(conn);
+
+			if (!free_conn) {
+				free_conn = conn;
+			}
+
+			continue;
+		}
+
+		if (!lru || conn->idle_since < lru->idle_since) {
+			lru = conn;
+		}
+	}
+
+	/* Make room by dropping the connection idle for the longest time */
+	if (!free_conn && lru) {
+		conn_close(lru);
+		free_conn = lru;
+	}
+
+	if (!free_conn) {
+		k_mutex_unlock(&conn_pool_lock);
+		return -ENOMEM;
+	}
+
+	/* Reserve the entry while connecting */
+	free_conn->in_use = true;
+	k_mutex_unlock(&conn_pool_lock);
+
+	sock = conn_open(ep);
+
+	k_mutex_lock(&conn_pool_lock, K_FOREVER);
+
+	if (sock < 0) {
+		free_conn->in_use = false;
+	} else {
+		strcpy(free_conn->host, ep->host);
+		free_conn->port = ep->port;
+		free_conn->sec_tag = ep->sec_tag;
+		free_conn->sock = sock;
+	}
+
+	k_mutex_unlock(&conn_pool_lock);
+
+	*reused = false;
+	return sock;
+}
+
+int http_client_pool_get(const struct http_client_endpoint *ep)
+{
+	bool reused;
+
+	return pool_get(ep, &reused);
+}
+
+/* If closed is set, the socket was already closed by a request timeout and
+ * its number may have been reused by now, so it must not be closed again.
+ */
+static int pool_put(int sock, bool reuse, bool closed)
+{
+	struct http_client_conn *conn;
+	int i, ret = -ENOENT;
+
+	k_mutex_lock(&conn_pool_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(conn_pool); i++) {
+		conn = &conn_pool[i];
+
+		if (conn->sock != sock || !conn->in_use) {
+			continue;
+		}
+
+		if (closed) {
+			conn->sock = -1;
+			conn->in_use = false;
+		} else if (reuse) {
+			conn->in_use = false;
+			conn->idle_since = k_uptime_get();
+		} else {
+			conn_close(conn);
+		}
+
+		ret = 0;
+		break;
+	}
+
+	k_mutex_unlock(&conn_pool_lock);
 
-out:
 	return ret;
 }
+
+int http_client_pool_put(int sock, bool reuse)
+{
+	return pool_put(sock, reuse, false);
+}
+
+void http_client_pool_flush(void)
+{
+	int i;
+
+	k_mutex_lock(&conn_pool_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(conn_pool); i++) {
+		if (conn_pool[i].sock >= 0 && !conn_pool[i].in_use) {
+			conn_close(&conn_pool[i]);
+		}
+	}
+
+	k_mutex_unlock(&conn_pool_lock);
+}
+
+int http_client_pool_req(const struct http_client_endpoint *ep,
+			 struct http_request *req, int32_t timeout,
+			 void *user_data)
+{
+	size_t pending;
+	bool reused, reuse, timed_out;
+	int sock, total_sent, total_recv;
+
+	do {
+		sock = pool_get(ep, &reused);
+		if (sock < 0) {
+			return sock;
+		}
+
+		pending = 0;
+		total_recv = 0;
+		timed_out = false;
+
+		total_sent = http_send_request(sock, req, timeout, user_data);
+		if (total_sent >= 0) {
+			total_recv = http_recv_response(sock, req, &pending);
+			timed_out = req->internal.timed_out;
+		}
+
+		reuse = total_sent >= 0 && total_recv > 0 && pending == 0 &&
+			req->internal.response.message_complete &&
+			http_should_keep_alive(&req->internal.parser);
+
+		(void)pool_put(sock, reuse, timed_out);
+
+		/* The server may have closed a reused connection just as the
+		 * request was sent, try once more on a new connection unless
+		 * the request timed out or the payload callback cannot be
+		 * replayed.
+		 */
+	} while (reused && total_recv <= 0 && !timed_out &&
+		 req->payload_cb == NULL && total_sent != -EINVAL);
+
+	return total_sent;
+}
+
+#endif /* CONFIG_HTTP_CLIENT_POOL */
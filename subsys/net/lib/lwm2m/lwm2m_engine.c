@@ -45,6 +45,9 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #ifdef CONFIG_LWM2M_RW_JSON_SUPPORT
 #include "lwm2m_rw_json.h"
 #endif
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+#include "lwm2m_rw_senml_cbor.h"
+#endif
 #ifdef CONFIG_LWM2M_RD_CLIENT_SUPPORT
 #include "lwm2m_rd_client.h"
 #endif
@@ -69,6 +72,9 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 #if defined(CONFIG_LWM2M_RW_JSON_SUPPORT)
 #define REG_PREFACE		"</>" RESOURCE_TYPE \
 				";ct=" STRINGIFY(LWM2M_FORMAT_OMA_JSON)
+#elif defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+#define REG_PREFACE		"</>" RESOURCE_TYPE \
+				";ct=" STRINGIFY(LWM2M_FORMAT_APP_SENML_CBOR)
 #else
 #define REG_PREFACE		""
 #endif
@@ -93,6 +99,7 @@ struct observe_node {
 	uint32_t counter;
 	uint16_t format;
 	uint8_t  tkl;
+	uint8_t  due;
 };
 
 struct notification_attrs {
@@ -109,6 +116,9 @@ static struct observe_node observe_node_data[CONFIG_LWM2M_ENGINE_MAX_OBSERVER];
 
 #define MAX_PERIODIC_SERVICE	10
 
+/* Objects and object instances are indexed by ID in hash tables */
+#define ENGINE_HASH_SIZE	BIT(CONFIG_LWM2M_ENGINE_OBJ_HASH_BITS)
+
 struct service_node {
 	sys_snode_t node;
 	k_work_handler_t service_work;
@@ -120,6 +130,8 @@ static struct service_node service_node_data[MAX_PERIODIC_SERVICE];
 
 static sys_slist_t engine_obj_list;
 static sys_slist_t engine_obj_inst_list;
+static sys_slist_t engine_obj_hash[ENGINE_HASH_SIZE];
+static sys_slist_t engine_obj_inst_hash[ENGINE_HASH_SIZE];
 static sys_slist_t engine_observer_list;
 static sys_slist_t engine_service_list;
 
@@ -602,22 +614,39 @@ static void engine_remove_observer_by_id(uint16_t obj_id, int32_t obj_inst_id)
 
 /* engine object */
 
+static inline sys_slist_t *engine_hash_bucket(sys_slist_t *table,
+					      uint16_t obj_id,
+					      uint16_t obj_inst_id)
+{
+	uint32_t key = ((uint32_t)obj_id << 16) | obj_inst_id;
+
+	/* Fibonacci hashing, keep bits from the middle of the product */
+	return &table[((key * 2654435769U) >> 16) & (ENGINE_HASH_SIZE - 1)];
+}
+
 void lwm2m_register_obj(struct lwm2m_engine_obj *obj)
 {
 	sys_slist_append(&engine_obj_list, &obj->node);
+	sys_slist_prepend(engine_hash_bucket(engine_obj_hash, obj->obj_id, 0),
+			  &obj->hash_node);
 }
 
 void lwm2m_unregister_obj(struct lwm2m_engine_obj *obj)
 {
 	engine_remove_observer_by_id(obj->obj_id, -1);
 	sys_slist_find_and_remove(&engine_obj_list, &obj->node);
+	sys_slist_find_and_remove(engine_hash_bucket(engine_obj_hash,
+						     obj->obj_id, 0),
+				  &obj->hash_node);
 }
 
 static struct lwm2m_engine_obj *get_engine_obj(int obj_id)
 {
 	struct lwm2m_engine_obj *obj;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_list, obj, node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(engine_hash_bucket(engine_obj_hash,
+							obj_id, 0),
+				     obj, hash_node) {
 		if (obj->obj_id == obj_id) {
 			return obj;
 		}
@@ -642,11 +671,79 @@ lwm2m_get_engine_obj_field(struct lwm2m_engine_obj *obj, int res_id)
 	return NULL;
 }
 
+/*
+ * Resources are normally laid out in the order of the object fields, so the
+ * field index is tried first and the resource array only scanned otherwise.
+ */
+struct lwm2m_engine_res *
+lwm2m_get_engine_res(struct lwm2m_engine_obj_inst *obj_inst, int res_id,
+		     struct lwm2m_engine_obj_field **obj_field)
+{
+	struct lwm2m_engine_obj_field *of;
+	int i;
+
+	of = lwm2m_get_engine_obj_field(obj_inst->obj, res_id);
+	if (obj_field) {
+		*obj_field = of;
+	}
+
+	if (!obj_inst->resources) {
+		return NULL;
+	}
+
+	if (of) {
+		i = of - obj_inst->obj->fields;
+		if (i < obj_inst->resource_count &&
+		    obj_inst->resources[i].res_id == res_id) {
+			return &obj_inst->resources[i];
+		}
+	}
+
+	for (i = 0; i < obj_inst->resource_count; i++) {
+		if (obj_inst->resources[i].res_id == res_id) {
+			return &obj_inst->resources[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct lwm2m_engine_obj_field *
+get_engine_res_field(struct lwm2m_engine_obj_inst *obj_inst, int index)
+{
+	struct lwm2m_engine_obj *obj = obj_inst->obj;
+	int res_id = obj_inst->resources[index].res_id;
+
+	if (index < obj->field_count && obj->fields[index].res_id == res_id) {
+		return &obj->fields[index];
+	}
+
+	return lwm2m_get_engine_obj_field(obj, res_id);
+}
+
 /* engine object instance */
 
 static void engine_register_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 {
-	sys_slist_append(&engine_obj_inst_list, &obj_inst->node);
+	struct lwm2m_engine_obj_inst *iter, *prev = NULL;
+
+	/* keep the list sorted so that instances are walked in order */
+	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, iter, node) {
+		if (iter->obj->obj_id > obj_inst->obj->obj_id ||
+		    (iter->obj->obj_id == obj_inst->obj->obj_id &&
+		     iter->obj_inst_id > obj_inst->obj_inst_id)) {
+			break;
+		}
+
+		prev = iter;
+	}
+
+	sys_slist_insert(&engine_obj_inst_list, prev ? &prev->node : NULL,
+			 &obj_inst->node);
+	sys_slist_prepend(engine_hash_bucket(engine_obj_inst_hash,
+					     obj_inst->obj->obj_id,
+					     obj_inst->obj_inst_id),
+			  &obj_inst->hash_node);
 }
 
 static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
@@ -654,6 +751,10 @@ static void engine_unregister_obj_inst(struct lwm2m_engine_obj_inst *obj_inst)
 	engine_remove_observer_by_id(
 			obj_inst->obj->obj_id, obj_inst->obj_inst_id);
 	sys_slist_find_and_remove(&engine_obj_inst_list, &obj_inst->node);
+	sys_slist_find_and_remove(engine_hash_bucket(engine_obj_inst_hash,
+						     obj_inst->obj->obj_id,
+						     obj_inst->obj_inst_id),
+				  &obj_inst->hash_node);
 }
 
 static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
@@ -661,8 +762,9 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 {
 	struct lwm2m_engine_obj_inst *obj_inst;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
+	SYS_SLIST_FOR_EACH_CONTAINER(engine_hash_bucket(engine_obj_inst_hash,
+							obj_id, obj_inst_id),
+				     obj_inst, hash_node) {
 		if (obj_inst->obj->obj_id == obj_id &&
 		    obj_inst->obj_inst_id == obj_inst_id) {
 			return obj_inst;
@@ -672,20 +774,37 @@ static struct lwm2m_engine_obj_inst *get_engine_obj_inst(int obj_id,
 	return NULL;
 }
 
+struct lwm2m_engine_obj_inst *lwm2m_get_engine_obj_inst(int obj_id,
+							int obj_inst_id)
+{
+	return get_engine_obj_inst(obj_id, obj_inst_id);
+}
+
 static struct lwm2m_engine_obj_inst *
 next_engine_obj_inst(int obj_id, int obj_inst_id)
 {
 	struct lwm2m_engine_obj_inst *obj_inst, *next = NULL;
 
-	SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
-				     node) {
-		if (obj_inst->obj->obj_id == obj_id &&
-		    obj_inst->obj_inst_id > obj_inst_id &&
-		    (!next || next->obj_inst_id > obj_inst->obj_inst_id)) {
-			next = obj_inst;
+	obj_inst = obj_inst_id < 0 ? NULL :
+		   get_engine_obj_inst(obj_id, obj_inst_id);
+	if (obj_inst) {
+		next = SYS_SLIST_PEEK_NEXT_CONTAINER(obj_inst, node);
+	} else {
+		SYS_SLIST_FOR_EACH_CONTAINER(&engine_obj_inst_list, obj_inst,
+					     node) {
+			if (obj_inst->obj->obj_id > obj_id ||
+			    (obj_inst->obj->obj_id == obj_id &&
+			     obj_inst->obj_inst_id > obj_inst_id)) {
+				next = obj_inst;
+				break;
+			}
 		}
 	}
 
+	if (next && next->obj->obj_id != obj_id) {
+		return NULL;
+	}
+
 	return next;
 }
 
@@ -1140,6 +1259,12 @@ static int select_writer(struct lwm2m_output_context *out, uint16_t accept)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		out->writer = &senml_cbor_writer;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", accept);
 		return -ENOMSG;
@@ -1171,6 +1296,12 @@ static int select_reader(struct lwm2m_input_context *in, uint16_t format)
 		break;
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		in->reader = &senml_cbor_reader;
+		break;
+#endif
+
 	default:
 		LOG_WRN("Unknown content type %u", format);
 		return -ENOMSG;
@@ -1274,19 +1405,12 @@ static int path_to_objs(const struct lwm2m_obj_path *path,
 		return -EINVAL;
 	}
 
-	of = lwm2m_get_engine_obj_field(oi->obj, path->res_id);
+	r = lwm2m_get_engine_res(oi, path->res_id, &of);
 	if (!of) {
 		LOG_ERR("obj field %d not found", path->res_id);
 		return -ENOENT;
 	}
 
-	for (i = 0; i < oi->resource_count; i++) {
-		if (oi->resources[i].res_id == path->res_id) {
-			r = &oi->resources[i];
-			break;
-		}
-	}
-
 	if (!r) {
 		LOG_ERR("resource %d not found", path->res_id);
 		return -ENOENT;
@@ -2885,6 +3009,11 @@ static int do_read_op(struct lwm2m_message *msg, uint16_t content_format)
 		return do_read_op_json(msg, content_format);
 #endif
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_read_op_senml_cbor(msg, content_format);
+#endif
+
 	default:
 		LOG_ERR("Unsupported content-format: %u", content_format);
 		return -ENOMSG;
@@ -2892,45 +3021,29 @@ static int do_read_op(struct lwm2m_message *msg, uint16_t content_format)
 	}
 }
 
-int lwm2m_perform_read_op(struct lwm2m_message *msg, uint16_t content_format)
+static struct lwm2m_engine_obj_inst *
+first_read_obj_inst(const struct lwm2m_obj_path *path)
 {
-	struct lwm2m_engine_obj_inst *obj_inst = NULL;
-	struct lwm2m_engine_res *res = NULL;
-	struct lwm2m_engine_obj_field *obj_field;
-	struct lwm2m_obj_path temp_path;
-	int ret = 0, index;
-	uint8_t num_read = 0U;
-
-	if (msg->path.level >= 2U) {
-		obj_inst = get_engine_obj_inst(msg->path.obj_id,
-					       msg->path.obj_inst_id);
-	} else if (msg->path.level == 1U) {
-		/* find first obj_inst with path's obj_id */
-		obj_inst = next_engine_obj_inst(msg->path.obj_id, -1);
-	}
-
-	if (!obj_inst) {
-		return -ENOENT;
+	if (path->level >= 2U) {
+		return get_engine_obj_inst(path->obj_id, path->obj_inst_id);
 	}
 
-	/* set output content-format */
-	ret = coap_append_option_int(msg->out.out_cpkt,
-				     COAP_OPTION_CONTENT_FORMAT,
-				     content_format);
-	if (ret < 0) {
-		LOG_ERR("Error setting response content-format: %d", ret);
-		return ret;
+	if (path->level == 1U) {
+		/* find first obj_inst with path's obj_id */
+		return next_engine_obj_inst(path->obj_id, -1);
 	}
 
-	ret = coap_packet_append_payload_marker(msg->out.out_cpkt);
-	if (ret < 0) {
-		LOG_ERR("Error appending payload marker: %d", ret);
-		return ret;
-	}
+	return NULL;
+}
 
-	/* store original path values so we can change them during processing */
-	memcpy(&temp_path, &msg->path, sizeof(temp_path));
-	engine_put_begin(&msg->out, &msg->path);
+/* Read the resources under msg->path, starting at obj_inst */
+static int read_path(struct lwm2m_message *msg,
+		     struct lwm2m_engine_obj_inst *obj_inst)
+{
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_obj_field *obj_field;
+	int ret = 0, index;
+	uint8_t num_read = 0U;
 
 	while (obj_inst) {
 		if (!obj_inst->resources || obj_inst->resource_count == 0U) {
@@ -2960,8 +3073,7 @@ int lwm2m_perform_read_op(struct lwm2m_message *msg, uint16_t content_format)
 			 * resource.
 			 */
 			msg->path.res_id = res->res_id;
-			obj_field = lwm2m_get_engine_obj_field(obj_inst->obj,
-							       res->res_id);
+			obj_field = get_engine_res_field(obj_inst, index);
 			if (!obj_field) {
 				ret = -ENOENT;
 			} else if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_R)) {
@@ -3012,17 +3124,105 @@ move_forward:
 		}
 	}
 
+	/* did not read anything even if we should have - on single item */
+	if (ret == 0 && num_read == 0U && msg->path.level == 3U) {
+		return -ENOENT;
+	}
+
+	return ret;
+}
+
+static int append_read_header(struct lwm2m_message *msg,
+			      uint16_t content_format)
+{
+	int ret;
+
+	/* set output content-format */
+	ret = coap_append_option_int(msg->out.out_cpkt,
+				     COAP_OPTION_CONTENT_FORMAT,
+				     content_format);
+	if (ret < 0) {
+		LOG_ERR("Error setting response content-format: %d", ret);
+		return ret;
+	}
+
+	ret = coap_packet_append_payload_marker(msg->out.out_cpkt);
+	if (ret < 0) {
+		LOG_ERR("Error appending payload marker: %d", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+int lwm2m_perform_read_op(struct lwm2m_message *msg, uint16_t content_format)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_obj_path temp_path;
+	int ret;
+
+	obj_inst = first_read_obj_inst(&msg->path);
+	if (!obj_inst) {
+		return -ENOENT;
+	}
+
+	ret = append_read_header(msg, content_format);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* store original path values so we can change them during processing */
+	memcpy(&temp_path, &msg->path, sizeof(temp_path));
+	engine_put_begin(&msg->out, &msg->path);
+
+	ret = read_path(msg, obj_inst);
+
 	engine_put_end(&msg->out, &msg->path);
 
 	/* restore original path values */
 	memcpy(&msg->path, &temp_path, sizeof(temp_path));
 
-	/* did not read anything even if we should have - on single item */
-	if (ret == 0 && num_read == 0U && msg->path.level == 3U) {
-		return -ENOENT;
+	return ret;
+}
+
+int lwm2m_perform_composite_read_op(struct lwm2m_message *msg,
+				    uint16_t content_format,
+				    const struct lwm2m_obj_path *paths,
+				    int path_count)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_obj_path temp_path;
+	int ret, i;
+
+	ret = append_read_header(msg, content_format);
+	if (ret < 0) {
+		return ret;
 	}
 
-	return ret;
+	memcpy(&temp_path, &msg->path, sizeof(temp_path));
+	engine_put_begin(&msg->out, &msg->path);
+
+	for (i = 0; i < path_count; i++) {
+		memcpy(&msg->path, &paths[i], sizeof(msg->path));
+
+		/* paths that cannot be read are left out of the result */
+		obj_inst = first_read_obj_inst(&msg->path);
+		if (!obj_inst) {
+			continue;
+		}
+
+		ret = read_path(msg, obj_inst);
+		if (ret < 0) {
+			LOG_DBG("composite read %u/%u/%u(%u) error: %d",
+				paths[i].obj_id, paths[i].obj_inst_id,
+				paths[i].res_id, paths[i].level, ret);
+		}
+	}
+
+	memcpy(&msg->path, &temp_path, sizeof(temp_path));
+	engine_put_end(&msg->out, &msg->path);
+
+	return 0;
 }
 
 static int print_attr(struct lwm2m_output_context *out,
@@ -3288,6 +3488,11 @@ static int do_write_op(struct lwm2m_message *msg,
 		return do_write_op_json(msg);
 #endif
 
+#ifdef CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT
+	case LWM2M_FORMAT_APP_SENML_CBOR:
+		return do_write_op_senml_cbor(msg);
+#endif
+
 	default:
 		LOG_ERR("Unsupported format: %u", format);
 		return -ENOMSG;
@@ -3336,6 +3541,7 @@ static int handle_request(struct coap_packet *request,
 	uint16_t payload_len = 0U;
 	bool last_block = false;
 	bool ignore = false;
+	bool composite = false;
 
 	/* set CoAP request / message */
 	msg->in.in_cpkt = request;
@@ -3378,6 +3584,13 @@ static int handle_request(struct coap_packet *request,
 			}
 
 			return 0;
+#endif
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+		/* Read-Composite and Write-Composite address the root path */
+		case COAP_METHOD_FETCH:
+		case COAP_METHOD_IPATCH:
+			composite = true;
+			break;
 #endif
 		default:
 			r = -EPERM;
@@ -3385,8 +3598,10 @@ static int handle_request(struct coap_packet *request,
 		}
 	}
 
+	if (composite) {
+		(void)memset(&msg->path, 0, sizeof(msg->path));
 	/* check for .well-known/core URI query (DISCOVER) */
-	if (r == 2 &&
+	} else if (r == 2 &&
 	    (options[0].len == 11U &&
 	     strncmp(options[0].value, ".well-known", 11) == 0) &&
 	    (options[1].len == 4U &&
@@ -3433,17 +3648,26 @@ static int handle_request(struct coap_packet *request,
 	r = coap_find_options(msg->in.in_cpkt, COAP_OPTION_ACCEPT, options, 1);
 	if (r > 0) {
 		accept = coap_option_value_to_int(&options[0]);
+	} else if (composite) {
+		accept = LWM2M_FORMAT_APP_SENML_CBOR;
 	} else {
 		LOG_DBG("No accept option given. Assume OMA TLV.");
 		accept = LWM2M_FORMAT_OMA_TLV;
 	}
 
+	/* only SenML CBOR can carry the paths of a composite operation */
+	if (composite && (format != LWM2M_FORMAT_APP_SENML_CBOR ||
+			  accept != LWM2M_FORMAT_APP_SENML_CBOR)) {
+		r = -ENOMSG;
+		goto error;
+	}
+
 	r = select_writer(&msg->out, accept);
 	if (r < 0) {
 		goto error;
 	}
 
-	if (!well_known) {
+	if (!well_known && !composite) {
 		/* find registered obj */
 		obj = get_engine_obj(msg->path.obj_id);
 		if (!obj) {
@@ -3506,6 +3730,26 @@ static int handle_request(struct coap_packet *request,
 		msg->code = COAP_RESPONSE_CODE_DELETED;
 		break;
 
+	case COAP_METHOD_FETCH:
+		if (!composite) {
+			r = -EPERM;
+			goto error;
+		}
+
+		msg->operation = LWM2M_OP_READ;
+		msg->code = COAP_RESPONSE_CODE_CONTENT;
+		break;
+
+	case COAP_METHOD_IPATCH:
+		if (!composite) {
+			r = -EPERM;
+			goto error;
+		}
+
+		msg->operation = LWM2M_OP_WRITE;
+		msg->code = COAP_RESPONSE_CODE_CHANGED;
+		break;
+
 	default:
 		break;
 	}
@@ -3619,6 +3863,14 @@ static int handle_request(struct coap_packet *request,
 				}
 			}
 
+#if defined(CONFIG_LWM2M_RW_SENML_CBOR_SUPPORT)
+			if (composite) {
+				r = do_composite_read_op_senml_cbor(msg,
+								    accept);
+				break;
+			}
+#endif
+
 			r = do_read_op(msg, accept);
 			break;
 
@@ -4066,11 +4318,49 @@ int lwm2m_engine_add_service(k_work_handler_t service, uint32_t period_ms)
 	return 0;
 }
 
+#define NOTIFY_NONE	0
+#define NOTIFY_MANUAL	1
+#define NOTIFY_AUTO	2
+
+static uint8_t notify_due(struct observe_node *obs, int64_t timestamp,
+			  int64_t window)
+{
+	int64_t pmin_timestamp = obs->last_timestamp +
+				 MSEC_PER_SEC * obs->min_period_sec;
+	int64_t pmax_timestamp = obs->last_timestamp +
+				 MSEC_PER_SEC * obs->max_period_sec;
+
+	/*
+	 * manual notify requirements:
+	 * - event_timestamp > last_timestamp
+	 * - current timestamp > last_timestamp + min_period_sec
+	 */
+	if (obs->event_timestamp > obs->last_timestamp &&
+	    timestamp > pmin_timestamp) {
+		return NOTIFY_MANUAL;
+	}
+
+	/*
+	 * automatic time-based notify requirements:
+	 * - current timestamp > last_timestamp + max_period_sec
+	 * - or, when batched with other notifications, current timestamp
+	 *   within window of it and past last_timestamp + min_period_sec
+	 */
+	if (timestamp > pmax_timestamp ||
+	    (window > 0 && timestamp + window > pmax_timestamp &&
+	     timestamp > pmin_timestamp)) {
+		return NOTIFY_AUTO;
+	}
+
+	return NOTIFY_NONE;
+}
+
 static int lwm2m_engine_service(void)
 {
-	struct observe_node *obs;
+	struct observe_node *obs, *iter;
 	struct service_node *srv;
 	int64_t timestamp, service_due_timestamp;
+	bool any_due = false;
 
 	/*
 	 * 1. scan the observer list
@@ -4080,27 +4370,45 @@ static int lwm2m_engine_service(void)
 	 */
 	timestamp = k_uptime_get();
 	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
-		/*
-		 * manual notify requirements:
-		 * - event_timestamp > last_timestamp
-		 * - current timestamp > last_timestamp + min_period_sec
-		 */
-		if (obs->event_timestamp > obs->last_timestamp &&
-		    timestamp > obs->last_timestamp +
-				MSEC_PER_SEC * obs->min_period_sec) {
-			obs->last_timestamp = k_uptime_get();
-			generate_notify_message(obs, true);
+		obs->due = notify_due(obs, timestamp, 0);
+		any_due |= obs->due != NOTIFY_NONE;
+	}
 
-		/*
-		 * automatic time-based notify requirements:
-		 * - current timestamp > last_timestamp + max_period_sec
-		 */
-		} else if (timestamp > obs->last_timestamp +
-				MSEC_PER_SEC * obs->max_period_sec) {
-			obs->last_timestamp = k_uptime_get();
-			generate_notify_message(obs, false);
+	/*
+	 * Time-based notifications of a context that is about to send
+	 * anyway are brought forward, so that they go out in the same
+	 * burst instead of waking the radio up again shortly after.
+	 */
+	if (any_due && CONFIG_LWM2M_ENGINE_NOTIFY_BATCH_WINDOW > 0) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
+			if (obs->due != NOTIFY_NONE) {
+				continue;
+			}
+
+			SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list,
+						     iter, node) {
+				if (iter->ctx == obs->ctx &&
+				    iter->due != NOTIFY_NONE) {
+					break;
+				}
+			}
+
+			if (iter) {
+				obs->due = notify_due(obs, timestamp,
+					MSEC_PER_SEC *
+					CONFIG_LWM2M_ENGINE_NOTIFY_BATCH_WINDOW);
+			}
 		}
+	}
 
+	SYS_SLIST_FOR_EACH_CONTAINER(&engine_observer_list, obs, node) {
+		if (obs->due == NOTIFY_NONE) {
+			continue;
+		}
+
+		obs->last_timestamp = k_uptime_get();
+		generate_notify_message(obs, obs->due == NOTIFY_MANUAL);
+		obs->due = NOTIFY_NONE;
 	}
 
 	timestamp = k_uptime_get();
@@ -4273,6 +4581,11 @@ static void socket_receive_loop(void)
 
 			in_buf[len] = 0U;
 
+			if (sock_ctx[i]->recv_cb) {
+				sock_ctx[i]->recv_cb(sock_ctx[i], in_buf, len);
+				continue;
+			}
+
 			lwm2m_udp_receive(sock_ctx[i], in_buf, len, &from_addr,
 					  handle_request);
 		}
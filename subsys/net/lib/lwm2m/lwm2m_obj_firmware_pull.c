@@ -17,6 +17,7 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 
 #include <net/http_parser.h>
 #include <net/socket.h>
+#include <net/coap_block_xfer.h>
 
 #include "lwm2m_object.h"
 #include "lwm2m_engine.h"
@@ -25,15 +26,28 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME);
 
 #define NETWORK_INIT_TIMEOUT	K_SECONDS(10)
 #define NETWORK_CONNECT_TIMEOUT	K_SECONDS(10)
-#define PACKET_TRANSFER_RETRY_MAX	3
+
+/* Room for the header and the options of a block request */
+#define REQUEST_LEN		(URI_LEN + 64)
+#define MAX_URI_OPTIONS		16
+
+BUILD_ASSERT(CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_WINDOW <=
+	     CONFIG_COAP_BLOCK_XFER_WINDOW_MAX,
+	     "Firmware pull window exceeds the CoAP block-wise window");
 
 static struct k_work firmware_work;
+static struct k_delayed_work firmware_retransmit_work;
+static K_MUTEX_DEFINE(firmware_lock);
 static char firmware_uri[URI_LEN];
 static struct lwm2m_ctx firmware_ctx = {
 	.sock_fd = -1
 };
-static int firmware_retry;
 static struct coap_block_context firmware_block_ctx;
+static struct coap_block_xfer firmware_xfer;
+static struct coap_block_xfer_option firmware_options[MAX_URI_OPTIONS];
+static uint8_t firmware_buf[REQUEST_LEN +
+			    CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_WINDOW *
+			    CONFIG_LWM2M_COAP_BLOCK_SIZE];
 
 #if defined(CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_COAP_PROXY_SUPPORT)
 #define COAP2COAP_PROXY_URI_PATH	"coap2coap"
@@ -42,17 +56,16 @@ static struct coap_block_context firmware_block_ctx;
 static char proxy_uri[URI_LEN];
 #endif
 
-static void do_transmit_timeout_cb(struct lwm2m_message *msg);
-
 static void set_update_result_from_error(int error_code)
 {
 	if (error_code == -ENOMEM) {
 		lwm2m_firmware_set_update_result(RESULT_OUT_OF_MEM);
 	} else if (error_code == -ENOSPC) {
 		lwm2m_firmware_set_update_result(RESULT_NO_STORAGE);
-	} else if (error_code == -EFAULT) {
+	} else if (error_code == -EFAULT || error_code == -EBADMSG) {
 		lwm2m_firmware_set_update_result(RESULT_INTEGRITY_FAILED);
-	} else if (error_code == -ENOMSG) {
+	} else if (error_code == -ENOMSG || error_code == -ETIMEDOUT ||
+		   error_code == -ECONNRESET) {
 		lwm2m_firmware_set_update_result(RESULT_CONNECTION_LOST);
 	} else if (error_code == -ENOTSUP) {
 		lwm2m_firmware_set_update_result(RESULT_INVALID_URI);
@@ -63,11 +76,25 @@ static void set_update_result_from_error(int error_code)
 	}
 }
 
-static int transfer_request(struct coap_block_context *ctx,
-			    uint8_t *token, uint8_t tkl,
-			    coap_reply_t reply_cb)
+/* Append a request option, all of them point into firmware_uri */
+static int add_option(size_t *count, uint16_t code, const char *value,
+		      uint16_t len)
+{
+	if (*count >= ARRAY_SIZE(firmware_options)) {
+		LOG_ERR("Too many URI options");
+		return -ENOTSUP;
+	}
+
+	firmware_options[*count].code = code;
+	firmware_options[*count].value = value;
+	firmware_options[*count].len = len;
+	(*count)++;
+
+	return 0;
+}
+
+static int transfer_options(size_t *count)
 {
-	struct lwm2m_message *msg;
 	int ret;
 	char *cursor;
 #if !defined(CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_COAP_PROXY_SUPPORT)
@@ -76,25 +103,7 @@ static int transfer_request(struct coap_block_context *ctx,
 	char *next_slash;
 #endif
 
-	msg = lwm2m_get_message(&firmware_ctx);
-	if (!msg) {
-		LOG_ERR("Unable to get a lwm2m message!");
-		return -ENOMEM;
-	}
-
-	msg->type = COAP_TYPE_CON;
-	msg->code = COAP_METHOD_GET;
-	msg->mid = 0U;
-	msg->token = token;
-	msg->tkl = tkl;
-	msg->reply_cb = reply_cb;
-	msg->message_timeout_cb = do_transmit_timeout_cb;
-
-	ret = lwm2m_init_message(msg);
-	if (ret < 0) {
-		LOG_ERR("Error setting up lwm2m message");
-		goto cleanup;
-	}
+	*count = 0;
 
 #if defined(CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_COAP_PROXY_SUPPORT)
 	/* TODO: shift to lower case */
@@ -103,16 +112,19 @@ static int transfer_request(struct coap_block_context *ctx,
 	} else if (strncmp(firmware_uri, "coap", 4) == 0) {
 		cursor = COAP2COAP_PROXY_URI_PATH;
 	} else {
-		ret = -EPROTONOSUPPORT;
 		LOG_ERR("Unsupported schema");
-		goto cleanup;
+		return -EPROTONOSUPPORT;
+	}
+
+	ret = add_option(count, COAP_OPTION_URI_PATH, cursor, strlen(cursor));
+	if (ret < 0) {
+		return ret;
 	}
 
-	ret = coap_packet_append_option(&msg->cpkt, COAP_OPTION_URI_PATH,
-					cursor, strlen(cursor));
+	ret = add_option(count, COAP_OPTION_PROXY_URI, firmware_uri,
+			 strlen(firmware_uri));
 	if (ret < 0) {
-		LOG_ERR("Error adding URI_PATH '%s'", log_strdup(cursor));
-		goto cleanup;
+		return ret;
 	}
 #else
 	http_parser_url_init(&parser);
@@ -120,8 +132,7 @@ static int transfer_request(struct coap_block_context *ctx,
 				    &parser);
 	if (ret < 0) {
 		LOG_ERR("Invalid firmware url: %s", log_strdup(firmware_uri));
-		ret = -ENOTSUP;
-		goto cleanup;
+		return -ENOTSUP;
 	}
 
 	/* if path is not available, off/len will be zero */
@@ -132,13 +143,10 @@ static int transfer_request(struct coap_block_context *ctx,
 	/* add path portions (separated by slashes) */
 	while (len > 0 && (next_slash = strchr(cursor, '/')) != NULL) {
 		if (next_slash != cursor) {
-			ret = coap_packet_append_option(&msg->cpkt,
-							COAP_OPTION_URI_PATH,
-							cursor,
-							next_slash - cursor);
+			ret = add_option(count, COAP_OPTION_URI_PATH, cursor,
+					 next_slash - cursor);
 			if (ret < 0) {
-				LOG_ERR("Error adding URI_PATH");
-				goto cleanup;
+				return ret;
 			}
 		}
 
@@ -149,259 +157,152 @@ static int transfer_request(struct coap_block_context *ctx,
 
 	if (len > 0) {
 		/* flush the rest */
-		ret = coap_packet_append_option(&msg->cpkt,
-						COAP_OPTION_URI_PATH,
-						cursor, len);
+		ret = add_option(count, COAP_OPTION_URI_PATH, cursor, len);
 		if (ret < 0) {
-			LOG_ERR("Error adding URI_PATH");
-			goto cleanup;
+			return ret;
 		}
 	}
 #endif
 
-	ret = coap_append_block2_option(&msg->cpkt, ctx);
-	if (ret < 0) {
-		LOG_ERR("Unable to add block2 option.");
-		goto cleanup;
-	}
-
-#if defined(CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_COAP_PROXY_SUPPORT)
-	ret = coap_packet_append_option(&msg->cpkt, COAP_OPTION_PROXY_URI,
-					firmware_uri, strlen(firmware_uri));
-	if (ret < 0) {
-		LOG_ERR("Error adding PROXY_URI '%s'",
-			log_strdup(firmware_uri));
-		goto cleanup;
-	}
-#else
-	/* Ask the server to provide a size estimate */
-	ret = coap_append_option_int(&msg->cpkt, COAP_OPTION_SIZE2, 0);
-	if (ret < 0) {
-		LOG_ERR("Unable to add size2 option.");
-		goto cleanup;
-	}
-#endif
-
-	/* send request */
-	ret = lwm2m_send_message(msg);
-	if (ret < 0) {
-		LOG_ERR("Error sending LWM2M packet (err:%d).", ret);
-		goto cleanup;
-	}
-
 	return 0;
-
-cleanup:
-	lwm2m_reset_message(msg, true);
-	return ret;
 }
 
-static int transfer_empty_ack(uint16_t mid)
+static int transfer_send_cb(struct coap_block_xfer *xfer,
+			    const uint8_t *data, size_t len)
 {
-	struct lwm2m_message *msg;
-	int ret;
-
-	msg = lwm2m_get_message(&firmware_ctx);
-	if (!msg) {
-		LOG_ERR("Unable to get a lwm2m message!");
-		return -ENOMEM;
-	}
-
-	msg->type = COAP_TYPE_ACK;
-	msg->code = COAP_CODE_EMPTY;
-	msg->mid = mid;
-
-	ret = lwm2m_init_message(msg);
-	if (ret) {
-		goto cleanup;
-	}
-
-	ret = lwm2m_send_message(msg);
-	if (ret < 0) {
-		LOG_ERR("Error sending LWM2M packet (err:%d).", ret);
-		goto cleanup;
+	if (send(firmware_ctx.sock_fd, data, len, 0) < 0) {
+		LOG_ERR("Error sending LWM2M packet (err:%d).", errno);
+		return -errno;
 	}
 
 	return 0;
-
-cleanup:
-	lwm2m_reset_message(msg, true);
-	return ret;
 }
 
-static int
-do_firmware_transfer_reply_cb(const struct coap_packet *response,
-			      struct coap_reply *reply,
-			      const struct sockaddr *from)
+static int transfer_write_cb(struct coap_block_xfer *xfer, size_t offset,
+			     const uint8_t *data, size_t payload_len,
+			     bool last_block)
 {
 	int ret;
-	bool last_block;
-	uint8_t token[8];
-	uint8_t tkl;
-	uint16_t payload_len, payload_offset, len;
-	struct coap_packet *check_response = (struct coap_packet *)response;
+	size_t len;
 	struct lwm2m_engine_res *res = NULL;
 	lwm2m_engine_set_data_cb_t write_cb;
 	size_t write_buflen;
-	uint8_t resp_code, *write_buf;
-	struct coap_block_context received_block_ctx;
+	uint8_t *write_buf;
 
-	/* token is used to determine a valid ACK vs a separated response */
-	tkl = coap_header_get_token(check_response, token);
+	firmware_block_ctx.block_size = xfer->block_size;
+	firmware_block_ctx.total_size = xfer->total_size;
+	firmware_block_ctx.current = offset + payload_len;
 
-	/* If separated response (ACK) return and wait for response */
-	if (!tkl && coap_header_get_type(response) == COAP_TYPE_ACK) {
+	if (payload_len == 0) {
 		return 0;
-	} else if (coap_header_get_type(response) == COAP_TYPE_CON) {
-		/* Send back ACK so the server knows we received the pkt */
-		ret = transfer_empty_ack(coap_header_get_id(check_response));
-		if (ret < 0) {
-			LOG_ERR("Error transmitting ACK");
-			goto error;
-		}
-	}
-
-	/* Check response code from server. Expecting (2.05) */
-	resp_code = coap_header_get_code(check_response);
-	if (resp_code != COAP_RESPONSE_CODE_CONTENT) {
-		LOG_ERR("Unexpected response from server: %d.%d",
-			COAP_RESPONSE_CODE_CLASS(resp_code),
-			COAP_RESPONSE_CODE_DETAIL(resp_code));
-		ret = -ENOMSG;
-		goto error;
 	}
 
-	/* save main firmware block context */
-	memcpy(&received_block_ctx, &firmware_block_ctx,
-	       sizeof(firmware_block_ctx));
+	LOG_DBG("total: %zd, current: %zd", firmware_block_ctx.total_size,
+		firmware_block_ctx.current);
 
-	ret = coap_update_from_block(check_response, &firmware_block_ctx);
+	/* look up firmware package resource */
+	ret = lwm2m_engine_get_resource("5/0/0", &res);
 	if (ret < 0) {
-		LOG_ERR("Error from block update: %d", ret);
-		ret = -EFAULT;
-		goto error;
+		return ret;
 	}
 
-	/* test for duplicate transfer */
-	if (firmware_block_ctx.current < received_block_ctx.current) {
-		LOG_WRN("Duplicate packet ignored");
+	/* get buffer data */
+	write_buf = res->res_instances->data_ptr;
+	write_buflen = res->res_instances->data_len;
 
-		/* restore main firmware block context */
-		memcpy(&firmware_block_ctx, &received_block_ctx,
-		       sizeof(firmware_block_ctx));
+	/* check for user override to buffer */
+	if (res->pre_write_cb) {
+		write_buf = res->pre_write_cb(0, 0, 0, &write_buflen);
+	}
 
-		/* set reply->user_data to error to avoid releasing */
-		reply->user_data = (void *)COAP_REPLY_STATUS_ERROR;
+	write_cb = lwm2m_firmware_get_write_cb();
+	if (!write_cb) {
 		return 0;
 	}
 
-	/* Reach last block if ret equals to 0 */
-	last_block = !coap_next_block(check_response, &firmware_block_ctx);
+	/* flush incoming data to write_cb */
+	while (payload_len > 0) {
+		len = MIN(payload_len, write_buflen);
+		payload_len -= len;
 
-	/* Process incoming data */
-	payload_offset = response->hdr_len + response->opt_len;
-	coap_packet_get_payload(response, &payload_len);
-	if (payload_len > 0) {
-		LOG_DBG("total: %zd, current: %zd",
-			firmware_block_ctx.total_size,
-			firmware_block_ctx.current);
+		memcpy(write_buf, data, len);
+		data += len;
 
-		/* look up firmware package resource */
-		ret = lwm2m_engine_get_resource("5/0/0", &res);
+		ret = write_cb(0, 0, 0, write_buf, len,
+			       last_block && (payload_len == 0U),
+			       firmware_block_ctx.total_size);
 		if (ret < 0) {
-			goto error;
+			return ret;
 		}
+	}
 
-		/* get buffer data */
-		write_buf = res->res_instances->data_ptr;
-		write_buflen = res->res_instances->data_len;
-
-		/* check for user override to buffer */
-		if (res->pre_write_cb) {
-			write_buf = res->pre_write_cb(0, 0, 0, &write_buflen);
-		}
+	return 0;
+}
 
-		write_cb = lwm2m_firmware_get_write_cb();
-		if (write_cb) {
-			/* flush incoming data to write_cb */
-			while (payload_len > 0) {
-				len = (payload_len > write_buflen) ?
-				       write_buflen : payload_len;
-				payload_len -= len;
-				/* check for end of packet */
-				if (buf_read(write_buf, len,
-					     CPKT_BUF_READ(response),
-					     &payload_offset) < 0) {
-					/* malformed packet */
-					ret = -EFAULT;
-					goto error;
-				}
-
-				ret = write_cb(0, 0, 0,
-					       write_buf, len,
-					       last_block &&
-							(payload_len == 0U),
-					       firmware_block_ctx.total_size);
-				if (ret < 0) {
-					goto error;
-				}
-			}
-		}
-	}
+static void transfer_done_cb(struct coap_block_xfer *xfer, int result)
+{
+	k_delayed_work_cancel(&firmware_retransmit_work);
 
-	if (!last_block) {
-		/* More block(s) to come, setup next transfer */
-		ret = transfer_request(&firmware_block_ctx, token, tkl,
-				       do_firmware_transfer_reply_cb);
-		if (ret < 0) {
-			goto error;
-		}
-	} else {
+	if (result == 0) {
 		/* Download finished */
 		lwm2m_firmware_set_update_state(STATE_DOWNLOADED);
-		lwm2m_engine_context_close(&firmware_ctx);
+	} else {
+		LOG_ERR("Firmware download failed (err:%d).", result);
+		set_update_result_from_error(result);
 	}
 
-	return 0;
-
-error:
-	set_update_result_from_error(ret);
 	lwm2m_engine_context_close(&firmware_ctx);
-	return ret;
 }
 
-static void do_transmit_timeout_cb(struct lwm2m_message *msg)
+static const struct coap_block_xfer_cb transfer_cb = {
+	.send = transfer_send_cb,
+	.write = transfer_write_cb,
+	.done = transfer_done_cb,
+};
+
+/* Must be called with firmware_lock held */
+static void transfer_schedule(void)
 {
-	int ret;
+	int32_t timeout;
 
-	if (firmware_retry < PACKET_TRANSFER_RETRY_MAX) {
-		/* retry block */
-		LOG_WRN("TIMEOUT - Sending a retry packet!");
+	timeout = coap_block_xfer_process(&firmware_xfer);
+	if (timeout >= 0 && timeout != INT32_MAX) {
+		k_delayed_work_submit(&firmware_retransmit_work,
+				      K_MSEC(timeout));
+	}
+}
 
-		ret = transfer_request(&firmware_block_ctx,
-				       msg->token, msg->tkl,
-				       do_firmware_transfer_reply_cb);
-		if (ret < 0) {
-			/* abort retries / transfer */
-			set_update_result_from_error(ret);
-			firmware_retry = PACKET_TRANSFER_RETRY_MAX;
-			lwm2m_engine_context_close(&firmware_ctx);
-			return;
-		}
+static void transfer_retransmit(struct k_work *work)
+{
+	k_mutex_lock(&firmware_lock, K_FOREVER);
+	transfer_schedule();
+	k_mutex_unlock(&firmware_lock);
+}
 
-		firmware_retry++;
-	} else {
-		LOG_ERR("TIMEOUT - Too many retry packet attempts! "
-			"Aborting firmware download.");
-		lwm2m_firmware_set_update_result(RESULT_CONNECTION_LOST);
-		lwm2m_engine_context_close(&firmware_ctx);
-	}
+static void transfer_recv_cb(struct lwm2m_ctx *client_ctx, uint8_t *buf,
+			     uint16_t len)
+{
+	k_mutex_lock(&firmware_lock, K_FOREVER);
+
+	(void)coap_block_xfer_input(&firmware_xfer, buf, len);
+	transfer_schedule();
+
+	k_mutex_unlock(&firmware_lock);
 }
 
 static void firmware_transfer(struct k_work *work)
 {
 	int ret;
 	char *server_addr;
+	struct coap_block_xfer_config config = {
+		.cb = &transfer_cb,
+		.options = firmware_options,
+		.buf = firmware_buf,
+		.buf_len = sizeof(firmware_buf),
+		.method = COAP_METHOD_GET,
+		.block_size = lwm2m_default_block_size(),
+		.window = CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_WINDOW,
+	};
 
 #if defined(CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_COAP_PROXY_SUPPORT)
 	server_addr = CONFIG_LWM2M_FIRMWARE_UPDATE_PULL_COAP_PROXY_ADDR;
@@ -424,8 +325,13 @@ static void firmware_transfer(struct k_work *work)
 		goto error;
 	}
 
+	ret = transfer_options(&config.num_options);
+	if (ret < 0) {
+		goto error;
+	}
+
 	lwm2m_engine_context_init(&firmware_ctx);
-	firmware_ctx.handle_separate_response = true;
+	firmware_ctx.recv_cb = transfer_recv_cb;
 	ret = lwm2m_socket_start(&firmware_ctx);
 	if (ret < 0) {
 		LOG_ERR("Cannot start a firmware-pull connection:%d", ret);
@@ -437,8 +343,18 @@ static void firmware_transfer(struct k_work *work)
 	/* reset block transfer context */
 	coap_block_transfer_init(&firmware_block_ctx,
 				 lwm2m_default_block_size(), 0);
-	ret = transfer_request(&firmware_block_ctx, coap_next_token(), 8,
-			       do_firmware_transfer_reply_cb);
+
+	k_mutex_lock(&firmware_lock, K_FOREVER);
+
+	ret = coap_block_xfer_init(&firmware_xfer, &config);
+	if (ret == 0) {
+		/* Failures from here on are reported by transfer_done_cb() */
+		(void)coap_block_xfer_start(&firmware_xfer);
+		transfer_schedule();
+	}
+
+	k_mutex_unlock(&firmware_lock);
+
 	if (ret < 0) {
 		goto error;
 	}
@@ -458,14 +374,19 @@ int lwm2m_firmware_cancel_transfer(void)
 
 int lwm2m_firmware_start_transfer(char *package_uri)
 {
+	/* stop retransmitting the blocks of a previous transfer */
+	if (firmware_xfer.started) {
+		k_delayed_work_cancel(&firmware_retransmit_work);
+	}
+
 	/* close old socket */
 	if (firmware_ctx.sock_fd > -1) {
 		lwm2m_engine_context_close(&firmware_ctx);
 	}
 
 	(void)memset(&firmware_ctx, 0, sizeof(struct lwm2m_ctx));
-	firmware_retry = 0;
 	k_work_init(&firmware_work, firmware_transfer);
+	k_delayed_work_init(&firmware_retransmit_work, transfer_retransmit);
 	lwm2m_firmware_set_update_state(STATE_DOWNLOADING);
 
 	/* start file transfer work */
@@ -177,6 +177,9 @@ struct lwm2m_engine_obj {
 	/* object list */
 	sys_snode_t node;
 
+	/* object lookup hash bucket */
+	sys_snode_t hash_node;
+
 	/* object field definitions */
 	struct lwm2m_engine_obj_field *fields;
 
@@ -340,9 +343,12 @@ struct lwm2m_engine_res {
 };
 
 struct lwm2m_engine_obj_inst {
-	/* instance list */
+	/* instance list, sorted by object and instance ID */
 	sys_snode_t node;
 
+	/* instance lookup hash bucket */
+	sys_snode_t hash_node;
+
 	struct lwm2m_engine_obj *obj;
 	struct lwm2m_engine_res *resources;
 
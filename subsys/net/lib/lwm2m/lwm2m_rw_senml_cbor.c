@@ -0,0 +1,1337 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * SenML CBOR content format (RFC 8428, application/senml+cbor).
+ *
+ * A pack is a CBOR array of records, each record being a map keyed by the
+ * integer labels of RFC 8428 section 6 ("vlo" is used for object links).
+ * The base name is only emitted when the object instance changes from the
+ * previous record, so reading an object instance costs a few bytes per
+ * resource on top of the values themselves.
+ *
+ * Fractional values are written as decimal fractions (CBOR tag 4) to stay
+ * away from floating point. Integers, decimal fractions and half, single
+ * and double precision floats are accepted on input.
+ */
+
+#define LOG_MODULE_NAME net_lwm2m_senml_cbor
+#define LOG_LEVEL CONFIG_LWM2M_LOG_LEVEL
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/byteorder.h>
+
+#include "lwm2m_object.h"
+#include "lwm2m_rw_senml_cbor.h"
+#include "lwm2m_engine.h"
+
+/* CBOR major types */
+#define CBOR_UINT		0
+#define CBOR_NINT		1
+#define CBOR_BSTR		2
+#define CBOR_TSTR		3
+#define CBOR_ARRAY		4
+#define CBOR_MAP		5
+#define CBOR_TAG		6
+#define CBOR_SIMPLE		7
+
+/* CBOR additional information */
+#define CBOR_FALSE		20
+#define CBOR_TRUE		21
+#define CBOR_FLOAT16		25
+#define CBOR_FLOAT32		26
+#define CBOR_FLOAT64		27
+#define CBOR_INDEFINITE		31
+
+#define CBOR_BREAK		0xff
+#define CBOR_TAG_DECIMAL	4
+#define CBOR_MAX_DEPTH		4
+
+/* largest power of 10 in pow10_table */
+#define POW10_MAX		18
+
+/* SenML labels */
+#define SENML_BASE_NAME		(-2)
+#define SENML_NAME		0
+#define SENML_VALUE		2
+#define SENML_STRING_VALUE	3
+#define SENML_BOOL_VALUE	4
+#define SENML_DATA_VALUE	8
+#define SENML_OBJLNK_VALUE	"vlo"
+
+/* keys of the string labels, out of the range of the integer labels */
+#define SENML_OBJLNK_LABEL	INT32_MAX
+#define SENML_UNKNOWN_LABEL	INT32_MIN
+
+/* longest name is "/65535/65535/65535/65535" */
+#define SENML_NAME_LEN		sizeof("/65535/65535/65535/65535")
+
+/* writer flag, the base name of the current instance has been written */
+#define WRITER_BASE_NAME	BIT(2)
+
+struct cbor_out_formatter_data {
+	/* position of the array header, inserted once the pack is done */
+	uint16_t mark_pos;
+	uint16_t record_count;
+
+	/* instance of the last base name */
+	uint16_t obj_id;
+	uint16_t obj_inst_id;
+
+	/* flags */
+	uint8_t writer_flags;
+
+	/* first error hit while writing, the payload is dropped */
+	int err;
+};
+
+struct cbor_item {
+	uint64_t value;
+	uint8_t major;
+	uint8_t info;
+};
+
+static const int64_t pow10_table[] = {
+	1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL,
+	10000000LL, 100000000LL, 1000000000LL, 10000000000LL,
+	100000000000LL, 1000000000000LL, 10000000000000LL,
+	100000000000000LL, 1000000000000000LL, 10000000000000000LL,
+	100000000000000000LL, 1000000000000000000LL,
+};
+
+/* CBOR encoding */
+
+/* The writer callbacks only return a length, so a buffer overflow is
+ * recorded here and reported once the read operation completes.
+ */
+static void out_set_error(struct lwm2m_output_context *out, int err)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (fd && !fd->err) {
+		fd->err = err;
+	}
+}
+
+static uint8_t cbor_encode_head(uint8_t *buf, uint8_t major, uint64_t value)
+{
+	major <<= 5;
+
+	if (value < 24) {
+		buf[0] = major | value;
+		return 1;
+	}
+
+	if (value <= UINT8_MAX) {
+		buf[0] = major | 24;
+		buf[1] = value;
+		return 2;
+	}
+
+	if (value <= UINT16_MAX) {
+		buf[0] = major | 25;
+		sys_put_be16(value, &buf[1]);
+		return 3;
+	}
+
+	if (value <= UINT32_MAX) {
+		buf[0] = major | 26;
+		sys_put_be32(value, &buf[1]);
+		return 5;
+	}
+
+	buf[0] = major | 27;
+	sys_put_be64(value, &buf[1]);
+	return 9;
+}
+
+static size_t cbor_put_head(struct lwm2m_output_context *out, uint8_t major,
+			    uint64_t value)
+{
+	uint8_t buf[9];
+	uint8_t len;
+
+	len = cbor_encode_head(buf, major, value);
+	if (buf_append(CPKT_BUF_WRITE(out->out_cpkt), buf, len) < 0) {
+		out_set_error(out, -ENOMEM);
+		return 0;
+	}
+
+	return len;
+}
+
+static size_t cbor_put_int(struct lwm2m_output_context *out, int64_t value)
+{
+	if (value < 0) {
+		return cbor_put_head(out, CBOR_NINT, -(value + 1));
+	}
+
+	return cbor_put_head(out, CBOR_UINT, value);
+}
+
+static size_t cbor_put_data(struct lwm2m_output_context *out, uint8_t major,
+			    const void *data, size_t len)
+{
+	size_t head;
+
+	if (len > UINT16_MAX) {
+		out_set_error(out, -EINVAL);
+		return 0;
+	}
+
+	head = cbor_put_head(out, major, len);
+	if (head == 0) {
+		return 0;
+	}
+
+	if (buf_append(CPKT_BUF_WRITE(out->out_cpkt), (uint8_t *)data,
+		       len) < 0) {
+		out_set_error(out, -ENOMEM);
+		return 0;
+	}
+
+	return head + len;
+}
+
+/* Fixed point value val1.val2, val2 being scaled by 10^digits */
+static size_t cbor_put_decimal(struct lwm2m_output_context *out,
+			       int64_t val1, int64_t val2, int digits)
+{
+	int64_t mantissa;
+	int exponent = -digits;
+	size_t len;
+
+	if (val2 == 0) {
+		return cbor_put_int(out, val1);
+	}
+
+	/* val2 follows the sign of val1, see plain_text_put_float32fix() */
+	if ((val1 < 0 && val2 > 0) || (val1 > 0 && val2 < 0)) {
+		val2 = -val2;
+	}
+
+	mantissa = val1 * pow10_table[digits] + val2;
+	while (mantissa % 10 == 0) {
+		mantissa /= 10;
+		exponent++;
+	}
+
+	len = cbor_put_head(out, CBOR_TAG, CBOR_TAG_DECIMAL);
+	len += cbor_put_head(out, CBOR_ARRAY, 2);
+	len += cbor_put_int(out, exponent);
+	len += cbor_put_int(out, mantissa);
+
+	return len;
+}
+
+/* CBOR decoding */
+
+static int cbor_get_head(struct lwm2m_input_context *in,
+			 struct cbor_item *item)
+{
+	uint8_t initial, byte;
+	int i, count;
+
+	if (buf_read_u8(&initial, CPKT_BUF_READ(in->in_cpkt),
+			&in->offset) < 0) {
+		return -ENODATA;
+	}
+
+	item->major = initial >> 5;
+	item->info = initial & 0x1f;
+	item->value = item->info;
+
+	if (item->info < 24 || item->info == CBOR_INDEFINITE) {
+		return 0;
+	}
+
+	if (item->info > 27) {
+		return -EINVAL;
+	}
+
+	item->value = 0U;
+	count = 1 << (item->info - 24);
+	for (i = 0; i < count; i++) {
+		if (buf_read_u8(&byte, CPKT_BUF_READ(in->in_cpkt),
+				&in->offset) < 0) {
+			return -ENODATA;
+		}
+
+		item->value = (item->value << 8) | byte;
+	}
+
+	return 0;
+}
+
+static bool cbor_indefinite(const struct cbor_item *item)
+{
+	return item->info == CBOR_INDEFINITE;
+}
+
+/* Consume the break code ending an indefinite length item, if present */
+static bool cbor_get_break(struct lwm2m_input_context *in)
+{
+	if (in->offset < in->in_cpkt->max_len &&
+	    in->in_cpkt->data[in->offset] == CBOR_BREAK) {
+		in->offset++;
+		return true;
+	}
+
+	return false;
+}
+
+static int cbor_skip(struct lwm2m_input_context *in, int depth)
+{
+	struct cbor_item item;
+	uint64_t count, i;
+	int ret;
+
+	if (depth > CBOR_MAX_DEPTH) {
+		return -EINVAL;
+	}
+
+	ret = cbor_get_head(in, &item);
+	if (ret < 0) {
+		return ret;
+	}
+
+	switch (item.major) {
+	case CBOR_UINT:
+	case CBOR_NINT:
+	case CBOR_SIMPLE:
+		/* the value, if any, came with the head */
+		return 0;
+
+	case CBOR_BSTR:
+	case CBOR_TSTR:
+		if (cbor_indefinite(&item)) {
+			while (!cbor_get_break(in)) {
+				ret = cbor_skip(in, depth + 1);
+				if (ret < 0) {
+					return ret;
+				}
+			}
+
+			return 0;
+		}
+
+		if (item.value > UINT16_MAX) {
+			return -EINVAL;
+		}
+
+		return buf_skip(item.value, CPKT_BUF_READ(in->in_cpkt),
+				&in->offset);
+
+	case CBOR_TAG:
+		return cbor_skip(in, depth + 1);
+
+	default:
+		/* array or map */
+		count = item.major == CBOR_MAP ? 2 * item.value : item.value;
+		for (i = 0; cbor_indefinite(&item) ? !cbor_get_break(in) :
+		     i < count; i++) {
+			ret = cbor_skip(in, depth + 1);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		return 0;
+	}
+}
+
+static int cbor_get_text(struct lwm2m_input_context *in, char *buf,
+			 size_t buflen)
+{
+	struct cbor_item item;
+	int ret;
+
+	ret = cbor_get_head(in, &item);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (item.major != CBOR_TSTR || cbor_indefinite(&item) ||
+	    item.value >= buflen) {
+		return -EINVAL;
+	}
+
+	ret = buf_read((uint8_t *)buf, item.value, CPKT_BUF_READ(in->in_cpkt),
+		       &in->offset);
+	if (ret < 0) {
+		return ret;
+	}
+
+	buf[item.value] = '\0';
+	return item.value;
+}
+
+static int cbor_get_int(struct lwm2m_input_context *in, int64_t *value)
+{
+	struct cbor_item item;
+	int ret;
+
+	ret = cbor_get_head(in, &item);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if ((item.major != CBOR_UINT && item.major != CBOR_NINT) ||
+	    item.value > INT64_MAX) {
+		return -EINVAL;
+	}
+
+	*value = item.major == CBOR_UINT ? (int64_t)item.value :
+		 -1 - (int64_t)item.value;
+	return 0;
+}
+
+/*
+ * Convert a binary floating point value m * 2^e to a decimal one, with up
+ * to 9 fractional digits.
+ */
+static int binary_to_decimal(bool negative, uint64_t m, int e,
+			     int64_t *mantissa, int *exponent)
+{
+	uint64_t frac = 0U;
+	int i;
+
+	if (e >= 0) {
+		if (e > 62 || m > (INT64_MAX >> e)) {
+			return -ERANGE;
+		}
+
+		*mantissa = m << e;
+		*exponent = 0;
+		goto out;
+	}
+
+	/* leave room to multiply the fraction by 10 */
+	while (e < -60) {
+		m >>= 1;
+		e++;
+	}
+
+	*mantissa = m >> -e;
+	*exponent = 0;
+	frac = m & ((1ULL << -e) - 1);
+
+	/* one decimal digit at a time, the fraction is exact */
+	for (i = 0; i < 9 && frac &&
+	     *mantissa <= INT64_MAX / 10 - 9; i++) {
+		frac *= 10U;
+		*mantissa = *mantissa * 10 + (frac >> -e);
+		frac &= (1ULL << -e) - 1;
+		(*exponent)--;
+	}
+
+out:
+	if (negative) {
+		*mantissa = -*mantissa;
+	}
+
+	return 0;
+}
+
+static int float_to_decimal(const struct cbor_item *item, int64_t *mantissa,
+			    int *exponent)
+{
+	uint64_t m;
+	int e, exp_bits, mant_bits, bias;
+	bool negative;
+
+	switch (item->info) {
+	case CBOR_FLOAT16:
+		exp_bits = 5;
+		mant_bits = 10;
+		break;
+	case CBOR_FLOAT32:
+		exp_bits = 8;
+		mant_bits = 23;
+		break;
+	case CBOR_FLOAT64:
+		exp_bits = 11;
+		mant_bits = 52;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	bias = (1 << (exp_bits - 1)) - 1;
+	negative = (item->value >> (exp_bits + mant_bits)) & 1;
+	e = (item->value >> mant_bits) & ((1 << exp_bits) - 1);
+	m = item->value & ((1ULL << mant_bits) - 1);
+
+	if (e == (1 << exp_bits) - 1) {
+		/* infinity or NaN */
+		return -ERANGE;
+	}
+
+	if (e == 0) {
+		/* subnormal */
+		e = 1;
+	} else {
+		m |= 1ULL << mant_bits;
+	}
+
+	return binary_to_decimal(negative, m, e - bias - mant_bits,
+				 mantissa, exponent);
+}
+
+/* Decode a number as mantissa * 10^exponent */
+static int cbor_get_number(struct lwm2m_input_context *in, int64_t *mantissa,
+			   int *exponent)
+{
+	struct cbor_item item;
+	uint16_t offset = in->offset;
+	int64_t exp;
+	int ret;
+
+	ret = cbor_get_head(in, &item);
+	if (ret < 0) {
+		return ret;
+	}
+
+	switch (item.major) {
+	case CBOR_UINT:
+	case CBOR_NINT:
+		in->offset = offset;
+		*exponent = 0;
+		return cbor_get_int(in, mantissa);
+
+	case CBOR_TAG:
+		if (item.value != CBOR_TAG_DECIMAL) {
+			return -EINVAL;
+		}
+
+		ret = cbor_get_head(in, &item);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (item.major != CBOR_ARRAY || item.value != 2U) {
+			return -EINVAL;
+		}
+
+		ret = cbor_get_int(in, &exp);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (exp < -2 * POW10_MAX || exp > POW10_MAX) {
+			return -ERANGE;
+		}
+
+		*exponent = exp;
+		return cbor_get_int(in, mantissa);
+
+	case CBOR_SIMPLE:
+		return float_to_decimal(&item, mantissa, exponent);
+
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Split mantissa * 10^exponent into val1.val2, val2 scaled by 10^digits */
+static int decimal_to_fixed(int64_t mantissa, int exponent, int digits,
+			    int64_t *val1, int64_t *val2)
+{
+	int64_t rem;
+	int shift;
+
+	if (exponent >= 0) {
+		if (exponent > POW10_MAX ||
+		    mantissa > INT64_MAX / pow10_table[exponent] ||
+		    mantissa < INT64_MIN / pow10_table[exponent]) {
+			return -ERANGE;
+		}
+
+		*val1 = mantissa * pow10_table[exponent];
+		*val2 = 0;
+		return 0;
+	}
+
+	/* drop the digits that cannot be represented anyway */
+	shift = -exponent - POW10_MAX;
+	if (shift > 0) {
+		mantissa = shift <= POW10_MAX ?
+			   mantissa / pow10_table[shift] : 0;
+		exponent += shift;
+	}
+
+	*val1 = mantissa / pow10_table[-exponent];
+	rem = mantissa % pow10_table[-exponent];
+
+	if (-exponent > digits) {
+		*val2 = rem / pow10_table[-exponent - digits];
+	} else {
+		*val2 = rem * pow10_table[digits + exponent];
+	}
+
+	return 0;
+}
+
+static int cbor_get_fixed(struct lwm2m_input_context *in, int digits,
+			  int64_t *val1, int64_t *val2)
+{
+	int64_t mantissa;
+	int exponent;
+	int ret;
+
+	ret = cbor_get_number(in, &mantissa, &exponent);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return decimal_to_fixed(mantissa, exponent, digits, val1, val2);
+}
+
+/* Parse "/obj/inst/res/res_inst", a trailing slash is allowed */
+static int parse_path(const char *name, struct lwm2m_obj_path *path)
+{
+	uint32_t val;
+
+	(void)memset(path, 0, sizeof(*path));
+
+	if (*name != '/') {
+		return -EINVAL;
+	}
+
+	while (*name == '/' && name[1] != '\0') {
+		name++;
+
+		if (!isdigit((unsigned char)*name) || path->level >= 4U) {
+			return -EINVAL;
+		}
+
+		val = 0U;
+		while (isdigit((unsigned char)*name)) {
+			val = val * 10U + (*name++ - '0');
+			if (val > UINT16_MAX) {
+				return -EINVAL;
+			}
+		}
+
+		switch (path->level) {
+		case 0:
+			path->obj_id = val;
+			break;
+		case 1:
+			path->obj_inst_id = val;
+			break;
+		case 2:
+			path->res_id = val;
+			break;
+		default:
+			path->res_inst_id = val;
+			break;
+		}
+
+		path->level++;
+	}
+
+	if (*name == '/') {
+		name++;
+	}
+
+	return *name == '\0' ? 0 : -EINVAL;
+}
+
+/* Read a map label, string labels other than "vlo" map to an unknown key */
+static int get_label(struct lwm2m_input_context *in, int64_t *key)
+{
+	char label[sizeof(SENML_OBJLNK_VALUE)];
+	uint16_t offset = in->offset;
+
+	if (offset >= in->in_cpkt->max_len) {
+		return -ENODATA;
+	}
+
+	if (in->in_cpkt->data[offset] >> 5 != CBOR_TSTR) {
+		return cbor_get_int(in, key);
+	}
+
+	if (cbor_get_text(in, label, sizeof(label)) >= 0 &&
+	    strcmp(label, SENML_OBJLNK_VALUE) == 0) {
+		*key = SENML_OBJLNK_LABEL;
+		return 0;
+	}
+
+	in->offset = offset;
+	*key = SENML_UNKNOWN_LABEL;
+	return cbor_skip(in, 0);
+}
+
+/*
+ * Parse the record at in->offset into the full path of the record and the
+ * position of its value (0 when it has none). The base name is kept in
+ * base_name for the following records.
+ */
+static int get_record(struct lwm2m_input_context *in, char *base_name,
+		      struct lwm2m_obj_path *path, uint16_t *value_offset)
+{
+	char name[SENML_NAME_LEN];
+	char full_name[2 * SENML_NAME_LEN];
+	struct cbor_item item;
+	uint64_t i;
+	int64_t key;
+	int ret;
+
+	name[0] = '\0';
+	*value_offset = 0U;
+
+	ret = cbor_get_head(in, &item);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (item.major != CBOR_MAP) {
+		return -EINVAL;
+	}
+
+	for (i = 0; cbor_indefinite(&item) ? !cbor_get_break(in) :
+	     i < item.value; i++) {
+		ret = get_label(in, &key);
+		if (ret < 0) {
+			return ret;
+		}
+
+		switch (key) {
+		case SENML_BASE_NAME:
+			ret = cbor_get_text(in, base_name, SENML_NAME_LEN);
+			break;
+
+		case SENML_NAME:
+			ret = cbor_get_text(in, name, sizeof(name));
+			break;
+
+		case SENML_VALUE:
+		case SENML_OBJLNK_LABEL:
+		case SENML_STRING_VALUE:
+		case SENML_BOOL_VALUE:
+		case SENML_DATA_VALUE:
+			*value_offset = in->offset;
+			/* fallthrough */
+
+		default:
+			ret = cbor_skip(in, 0);
+			break;
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	snprintk(full_name, sizeof(full_name), "%s%s", base_name, name);
+
+	return parse_path(full_name, path);
+}
+
+/* writer */
+
+static size_t put_begin(struct lwm2m_output_context *out,
+			struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->mark_pos = out->out_cpkt->offset;
+	fd->record_count = 0U;
+	return 0;
+}
+
+static size_t put_end(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+	uint8_t buf[9];
+	uint8_t len;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd || fd->err) {
+		return 0;
+	}
+
+	/* the record count is only known now, insert the array header */
+	len = cbor_encode_head(buf, CBOR_ARRAY, fd->record_count);
+	if (buf_insert(CPKT_BUF_WRITE(out->out_cpkt), fd->mark_pos,
+		       buf, len) < 0) {
+		fd->err = -ENOMEM;
+		return 0;
+	}
+
+	return len;
+}
+
+static size_t put_begin_ri(struct lwm2m_output_context *out,
+			   struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags |= WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+static size_t put_end_ri(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	fd->writer_flags &= ~WRITER_RESOURCE_INSTANCE;
+	return 0;
+}
+
+/* Write the map header and the names of a record, up to the value label */
+static size_t put_record(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path)
+{
+	struct cbor_out_formatter_data *fd;
+	char name[SENML_NAME_LEN];
+	bool base_name;
+	size_t len;
+	int n;
+
+	fd = engine_get_out_user_data(out);
+	if (!fd) {
+		return 0;
+	}
+
+	base_name = !(fd->writer_flags & WRITER_BASE_NAME) ||
+		    fd->obj_id != path->obj_id ||
+		    fd->obj_inst_id != path->obj_inst_id;
+
+	len = cbor_put_head(out, CBOR_MAP, base_name ? 3 : 2);
+
+	if (base_name) {
+		n = snprintk(name, sizeof(name), "/%u/%u/",
+			     path->obj_id, path->obj_inst_id);
+		len += cbor_put_int(out, SENML_BASE_NAME);
+		len += cbor_put_data(out, CBOR_TSTR, name, n);
+
+		fd->obj_id = path->obj_id;
+		fd->obj_inst_id = path->obj_inst_id;
+		fd->writer_flags |= WRITER_BASE_NAME;
+	}
+
+	if (fd->writer_flags & WRITER_RESOURCE_INSTANCE) {
+		n = snprintk(name, sizeof(name), "%u/%u",
+			     path->res_id, path->res_inst_id);
+	} else {
+		n = snprintk(name, sizeof(name), "%u", path->res_id);
+	}
+
+	len += cbor_put_int(out, SENML_NAME);
+	len += cbor_put_data(out, CBOR_TSTR, name, n);
+
+	fd->record_count++;
+	return len;
+}
+
+static size_t put_s64(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int64_t value)
+{
+	size_t len;
+
+	len = put_record(out, path);
+	len += cbor_put_int(out, SENML_VALUE);
+	len += cbor_put_int(out, value);
+
+	return len;
+}
+
+static size_t put_s32(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int32_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s16(struct lwm2m_output_context *out,
+		      struct lwm2m_obj_path *path, int16_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_s8(struct lwm2m_output_context *out,
+		     struct lwm2m_obj_path *path, int8_t value)
+{
+	return put_s64(out, path, (int64_t)value);
+}
+
+static size_t put_string(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	size_t len;
+
+	len = put_record(out, path);
+	len += cbor_put_int(out, SENML_STRING_VALUE);
+	len += cbor_put_data(out, CBOR_TSTR, buf, buflen);
+
+	return len;
+}
+
+static size_t put_opaque(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 char *buf, size_t buflen)
+{
+	size_t len;
+
+	len = put_record(out, path);
+	len += cbor_put_int(out, SENML_DATA_VALUE);
+	len += cbor_put_data(out, CBOR_BSTR, buf, buflen);
+
+	return len;
+}
+
+static size_t put_float32fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float32_value_t *value)
+{
+	size_t len;
+
+	len = put_record(out, path);
+	len += cbor_put_int(out, SENML_VALUE);
+	len += cbor_put_decimal(out, value->val1, value->val2, 6);
+
+	return len;
+}
+
+static size_t put_float64fix(struct lwm2m_output_context *out,
+			     struct lwm2m_obj_path *path,
+			     float64_value_t *value)
+{
+	size_t len;
+
+	len = put_record(out, path);
+	len += cbor_put_int(out, SENML_VALUE);
+	len += cbor_put_decimal(out, value->val1, value->val2, 9);
+
+	return len;
+}
+
+static size_t put_bool(struct lwm2m_output_context *out,
+		       struct lwm2m_obj_path *path,
+		       bool value)
+{
+	size_t len;
+
+	len = put_record(out, path);
+	len += cbor_put_int(out, SENML_BOOL_VALUE);
+	len += cbor_put_head(out, CBOR_SIMPLE, value ? CBOR_TRUE : CBOR_FALSE);
+
+	return len;
+}
+
+static size_t put_objlnk(struct lwm2m_output_context *out,
+			 struct lwm2m_obj_path *path,
+			 struct lwm2m_objlnk *value)
+{
+	char buf[sizeof("65535:65535")];
+	size_t len;
+	int n;
+
+	n = snprintk(buf, sizeof(buf), "%u:%u", value->obj_id,
+		     value->obj_inst);
+
+	len = put_record(out, path);
+	len += cbor_put_data(out, CBOR_TSTR, SENML_OBJLNK_VALUE,
+			     sizeof(SENML_OBJLNK_VALUE) - 1);
+	len += cbor_put_data(out, CBOR_TSTR, buf, n);
+
+	return len;
+}
+
+/* reader */
+
+static size_t get_s64(struct lwm2m_input_context *in, int64_t *value)
+{
+	uint16_t offset = in->offset;
+	int64_t frac;
+
+	if (cbor_get_fixed(in, 0, value, &frac) < 0) {
+		return 0;
+	}
+
+	return in->offset - offset;
+}
+
+static size_t get_s32(struct lwm2m_input_context *in, int32_t *value)
+{
+	int64_t tmp = 0;
+	size_t len;
+
+	len = get_s64(in, &tmp);
+	if (len > 0) {
+		*value = (int32_t)tmp;
+	}
+
+	return len;
+}
+
+static size_t get_string(struct lwm2m_input_context *in,
+			 uint8_t *buf, size_t buflen)
+{
+	struct cbor_item item;
+	uint16_t len;
+
+	if (buflen == 0 || cbor_get_head(in, &item) < 0 ||
+	    (item.major != CBOR_TSTR && item.major != CBOR_BSTR) ||
+	    cbor_indefinite(&item) || item.value > UINT16_MAX) {
+		return 0;
+	}
+
+	len = MIN(item.value, buflen - 1);
+	if (buf_read(buf, len, CPKT_BUF_READ(in->in_cpkt),
+		     &in->offset) < 0 ||
+	    buf_skip(item.value - len, CPKT_BUF_READ(in->in_cpkt),
+		     &in->offset) < 0) {
+		buf[0] = '\0';
+		return 0;
+	}
+
+	buf[len] = '\0';
+	return len;
+}
+
+static size_t get_float32fix(struct lwm2m_input_context *in,
+			     float32_value_t *value)
+{
+	uint16_t offset = in->offset;
+	int64_t val1, val2;
+
+	if (cbor_get_fixed(in, 6, &val1, &val2) < 0) {
+		return 0;
+	}
+
+	value->val1 = (int32_t)val1;
+	value->val2 = (int32_t)val2;
+
+	return in->offset - offset;
+}
+
+static size_t get_float64fix(struct lwm2m_input_context *in,
+			     float64_value_t *value)
+{
+	uint16_t offset = in->offset;
+
+	if (cbor_get_fixed(in, 9, &value->val1, &value->val2) < 0) {
+		return 0;
+	}
+
+	return in->offset - offset;
+}
+
+static size_t get_bool(struct lwm2m_input_context *in, bool *value)
+{
+	struct cbor_item item;
+
+	if (cbor_get_head(in, &item) < 0 || item.major != CBOR_SIMPLE ||
+	    (item.value != CBOR_TRUE && item.value != CBOR_FALSE)) {
+		return 0;
+	}
+
+	*value = item.value == CBOR_TRUE;
+	return 1;
+}
+
+static size_t get_opaque(struct lwm2m_input_context *in,
+			 uint8_t *value, size_t buflen, bool *last_block)
+{
+	struct cbor_item item;
+
+	if (cbor_get_head(in, &item) < 0 || item.major != CBOR_BSTR ||
+	    cbor_indefinite(&item)) {
+		return 0;
+	}
+
+	in->opaque_len = item.value;
+	return lwm2m_engine_get_opaque_more(in, value, buflen, last_block);
+}
+
+static size_t get_objlnk(struct lwm2m_input_context *in,
+			 struct lwm2m_objlnk *value)
+{
+	char buf[sizeof("65535:65535")];
+	unsigned long obj_id, obj_inst;
+	uint16_t offset = in->offset;
+	char *end;
+
+	if (cbor_get_text(in, buf, sizeof(buf)) < 0) {
+		return 0;
+	}
+
+	obj_id = strtoul(buf, &end, 10);
+	if (*end != ':') {
+		return 0;
+	}
+
+	obj_inst = strtoul(end + 1, &end, 10);
+	if (*end != '\0' || obj_id > UINT16_MAX || obj_inst > UINT16_MAX) {
+		return 0;
+	}
+
+	value->obj_id = obj_id;
+	value->obj_inst = obj_inst;
+
+	return in->offset - offset;
+}
+
+const struct lwm2m_writer senml_cbor_writer = {
+	.put_begin = put_begin,
+	.put_end = put_end,
+	.put_begin_ri = put_begin_ri,
+	.put_end_ri = put_end_ri,
+	.put_s8 = put_s8,
+	.put_s16 = put_s16,
+	.put_s32 = put_s32,
+	.put_s64 = put_s64,
+	.put_string = put_string,
+	.put_float32fix = put_float32fix,
+	.put_float64fix = put_float64fix,
+	.put_bool = put_bool,
+	.put_opaque = put_opaque,
+	.put_objlnk = put_objlnk,
+};
+
+const struct lwm2m_reader senml_cbor_reader = {
+	.get_s32 = get_s32,
+	.get_s64 = get_s64,
+	.get_string = get_string,
+	.get_float32fix = get_float32fix,
+	.get_float64fix = get_float64fix,
+	.get_bool = get_bool,
+	.get_opaque = get_opaque,
+	.get_objlnk = get_objlnk,
+};
+
+int do_read_op_senml_cbor(struct lwm2m_message *msg, int content_format)
+{
+	struct cbor_out_formatter_data fd;
+	int ret;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	ret = lwm2m_perform_read_op(msg, content_format);
+	engine_clear_out_user_data(&msg->out);
+
+	if (ret >= 0 && fd.err < 0) {
+		LOG_ERR("SenML CBOR payload not written: %d", fd.err);
+		ret = fd.err;
+	}
+
+	return ret;
+}
+
+int do_composite_read_op_senml_cbor(struct lwm2m_message *msg,
+				    int content_format)
+{
+	struct lwm2m_obj_path paths[CONFIG_LWM2M_COMPOSITE_PATH_MAX];
+	struct cbor_out_formatter_data fd;
+	char base_name[SENML_NAME_LEN] = "";
+	struct cbor_item pack;
+	uint16_t value_offset;
+	int count = 0;
+	uint64_t i;
+	int ret;
+
+	ret = cbor_get_head(&msg->in, &pack);
+	if (ret < 0 || pack.major != CBOR_ARRAY) {
+		return -EINVAL;
+	}
+
+	for (i = 0; cbor_indefinite(&pack) ? !cbor_get_break(&msg->in) :
+	     i < pack.value; i++) {
+		if (count == ARRAY_SIZE(paths)) {
+			LOG_ERR("Too many paths in composite read");
+			return -EFBIG;
+		}
+
+		ret = get_record(&msg->in, base_name, &paths[count],
+				 &value_offset);
+		if (ret < 0) {
+			LOG_ERR("Invalid composite read record: %d", ret);
+			return -EINVAL;
+		}
+
+		/* reading everything at once is not supported */
+		if (paths[count].level == 0U) {
+			return -EPERM;
+		}
+
+		count++;
+	}
+
+	(void)memset(&fd, 0, sizeof(fd));
+	engine_set_out_user_data(&msg->out, &fd);
+	ret = lwm2m_perform_composite_read_op(msg, content_format, paths,
+					      count);
+	engine_clear_out_user_data(&msg->out);
+
+	if (ret >= 0 && fd.err < 0) {
+		LOG_ERR("SenML CBOR payload not written: %d", fd.err);
+		ret = fd.err;
+	}
+
+	return ret;
+}
+
+static bool path_is_below(const struct lwm2m_obj_path *parent,
+			  const struct lwm2m_obj_path *path)
+{
+	return path->level >= parent->level &&
+	       (parent->level < 1U || path->obj_id == parent->obj_id) &&
+	       (parent->level < 2U ||
+		path->obj_inst_id == parent->obj_inst_id) &&
+	       (parent->level < 3U || path->res_id == parent->res_id) &&
+	       (parent->level < 4U ||
+		path->res_inst_id == parent->res_inst_id);
+}
+
+static int do_write_op_senml_cbor_item(struct lwm2m_message *msg,
+				       bool composite)
+{
+	struct lwm2m_engine_obj_inst *obj_inst = NULL;
+	struct lwm2m_engine_res *res = NULL;
+	struct lwm2m_engine_res_inst *res_inst = NULL;
+	struct lwm2m_engine_obj_field *obj_field = NULL;
+	int ret, i;
+
+	if (composite) {
+		/* Write-Composite does not create object instances */
+		obj_inst = lwm2m_get_engine_obj_inst(msg->path.obj_id,
+						     msg->path.obj_inst_id);
+		if (!obj_inst) {
+			return -ENOENT;
+		}
+	} else {
+		ret = lwm2m_get_or_create_engine_obj(msg, &obj_inst, NULL);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	res = lwm2m_get_engine_res(obj_inst, msg->path.res_id, &obj_field);
+	if (!obj_field) {
+		return -ENOENT;
+	}
+
+	if (!LWM2M_HAS_PERM(obj_field, LWM2M_PERM_W)) {
+		return -EPERM;
+	}
+
+	if (res) {
+		for (i = 0; i < res->res_inst_count; i++) {
+			if (res->res_instances[i].res_inst_id ==
+			    msg->path.res_inst_id) {
+				res_inst = &res->res_instances[i];
+				break;
+			}
+		}
+	}
+
+	if (!res || !res_inst) {
+		/* if OPTIONAL and BOOTSTRAP-WRITE or CREATE use ENOTSUP */
+		if ((msg->ctx->bootstrap_mode ||
+		     msg->operation == LWM2M_OP_CREATE) &&
+		    LWM2M_HAS_PERM(obj_field, BIT(LWM2M_FLAG_OPTIONAL))) {
+			return -ENOTSUP;
+		}
+
+		return -ENOENT;
+	}
+
+	ret = lwm2m_write_handler(obj_inst, res, res_inst, obj_field, msg);
+	if (ret == -EACCES || ret == -ENOENT) {
+		/* if read-only or non-existent data buffer move on */
+		ret = 0;
+	}
+
+	return ret;
+}
+
+int do_write_op_senml_cbor(struct lwm2m_message *msg)
+{
+	struct lwm2m_obj_path orig_path;
+	char base_name[SENML_NAME_LEN] = "";
+	struct cbor_item pack;
+	uint16_t value_offset, next_offset;
+	uint64_t i;
+	int ret;
+
+	/* store a copy of the original path */
+	memcpy(&orig_path, &msg->path, sizeof(msg->path));
+
+	ret = cbor_get_head(&msg->in, &pack);
+	if (ret < 0 || pack.major != CBOR_ARRAY) {
+		return -EINVAL;
+	}
+
+	for (i = 0; cbor_indefinite(&pack) ? !cbor_get_break(&msg->in) :
+	     i < pack.value; i++) {
+		ret = get_record(&msg->in, base_name, &msg->path,
+				 &value_offset);
+		if (ret < 0) {
+			LOG_ERR("Invalid record: %d", ret);
+			ret = -EINVAL;
+			break;
+		}
+
+		if (msg->path.level < 3U || !value_offset ||
+		    !path_is_below(&orig_path, &msg->path)) {
+			ret = -EINVAL;
+			break;
+		}
+
+		next_offset = msg->in.offset;
+		msg->in.offset = value_offset;
+
+		ret = do_write_op_senml_cbor_item(msg, orig_path.level == 0U);
+
+		msg->in.offset = next_offset;
+
+		/*
+		 * for OP_CREATE and BOOTSTRAP WRITE: errors on optional
+		 * resources are ignored (ENOTSUP)
+		 */
+		if (ret < 0 &&
+		    !((ret == -ENOTSUP) &&
+		      (msg->ctx->bootstrap_mode ||
+		       msg->operation == LWM2M_OP_CREATE))) {
+			break;
+		}
+
+		ret = 0;
+	}
+
+	memcpy(&msg->path, &orig_path, sizeof(msg->path));
+
+	return ret;
+}
@@ -249,13 +249,153 @@ static int verify_tx_state(const struct mqtt_client *client)
 	return 0;
 }
 
+/**@brief Encodes the headers of as many publish messages as fit into the tx
+ *        buffer, and sets up a message with the headers and the payloads.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] params Publish message parameters.
+ * @param[in] count Number of publish messages.
+ * @param[in] io_vector I/O vector with room for two entries per message.
+ * @param[out] msg Message to be written to the transport.
+ *
+ * @return Number of messages encoded, or an error code.
+ */
+static int publish_batch_encode(struct mqtt_client *client,
+				const struct mqtt_publish_param *params,
+				size_t count, struct iovec *io_vector,
+				struct msghdr *msg)
+{
+	uint8_t *end = client->tx_buf + client->tx_buf_size;
+	uint8_t *next = client->tx_buf;
+	struct buf_ctx packet;
+	int err_code;
+	size_t i;
+
+	count = MIN(count, CONFIG_MQTT_PUBLISH_BATCH_MAX);
+
+	for (i = 0; i < count; i++) {
+		packet.cur = next;
+		packet.end = end;
+
+		if ((end - next) <= MQTT_FIXED_HEADER_MAX_SIZE) {
+			err_code = -ENOMEM;
+		} else {
+			err_code = publish_encode(&params[i], &packet);
+		}
+
+		if (err_code == -ENOMEM && i > 0) {
+			/* Send the messages encoded so far. */
+			break;
+		}
+
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		io_vector[2 * i].iov_base = packet.cur;
+		io_vector[2 * i].iov_len = packet.end - packet.cur;
+		io_vector[2 * i + 1].iov_base = params[i].message.payload.data;
+		io_vector[2 * i + 1].iov_len = params[i].message.payload.len;
+
+		next = packet.end;
+	}
+
+	memset(msg, 0, sizeof(*msg));
+
+	msg->msg_iov = io_vector;
+	msg->msg_iovlen = 2 * i;
+
+	return i;
+}
+
+/**@brief Writes publish messages to the transport, batching as many of them
+ *        as possible per write.
+ *
+ * @param[in] client Identifies the client for which the procedure is requested.
+ * @param[in] params Publish message parameters.
+ * @param[in] count Number of publish messages.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+static int publish_batch_write(struct mqtt_client *client,
+			       const struct mqtt_publish_param *params,
+			       size_t count)
+{
+	struct iovec io_vector[2 * CONFIG_MQTT_PUBLISH_BATCH_MAX];
+	struct msghdr msg;
+	int err_code;
+
+	while (count > 0) {
+		err_code = publish_batch_encode(client, params, count,
+						io_vector, &msg);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		params += err_code;
+		count -= err_code;
+
+		MQTT_TRC("[%p]: Transport writing %d messages.", client,
+			 err_code);
+
+		err_code = mqtt_transport_write_msg(client, &msg);
+		if (err_code < 0) {
+			return err_code;
+		}
+
+		client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+	}
+
+	return 0;
+}
+
+static int client_publish(struct mqtt_client *client,
+			  const struct mqtt_publish_param *params,
+			  size_t count)
+{
+	int err_code;
+	size_t i;
+
+	err_code = verify_tx_state(client);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	/* Reject messages that cannot be encoded before any of them is
+	 * tracked or sent.
+	 */
+	for (i = 0; i < count; i++) {
+		if (params[i].message.topic.qos &&
+		    params[i].message_id == 0U) {
+			return -EINVAL;
+		}
+
+		if (MQTT_FIXED_HEADER_MAX_SIZE + sizeof(uint16_t) +
+		    GET_UT8STR_BUFFER_SIZE(&params[i].message.topic.topic) >
+		    client->tx_buf_size) {
+			return -ENOMEM;
+		}
+	}
+
+	err_code = mqtt_inflight_add(client, params, count);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	err_code = publish_batch_write(client, params, count);
+	if (err_code < 0) {
+		MQTT_TRC("Transport write failed, err_code = %d, "
+			 "closing connection", err_code);
+		client_disconnect(client, err_code);
+	}
+
+	return err_code;
+}
+
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param)
 {
 	int err_code;
-	struct buf_ctx packet;
-	struct iovec io_vector[2];
-	struct msghdr msg;
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
@@ -267,39 +407,116 @@ int mqtt_publish(struct mqtt_client *client,
 
 	mqtt_mutex_lock(client);
 
-	tx_buf_init(client, &packet);
+	err_code = client_publish(client, param, 1);
 
-	err_code = verify_tx_state(client);
-	if (err_code < 0) {
-		goto error;
-	}
+	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
+			 client, client->internal.state, err_code);
 
-	err_code = publish_encode(param, &packet);
-	if (err_code < 0) {
-		goto error;
-	}
+	mqtt_mutex_unlock(client);
 
-	io_vector[0].iov_base = packet.cur;
-	io_vector[0].iov_len = packet.end - packet.cur;
-	io_vector[1].iov_base = param->message.payload.data;
-	io_vector[1].iov_len = param->message.payload.len;
+	return err_code;
+}
 
-	memset(&msg, 0, sizeof(msg));
+int mqtt_publish_batch(struct mqtt_client *client,
+		       const struct mqtt_publish_param *params, size_t count)
+{
+	int err_code;
 
-	msg.msg_iov = io_vector;
-	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(params);
 
-	err_code = client_write_msg(client, &msg);
+	MQTT_TRC("[CID %p]:[State 0x%02x]: >> Message count %zu",
+		 client, client->internal.state, count);
+
+	mqtt_mutex_lock(client);
+
+	err_code = client_publish(client, params, count);
 
-error:
 	MQTT_TRC("[CID %p]:[State 0x%02x]: << result 0x%08x",
-			 client, client->internal.state, err_code);
+		 client, client->internal.state, err_code);
 
 	mqtt_mutex_unlock(client);
 
 	return err_code;
 }
 
+#if defined(CONFIG_MQTT_INFLIGHT_WINDOW)
+static int resend_release(struct mqtt_client *client, uint16_t message_id)
+{
+	struct mqtt_pubrel_param param = {
+		.message_id = message_id
+	};
+	struct buf_ctx packet;
+	int err_code;
+
+	tx_buf_init(client, &packet);
+
+	err_code = publish_release_encode(&param, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	return mqtt_transport_write(client, packet.cur, packet.end - packet.cur);
+}
+
+int mqtt_inflight_resend(struct mqtt_client *client, bool session_present)
+{
+	struct mqtt_publish_param params[CONFIG_MQTT_PUBLISH_BATCH_MAX];
+	struct mqtt_inflight *entry;
+	size_t count = 0;
+	int err_code;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->inflight); i++) {
+		entry = &client->inflight[i];
+
+		if (!entry->in_use) {
+			continue;
+		}
+
+		if (entry->state == MQTT_INFLIGHT_PUBLISHED) {
+			/* The message is a duplicate only if the broker may
+			 * have seen it in the same session.
+			 */
+			memset(&params[count], 0, sizeof(params[count]));
+			params[count].message = entry->message;
+			params[count].message_id = entry->message_id;
+			params[count].retain_flag = entry->retain_flag;
+			params[count].dup_flag = session_present ? 1U : 0U;
+			count++;
+
+			if (count == ARRAY_SIZE(params)) {
+				err_code = publish_batch_write(client, params,
+							       count);
+				if (err_code < 0) {
+					return err_code;
+				}
+
+				count = 0;
+			}
+
+			continue;
+		}
+
+		/* Without the session the broker has already forgotten the
+		 * message, so there is nothing left to release.
+		 */
+		if (!session_present) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					  entry->message_id);
+			continue;
+		}
+
+		err_code = resend_release(client, entry->message_id);
+		if (err_code < 0) {
+			return err_code;
+		}
+	}
+
+	return publish_batch_write(client, params, count);
+}
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW */
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file mqtt_inflight.c
+ *
+ * @brief MQTT in-flight window of QoS 1 and QoS 2 publish messages.
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_mqtt_inflight, CONFIG_MQTT_LOG_LEVEL);
+
+#include "mqtt_internal.h"
+#include "mqtt_os.h"
+
+static void session_store(struct mqtt_client *client,
+			  const struct mqtt_inflight *entry,
+			  enum mqtt_session_store_op op)
+{
+	if (client->session_store != NULL) {
+		client->session_store(client, entry, op);
+	}
+}
+
+static struct mqtt_inflight *inflight_find(struct mqtt_client *client,
+					   uint16_t message_id)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->inflight); i++) {
+		if (client->inflight[i].in_use &&
+		    client->inflight[i].message_id == message_id) {
+			return &client->inflight[i];
+		}
+	}
+
+	return NULL;
+}
+
+static struct mqtt_inflight *inflight_alloc(struct mqtt_client *client)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->inflight); i++) {
+		if (!client->inflight[i].in_use) {
+			client->inflight[i].in_use = 1U;
+			return &client->inflight[i];
+		}
+	}
+
+	return NULL;
+}
+
+static size_t inflight_free_count(const struct mqtt_client *client)
+{
+	size_t count = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(client->inflight); i++) {
+		if (!client->inflight[i].in_use) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void inflight_remove(struct mqtt_client *client,
+			    struct mqtt_inflight *entry)
+{
+	session_store(client, entry, MQTT_SESSION_STORE_REMOVE);
+
+	memset(entry, 0, sizeof(*entry));
+}
+
+int mqtt_inflight_add(struct mqtt_client *client,
+		      const struct mqtt_publish_param *params, size_t count)
+{
+	struct mqtt_inflight *entry;
+	size_t needed = 0;
+	size_t i, j;
+
+	for (i = 0; i < count; i++) {
+		if (params[i].message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+			continue;
+		}
+
+		if (inflight_find(client, params[i].message_id) != NULL) {
+			return -EBUSY;
+		}
+
+		for (j = 0; j < i; j++) {
+			if (params[j].message.topic.qos &&
+			    params[j].message_id == params[i].message_id) {
+				return -EBUSY;
+			}
+		}
+
+		needed++;
+	}
+
+	if (needed > inflight_free_count(client)) {
+		MQTT_TRC("[CID %p]: In-flight window full", client);
+		return -EAGAIN;
+	}
+
+	for (i = 0; i < count; i++) {
+		if (params[i].message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+			continue;
+		}
+
+		entry = inflight_alloc(client);
+
+		entry->message = params[i].message;
+		entry->message_id = params[i].message_id;
+		entry->retain_flag = params[i].retain_flag;
+		entry->state = MQTT_INFLIGHT_PUBLISHED;
+
+		session_store(client, entry, MQTT_SESSION_STORE_ADD);
+	}
+
+	return 0;
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		       uint16_t message_id)
+{
+	struct mqtt_inflight *entry;
+
+	entry = inflight_find(client, message_id);
+	if (entry == NULL) {
+		MQTT_TRC("[CID %p]: Message id 0x%04x not in flight", client,
+			 message_id);
+		return;
+	}
+
+	switch (type) {
+	case MQTT_PKT_TYPE_PUBACK:
+		if (entry->message.topic.qos != MQTT_QOS_1_AT_LEAST_ONCE) {
+			MQTT_TRC("[CID %p]: PUBACK for QoS %d message 0x%04x",
+				 client, entry->message.topic.qos, message_id);
+			break;
+		}
+
+		inflight_remove(client, entry);
+		break;
+
+	case MQTT_PKT_TYPE_PUBCOMP:
+		if (entry->message.topic.qos != MQTT_QOS_2_EXACTLY_ONCE) {
+			MQTT_TRC("[CID %p]: PUBCOMP for QoS %d message 0x%04x",
+				 client, entry->message.topic.qos, message_id);
+			break;
+		}
+
+		inflight_remove(client, entry);
+		break;
+
+	case MQTT_PKT_TYPE_PUBREC:
+		if (entry->message.topic.qos != MQTT_QOS_2_EXACTLY_ONCE) {
+			MQTT_TRC("[CID %p]: PUBREC for QoS %d message 0x%04x",
+				 client, entry->message.topic.qos, message_id);
+			break;
+		}
+
+		if (entry->state != MQTT_INFLIGHT_RECEIVED) {
+			entry->state = MQTT_INFLIGHT_RECEIVED;
+			session_store(client, entry,
+				      MQTT_SESSION_STORE_UPDATE);
+		}
+
+		break;
+
+	default:
+		break;
+	}
+}
+
+int mqtt_inflight_count(struct mqtt_client *client)
+{
+	int count;
+
+	NULL_PARAM_CHECK(client);
+
+	mqtt_mutex_lock(client);
+
+	count = ARRAY_SIZE(client->inflight) - inflight_free_count(client);
+
+	mqtt_mutex_unlock(client);
+
+	return count;
+}
+
+int mqtt_inflight_restore(struct mqtt_client *client,
+			  const struct mqtt_inflight *entry)
+{
+	struct mqtt_inflight *restored;
+	int err_code = 0;
+
+	NULL_PARAM_CHECK(client);
+	NULL_PARAM_CHECK(entry);
+
+	if (entry->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE ||
+	    entry->message_id == 0U ||
+	    entry->state > MQTT_INFLIGHT_RECEIVED) {
+		return -EINVAL;
+	}
+
+	mqtt_mutex_lock(client);
+
+	if (inflight_find(client, entry->message_id) != NULL) {
+		err_code = -EBUSY;
+		goto exit;
+	}
+
+	restored = inflight_alloc(client);
+	if (restored == NULL) {
+		err_code = -ENOMEM;
+		goto exit;
+	}
+
+	*restored = *entry;
+	restored->in_use = 1U;
+
+exit:
+	mqtt_mutex_unlock(client);
+
+	return err_code;
+}
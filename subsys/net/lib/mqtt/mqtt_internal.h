@@ -393,6 +393,61 @@ int subscribe_ack_decode(struct buf_ctx *buf,
 int unsubscribe_ack_decode(struct buf_ctx *buf,
 			   struct mqtt_unsuback_param *param);
 
+#if defined(CONFIG_MQTT_INFLIGHT_WINDOW)
+/**@brief Adds the QoS 1 and QoS 2 messages of a publish request to the
+ *        in-flight window.
+ *
+ * @param[in] client Identifies the client for which the messages are
+ *                   published.
+ * @param[in] params Publish message parameters.
+ * @param[in] count Number of publish messages.
+ *
+ * @retval 0 if all the messages were added.
+ * @retval -EAGAIN if the window has no room for all the messages.
+ * @retval -EBUSY if a message id is already in the window.
+ */
+int mqtt_inflight_add(struct mqtt_client *client,
+		      const struct mqtt_publish_param *params, size_t count);
+
+/**@brief Updates the in-flight window on a publish acknowledgment.
+ *
+ * @param[in] client Identifies the client for which the acknowledgment was
+ *                   received.
+ * @param[in] type Packet type, PUBACK, PUBREC or PUBCOMP.
+ * @param[in] message_id Message id of the acknowledged message.
+ */
+void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		       uint16_t message_id);
+
+/**@brief Sends the in-flight window again once the connection is accepted.
+ *
+ * @param[in] client Identifies the client for which the connection was
+ *                   accepted.
+ * @param[in] session_present Broker still has the session state.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_inflight_resend(struct mqtt_client *client, bool session_present);
+#else
+static inline int mqtt_inflight_add(struct mqtt_client *client,
+				    const struct mqtt_publish_param *params,
+				    size_t count)
+{
+	return 0;
+}
+
+static inline void mqtt_inflight_ack(struct mqtt_client *client,
+				     uint8_t type, uint16_t message_id)
+{
+}
+
+static inline int mqtt_inflight_resend(struct mqtt_client *client,
+				       bool session_present)
+{
+	return 0;
+}
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW */
+
 #ifdef __cplusplus
 }
 #endif
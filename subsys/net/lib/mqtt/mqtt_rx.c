@@ -75,6 +75,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBACK;
 		err_code = publish_ack_decode(buf, &evt.param.puback);
 		evt.result = err_code;
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBACK,
+					  evt.param.puback.message_id);
+		}
+
 		break;
 
 	case MQTT_PKT_TYPE_PUBREC:
@@ -83,6 +88,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBREC;
 		err_code = publish_receive_decode(buf, &evt.param.pubrec);
 		evt.result = err_code;
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBREC,
+					  evt.param.pubrec.message_id);
+		}
+
 		break;
 
 	case MQTT_PKT_TYPE_PUBREL:
@@ -99,6 +109,11 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		evt.type = MQTT_EVT_PUBCOMP;
 		err_code = publish_complete_decode(buf, &evt.param.pubcomp);
 		evt.result = err_code;
+		if (err_code == 0) {
+			mqtt_inflight_ack(client, MQTT_PKT_TYPE_PUBCOMP,
+					  evt.param.pubcomp.message_id);
+		}
+
 		break;
 
 	case MQTT_PKT_TYPE_SUBACK:
@@ -140,6 +155,12 @@ static int mqtt_handle_packet(struct mqtt_client *client,
 		event_notify(client, &evt);
 	}
 
+	if (err_code == 0 && evt.type == MQTT_EVT_CONNACK &&
+	    MQTT_HAS_STATE(client, MQTT_STATE_CONNECTED)) {
+		err_code = mqtt_inflight_resend(
+				client, evt.param.connack.session_present_flag);
+	}
+
 	return err_code;
 }
 
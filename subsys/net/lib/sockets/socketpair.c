@@ -557,8 +557,9 @@ out:
  * send(2)) can be read at the other end using common POSIX calls such as
  * read(2) or recv(2).
  *
- * If the underlying file descriptor has the @ref O_NONBLOCK flag set then
- * this function will return immediately. If no data was read from a
+ * If the underlying file descriptor has the @ref O_NONBLOCK flag set, or
+ * @p flags contains @ref ZSOCK_MSG_DONTWAIT, then this function will return
+ * immediately. If no data was read from a
  * non-blocking file descriptor, then -1 will be returned and @ref errno will
  * be set to @ref EAGAIN.
  *
@@ -580,11 +581,12 @@ out:
  * @param obj the address of an @ref spair object cast to `void *`
  * @param buffer the buffer in which to read
  * @param count the number of bytes to read
+ * @param flags the recv() flags, only @ref ZSOCK_MSG_DONTWAIT is supported
  *
  * @return on success, a number > 0 representing the number of bytes written
  * @return -1 on error, with @ref errno set appropriately.
  */
-static ssize_t spair_read(void *obj, void *buffer, size_t count)
+static ssize_t spair_recv(void *obj, void *buffer, size_t count, int flags)
 {
 	int res;
 	int key;
@@ -603,7 +605,7 @@ static ssize_t spair_read(void *obj, void *buffer, size_t count)
 	}
 
 	key = irq_lock();
-	is_nonblock = sock_is_nonblock(spair);
+	is_nonblock = sock_is_nonblock(spair) || (flags & ZSOCK_MSG_DONTWAIT);
 	res = k_sem_take(&spair->sem, K_NO_WAIT);
 	irq_unlock(key);
 	if (res < 0) {
@@ -619,7 +621,8 @@ static ssize_t spair_read(void *obj, void *buffer, size_t count)
 			res = -1;
 			goto out;
 		}
-		is_nonblock = sock_is_nonblock(spair);
+		is_nonblock = sock_is_nonblock(spair) ||
+			      (flags & ZSOCK_MSG_DONTWAIT);
 	}
 
 	have_local_sem = true;
@@ -717,6 +720,11 @@ out:
 	return res;
 }
 
+static ssize_t spair_read(void *obj, void *buffer, size_t count)
+{
+	return spair_recv(obj, buffer, count, 0);
+}
+
 static int zsock_poll_prepare_ctx(struct spair *const spair,
 				  struct zsock_pollfd *const pfd,
 				  struct k_poll_event **pev,
@@ -1083,7 +1091,6 @@ static ssize_t spair_recvfrom(void *obj, void *buf, size_t max_len,
 			      int flags, struct sockaddr *src_addr,
 				   socklen_t *addrlen)
 {
-	(void)flags;
 	(void)src_addr;
 	(void)addrlen;
 
@@ -1100,7 +1107,7 @@ static ssize_t spair_recvfrom(void *obj, void *buf, size_t max_len,
 		*addrlen = 0;
 	}
 
-	return spair_read(obj, buf, max_len);
+	return spair_recv(obj, buf, max_len, flags);
 }
 
 static int spair_getsockopt(void *obj, int level, int optname,
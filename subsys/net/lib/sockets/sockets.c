@@ -748,6 +748,175 @@ fail:
 #include <syscalls/zsock_sendmsg_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+static unsigned int sendmmsg_ctx(void *ctx,
+				 const struct socket_op_vtable *vtable,
+				 struct mmsghdr *msgvec, unsigned int vlen,
+				 int flags)
+{
+	unsigned int i;
+	ssize_t ret;
+
+	for (i = 0; i < vlen; i++) {
+		ret = vtable->sendmsg(ctx, &msgvec[i].msg_hdr, flags);
+		if (ret < 0) {
+			break;
+		}
+
+		msgvec[i].msg_len = ret;
+	}
+
+	return i;
+}
+
+int z_impl_zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+			  unsigned int vlen, int flags)
+{
+	const struct socket_op_vtable *vtable;
+	unsigned int i;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL || vtable->sendmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	i = sendmmsg_ctx(ctx, vtable, msgvec, vlen, flags);
+
+	/* An error is reported only if no message was sent, errno is
+	 * set by sendmsg().
+	 */
+	if (i == 0 && vlen > 0) {
+		return -1;
+	}
+
+	return i;
+}
+
+#ifdef CONFIG_USERSPACE
+/* Number of messages copied from user memory at once */
+#define SENDMMSG_CHUNK 4
+
+/* Copy the iovecs and the address of the messages to kernel memory. The
+ * data is only checked to be readable and is sent from user memory, as
+ * sendto() does. The iovecs are stored in the returned array, which the
+ * caller must free.
+ */
+static struct iovec *sendmmsg_chunk_copy(struct mmsghdr *vec,
+					 struct sockaddr_storage *addr,
+					 unsigned int n)
+{
+	struct iovec *iov;
+	size_t iov_cnt = 0;
+	size_t iov_size;
+	unsigned int i;
+	size_t j;
+
+	for (i = 0; i < n; i++) {
+		if (size_add_overflow(iov_cnt, vec[i].msg_hdr.msg_iovlen,
+				      &iov_cnt)) {
+			errno = EINVAL;
+			return NULL;
+		}
+	}
+
+	if (size_mul_overflow(iov_cnt, sizeof(struct iovec), &iov_size)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	iov = k_malloc(MAX(iov_size, 1));
+	if (!iov) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	iov_cnt = 0;
+
+	for (i = 0; i < n; i++) {
+		struct msghdr *msg = &vec[i].msg_hdr;
+
+		Z_OOPS(z_user_from_copy(&iov[iov_cnt], msg->msg_iov,
+					msg->msg_iovlen * sizeof(struct iovec)));
+		msg->msg_iov = &iov[iov_cnt];
+
+		for (j = 0; j < msg->msg_iovlen; j++) {
+			Z_OOPS(Z_SYSCALL_MEMORY_READ(msg->msg_iov[j].iov_base,
+						     msg->msg_iov[j].iov_len));
+		}
+
+		iov_cnt += msg->msg_iovlen;
+
+		if (msg->msg_name) {
+			Z_OOPS(Z_SYSCALL_VERIFY(msg->msg_namelen <=
+						sizeof(addr[i])));
+			Z_OOPS(z_user_from_copy(&addr[i], msg->msg_name,
+						msg->msg_namelen));
+			msg->msg_name = &addr[i];
+		}
+
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
+	}
+
+	return iov;
+}
+
+static inline int z_vrfy_zsock_sendmmsg(int sock, struct mmsghdr *msgvec,
+					unsigned int vlen, int flags)
+{
+	struct sockaddr_storage addr[SENDMMSG_CHUNK];
+	struct mmsghdr vec[SENDMMSG_CHUNK];
+	const struct socket_op_vtable *vtable;
+	unsigned int cnt, done, i;
+	unsigned int sent = 0;
+	struct iovec *iov;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL || vtable->sendmsg == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	while (sent < vlen) {
+		cnt = MIN(vlen - sent, SENDMMSG_CHUNK);
+
+		Z_OOPS(z_user_from_copy(vec, &msgvec[sent],
+					cnt * sizeof(struct mmsghdr)));
+
+		iov = sendmmsg_chunk_copy(vec, addr, cnt);
+		if (!iov) {
+			break;
+		}
+
+		done = sendmmsg_ctx(ctx, vtable, vec, cnt, flags);
+
+		k_free(iov);
+
+		for (i = 0; i < done; i++) {
+			Z_OOPS(z_user_to_copy(&msgvec[sent + i].msg_len,
+					      &vec[i].msg_len,
+					      sizeof(vec[i].msg_len)));
+		}
+
+		sent += done;
+
+		if (done < cnt) {
+			break;
+		}
+	}
+
+	/* Same as zsock_sendmmsg(), errno is set when no message was sent */
+	if (sent == 0 && vlen > 0) {
+		return -1;
+	}
+
+	return sent;
+}
+#include <syscalls/zsock_sendmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
 static int sock_get_pkt_src_addr(struct net_pkt *pkt,
 				 enum net_ip_protocol proto,
 				 struct sockaddr *addr,
@@ -851,6 +1020,31 @@ error:
 	return ret;
 }
 
+/* Fill in the source address of a received datagram, addrlen is
+ * a value-result argument set to the actual size of the address.
+ */
+static int sock_get_src_addr(struct net_context *ctx, struct net_pkt *pkt,
+			     struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	int rv;
+
+	rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
+				   src_addr, *addrlen);
+	if (rv < 0) {
+		return rv;
+	}
+
+	if (src_addr->sa_family == AF_INET) {
+		*addrlen = sizeof(struct sockaddr_in);
+	} else if (src_addr->sa_family == AF_INET6) {
+		*addrlen = sizeof(struct sockaddr_in6);
+	} else {
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
 static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 				       void *buf,
 				       size_t max_len,
@@ -892,24 +1086,11 @@ static inline ssize_t zsock_recv_dgram(struct net_context *ctx,
 	if (src_addr && addrlen) {
 		int rv;
 
-		rv = sock_get_pkt_src_addr(pkt, net_context_get_ip_proto(ctx),
-					   src_addr, *addrlen);
+		rv = sock_get_src_addr(ctx, pkt, src_addr, addrlen);
 		if (rv < 0) {
 			errno = -rv;
 			goto fail;
 		}
-
-		/* addrlen is a value-result argument, set to actual
-		 * size of source address
-		 */
-		if (src_addr->sa_family == AF_INET) {
-			*addrlen = sizeof(struct sockaddr_in);
-		} else if (src_addr->sa_family == AF_INET6) {
-			*addrlen = sizeof(struct sockaddr_in6);
-		} else {
-			errno = ENOTSUP;
-			goto fail;
-		}
 	}
 
 	recv_len = net_pkt_remaining_data(pkt);
@@ -1094,6 +1275,236 @@ ssize_t z_vrfy_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
 #include <syscalls/zsock_recvfrom_mrsh.c>
 #endif /* CONFIG_USERSPACE */
 
+#if defined(CONFIG_NET_SOCKETS_ZEROCOPY)
+/* The zero-copy API works on the net_context directly, so it is limited
+ * to the native sockets.
+ */
+static struct net_context *zsock_get_native_ctx(int sock)
+{
+	const struct socket_op_vtable *vtable;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL) {
+		errno = EBADF;
+		return NULL;
+	}
+
+	if (vtable != &sock_fd_op_vtable) {
+		errno = EOPNOTSUPP;
+		return NULL;
+	}
+
+	return ctx;
+}
+
+/* Unlink whole fragments holding up to max_len bytes, starting at the
+ * cursor, from the packet. The fragments in front of the cursor stay in
+ * the packet, and so do the ones which do not fit, with the cursor moved
+ * to them.
+ */
+static struct net_buf *sock_pkt_detach_data(struct net_pkt *pkt,
+					    size_t max_len, size_t *len)
+{
+	struct net_buf *first = pkt->cursor.buf;
+	struct net_buf *last, *prev;
+
+	*len = 0;
+
+	if (!first) {
+		return NULL;
+	}
+
+	/* Drop the headers and the data already read */
+	net_buf_pull(first, pkt->cursor.pos - first->data);
+
+	while (first && !first->len) {
+		first = first->frags;
+	}
+
+	if (!first || first->len > max_len) {
+		return NULL;
+	}
+
+	last = first;
+	*len = first->len;
+
+	while (last->frags && *len + last->frags->len <= max_len) {
+		last = last->frags;
+		*len += last->len;
+	}
+
+	if (pkt->buffer == first) {
+		pkt->buffer = last->frags;
+	} else {
+		for (prev = pkt->buffer; prev->frags != first;
+		     prev = prev->frags) {
+		}
+
+		prev->frags = last->frags;
+	}
+
+	pkt->cursor.buf = last->frags;
+	pkt->cursor.pos = last->frags ? last->frags->data : NULL;
+
+	last->frags = NULL;
+
+	return first;
+}
+
+static ssize_t zsock_recv_buf_ctx(struct net_context *ctx,
+				  struct net_buf **frags, size_t max_len,
+				  int flags, struct sockaddr *src_addr,
+				  socklen_t *addrlen)
+{
+	enum net_sock_type sock_type = net_context_get_type(ctx);
+	k_timeout_t timeout = K_FOREVER;
+	size_t recv_len = 0;
+	int res;
+
+	*frags = NULL;
+
+	if (flags & ZSOCK_MSG_PEEK) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (sock_type != SOCK_STREAM && sock_type != SOCK_DGRAM) {
+		errno = EOPNOTSUPP;
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	do {
+		struct net_pkt *pkt;
+
+		if (sock_type == SOCK_STREAM && sock_is_eof(ctx)) {
+			return 0;
+		}
+
+		res = k_fifo_wait_non_empty(&ctx->recv_q, timeout);
+		/* EAGAIN when timeout expired, EINTR when cancelled */
+		if (res && res != -EAGAIN && res != -EINTR) {
+			errno = -res;
+			return -1;
+		}
+
+		pkt = k_fifo_peek_head(&ctx->recv_q);
+		if (!pkt) {
+			if (sock_type == SOCK_STREAM && sock_is_eof(ctx)) {
+				return 0;
+			}
+
+			errno = EAGAIN;
+			return -1;
+		}
+
+		if (sock_type == SOCK_DGRAM) {
+			/* Datagrams are never split */
+			if (net_pkt_remaining_data(pkt) > max_len) {
+				errno = EMSGSIZE;
+				return -1;
+			}
+
+			if (src_addr && addrlen) {
+				res = sock_get_src_addr(ctx, pkt, src_addr,
+							addrlen);
+				if (res < 0) {
+					k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+					net_pkt_unref(pkt);
+					errno = -res;
+					return -1;
+				}
+			}
+		}
+
+		*frags = sock_pkt_detach_data(pkt, max_len, &recv_len);
+		if (!*frags && net_pkt_remaining_data(pkt)) {
+			errno = EMSGSIZE;
+			return -1;
+		}
+
+		if (sock_type == SOCK_DGRAM || !net_pkt_remaining_data(pkt)) {
+			/* Finished processing head pkt in the fifo */
+			k_fifo_get(&ctx->recv_q, K_NO_WAIT);
+			if (sock_type == SOCK_STREAM && net_pkt_eof(pkt)) {
+				sock_set_eof(ctx);
+			}
+
+			net_stats_update_tc_rx_time(
+				net_pkt_iface(pkt),
+				net_pkt_priority(pkt),
+				net_pkt_timestamp(pkt)->nanosecond,
+				k_cycle_get_32());
+
+			net_pkt_unref(pkt);
+		}
+	} while (sock_type == SOCK_STREAM && recv_len == 0);
+
+	if (sock_type == SOCK_STREAM) {
+		net_context_update_recv_wnd(ctx, recv_len);
+	}
+
+	return recv_len;
+}
+
+ssize_t zsock_recv_buf(int sock, struct net_buf **frags, size_t max_len,
+		       int flags, struct sockaddr *src_addr,
+		       socklen_t *addrlen)
+{
+	struct net_context *ctx;
+
+	ctx = zsock_get_native_ctx(sock);
+	if (!ctx) {
+		return -1;
+	}
+
+	return zsock_recv_buf_ctx(ctx, frags, max_len, flags, src_addr,
+				  addrlen);
+}
+
+ssize_t zsock_send_buf(int sock, struct net_buf *frags, int flags,
+		       const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	k_timeout_t timeout = K_FOREVER;
+	struct net_context *ctx;
+	int status;
+
+	ctx = zsock_get_native_ctx(sock);
+	if (!ctx) {
+		net_buf_unref(frags);
+		return -1;
+	}
+
+	if ((flags & ZSOCK_MSG_DONTWAIT) || sock_is_nonblock(ctx)) {
+		timeout = K_NO_WAIT;
+	}
+
+	/* Register the callback before sending in order to receive the response
+	 * from the peer.
+	 */
+	status = net_context_recv(ctx, zsock_received_cb,
+				  K_NO_WAIT, ctx->user_data);
+	if (status < 0) {
+		net_buf_unref(frags);
+		errno = -status;
+		return -1;
+	}
+
+	status = net_context_send_buf(ctx, frags, dest_addr, addrlen, NULL,
+				      timeout, ctx->user_data);
+	if (status < 0) {
+		errno = -status;
+		return -1;
+	}
+
+	return status;
+}
+#endif /* CONFIG_NET_SOCKETS_ZEROCOPY */
+
 /* As this is limited function, we don't follow POSIX signature, with
  * "..." instead of last arg.
  */
@@ -1357,6 +1768,148 @@ static inline int z_vrfy_zsock_poll(struct zsock_pollfd *fds,
 #include <syscalls/zsock_poll_mrsh.c>
 #endif
 
+int z_impl_zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+			  unsigned int vlen, int flags, int timeout)
+{
+	const struct socket_op_vtable *vtable;
+	uint32_t start = k_uptime_get_32();
+	bool nonblock;
+	unsigned int i = 0;
+	ssize_t ret;
+	void *ctx;
+
+	ctx = get_sock_vtable(sock, &vtable);
+	if (ctx == NULL || vtable->recvfrom == NULL) {
+		errno = EBADF;
+		return -1;
+	}
+
+	nonblock = flags & ZSOCK_MSG_DONTWAIT;
+	if (!nonblock) {
+		ret = z_impl_zsock_fcntl(sock, F_GETFL, 0);
+		nonblock = ret > 0 && (ret & O_NONBLOCK);
+	}
+
+	while (i < vlen) {
+		struct msghdr *msg = &msgvec[i].msg_hdr;
+		struct zsock_pollfd pfd = {
+			.fd = sock,
+			.events = ZSOCK_POLLIN,
+		};
+
+		if (msg->msg_iovlen == 0) {
+			errno = EINVAL;
+			break;
+		}
+
+		/* Only wait in poll() below, so that the timeout covers
+		 * the whole batch.
+		 */
+		ret = vtable->recvfrom(ctx, msg->msg_iov[0].iov_base,
+				       msg->msg_iov[0].iov_len,
+				       flags | ZSOCK_MSG_DONTWAIT,
+				       msg->msg_name,
+				       msg->msg_name ? &msg->msg_namelen : NULL);
+		if (ret >= 0) {
+			msgvec[i].msg_len = ret;
+			msg->msg_flags = 0;
+			i++;
+			continue;
+		}
+
+		if (errno != EAGAIN || nonblock ||
+		    (i > 0 && (flags & ZSOCK_MSG_WAITFORONE))) {
+			break;
+		}
+
+		ret = z_impl_zsock_poll(&pfd, 1, timeout < 0 ? timeout :
+					time_left(start, timeout));
+		if (ret == 0) {
+			errno = EAGAIN;
+		}
+
+		if (ret <= 0) {
+			break;
+		}
+	}
+
+	if (i == 0 && vlen > 0) {
+		return -1;
+	}
+
+	return i;
+}
+
+#ifdef CONFIG_USERSPACE
+static inline int z_vrfy_zsock_recvmmsg(int sock, struct mmsghdr *msgvec,
+					unsigned int vlen, int flags,
+					int timeout)
+{
+	struct mmsghdr *vec_copy;
+	struct iovec *iov_copy;
+	size_t vec_size;
+	unsigned int i;
+	int ret;
+
+	if (size_mul_overflow(vlen, sizeof(struct mmsghdr), &vec_size)) {
+		errno = EFAULT;
+		return -1;
+	}
+
+	vec_copy = z_user_alloc_from_copy(msgvec, vec_size);
+	if (!vec_copy) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	/* Only the first iovec of each message is used */
+	iov_copy = k_malloc(MAX(vlen, 1) * sizeof(struct iovec));
+	if (!iov_copy) {
+		k_free(vec_copy);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	for (i = 0; i < vlen; i++) {
+		struct msghdr *msg = &vec_copy[i].msg_hdr;
+
+		if (msg->msg_iovlen) {
+			Z_OOPS(z_user_from_copy(&iov_copy[i], msg->msg_iov,
+						sizeof(struct iovec)));
+			Z_OOPS(Z_SYSCALL_MEMORY_WRITE(iov_copy[i].iov_base,
+						      iov_copy[i].iov_len));
+			msg->msg_iov = &iov_copy[i];
+			msg->msg_iovlen = 1;
+		}
+
+		Z_OOPS(msg->msg_name &&
+		       Z_SYSCALL_MEMORY_WRITE(msg->msg_name,
+					      msg->msg_namelen));
+		msg->msg_control = NULL;
+		msg->msg_controllen = 0;
+	}
+
+	ret = z_impl_zsock_recvmmsg(sock, vec_copy, vlen, flags, timeout);
+
+	for (i = 0; ret > 0 && i < (unsigned int)ret; i++) {
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_len, &vec_copy[i].msg_len,
+				      sizeof(msgvec[i].msg_len)));
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_hdr.msg_namelen,
+				      &vec_copy[i].msg_hdr.msg_namelen,
+				      sizeof(socklen_t)));
+		Z_OOPS(z_user_to_copy(&msgvec[i].msg_hdr.msg_flags,
+				      &vec_copy[i].msg_hdr.msg_flags,
+				      sizeof(int)));
+	}
+
+	k_free(iov_copy);
+	k_free(vec_copy);
+
+	return ret;
+}
+#include <syscalls/zsock_recvmmsg_mrsh.c>
+#endif /* CONFIG_USERSPACE */
+
 int z_impl_zsock_inet_pton(sa_family_t family, const char *src, void *dst)
 {
 	if (net_addr_pton(family, src, dst) == 0) {
@@ -1418,6 +1971,28 @@ int zsock_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 			}
 		}
 
+		break;
+
+	case IPPROTO_TCP:
+		switch (optname) {
+		case TCP_CONGESTION:
+			if (IS_ENABLED(CONFIG_NET_TCP_CONGESTION_CONTROL)) {
+				size_t len = *optlen;
+
+				ret = net_context_get_option(ctx,
+						NET_OPT_TCP_CONGESTION,
+						optval, &len);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				*optlen = len;
+
+				return 0;
+			}
+		}
+
 		break;
 	}
 
@@ -1549,6 +2124,21 @@ int zsock_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 			 * existing apps.
 			 */
 			return 0;
+
+		case TCP_CONGESTION:
+			if (IS_ENABLED(CONFIG_NET_TCP_CONGESTION_CONTROL)) {
+				ret = net_context_set_option(ctx,
+						NET_OPT_TCP_CONGESTION,
+						optval, optlen);
+				if (ret < 0) {
+					errno = -ret;
+					return -1;
+				}
+
+				return 0;
+			}
+
+			break;
 		}
 		break;
 
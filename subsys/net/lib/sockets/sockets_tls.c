@@ -35,6 +35,12 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #include <mbedtls/ssl_cookie.h>
 #include <mbedtls/error.h>
 #include <mbedtls/debug.h>
+#if defined(MBEDTLS_SSL_CACHE_C)
+#include <mbedtls/ssl_cache.h>
+#endif
+#if defined(MBEDTLS_SSL_TICKET_C)
+#include <mbedtls/ssl_ticket.h>
+#endif
 #endif /* CONFIG_MBEDTLS */
 
 #include "sockets_internal.h"
@@ -103,6 +109,14 @@ struct tls_context {
 
 		/** DTLS role, client by default. */
 		int8_t role;
+
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+		/** TLS session caching, disabled by default. */
+		int8_t session_cache;
+
+		/** Session tickets, -1 if not set explicitly. */
+		int8_t session_tickets;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
 	} options;
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -151,6 +165,61 @@ static struct k_mutex context_lock;
 #define IS_LISTENING(context) (net_context_get_state(context) == \
 			       NET_CONTEXT_LISTENING)
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#define TLS_SESSION_LIFETIME_MS (CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME * \
+				 MSEC_PER_SEC)
+
+#if defined(MBEDTLS_GCM_C)
+#define TLS_TICKET_CIPHER MBEDTLS_CIPHER_AES_128_GCM
+#else
+#define TLS_TICKET_CIPHER MBEDTLS_CIPHER_AES_128_CCM
+#endif
+
+/** Cached TLS client session. */
+struct tls_session_entry {
+	/** Information whether the entry is used. */
+	bool is_used;
+
+	/** Time the session was stored. */
+	uint32_t created;
+
+	/** Time the session was last used, for LRU eviction. */
+	uint32_t last_used;
+
+	/** Peer address the session was established with. */
+	struct sockaddr peer;
+
+	/** Hostname the session was established with. */
+	char hostname[CONFIG_NET_SOCKETS_TLS_SESSION_HOSTNAME_LEN + 1];
+
+	/** mbedTLS session. */
+	mbedtls_ssl_session session;
+};
+
+/* A pool of cached TLS client sessions. */
+static struct tls_session_entry
+		tls_sessions[CONFIG_NET_SOCKETS_TLS_MAX_CLIENT_SESSION_COUNT];
+
+/* A mutex protecting session caches, ticket keys and statistics. */
+static struct k_mutex session_lock;
+
+static struct tls_session_stats session_stats;
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static mbedtls_ssl_cache_context tls_server_cache;
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+/* Session ticket keys. The mbedTLS configurations of the server sockets
+ * do not point to them, the ticket callbacks use the active keys so that
+ * they can be replaced while handshakes are running. NULL when the keys
+ * could not be set up.
+ */
+static mbedtls_ssl_ticket_context tls_server_tickets[2];
+static mbedtls_ssl_ticket_context *tls_server_ticket;
+#endif
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 #if defined(MBEDTLS_DEBUG_C) && (CONFIG_NET_SOCKETS_LOG_LEVEL >= LOG_LEVEL_DBG)
 static void tls_debug(void *ctx, int level, const char *file,
 		      int line, const char *str)
@@ -251,6 +320,444 @@ static int dtls_timing_get_delay(void *data)
 }
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+#if defined(MBEDTLS_SSL_CACHE_C)
+static int tls_server_cache_get(void *data, mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	ret = mbedtls_ssl_cache_get(data, session);
+	if (ret == 0) {
+		session_stats.server_resumed++;
+	}
+
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_server_cache_set(void *data, const mbedtls_ssl_session *session)
+{
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	ret = mbedtls_ssl_cache_set(data, session);
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+#endif /* MBEDTLS_SSL_CACHE_C */
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+static int tls_server_ticket_write(void *p_ticket,
+				   const mbedtls_ssl_session *session,
+				   unsigned char *start,
+				   const unsigned char *end,
+				   size_t *tlen, uint32_t *lifetime)
+{
+	int ret = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+
+	ARG_UNUSED(p_ticket);
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	if (tls_server_ticket) {
+		ret = mbedtls_ssl_ticket_write(tls_server_ticket, session,
+					       start, end, tlen, lifetime);
+	}
+
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static int tls_server_ticket_parse(void *p_ticket,
+				   mbedtls_ssl_session *session,
+				   unsigned char *buf, size_t len)
+{
+	int ret = MBEDTLS_ERR_SSL_INTERNAL_ERROR;
+
+	ARG_UNUSED(p_ticket);
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	if (tls_server_ticket) {
+		ret = mbedtls_ssl_ticket_parse(tls_server_ticket, session,
+					       buf, len);
+	}
+
+	if (ret == 0) {
+		session_stats.server_resumed++;
+	}
+
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+/* Replace the session ticket keys with new ones, tickets issued with the
+ * previous keys are no longer accepted. If the new keys cannot be set up,
+ * no tickets are issued or accepted. Called with session_lock held.
+ */
+static int tls_server_ticket_rotate(void)
+{
+	mbedtls_ssl_ticket_context *next = &tls_server_tickets[0];
+	int ret;
+
+	if (tls_server_ticket == next) {
+		next = &tls_server_tickets[1];
+	}
+
+	mbedtls_ssl_ticket_init(next);
+
+	ret = mbedtls_ssl_ticket_setup(next, mbedtls_ctr_drbg_random,
+				       &tls_ctr_drbg, TLS_TICKET_CIPHER,
+				       CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+
+	if (tls_server_ticket) {
+		mbedtls_ssl_ticket_free(tls_server_ticket);
+		tls_server_ticket = NULL;
+	}
+
+	if (ret != 0) {
+		NET_ERR("TLS session ticket setup failed: -%x", -ret);
+		mbedtls_ssl_ticket_free(next);
+		return -ENOMEM;
+	}
+
+	tls_server_ticket = next;
+
+	return 0;
+}
+#endif /* MBEDTLS_SSL_TICKET_C */
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+static void tls_server_cache_setup(void)
+{
+	mbedtls_ssl_cache_init(&tls_server_cache);
+	mbedtls_ssl_cache_set_max_entries(
+			&tls_server_cache,
+			CONFIG_NET_SOCKETS_TLS_MAX_SERVER_SESSION_COUNT);
+	mbedtls_ssl_cache_set_timeout(&tls_server_cache,
+				      CONFIG_NET_SOCKETS_TLS_SESSION_LIFETIME);
+}
+#endif /* MBEDTLS_SSL_CACHE_C */
+
+/* Initialize server session cache and session ticket keys. */
+static int tls_session_server_init(void)
+{
+	int ret = 0;
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	tls_server_cache_setup();
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	ret = tls_server_ticket_rotate();
+#endif
+
+	return ret;
+}
+
+static bool tls_session_peer_match(const struct sockaddr *addr1,
+				   const struct sockaddr *addr2)
+{
+	if (addr1->sa_family != addr2->sa_family) {
+		return false;
+	}
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && addr1->sa_family == AF_INET6) {
+		return (net_sin6(addr1)->sin6_port ==
+			net_sin6(addr2)->sin6_port) &&
+			net_ipv6_addr_cmp(&net_sin6(addr1)->sin6_addr,
+					  &net_sin6(addr2)->sin6_addr);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) &&
+		   addr1->sa_family == AF_INET) {
+		return (net_sin(addr1)->sin_port ==
+			net_sin(addr2)->sin_port) &&
+			net_ipv4_addr_cmp(&net_sin(addr1)->sin_addr,
+					  &net_sin(addr2)->sin_addr);
+	}
+
+	return false;
+}
+
+static const char *tls_session_hostname(struct tls_context *tls)
+{
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	if (tls->ssl.hostname != NULL) {
+		return tls->ssl.hostname;
+	}
+#endif
+
+	return "";
+}
+
+static void tls_session_entry_free(struct tls_session_entry *entry)
+{
+	mbedtls_ssl_session_free(&entry->session);
+	entry->is_used = false;
+
+	session_stats.client_cached--;
+}
+
+/* Find cached client session, dropping expired ones on the way.
+ * Must be called with session_lock held.
+ */
+static struct tls_session_entry *tls_session_find(const struct sockaddr *peer,
+						  const char *hostname)
+{
+	uint32_t now = k_uptime_get_32();
+	struct tls_session_entry *entry;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(tls_sessions); i++) {
+		entry = &tls_sessions[i];
+
+		if (!entry->is_used) {
+			continue;
+		}
+
+		if (now - entry->created >= TLS_SESSION_LIFETIME_MS) {
+			NET_DBG("TLS session %p expired", entry);
+			tls_session_entry_free(entry);
+			continue;
+		}
+
+		if (tls_session_peer_match(&entry->peer, peer) &&
+		    strcmp(entry->hostname, hostname) == 0) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/* Allocate client session entry, evicting the least recently used one
+ * if needed. Must be called with session_lock held.
+ */
+static struct tls_session_entry *tls_session_alloc(void)
+{
+	struct tls_session_entry *entry = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(tls_sessions); i++) {
+		if (!tls_sessions[i].is_used) {
+			entry = &tls_sessions[i];
+			break;
+		}
+
+		if (entry == NULL ||
+		    (int32_t)(tls_sessions[i].last_used -
+			      entry->last_used) < 0) {
+			entry = &tls_sessions[i];
+		}
+	}
+
+	if (entry->is_used) {
+		NET_DBG("Evicting TLS session %p", entry);
+		tls_session_entry_free(entry);
+		session_stats.client_evicted++;
+	}
+
+	mbedtls_ssl_session_init(&entry->session);
+	entry->is_used = true;
+
+	session_stats.client_cached++;
+
+	return entry;
+}
+
+/* Offer cached session, if any, to the peer on the next handshake. */
+static void tls_session_restore(struct net_context *context,
+				const struct sockaddr *addr)
+{
+	struct tls_session_entry *entry;
+	int ret;
+
+	if (context->tls->options.session_cache != TLS_SESSION_CACHE_ENABLED) {
+		return;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	entry = tls_session_find(addr, tls_session_hostname(context->tls));
+	if (entry == NULL) {
+		goto out;
+	}
+
+	ret = mbedtls_ssl_set_session(&context->tls->ssl, &entry->session);
+	if (ret != 0) {
+		NET_DBG("Failed to restore TLS session: -%x", -ret);
+		tls_session_entry_free(entry);
+	}
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+/* Update client session cache and statistics after the handshake. */
+static void tls_session_store(struct net_context *context,
+			      const struct sockaddr *addr, bool established)
+{
+	const char *hostname = tls_session_hostname(context->tls);
+	mbedtls_ssl_session *session = context->tls->ssl.session;
+	struct tls_session_entry *entry;
+	bool resumed = false;
+	int ret;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	if (established) {
+		session_stats.client_handshakes++;
+	}
+
+	if (context->tls->options.session_cache != TLS_SESSION_CACHE_ENABLED) {
+		goto out;
+	}
+
+	entry = tls_session_find(addr, hostname);
+
+	if (!established) {
+		/* Do not offer a session that could not be resumed again. */
+		if (entry != NULL) {
+			tls_session_entry_free(entry);
+		}
+
+		goto out;
+	}
+
+	/* On resumption, the server echoes the session ID offered. */
+	if (entry != NULL && session != NULL && session->id_len != 0 &&
+	    session->id_len == entry->session.id_len &&
+	    memcmp(session->id, entry->session.id, session->id_len) == 0) {
+		session_stats.client_resumed++;
+		resumed = true;
+	}
+
+	if (strlen(hostname) > CONFIG_NET_SOCKETS_TLS_SESSION_HOSTNAME_LEN) {
+		goto out;
+	}
+
+	if (entry == NULL) {
+		entry = tls_session_alloc();
+		memcpy(&entry->peer, addr, sizeof(entry->peer));
+		strcpy(entry->hostname, hostname);
+	} else {
+		/* Replace the session, a new ticket might have been issued. */
+		mbedtls_ssl_session_free(&entry->session);
+		mbedtls_ssl_session_init(&entry->session);
+	}
+
+	ret = mbedtls_ssl_get_session(&context->tls->ssl, &entry->session);
+	if (ret != 0) {
+		NET_DBG("Failed to store TLS session: -%x", -ret);
+		tls_session_entry_free(entry);
+		goto out;
+	}
+
+	entry->last_used = k_uptime_get_32();
+	if (!resumed) {
+		entry->created = entry->last_used;
+	}
+
+out:
+	k_mutex_unlock(&session_lock);
+}
+
+static void tls_session_server_handshake_done(void)
+{
+	k_mutex_lock(&session_lock, K_FOREVER);
+	session_stats.server_handshakes++;
+	k_mutex_unlock(&session_lock);
+}
+
+/* Drop all cached sessions and invalidate issued session tickets. */
+static int tls_session_purge(void)
+{
+	int ret = 0;
+	int i;
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+
+	for (i = 0; i < ARRAY_SIZE(tls_sessions); i++) {
+		if (tls_sessions[i].is_used) {
+			tls_session_entry_free(&tls_sessions[i]);
+		}
+	}
+
+	/* The cache stays at the same address and is only accessed through
+	 * tls_server_cache_get/set() under session_lock, so handshakes of
+	 * the server sockets never see it half cleared.
+	 */
+#if defined(MBEDTLS_SSL_CACHE_C)
+	mbedtls_ssl_cache_free(&tls_server_cache);
+	tls_server_cache_setup();
+#endif
+
+#if defined(MBEDTLS_SSL_TICKET_C)
+	ret = tls_server_ticket_rotate();
+#endif
+
+	k_mutex_unlock(&session_lock);
+
+	return ret;
+}
+
+static void tls_mbedtls_session_conf(struct tls_context *tls, bool is_server)
+{
+#if defined(MBEDTLS_SSL_CACHE_C)
+	if (is_server &&
+	    tls->options.session_cache == TLS_SESSION_CACHE_ENABLED) {
+		mbedtls_ssl_conf_session_cache(&tls->config, &tls_server_cache,
+					       tls_server_cache_get,
+					       tls_server_cache_set);
+	}
+#endif
+
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	if (tls->options.session_tickets == -1) {
+		return;
+	}
+
+#if defined(MBEDTLS_SSL_CLI_C)
+	if (!is_server) {
+		mbedtls_ssl_conf_session_tickets(
+			&tls->config, tls->options.session_tickets ?
+				MBEDTLS_SSL_SESSION_TICKETS_ENABLED :
+				MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+	}
+#endif
+
+#if defined(MBEDTLS_SSL_SRV_C) && defined(MBEDTLS_SSL_TICKET_C)
+	if (is_server && tls->options.session_tickets && tls_server_ticket) {
+		mbedtls_ssl_conf_session_tickets_cb(&tls->config,
+						    tls_server_ticket_write,
+						    tls_server_ticket_parse,
+						    NULL);
+	}
+#endif
+#endif /* MBEDTLS_SSL_SESSION_TICKETS */
+}
+#else
+static inline void tls_session_restore(struct net_context *context,
+				       const struct sockaddr *addr)
+{
+}
+
+static inline void tls_session_store(struct net_context *context,
+				     const struct sockaddr *addr,
+				     bool established)
+{
+}
+
+static inline void tls_session_server_handshake_done(void)
+{
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 /* Initialize TLS internals. */
 static int tls_init(struct device *unused)
 {
@@ -286,6 +793,15 @@ static int tls_init(struct device *unused)
 		return -EFAULT;
 	}
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	k_mutex_init(&session_lock);
+
+	ret = tls_session_server_init();
+	if (ret < 0) {
+		return ret;
+	}
+#endif
+
 #if defined(MBEDTLS_DEBUG_C) && (CONFIG_NET_SOCKETS_LOG_LEVEL >= LOG_LEVEL_DBG)
 	mbedtls_debug_set_threshold(CONFIG_MBEDTLS_DEBUG_LEVEL);
 #endif
@@ -314,6 +830,9 @@ static struct tls_context *tls_alloc(void)
 			(void)memset(tls, 0, sizeof(*tls));
 			tls->is_used = true;
 			tls->options.verify_level = -1;
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+			tls->options.session_tickets = -1;
+#endif
 
 			NET_DBG("Allocated TLS context, %p", tls);
 			break;
@@ -906,6 +1425,10 @@ static int tls_mbedtls_init(struct net_context *context, bool is_server)
 			     mbedtls_ctr_drbg_random,
 			     &tls_ctr_drbg);
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	tls_mbedtls_session_conf(context->tls, is_server);
+#endif
+
 	ret = tls_mbedtls_set_credentials(context->tls);
 	if (ret != 0) {
 		return ret;
@@ -1113,6 +1636,87 @@ static int tls_opt_dtls_role_set(struct net_context *context,
 	return 0;
 }
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+static int tls_opt_session_cache_set(struct net_context *context,
+				     const void *optval, socklen_t optlen)
+{
+	int *session_cache;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	session_cache = (int *)optval;
+	if (*session_cache != TLS_SESSION_CACHE_DISABLED &&
+	    *session_cache != TLS_SESSION_CACHE_ENABLED) {
+		return -EINVAL;
+	}
+
+	context->tls->options.session_cache = *session_cache;
+
+	return 0;
+}
+
+static int tls_opt_session_cache_get(struct net_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->tls->options.session_cache;
+
+	return 0;
+}
+
+static int tls_opt_session_tickets_set(struct net_context *context,
+				       const void *optval, socklen_t optlen)
+{
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	int *session_tickets;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	session_tickets = (int *)optval;
+	if (*session_tickets != 0 && *session_tickets != 1) {
+		return -EINVAL;
+	}
+
+	context->tls->options.session_tickets = *session_tickets;
+
+	return 0;
+#else
+	return -ENOPROTOOPT;
+#endif
+}
+
+static int tls_opt_session_stats_get(struct net_context *context,
+				     void *optval, socklen_t *optlen)
+{
+	ARG_UNUSED(context);
+
+	if (*optlen != sizeof(struct tls_session_stats)) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&session_lock, K_FOREVER);
+	memcpy(optval, &session_stats, sizeof(session_stats));
+	k_mutex_unlock(&session_lock);
+
+	return 0;
+}
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 static int ztls_socket(int family, int type, int proto)
 {
 	enum net_ip_protocol_secure tls_proto = 0;
@@ -1237,10 +1841,13 @@ int ztls_connect_ctx(struct net_context *ctx, const struct sockaddr *addr,
 		/* Do not use any socket flags during the handshake. */
 		ctx->tls->flags = 0;
 
+		tls_session_restore(ctx, addr);
+
 		/* TODO For simplicity, TLS handshake blocks the socket
 		 * even for non-blocking socket.
 		 */
 		ret = tls_mbedtls_handshake(ctx, true);
+		tls_session_store(ctx, addr, ret == 0);
 		if (ret < 0) {
 			goto error;
 		}
@@ -1332,6 +1939,8 @@ int ztls_accept_ctx(struct net_context *parent, struct sockaddr *addr,
 		goto error;
 	}
 
+	tls_session_server_handshake_done();
+
 	return fd;
 
 error:
@@ -1870,6 +2479,16 @@ int ztls_getsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_ciphersuite_used_get(ctx, optval, optlen);
 		break;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_get(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_STATS:
+		err = tls_opt_session_stats_get(ctx, optval, optlen);
+		break;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	default:
 		/* Unknown or write-only option. */
 		err = -ENOPROTOOPT;
@@ -1920,6 +2539,20 @@ int ztls_setsockopt_ctx(struct net_context *ctx, int level, int optname,
 		err = tls_opt_dtls_role_set(ctx, optval, optlen);
 		break;
 
+#if defined(CONFIG_NET_SOCKETS_TLS_SESSION_CACHE)
+	case TLS_SESSION_CACHE:
+		err = tls_opt_session_cache_set(ctx, optval, optlen);
+		break;
+
+	case TLS_SESSION_CACHE_PURGE:
+		err = tls_session_purge();
+		break;
+
+	case TLS_SESSION_TICKETS:
+		err = tls_opt_session_tickets_set(ctx, optval, optlen);
+		break;
+#endif /* CONFIG_NET_SOCKETS_TLS_SESSION_CACHE */
+
 	default:
 		/* Unknown or read-only option. */
 		err = -ENOPROTOOPT;
@@ -438,27 +438,76 @@ static int websocket_ioctl_vmeth(void *obj, unsigned int request, va_list args)
 	return sock_fd_op_vtable.fd_vtable.ioctl(obj, request, args);
 }
 
+/* Word type used when masking the payload so that the XOR is done one
+ * machine word at a time instead of byte by byte.
+ */
+typedef unsigned long __may_alias ws_word_t;
+
+/* Mask or unmask data in place. The pos tells the offset of the data in the
+ * payload so that the correct byte of the masking key is used.
+ */
+static void websocket_mask(uint8_t *data, size_t len, uint32_t mask,
+			   uint64_t pos)
+{
+	uint8_t key[sizeof(uint32_t)];
+	ws_word_t word_mask;
+	size_t i = 0;
+	int j;
+
+	sys_put_be32(mask, key);
+
+	while (i < len && ((uintptr_t)&data[i] & (sizeof(ws_word_t) - 1))) {
+		data[i] ^= key[(pos + i) % sizeof(key)];
+		i++;
+	}
+
+	if (len - i >= sizeof(ws_word_t)) {
+		/* The word size is a multiple of the key size, so the same
+		 * word mask can be used for the whole aligned part.
+		 */
+		for (j = 0; j < sizeof(ws_word_t); j++) {
+			((uint8_t *)&word_mask)[j] =
+				key[(pos + i + j) % sizeof(key)];
+		}
+
+		for (; len - i >= sizeof(ws_word_t); i += sizeof(ws_word_t)) {
+			*(ws_word_t *)&data[i] ^= word_mask;
+		}
+	}
+
+	for (; i < len; i++) {
+		data[i] ^= key[(pos + i) % sizeof(key)];
+	}
+}
+
 static int websocket_prepare_and_send(struct websocket_context *ctx,
 				      uint8_t *header, size_t header_len,
-				      uint8_t *payload, size_t payload_len,
+				      struct iovec *payload, size_t iovcnt,
 				      int32_t timeout)
 {
-	struct iovec io_vector[2];
+	struct iovec io_vector[1 + WEBSOCKET_MAX_IOV];
 	struct msghdr msg;
+	size_t i;
 
 	io_vector[0].iov_base = header;
 	io_vector[0].iov_len = header_len;
-	io_vector[1].iov_base = payload;
-	io_vector[1].iov_len = payload_len;
+
+	for (i = 0; i < iovcnt; i++) {
+		io_vector[1 + i] = payload[i];
+	}
 
 	memset(&msg, 0, sizeof(msg));
 
 	msg.msg_iov = io_vector;
-	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+	msg.msg_iovlen = 1 + iovcnt;
 
 	if (HEXDUMP_SENT_PACKETS) {
 		LOG_HEXDUMP_DBG(header, header_len, "Header");
-		LOG_HEXDUMP_DBG(payload, payload_len, "Payload");
+
+		for (i = 0; i < iovcnt; i++) {
+			LOG_HEXDUMP_DBG(payload[i].iov_base, payload[i].iov_len,
+					"Payload");
+		}
 	}
 
 #if defined(CONFIG_NET_TEST)
@@ -478,13 +527,36 @@ static int websocket_prepare_and_send(struct websocket_context *ctx,
 #endif /* CONFIG_NET_TEST */
 }
 
-int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
-		       enum websocket_opcode opcode, bool mask, bool final,
-		       int32_t timeout)
+static int websocket_send_ctx(int ws_sock, struct websocket_context **ctx)
+{
+#if defined(CONFIG_NET_TEST)
+	/* Websocket unit test does not use socket layer but feeds
+	 * the data directly here when testing this function.
+	 */
+	*ctx = INT_TO_POINTER(ws_sock);
+#else
+	*ctx = z_get_fd_obj(ws_sock, NULL, 0);
+	if (*ctx == NULL) {
+		return -EBADF;
+	}
+
+	if (!PART_OF_ARRAY(contexts, *ctx)) {
+		return -ENOENT;
+	}
+#endif /* CONFIG_NET_TEST */
+
+	return 0;
+}
+
+static int websocket_send_iov(struct websocket_context *ctx,
+			      struct iovec *iov, size_t iovcnt,
+			      enum websocket_opcode opcode, bool mask,
+			      bool final, int32_t timeout)
 {
-	struct websocket_context *ctx;
 	uint8_t header[MAX_HEADER_LEN], hdr_len = 2;
-	uint8_t *data_to_send = (uint8_t *)payload;
+	size_t payload_len = 0;
+	uint64_t pos = 0;
+	size_t i;
 	int ret;
 
 	if (opcode != WEBSOCKET_OPCODE_DATA_TEXT &&
@@ -496,21 +568,13 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		return -EINVAL;
 	}
 
-#if defined(CONFIG_NET_TEST)
-	/* Websocket unit test does not use socket layer but feeds
-	 * the data directly here when testing this function.
-	 */
-	ctx = INT_TO_POINTER(ws_sock);
-#else
-	ctx = z_get_fd_obj(ws_sock, NULL, 0);
-	if (ctx == NULL) {
-		return -EBADF;
+	if (iovcnt > WEBSOCKET_MAX_IOV) {
+		return -EINVAL;
 	}
 
-	if (!PART_OF_ARRAY(contexts, ctx)) {
-		return -ENOENT;
+	for (i = 0; i < iovcnt; i++) {
+		payload_len += iov[i].iov_len;
 	}
-#endif /* CONFIG_NET_TEST */
 
 	NET_DBG("[%p] Len %zd %s/%d/%s", ctx, payload_len, opcode2str(opcode),
 		mask, final ? "final" : "more");
@@ -548,8 +612,6 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 
 	/* Add masking value if needed */
 	if (mask) {
-		int i;
-
 		ctx->masking_value = sys_rand32_get();
 
 		header[hdr_len++] |= ctx->masking_value >> 24;
@@ -557,32 +619,75 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		header[hdr_len++] |= ctx->masking_value >> 8;
 		header[hdr_len++] |= ctx->masking_value;
 
-		data_to_send = k_malloc(payload_len);
-		if (!data_to_send) {
-			return -ENOMEM;
+		for (i = 0; i < iovcnt; i++) {
+			websocket_mask(iov[i].iov_base, iov[i].iov_len,
+				       ctx->masking_value, pos);
+			pos += iov[i].iov_len;
 		}
+	}
+
+	ret = websocket_prepare_and_send(ctx, header, hdr_len, iov, iovcnt,
+					 timeout);
+	if (ret < 0) {
+		ret = -errno;
+		NET_DBG("Cannot send ws msg (%d)", ret);
+		return ret;
+	}
 
-		memcpy(data_to_send, payload, payload_len);
+	return ret - hdr_len;
+}
 
-		for (i = 0; i < payload_len; i++) {
-			data_to_send[i] ^=
-				ctx->masking_value >> (8 * (3 - i % 4));
-		}
+int websocket_send_msg_iov(int ws_sock, struct iovec *iov, size_t iovcnt,
+			   enum websocket_opcode opcode, bool mask, bool final,
+			   int32_t timeout)
+{
+	struct websocket_context *ctx;
+	int ret;
+
+	ret = websocket_send_ctx(ws_sock, &ctx);
+	if (ret < 0) {
+		return ret;
 	}
 
-	ret = websocket_prepare_and_send(ctx, header, hdr_len,
-					 data_to_send, payload_len, timeout);
+	return websocket_send_iov(ctx, iov, iovcnt, opcode, mask, final,
+				  timeout);
+}
+
+int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
+		       enum websocket_opcode opcode, bool mask, bool final,
+		       int32_t timeout)
+{
+	struct websocket_context *ctx;
+	struct iovec iov;
+	int ret;
+
+	ret = websocket_send_ctx(ws_sock, &ctx);
 	if (ret < 0) {
-		NET_DBG("Cannot send ws msg (%d)", -errno);
-		goto quit;
+		return ret;
 	}
 
-quit:
-	if (data_to_send != payload) {
-		k_free(data_to_send);
+	iov.iov_base = (void *)payload;
+	iov.iov_len = payload_len;
+
+	if (!mask || payload_len == 0) {
+		/* The payload is not modified so it can be sent as is */
+		return websocket_send_iov(ctx, &iov, 1, opcode, mask, final,
+					  timeout);
 	}
 
-	return ret - hdr_len;
+	/* The payload is const so mask a copy of it */
+	iov.iov_base = k_malloc(payload_len);
+	if (!iov.iov_base) {
+		return -ENOMEM;
+	}
+
+	memcpy(iov.iov_base, payload, payload_len);
+
+	ret = websocket_send_iov(ctx, &iov, 1, opcode, mask, final, timeout);
+
+	k_free(iov.iov_base);
+
+	return ret;
 }
 
 static bool websocket_parse_header(uint8_t *buf, size_t buf_len, bool *masked,
@@ -649,6 +754,32 @@ static bool websocket_parse_header(uint8_t *buf, size_t buf_len, bool *masked,
 	return false;
 }
 
+/* Check if the temp buffer contains a complete websocket header. The message
+ * information in the context is updated from the header.
+ */
+static bool websocket_header_parsed(struct websocket_context *ctx,
+				    size_t *header_len)
+{
+	bool masked;
+
+	if (ctx->tmp_buf_pos < MIN_HEADER_LEN) {
+		return false;
+	}
+
+	ctx->message_type = 0;
+
+	if (!websocket_parse_header(&ctx->tmp_buf[0], ctx->tmp_buf_pos,
+				    &masked, &ctx->masking_value,
+				    &ctx->message_len, &ctx->message_type,
+				    header_len)) {
+		return false;
+	}
+
+	ctx->masked = masked;
+
+	return ctx->tmp_buf_pos >= *header_len;
+}
+
 int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 		       uint32_t *message_type, uint64_t *remaining, int32_t timeout)
 {
@@ -687,8 +818,12 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 	}
 #endif /* CONFIG_NET_TEST */
 
-	/* If we have not received the websocket header yet, read it first */
-	if (!ctx->header_received) {
+	/* If we have not received the websocket header yet, read it first.
+	 * The header of the next frame might already be in the temp buffer
+	 * if the previous read returned more than one frame.
+	 */
+	if (!ctx->header_received &&
+	    !websocket_header_parsed(ctx, &header_len)) {
 #if defined(CONFIG_NET_TEST)
 		size_t input_len = MIN(ctx->tmp_buf_len - ctx->tmp_buf_pos,
 				       test_data->input_len);
@@ -714,40 +849,21 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 
 		ctx->tmp_buf_pos += ret;
 
-		if (ctx->tmp_buf_pos >= MIN_HEADER_LEN) {
-			bool masked;
-
-			/* Now we will be able to figure out what is the
-			 * actual size of the header.
-			 */
-			if (websocket_parse_header(&ctx->tmp_buf[0],
-						   ctx->tmp_buf_pos,
-						   &masked,
-						   &ctx->masking_value,
-						   &ctx->message_len,
-						   &ctx->message_type,
-						   &header_len)) {
-				ctx->masked = masked;
-
-				if (message_type) {
-					*message_type = ctx->message_type;
-				}
-			} else {
-				return -EAGAIN;
-			}
-		} else {
-			return -EAGAIN;
-		}
-
-		if (ctx->tmp_buf_pos < header_len) {
+		if (!websocket_header_parsed(ctx, &header_len)) {
 			return -EAGAIN;
 		}
+	}
 
+	if (!ctx->header_received) {
 		/* All of the header is now received, we can read the payload
 		 * data next.
 		 */
 		ctx->header_received = true;
 
+		if (message_type) {
+			*message_type = ctx->message_type;
+		}
+
 		if (HEXDUMP_RECV_PACKETS) {
 			LOG_HEXDUMP_DBG(&ctx->tmp_buf[0], header_len,
 					"Header");
@@ -763,7 +879,7 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 			ctx->tmp_buf_len - header_len);
 		ctx->tmp_buf_pos -= header_len;
 
-		if (ctx->tmp_buf_pos == 0) {
+		if (ctx->tmp_buf_pos == 0 && ctx->message_len > 0) {
 			/* No data after the header, let the caller call
 			 * this function again to get the payload.
 			 */
@@ -776,76 +892,75 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 	/* Now read the whole payload or parts of it */
 
 	if (ctx->tmp_buf_pos == 0) {
-		/* Read more data into temp buffer */
+		/* Nothing is buffered, so read the payload directly into the
+		 * user buffer. At most the rest of this frame is read so that
+		 * the next header stays in the socket.
+		 */
+		can_copy = MIN(ctx->message_len - ctx->total_read, buf_len);
+		if (can_copy > 0) {
 #if defined(CONFIG_NET_TEST)
-		size_t input_len = MIN(ctx->tmp_buf_len, test_data->input_len);
+			can_copy = MIN(can_copy, test_data->input_len);
 
-		memcpy(ctx->tmp_buf, test_data->input_buf, input_len);
-		test_data->input_buf += input_len;
+			memcpy(buf, test_data->input_buf, can_copy);
+			test_data->input_buf += can_copy;
 
-		ret = input_len;
+			ret = can_copy;
 #else
-		ret = recv(ctx->real_sock, ctx->tmp_buf, ctx->tmp_buf_len,
-			   K_TIMEOUT_EQ(tout, K_NO_WAIT) ? MSG_DONTWAIT : 0);
+			ret = recv(ctx->real_sock, buf, can_copy,
+				   K_TIMEOUT_EQ(tout, K_NO_WAIT) ?
+				   MSG_DONTWAIT : 0);
 #endif /* CONFIG_NET_TEST */
 
-		if (ret < 0) {
-			return -errno;
-		}
+			if (ret < 0) {
+				return -errno;
+			}
 
-		if (ret == 0) {
-			return 0;
+			if (ret == 0) {
+				return 0;
+			}
+		} else {
+			ret = 0;
 		}
 
-		ctx->tmp_buf_pos = ret;
-	}
-
-	if (ctx->tmp_buf_pos <= buf_len) {
+		recv_len = ret;
+	} else {
 		/* Is there already any data in the temp buffer? If yes,
 		 * just return it to the caller.
 		 */
 		can_copy = MIN(ctx->message_len - ctx->total_read,
-			       ctx->tmp_buf_pos);
-	} else {
-		/* We have more data in tmp buffer that will fit into
-		 * user buffer.
-		 */
-		can_copy = MIN(ctx->message_len - ctx->total_read, buf_len);
-	}
+			       MIN(ctx->tmp_buf_pos, buf_len));
 
-	left = ctx->tmp_buf_pos - can_copy;
+		left = ctx->tmp_buf_pos - can_copy;
 
-	NET_ASSERT(ctx->tmp_buf_pos >= can_copy);
+		memmove(buf, ctx->tmp_buf, can_copy);
+		recv_len = can_copy;
 
-	memmove(buf, ctx->tmp_buf, can_copy);
-	recv_len = can_copy;
+		if (left > 0) {
+			memmove(ctx->tmp_buf, &ctx->tmp_buf[can_copy], left);
+		}
 
-	if (left > 0) {
-		memmove(ctx->tmp_buf, &ctx->tmp_buf[can_copy], left);
+		ctx->tmp_buf_pos = left;
 	}
 
-	ctx->tmp_buf_pos = left;
 	ctx->total_read += recv_len;
 
-	/* Unmask the data */
+	/* Unmask the data. As we might have received data in pieces that are
+	 * not multiple of 4 bytes, the offset in the payload tells which byte
+	 * of the masking value to start from.
+	 */
 	if (ctx->masked) {
-		/* As we might have less than 4 received bytes, we must select
-		 * which byte from masking value to take. The mask_shift will
-		 * tell that.
-		 */
-		int mask_shift = (ctx->total_read - recv_len) % sizeof(uint32_t);
-		int i;
-
-		for (i = 0; i < recv_len; i++) {
-			buf[i] ^= ctx->masking_value >>
-				(8 * (3 - (i + mask_shift) % 4));
-		}
+		websocket_mask(buf, recv_len, ctx->masking_value,
+			       ctx->total_read - recv_len);
 	}
 
 #if HEXDUMP_RECV_PACKETS
 	LOG_HEXDUMP_DBG(buf, recv_len, "Payload");
 #endif
 
+	if (message_type) {
+		*message_type = ctx->message_type;
+	}
+
 	if (remaining) {
 		*remaining = ctx->message_len - ctx->total_read;
 	}
@@ -860,6 +975,66 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 	return recv_len;
 }
 
+int websocket_recv_frames(int ws_sock, uint8_t *buf, size_t buf_len,
+			  struct websocket_frame *frames, size_t max_frames,
+			  int32_t timeout)
+{
+	struct websocket_frame *frame = NULL;
+	uint32_t message_type;
+	uint64_t remaining;
+	size_t count = 0;
+	size_t used = 0;
+	int ret = 0;
+
+	if (buf == NULL || buf_len == 0 || frames == NULL || max_frames == 0) {
+		return -EINVAL;
+	}
+
+	while (used < buf_len) {
+		message_type = 0;
+
+		/* Only the first frame is waited for, the rest are returned
+		 * if they are already available.
+		 */
+		ret = websocket_recv_msg(ws_sock, &buf[used], buf_len - used,
+					 &message_type, &remaining,
+					 count == 0 ? timeout : 0);
+		if (ret == -EAGAIN && count == 0 && timeout != 0) {
+			/* Only part of the header was received */
+			continue;
+		}
+
+		if (ret < 0 || (ret == 0 && message_type == 0)) {
+			break;
+		}
+
+		if (frame != NULL && frame->remaining > 0) {
+			/* Rest of the frame that was returned partially */
+			frame->len += ret;
+			frame->remaining = remaining;
+		} else {
+			frame = &frames[count++];
+			frame->data = &buf[used];
+			frame->len = ret;
+			frame->message_type = message_type;
+			frame->remaining = remaining;
+		}
+
+		used += ret;
+
+		/* Stop when there is no room for the next frame */
+		if (count == max_frames && frame->remaining == 0) {
+			break;
+		}
+	}
+
+	if (count == 0) {
+		return ret;
+	}
+
+	return count;
+}
+
 static int websocket_send(struct websocket_context *ctx, const uint8_t *buf,
 			  size_t buf_len, int32_t timeout)
 {
@@ -74,6 +74,26 @@ static void shell_tdata_dump(const struct k_thread *cthread, void *user_data)
 		      thread->base.timeout.dticks);
 	shell_print(shell, "\tstate: %s", k_thread_state_str(thread));
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	k_thread_runtime_stats_t rt_stats;
+
+	if (k_thread_runtime_stats_get(thread, &rt_stats) == 0) {
+		shell_print(shell, "\truntime: %llu cycles, usage %u %%",
+			    rt_stats.execution_cycles,
+			    k_thread_runtime_utilization_get(thread));
+	}
+#endif
+
+#ifdef CONFIG_IRQ_STATS
+	struct k_irq_wakeup wakeup;
+
+	if (k_thread_irq_wakeup_get(thread, &wakeup) == 0) {
+		shell_print(shell, "\tlast irq wakeup: irq %u, give %u cycles, "
+			    "run %u cycles", wakeup.irq, wakeup.give_cycles,
+			    wakeup.run_cycles);
+	}
+#endif
+
 	ret = k_thread_stack_space_get(thread, &unused);
 	if (ret) {
 		shell_print(shell,
@@ -171,6 +191,59 @@ static int cmd_kernel_stacks(const struct shell *shell,
 }
 #endif
 
+#ifdef CONFIG_IRQ_STATS
+static uint32_t duration_avg(const struct irq_duration *duration)
+{
+	return (duration->count != 0U) ?
+		(uint32_t)(duration->total_cycles / duration->count) : 0U;
+}
+
+static int cmd_kernel_irqs(const struct shell *shell,
+			   size_t argc, char **argv)
+{
+	struct irq_stats stats;
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	shell_print(shell, "Max nesting: %u", irq_stats_max_nesting_get());
+	shell_print(shell, "IRQ      count  nested   min/avg/max cycles   "
+		    "wakeups  min/avg/max cycles");
+
+	for (unsigned int irq = 0U; irq_stats_get(irq, &stats) == 0; irq++) {
+		if (stats.run.count == 0U) {
+			continue;
+		}
+
+		shell_print(shell, "%3u %10u %7u %6u/%u/%u %8u %6u/%u/%u",
+			    irq, stats.run.count, stats.nested,
+			    stats.run.min_cycles, duration_avg(&stats.run),
+			    stats.run.max_cycles, stats.wakeup.count,
+			    stats.wakeup.min_cycles,
+			    duration_avg(&stats.wakeup),
+			    stats.wakeup.max_cycles);
+	}
+
+	return 0;
+}
+
+static int cmd_kernel_irqs_reset(const struct shell *shell,
+				 size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	irq_stats_reset();
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel_irqs,
+	SHELL_CMD(reset, NULL, "Clear interrupt statistics.",
+		  cmd_kernel_irqs_reset),
+	SHELL_SUBCMD_SET_END /* Array terminated. */
+);
+#endif
+
 #if defined(CONFIG_REBOOT)
 static int cmd_kernel_reboot_warm(const struct shell *shell,
 				  size_t argc, char **argv)
@@ -199,6 +272,10 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel_reboot,
 
 SHELL_STATIC_SUBCMD_SET_CREATE(sub_kernel,
 	SHELL_CMD(cycles, NULL, "Kernel cycles.", cmd_kernel_cycles),
+#ifdef CONFIG_IRQ_STATS
+	SHELL_CMD(irqs, &sub_kernel_irqs, "Interrupt statistics.",
+		  cmd_kernel_irqs),
+#endif
 #if defined(CONFIG_REBOOT)
 	SHELL_CMD(reboot, &sub_kernel_reboot, "Reboot.", NULL),
 #endif
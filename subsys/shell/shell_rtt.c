@@ -25,11 +25,15 @@ static bool rtt_blocking;
 
 static void timer_handler(struct k_timer *timer)
 {
-	const struct shell_rtt *sh_rtt = k_timer_user_data_get(timer);
+	struct shell_rtt *sh_rtt = k_timer_user_data_get(timer);
 
 	if (SEGGER_RTT_HasData(0)) {
 		sh_rtt->handler(SHELL_TRANSPORT_EVT_RX_RDY, sh_rtt->context);
 	}
+
+	if (atomic_cas(&sh_rtt->tx_pending, 1, 0)) {
+		sh_rtt->handler(SHELL_TRANSPORT_EVT_TX_RDY, sh_rtt->context);
+	}
 }
 
 static int init(const struct shell_transport *transport,
@@ -82,6 +86,22 @@ static int write(const struct shell_transport *transport,
 		*cnt = SEGGER_RTT_Write(0, data8, length);
 	}
 
+	if ((*cnt == 0U) && !rtt_blocking && (length != 0U)) {
+		if (sh_rtt->tx_retries < CONFIG_SHELL_RTT_TX_RETRY_CNT) {
+			/* Up buffer is full, retry once the host had time
+			 * to read it instead of spinning.
+			 */
+			sh_rtt->tx_retries++;
+			atomic_set(&sh_rtt->tx_pending, 1);
+			return 0;
+		}
+
+		/* The host is not reading, drop the output. */
+		*cnt = length;
+	} else {
+		sh_rtt->tx_retries = 0U;
+	}
+
 	sh_rtt->handler(SHELL_TRANSPORT_EVT_TX_RDY, sh_rtt->context);
 
 	return 0;
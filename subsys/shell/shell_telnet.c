@@ -34,6 +34,15 @@ struct shell_telnet *sh_telnet;
 
 /* Basic TELNET implmentation. */
 
+/* The buffered output is discarded by the work, the only reader of the ring
+ * buffer, as it cannot be reset while the shell may be writing to it.
+ */
+static void telnet_tx_discard(void)
+{
+	atomic_set(&sh_telnet->tx_discard, 1);
+	k_delayed_work_submit(&sh_telnet->send_work, K_NO_WAIT);
+}
+
 static void telnet_end_client_connection(void)
 {
 	struct net_pkt *pkt;
@@ -43,7 +52,8 @@ static void telnet_end_client_connection(void)
 	sh_telnet->client_ctx = NULL;
 	sh_telnet->output_lock = false;
 
-	k_delayed_work_cancel(&sh_telnet->send_work);
+	/* Do not send what was left over to the next client */
+	telnet_tx_discard();
 
 	/* Flush the RX FIFO */
 	while ((pkt = k_fifo_get(&sh_telnet->rx_fifo, K_NO_WAIT)) != NULL) {
@@ -108,8 +118,7 @@ static void telnet_reply_command(struct telnet_simple_command *cmd)
 	case NVT_CMD_AO:
 		/* OK, no output then */
 		sh_telnet->output_lock = true;
-		sh_telnet->line_out.len = 0;
-		k_delayed_work_cancel(&sh_telnet->send_work);
+		telnet_tx_discard();
 		break;
 	case NVT_CMD_AYT:
 		telnet_reply_ay_command();
@@ -125,34 +134,54 @@ static void telnet_reply_command(struct telnet_simple_command *cmd)
 
 static int telnet_send(void)
 {
+	uint8_t *data;
+	uint32_t len;
 	int err;
 
-	if (sh_telnet->line_out.len == 0) {
-		return 0;
-	}
-
 	if (sh_telnet->client_ctx == NULL) {
 		return -ENOTCONN;
 	}
 
-	err = net_context_send(sh_telnet->client_ctx, sh_telnet->line_out.buf,
-			       sh_telnet->line_out.len, telnet_sent_cb,
-			       K_FOREVER, NULL);
-	if (err < 0) {
-		LOG_ERR("Failed to send %d, shutting down", err);
-		telnet_end_client_connection();
-		return err;
-	}
+	/* Drain the whole buffer, possibly in two parts if it wraps */
+	while ((len = ring_buf_get_claim(&sh_telnet->tx_ringbuf, &data,
+					 sizeof(sh_telnet->tx_buf))) > 0) {
+		err = net_context_send(sh_telnet->client_ctx, data, len,
+				       telnet_sent_cb, K_FOREVER, NULL);
+
+		(void)ring_buf_get_finish(&sh_telnet->tx_ringbuf, len);
 
-	/* We reinitialize the line buffer */
-	sh_telnet->line_out.len = 0;
+		if (err < 0) {
+			LOG_ERR("Failed to send %d, shutting down", err);
+			telnet_end_client_connection();
+			return err;
+		}
+	}
 
 	return 0;
 }
 
+static void telnet_drop(void)
+{
+	uint8_t *data;
+	uint32_t len;
+
+	while ((len = ring_buf_get_claim(&sh_telnet->tx_ringbuf, &data,
+					 sizeof(sh_telnet->tx_buf))) > 0) {
+		(void)ring_buf_get_finish(&sh_telnet->tx_ringbuf, len);
+	}
+}
+
 static void telnet_send_prematurely(struct k_work *work)
 {
-	(void)telnet_send();
+	if (atomic_clear(&sh_telnet->tx_discard)) {
+		telnet_drop();
+	} else {
+		(void)telnet_send();
+	}
+
+	/* Space was freed, a writer may wait for it */
+	sh_telnet->shell_handler(SHELL_TRANSPORT_EVT_TX_RDY,
+				 sh_telnet->shell_context);
 }
 
 static inline bool telnet_handle_command(struct net_pkt *pkt)
@@ -342,6 +371,8 @@ static int init(const struct shell_transport *transport,
 	sh_telnet->shell_handler = evt_handler;
 	sh_telnet->shell_context = context;
 
+	ring_buf_init(&sh_telnet->tx_ringbuf, sizeof(sh_telnet->tx_buf),
+		      sh_telnet->tx_buf);
 	k_fifo_init(&sh_telnet->rx_fifo);
 	k_delayed_work_init(&sh_telnet->send_work, telnet_send_prematurely);
 
@@ -369,9 +400,7 @@ static int enable(const struct shell_transport *transport, bool blocking)
 static int write(const struct shell_transport *transport,
 		 const void *data, size_t length, size_t *cnt)
 {
-	struct shell_telnet_line_buf *lb;
-	size_t copy_len;
-	int err;
+	struct ring_buf *rb;
 	uint32_t timeout;
 
 	if (sh_telnet == NULL) {
@@ -384,49 +413,35 @@ static int write(const struct shell_transport *transport,
 		return 0;
 	}
 
-	*cnt = 0;
-	lb = &sh_telnet->line_out;
+	rb = &sh_telnet->tx_ringbuf;
 
-	/* Stop the transmission timer, so it does not interrupt the operation.
+	/* Data is only queued here, the network is accessed from the work
+	 * queue. If the buffer is full, the shell waits for TX_RDY which is
+	 * signaled once the work has sent the buffered data.
 	 */
-	timeout = k_delayed_work_remaining_get(&sh_telnet->send_work);
-	k_delayed_work_cancel(&sh_telnet->send_work);
-
-	do {
-		if (lb->len + length - *cnt > TELNET_LINE_SIZE) {
-			copy_len = TELNET_LINE_SIZE - lb->len;
-		} else {
-			copy_len = length - *cnt;
-		}
-
-		memcpy(lb->buf + lb->len, (uint8_t *)data + *cnt, copy_len);
-		lb->len += copy_len;
+	*cnt = ring_buf_put(rb, data, length);
 
-		/* Send the data immediately if the buffer is full or line feed
-		 * is recognized.
+	/* Send the data immediately if the buffer is full, holds a line worth
+	 * of data or line feed is recognized.
+	 */
+	if ((*cnt < length) ||
+	    (ring_buf_capacity_get(rb) - ring_buf_space_get(rb) >=
+	     TELNET_LINE_SIZE) ||
+	    (memchr(data, '\n', *cnt) != NULL)) {
+		timeout = 0;
+	} else {
+		/* Check if the work was already scheduled, initialize
+		 * otherwise.
 		 */
-		if (lb->buf[lb->len - 1] == '\n' ||
-		    lb->len == TELNET_LINE_SIZE) {
-			err = telnet_send();
-			if (err != 0) {
-				*cnt = length;
-				return err;
-			}
+		if ((k_delayed_work_remaining_get(&sh_telnet->send_work) != 0) ||
+		    k_work_pending(&sh_telnet->send_work.work)) {
+			return 0;
 		}
 
-		*cnt += copy_len;
-	} while (*cnt < length);
-
-	if (lb->len > 0) {
-		/* Check if the timer was already running, initialize otherwise.
-		 */
-		timeout = (timeout == 0) ? TELNET_TIMEOUT : timeout;
-
-		k_delayed_work_submit(&sh_telnet->send_work, K_MSEC(timeout));
+		timeout = TELNET_TIMEOUT;
 	}
 
-	sh_telnet->shell_handler(SHELL_TRANSPORT_EVT_TX_RDY,
-				 sh_telnet->shell_context);
+	k_delayed_work_submit(&sh_telnet->send_work, K_MSEC(timeout));
 
 	return 0;
 }
@@ -9,6 +9,8 @@
 #include <stdio.h>
 #include <errno.h>
 #include <zephyr/types.h>
+#include <kernel.h>
+#include <spinlock.h>
 #include <stats/stats.h>
 
 #define STATS_GEN_NAME_MAX_LEN  (sizeof("s255"))
@@ -16,6 +18,98 @@
 /* The global list of registered statistic groups. */
 static struct stats_hdr *stats_list;
 
+#ifdef CONFIG_STATS_PER_CPU
+/* Serializes the snapshots stored in the groups. */
+static struct k_spinlock stats_lock;
+#endif
+
+/**
+ * Returns the offset of the first entry from the header.
+ */
+static uint16_t
+stats_entries_off(void)
+{
+#ifdef CONFIG_STATS_PER_CPU
+	return ROUND_UP(sizeof(struct stats_hdr), STATS_CPU_ALIGN);
+#else
+	return sizeof(struct stats_hdr);
+#endif
+}
+
+/**
+ * Returns the distance between the copies of the entries of two CPUs.
+ */
+static size_t
+stats_cpu_stride(const struct stats_hdr *hdr)
+{
+#ifdef CONFIG_STATS_PER_CPU
+	return ROUND_UP(hdr->s_size * hdr->s_cnt, STATS_CPU_ALIGN);
+#else
+	return hdr->s_size * hdr->s_cnt;
+#endif
+}
+
+static uint64_t
+stats_entry_read(const uint8_t *ptr, uint8_t size)
+{
+	switch (size) {
+	case sizeof(uint16_t):
+		return *(const volatile uint16_t *)ptr;
+	case sizeof(uint32_t):
+		return *(const volatile uint32_t *)ptr;
+	default:
+#ifdef CONFIG_STATS_PER_CPU
+		return stats_cpu_read64((const volatile uint64_t *)ptr);
+#else
+		return *(const volatile uint64_t *)ptr;
+#endif
+	}
+}
+
+static void
+stats_entry_write(uint8_t *ptr, uint8_t size, uint64_t val)
+{
+	switch (size) {
+	case sizeof(uint16_t):
+		*(uint16_t *)ptr = val;
+		break;
+	case sizeof(uint32_t):
+		*(uint32_t *)ptr = val;
+		break;
+	default:
+		*(uint64_t *)ptr = val;
+		break;
+	}
+}
+
+/**
+ * Sums the copies of an entry of all CPUs.  The copies are only written by
+ * their own CPU, so they are read without any locking.
+ */
+static uint64_t
+stats_entry_sum(const struct stats_hdr *hdr, uint16_t off)
+{
+#ifdef CONFIG_STATS_PER_CPU
+	const uint8_t *ptr = (const uint8_t *)hdr + off;
+	size_t stride = stats_cpu_stride(hdr);
+	uint64_t sum = 0;
+	int i;
+
+	for (i = 1; i <= CONFIG_MP_NUM_CPUS; i++) {
+		sum += stats_entry_read(ptr + i * stride, hdr->s_size);
+	}
+
+	/* Wrap around like a single counter of the entry size. */
+	if (hdr->s_size < sizeof(uint64_t)) {
+		sum &= BIT_MASK(hdr->s_size * 8U);
+	}
+
+	return sum;
+#else
+	return stats_entry_read((const uint8_t *)hdr + off, hdr->s_size);
+#endif
+}
+
 static const char *
 stats_get_name(const struct stats_hdr *hdr, int idx)
 {
@@ -29,7 +123,7 @@ stats_get_name(const struct stats_hdr *hdr, int idx)
 	 * offset.  This annotation allows for naming only certain statistics,
 	 * and doesn't enforce ordering restrictions on the stats name map.
 	 */
-	off = sizeof(*hdr) + idx * hdr->s_size;
+	off = stats_entries_off() + idx * hdr->s_size;
 	for (i = 0; i < hdr->s_map_cnt; i++) {
 		cur = hdr->s_map + i;
 		if (cur->snm_off == off) {
@@ -44,7 +138,7 @@ stats_get_name(const struct stats_hdr *hdr, int idx)
 static uint16_t
 stats_get_off(const struct stats_hdr *hdr, int idx)
 {
-	return sizeof(*hdr) + idx * hdr->s_size;
+	return stats_entries_off() + idx * hdr->s_size;
 }
 
 /**
@@ -90,6 +184,8 @@ stats_gen_name(int idx, char *dst)
  *   ("s%d", n), where n is the number of the statistic in the structure.
  * - A pointer to the current entry.
  *
+ * With per-CPU statistics the entries are refreshed from a snapshot first.
+ *
  * @return 0 on success, the return code of the walk_func on abort.
  *
  */
@@ -101,6 +197,10 @@ stats_walk(struct stats_hdr *hdr, stats_walk_fn *walk_func, void *arg)
 	int rc;
 	int i;
 
+#ifdef CONFIG_STATS_PER_CPU
+	(void)stats_snapshot(hdr, NULL, 0);
+#endif
+
 	for (i = 0; i < hdr->s_cnt; i++) {
 		name = stats_get_name(hdr, i);
 		if (name == NULL) {
@@ -281,5 +381,91 @@ stats_init_and_reg(struct stats_hdr *shdr, uint8_t size, uint16_t cnt,
 void
 stats_reset(struct stats_hdr *hdr)
 {
-	(void)memset((uint8_t *)hdr + sizeof(*hdr), 0, hdr->s_size * hdr->s_cnt);
+#ifdef CONFIG_STATS_PER_CPU
+	size_t len = stats_cpu_stride(hdr) * (CONFIG_MP_NUM_CPUS + 1);
+#else
+	size_t len = stats_cpu_stride(hdr);
+#endif
+
+	(void)memset((uint8_t *)hdr + stats_entries_off(), 0, len);
+}
+
+/**
+ * Reads a statistic entry, summing the counts of all CPUs.
+ *
+ * @param hdr The statistics header of the entry
+ * @param off The offset of the entry, as reported by stats_walk()
+ *
+ * @return The value of the entry.
+ */
+uint64_t
+stats_entry_get(struct stats_hdr *hdr, uint16_t off)
+{
+	return stats_entry_sum(hdr, off);
+}
+
+/**
+ * Sets a statistic entry.  With per-CPU statistics the value is stored in
+ * the copy of the first CPU and the copies of the other CPUs are zeroed.
+ *
+ * @param hdr The statistics header of the entry
+ * @param off The offset of the entry, as reported by stats_walk()
+ * @param val The new value of the entry
+ */
+void
+stats_entry_set(struct stats_hdr *hdr, uint16_t off, uint64_t val)
+{
+	uint8_t *ptr = (uint8_t *)hdr + off;
+#ifdef CONFIG_STATS_PER_CPU
+	size_t stride = stats_cpu_stride(hdr);
+	int i;
+
+	for (i = 2; i <= CONFIG_MP_NUM_CPUS; i++) {
+		stats_entry_write(ptr + i * stride, hdr->s_size, 0);
+	}
+	stats_entry_write(ptr + stride, hdr->s_size, val);
+#endif
+
+	stats_entry_write(ptr, hdr->s_size, val);
+}
+
+/**
+ * Reads all entries of a statistics group.  The code updating the entries
+ * is never blocked; with per-CPU statistics only concurrent snapshots of
+ * the group are serialized, as the snapshot is also stored in the entries
+ * read by stats_walk() callbacks.
+ *
+ * @param hdr The statistics header to read
+ * @param values Buffer for the values, may be NULL if cnt is zero
+ * @param cnt The number of values the buffer can hold
+ *
+ * @return The number of values stored in the buffer.
+ */
+int
+stats_snapshot(struct stats_hdr *hdr, uint64_t *values, uint16_t cnt)
+{
+	uint64_t val;
+	uint16_t off;
+	int i;
+#ifdef CONFIG_STATS_PER_CPU
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+#endif
+
+	for (i = 0; i < hdr->s_cnt; i++) {
+		off = stats_get_off(hdr, i);
+		val = stats_entry_sum(hdr, off);
+
+#ifdef CONFIG_STATS_PER_CPU
+		stats_entry_write((uint8_t *)hdr + off, hdr->s_size, val);
+#endif
+		if (i < cnt) {
+			values[i] = val;
+		}
+	}
+
+#ifdef CONFIG_STATS_PER_CPU
+	k_spin_unlock(&stats_lock, key);
+#endif
+
+	return MIN(cnt, hdr->s_cnt);
 }
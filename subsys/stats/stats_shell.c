@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <shell/shell.h>
+#include <stats/stats.h>
+
+static int group_print(struct stats_hdr *hdr, void *arg)
+{
+	const struct shell *shell = arg;
+
+	shell_print(shell, "%s (%u entries)", hdr->s_name, hdr->s_cnt);
+
+	return 0;
+}
+
+static int entry_print(struct stats_hdr *hdr, void *arg, const char *name,
+		       uint16_t off)
+{
+	const struct shell *shell = arg;
+
+	shell_print(shell, "  %-24s %llu", name,
+		    (unsigned long long)stats_entry_get(hdr, off));
+
+	return 0;
+}
+
+static struct stats_hdr *group_get(const struct shell *shell, const char *name)
+{
+	struct stats_hdr *hdr = stats_group_find(name);
+
+	if (hdr == NULL) {
+		shell_error(shell, "Unknown group: %s", name);
+	}
+
+	return hdr;
+}
+
+static int cmd_stats_list(const struct shell *shell, size_t argc, char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	return stats_group_walk(group_print, (void *)shell);
+}
+
+static int cmd_stats_show(const struct shell *shell, size_t argc, char **argv)
+{
+	struct stats_hdr *hdr;
+
+	for (size_t i = 1; i < argc; i++) {
+		hdr = group_get(shell, argv[i]);
+		if (hdr == NULL) {
+			return -ENOENT;
+		}
+
+		shell_print(shell, "%s:", hdr->s_name);
+		(void)stats_walk(hdr, entry_print, (void *)shell);
+	}
+
+	return 0;
+}
+
+static int cmd_stats_reset(const struct shell *shell, size_t argc, char **argv)
+{
+	struct stats_hdr *hdr;
+
+	for (size_t i = 1; i < argc; i++) {
+		hdr = group_get(shell, argv[i]);
+		if (hdr == NULL) {
+			return -ENOENT;
+		}
+
+		stats_reset(hdr);
+	}
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_stats,
+	SHELL_CMD(list, NULL, "List statistics groups.", cmd_stats_list),
+	SHELL_CMD_ARG(show, NULL, "Print entries <group> [<group> ...].",
+		      cmd_stats_show, 2, 255),
+	SHELL_CMD_ARG(reset, NULL, "Zero entries <group> [<group> ...].",
+		      cmd_stats_reset, 2, 255),
+	SHELL_SUBCMD_SET_END /* Array terminated. */
+);
+
+SHELL_CMD_REGISTER(stats, &sub_stats, "Statistics", NULL);
@@ -9,27 +9,50 @@
 #include <kernel_internal.h>
 #include <ctf_top.h>
 
-void sys_trace_thread_switched_out(void)
+/* The hooks are defined with their names in parentheses, which keeps them
+ * from being expanded when CONFIG_TRACING_STATIC_KEYS turns them into
+ * macros. Hooks also called from assembly check their category here.
+ */
+#ifdef CONFIG_TRACING_STATIC_KEYS
+#define CATEGORY_ENABLED(category) \
+	static_branch_unlikely(&tracing_key_##category)
+#else
+#define CATEGORY_ENABLED(category) true
+#endif
+
+void (sys_trace_thread_switched_out)(void)
 {
-	struct k_thread *thread = k_current_get();
+	struct k_thread *thread;
+
+	if (!CATEGORY_ENABLED(thread)) {
+		return;
+	}
+
+	thread = k_current_get();
 
 	ctf_top_thread_switched_out((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_switched_in(void)
+void (sys_trace_thread_switched_in)(void)
 {
-	struct k_thread *thread = k_current_get();
+	struct k_thread *thread;
+
+	if (!CATEGORY_ENABLED(thread)) {
+		return;
+	}
+
+	thread = k_current_get();
 
 	ctf_top_thread_switched_in((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_priority_set(struct k_thread *thread)
+void (sys_trace_thread_priority_set)(struct k_thread *thread)
 {
 	ctf_top_thread_priority_set((uint32_t)(uintptr_t)thread,
 				    thread->base.prio);
 }
 
-void sys_trace_thread_create(struct k_thread *thread)
+void (sys_trace_thread_create)(struct k_thread *thread)
 {
 	ctf_bounded_string_t name = { "Unnamed thread" };
 
@@ -58,32 +81,32 @@ void sys_trace_thread_create(struct k_thread *thread)
 #endif
 }
 
-void sys_trace_thread_abort(struct k_thread *thread)
+void (sys_trace_thread_abort)(struct k_thread *thread)
 {
 	ctf_top_thread_abort((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_suspend(struct k_thread *thread)
+void (sys_trace_thread_suspend)(struct k_thread *thread)
 {
 	ctf_top_thread_suspend((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_resume(struct k_thread *thread)
+void (sys_trace_thread_resume)(struct k_thread *thread)
 {
 	ctf_top_thread_resume((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_ready(struct k_thread *thread)
+void (sys_trace_thread_ready)(struct k_thread *thread)
 {
 	ctf_top_thread_ready((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_pend(struct k_thread *thread)
+void (sys_trace_thread_pend)(struct k_thread *thread)
 {
 	ctf_top_thread_pend((uint32_t)(uintptr_t)thread);
 }
 
-void sys_trace_thread_info(struct k_thread *thread)
+void (sys_trace_thread_info)(struct k_thread *thread)
 {
 #if defined(CONFIG_THREAD_STACK_INFO)
 	ctf_top_thread_info(
@@ -94,7 +117,7 @@ void sys_trace_thread_info(struct k_thread *thread)
 #endif
 }
 
-void sys_trace_thread_name_set(struct k_thread *thread)
+void (sys_trace_thread_name_set)(struct k_thread *thread)
 {
 #if defined(CONFIG_THREAD_NAME)
 	ctf_bounded_string_t name = { "Unnamed thread" };
@@ -112,32 +135,44 @@ void sys_trace_thread_name_set(struct k_thread *thread)
 #endif
 }
 
-void sys_trace_isr_enter(void)
+void (sys_trace_isr_enter)(void)
 {
+	if (!CATEGORY_ENABLED(isr)) {
+		return;
+	}
+
 	ctf_top_isr_enter();
 }
 
-void sys_trace_isr_exit(void)
+void (sys_trace_isr_exit)(void)
 {
+	if (!CATEGORY_ENABLED(isr)) {
+		return;
+	}
+
 	ctf_top_isr_exit();
 }
 
-void sys_trace_isr_exit_to_scheduler(void)
+void (sys_trace_isr_exit_to_scheduler)(void)
 {
 	ctf_top_isr_exit_to_scheduler();
 }
 
-void sys_trace_idle(void)
+void (sys_trace_idle)(void)
 {
+	if (!CATEGORY_ENABLED(idle)) {
+		return;
+	}
+
 	ctf_top_idle();
 }
 
-void sys_trace_void(unsigned int id)
+void (sys_trace_void)(unsigned int id)
 {
 	ctf_top_void(id);
 }
 
-void sys_trace_end_call(unsigned int id)
+void (sys_trace_end_call)(unsigned int id)
 {
 	ctf_top_end_call(id);
 }
@@ -33,6 +33,46 @@ void sys_trace_idle(void);
 void sys_trace_void(unsigned int id);
 void sys_trace_end_call(unsigned int id);
 
+#ifdef CONFIG_TRACING_STATIC_KEYS
+/* Skip the calls of disabled categories at the call site. The parentheses
+ * around the hook names prevent their expansion inside the macros.
+ */
+#define sys_trace_thread_switched_out() \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_switched_out)())
+#define sys_trace_thread_switched_in() \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_switched_in)())
+#define sys_trace_thread_priority_set(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_priority_set)(t))
+#define sys_trace_thread_create(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_create)(t))
+#define sys_trace_thread_abort(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_abort)(t))
+#define sys_trace_thread_suspend(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_suspend)(t))
+#define sys_trace_thread_resume(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_resume)(t))
+#define sys_trace_thread_ready(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_ready)(t))
+#define sys_trace_thread_pend(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_pend)(t))
+#define sys_trace_thread_info(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_info)(t))
+#define sys_trace_thread_name_set(t) \
+	SYS_TRACE_POINT(thread, (sys_trace_thread_name_set)(t))
+#define sys_trace_isr_enter() \
+	SYS_TRACE_POINT(isr, (sys_trace_isr_enter)())
+#define sys_trace_isr_exit() \
+	SYS_TRACE_POINT(isr, (sys_trace_isr_exit)())
+#define sys_trace_isr_exit_to_scheduler() \
+	SYS_TRACE_POINT(isr, (sys_trace_isr_exit_to_scheduler)())
+#define sys_trace_idle() \
+	SYS_TRACE_POINT(idle, (sys_trace_idle)())
+#define sys_trace_void(id) \
+	SYS_TRACE_POINT(ipc, (sys_trace_void)(id))
+#define sys_trace_end_call(id) \
+	SYS_TRACE_POINT(ipc, (sys_trace_end_call)(id))
+#endif /* CONFIG_TRACING_STATIC_KEYS */
+
 #ifdef __cplusplus
 }
 #endif
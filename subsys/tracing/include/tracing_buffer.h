@@ -9,6 +9,7 @@
 
 #include <stdbool.h>
 #include <zephyr/types.h>
+#include <toolchain.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -113,6 +114,70 @@ uint32_t tracing_buffer_get(uint8_t *data, uint32_t size);
  */
 uint32_t tracing_cmd_buffer_alloc(uint8_t **data);
 
+/**
+ * @brief CTF packet header and context of per CPU tracing buffers.
+ *
+ * Must match the packet declaration of the generated CTF metadata.
+ */
+struct tracing_ctf_packet_hdr {
+	uint32_t magic;
+	uint8_t stream_id;
+	uint8_t stream_instance_id;
+	uint32_t timestamp_begin;
+	uint32_t timestamp_end;
+	uint32_t content_size;
+	uint32_t packet_size;
+	uint32_t events_discarded;
+	uint8_t cpu_id;
+} __packed;
+
+/**
+ * @brief Initialize per CPU tracing buffers.
+ */
+void tracing_cpu_buffer_init(void);
+
+/**
+ * @brief Write an event to the tracing buffer of the current CPU.
+ *
+ * @param data Address of data.
+ * @param size Data size (in bytes).
+ * @param timestamp Event timestamp.
+ * @param packet_done Set to true if a packet was closed by this event.
+ *
+ * @retval true Event buffered.
+ * @retval false Event dropped.
+ */
+bool tracing_cpu_buffer_put(const uint8_t *data, uint32_t size,
+			    uint32_t timestamp, bool *packet_done);
+
+/**
+ * @brief Get the oldest closed packet over all CPUs.
+ *
+ * Packets are returned in timestamp_begin order.
+ *
+ * @param data Pointer to the address. It's set to the packet start.
+ *
+ * @return Packet size (in bytes), 0 if no packet is ready.
+ */
+uint32_t tracing_cpu_buffer_get_claim(uint8_t **data);
+
+/**
+ * @brief Release the packet returned by tracing_cpu_buffer_get_claim().
+ */
+void tracing_cpu_buffer_get_finish(void);
+
+/**
+ * @brief Close packets which hold events, making them ready for output.
+ */
+void tracing_cpu_buffer_flush(void);
+
+/**
+ * @brief Per CPU tracing buffers are empty or not.
+ *
+ * @return true if no events are buffered, or false if not.
+ */
+bool tracing_cpu_buffer_is_empty(void);
+
 #ifdef __cplusplus
 }
 #endif
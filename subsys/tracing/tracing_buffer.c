@@ -6,8 +6,15 @@
 
 #include <sys/ring_buffer.h>
 
+#ifdef CONFIG_TRACING_PER_CPU_BUFFERS
+/* Unused, events are stored in per CPU buffers */
+#define TRACING_RING_BUF_SIZE 0
+#else
+#define TRACING_RING_BUF_SIZE CONFIG_TRACING_BUFFER_SIZE
+#endif
+
 static struct ring_buf tracing_ring_buf;
-static uint8_t tracing_buffer[CONFIG_TRACING_BUFFER_SIZE + 1];
+static uint8_t tracing_buffer[TRACING_RING_BUF_SIZE + 1];
 static uint8_t tracing_cmd_buffer[CONFIG_TRACING_CMD_BUFFER_SIZE];
 
 uint32_t tracing_cmd_buffer_alloc(uint8_t **data)
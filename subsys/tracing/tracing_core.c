@@ -45,6 +45,41 @@ static K_SEM_DEFINE(tracing_thread_sem, 0, 1);
 static K_THREAD_STACK_DEFINE(tracing_thread_stack,
 			CONFIG_TRACING_THREAD_STACK_SIZE);
 
+#ifdef CONFIG_TRACING_PER_CPU_BUFFERS
+static atomic_t tracing_thread_wake_pending;
+
+static void tracing_thread_func(void *dummy1, void *dummy2, void *dummy3)
+{
+	uint8_t *packet;
+	uint32_t length;
+	int err;
+
+	tracing_thread_tid = k_current_get();
+
+	while (true) {
+		while ((length = tracing_cpu_buffer_get_claim(&packet)) != 0U) {
+			tracing_buffer_handle(packet, length);
+			tracing_cpu_buffer_get_finish();
+		}
+
+		/* Partially filled packets are flushed after the threshold
+		 * unless a closed packet wakes the thread up earlier.
+		 */
+		if (tracing_cpu_buffer_is_empty()) {
+			err = k_sem_take(&tracing_thread_sem, K_FOREVER);
+		} else {
+			err = k_sem_take(&tracing_thread_sem,
+				K_MSEC(CONFIG_TRACING_THREAD_WAIT_THRESHOLD));
+		}
+
+		atomic_clear(&tracing_thread_wake_pending);
+
+		if (err != 0) {
+			tracing_cpu_buffer_flush();
+		}
+	}
+}
+#else
 static void tracing_thread_func(void *dummy1, void *dummy2, void *dummy3)
 {
 	uint8_t *transferring_buf;
@@ -68,6 +103,7 @@ static void tracing_thread_func(void *dummy1, void *dummy2, void *dummy3)
 		}
 	}
 }
+#endif
 
 static void tracing_thread_timer_expiry_fn(struct k_timer *timer)
 {
@@ -78,6 +114,10 @@ static void tracing_thread_timer_expiry_fn(struct k_timer *timer)
 static void tracing_set_state(enum tracing_state state)
 {
 	atomic_set(&tracing_state, state);
+
+#ifdef CONFIG_TRACING_STATIC_KEYS
+	tracing_categories_set(state == TRACING_ENABLE);
+#endif
 }
 
 static int tracing_init(struct device *arg)
@@ -85,6 +125,9 @@ static int tracing_init(struct device *arg)
 	ARG_UNUSED(arg);
 
 	tracing_buffer_init();
+#ifdef CONFIG_TRACING_PER_CPU_BUFFERS
+	tracing_cpu_buffer_init();
+#endif
 
 	working_backend = tracing_backend_get(TRACING_BACKEND_NAME);
 	tracing_backend_init(working_backend);
@@ -116,11 +159,21 @@ SYS_INIT(tracing_init, APPLICATION, 0);
 #ifdef CONFIG_TRACING_ASYNC
 void tracing_trigger_output(bool before_put_is_empty)
 {
+#ifdef CONFIG_TRACING_PER_CPU_BUFFERS
+	/* Called outside of the buffer locks, giving the semaphore is
+	 * traced as well. The timer defers it out of the traced context.
+	 */
+	if (before_put_is_empty &&
+	    atomic_cas(&tracing_thread_wake_pending, 0, 1)) {
+		k_timer_start(&tracing_thread_timer, K_NO_WAIT, K_NO_WAIT);
+	}
+#else
 	if (before_put_is_empty) {
 		k_timer_start(&tracing_thread_timer,
 			      K_MSEC(CONFIG_TRACING_THREAD_WAIT_THRESHOLD),
 			      K_NO_WAIT);
 	}
+#endif
 }
 
 bool is_tracing_thread(void)
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 Intel corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <kernel.h>
+#include <kernel_structs.h>
+#include <spinlock.h>
+#include <sys/util.h>
+#include <tracing_buffer.h>
+
+/* Each CPU owns a buffer split in fixed size slots. Events are appended to
+ * the open packet of the current CPU, a packet is closed once the next event
+ * does not fit and then waits for the tracing thread in its slot. Producers
+ * only take the lock of their own CPU, so CPUs do not contend with each
+ * other, only briefly with the tracing thread.
+ */
+#define PACKET_SIZE CONFIG_TRACING_CTF_PACKET_SIZE
+#define PACKET_SLOTS (CONFIG_TRACING_BUFFER_SIZE / PACKET_SIZE)
+
+#define CTF_MAGIC 0xC1FC1FC1
+
+BUILD_ASSERT(PACKET_SLOTS >= 2,
+	     "Tracing buffer must hold at least two packets");
+
+struct tracing_cpu_buffer {
+	struct k_spinlock lock;
+	uint32_t rd;		/* Oldest closed slot */
+	uint32_t closed;	/* Number of closed slots */
+	uint32_t offset;	/* Fill of the open packet, 0 if none */
+	uint32_t discarded;	/* Events discarded so far */
+	uint8_t slots[PACKET_SLOTS][PACKET_SIZE] __aligned(4);
+};
+
+static struct tracing_cpu_buffer cpu_buffers[CONFIG_MP_NUM_CPUS];
+static int claimed_cpu = -1;
+
+static inline struct tracing_ctf_packet_hdr *
+slot_hdr(struct tracing_cpu_buffer *buf, uint32_t slot)
+{
+	return (struct tracing_ctf_packet_hdr *)buf->slots[slot % PACKET_SLOTS];
+}
+
+static void packet_open(struct tracing_cpu_buffer *buf, uint8_t cpu,
+			uint32_t timestamp)
+{
+	struct tracing_ctf_packet_hdr *hdr =
+		slot_hdr(buf, buf->rd + buf->closed);
+
+	hdr->magic = CTF_MAGIC;
+	hdr->stream_id = 0U;
+	hdr->stream_instance_id = cpu;
+	hdr->timestamp_begin = timestamp;
+	hdr->timestamp_end = timestamp;
+	hdr->events_discarded = buf->discarded;
+	hdr->cpu_id = cpu;
+
+	buf->offset = sizeof(*hdr);
+}
+
+static void packet_close(struct tracing_cpu_buffer *buf)
+{
+	struct tracing_ctf_packet_hdr *hdr =
+		slot_hdr(buf, buf->rd + buf->closed);
+
+	/* Sizes are given in bits. Only the content is sent. */
+	hdr->content_size = buf->offset * 8U;
+	hdr->packet_size = buf->offset * 8U;
+
+	buf->closed++;
+	buf->offset = 0U;
+}
+
+bool tracing_cpu_buffer_put(const uint8_t *data, uint32_t size,
+			    uint32_t timestamp, bool *packet_done)
+{
+	struct tracing_cpu_buffer *buf;
+	struct tracing_ctf_packet_hdr *hdr;
+	k_spinlock_key_t key;
+	unsigned int irq_key;
+	bool ret = true;
+	uint8_t cpu;
+
+	*packet_done = false;
+
+	if (size > (PACKET_SIZE - sizeof(*hdr))) {
+		return false;
+	}
+
+	/* Interrupts are locked first so the thread can not migrate */
+	irq_key = arch_irq_lock();
+	cpu = _current_cpu->id;
+	buf = &cpu_buffers[cpu];
+	key = k_spin_lock(&buf->lock);
+
+	if ((buf->offset != 0U) && ((buf->offset + size) > PACKET_SIZE)) {
+		packet_close(buf);
+		*packet_done = true;
+	}
+
+	if (buf->offset == 0U) {
+		if (buf->closed == PACKET_SLOTS) {
+			buf->discarded++;
+			ret = false;
+			goto out;
+		}
+
+		packet_open(buf, cpu, timestamp);
+	}
+
+	hdr = slot_hdr(buf, buf->rd + buf->closed);
+	memcpy((uint8_t *)hdr + buf->offset, data, size);
+	buf->offset += size;
+	hdr->timestamp_end = timestamp;
+
+out:
+	k_spin_unlock(&buf->lock, key);
+	arch_irq_unlock(irq_key);
+
+	return ret;
+}
+
+uint32_t tracing_cpu_buffer_get_claim(uint8_t **data)
+{
+	struct tracing_ctf_packet_hdr *hdr, *oldest = NULL;
+	k_spinlock_key_t key;
+
+	__ASSERT_NO_MSG(claimed_cpu < 0);
+
+	/* Merge CPU streams by packet start time */
+	for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+		struct tracing_cpu_buffer *buf = &cpu_buffers[cpu];
+
+		key = k_spin_lock(&buf->lock);
+		hdr = (buf->closed != 0U) ? slot_hdr(buf, buf->rd) : NULL;
+		k_spin_unlock(&buf->lock, key);
+
+		if ((hdr != NULL) &&
+		    ((oldest == NULL) ||
+		     ((int32_t)(hdr->timestamp_begin -
+				oldest->timestamp_begin) < 0))) {
+			oldest = hdr;
+			claimed_cpu = cpu;
+		}
+	}
+
+	if (oldest == NULL) {
+		return 0;
+	}
+
+	/* Closed slots are not touched by producers until finished */
+	*data = (uint8_t *)oldest;
+
+	return oldest->content_size / 8U;
+}
+
+void tracing_cpu_buffer_get_finish(void)
+{
+	struct tracing_cpu_buffer *buf;
+	k_spinlock_key_t key;
+
+	__ASSERT_NO_MSG(claimed_cpu >= 0);
+
+	buf = &cpu_buffers[claimed_cpu];
+	claimed_cpu = -1;
+
+	key = k_spin_lock(&buf->lock);
+	buf->rd = (buf->rd + 1U) % PACKET_SLOTS;
+	buf->closed--;
+	k_spin_unlock(&buf->lock, key);
+}
+
+void tracing_cpu_buffer_flush(void)
+{
+	k_spinlock_key_t key;
+
+	for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+		struct tracing_cpu_buffer *buf = &cpu_buffers[cpu];
+
+		key = k_spin_lock(&buf->lock);
+		if (buf->offset != 0U) {
+			packet_close(buf);
+		}
+		k_spin_unlock(&buf->lock, key);
+	}
+}
+
+bool tracing_cpu_buffer_is_empty(void)
+{
+	for (int cpu = 0; cpu < CONFIG_MP_NUM_CPUS; cpu++) {
+		struct tracing_cpu_buffer *buf = &cpu_buffers[cpu];
+
+		if ((buf->closed != 0U) || (buf->offset != 0U)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void tracing_cpu_buffer_init(void)
+{
+	memset(cpu_buffers, 0, sizeof(cpu_buffers));
+	claimed_cpu = -1;
+}
@@ -4,10 +4,90 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
+#include <kernel.h>
+#include <sys/printk.h>
 #include <tracing_core.h>
 #include <tracing_buffer.h>
 #include <tracing_format_common.h>
 
+#ifdef CONFIG_TRACING_PER_CPU_BUFFERS
+static void cpu_buffer_put(const uint8_t *data, uint32_t length,
+			   uint32_t timestamp)
+{
+	bool before_put_is_empty = tracing_cpu_buffer_is_empty();
+	bool packet_done;
+
+	if (tracing_cpu_buffer_put(data, length, timestamp, &packet_done)) {
+		tracing_trigger_output(before_put_is_empty || packet_done);
+	} else {
+		tracing_trigger_output(packet_done);
+		tracing_packet_drop_handle();
+	}
+}
+
+void tracing_format_string(const char *str, ...)
+{
+	char buf[CONFIG_TRACING_PACKET_MAX_SIZE];
+	va_list args;
+	int length;
+
+	if (!is_tracing_enabled() || is_tracing_thread()) {
+		return;
+	}
+
+	va_start(args, str);
+	length = vsnprintk(buf, sizeof(buf), str, args);
+	va_end(args);
+
+	/* Long strings are truncated, the NUL is not sent */
+	length = MIN(length, (int)sizeof(buf) - 1);
+	cpu_buffer_put((uint8_t *)buf, length, k_cycle_get_32());
+}
+
+void tracing_format_raw_data(uint8_t *data, uint32_t length)
+{
+	uint32_t timestamp;
+
+	if (!is_tracing_enabled() || is_tracing_thread()) {
+		return;
+	}
+
+	/* CTF events start with their timestamp */
+	if (IS_ENABLED(CONFIG_TRACING_CTF_TIMESTAMP) &&
+	    (length >= sizeof(timestamp))) {
+		memcpy(&timestamp, data, sizeof(timestamp));
+	} else {
+		timestamp = k_cycle_get_32();
+	}
+
+	cpu_buffer_put(data, length, timestamp);
+}
+
+void tracing_format_data(tracing_data_t *tracing_data_array, uint32_t count)
+{
+	uint8_t buf[CONFIG_TRACING_PACKET_MAX_SIZE];
+	uint32_t length = 0U;
+
+	if (!is_tracing_enabled() || is_tracing_thread()) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		if ((length + tracing_data_array[i].length) > sizeof(buf)) {
+			tracing_packet_drop_handle();
+			return;
+		}
+
+		memcpy(&buf[length], tracing_data_array[i].data,
+		       tracing_data_array[i].length);
+		length += tracing_data_array[i].length;
+	}
+
+	cpu_buffer_put(buf, length, k_cycle_get_32());
+}
+#else
+
 void tracing_format_string(const char *str, ...)
 {
 	va_list args;
@@ -72,3 +152,4 @@ void tracing_format_data(tracing_data_t *tracing_data_array, uint32_t count)
 		tracing_packet_drop_handle();
 	}
 }
+#endif
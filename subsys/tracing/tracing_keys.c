@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2020 Intel corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Runtime switches of the tracepoint categories
+ */
+
+#include <string.h>
+#include <kernel.h>
+#include <sys/static_key.h>
+#include <tracing/tracing.h>
+#ifdef CONFIG_TRACING_SHELL
+#include <shell/shell.h>
+#endif
+
+STATIC_KEY_DEFINE(tracing_key_thread);
+STATIC_KEY_DEFINE(tracing_key_isr);
+STATIC_KEY_DEFINE(tracing_key_idle);
+STATIC_KEY_DEFINE(tracing_key_ipc);
+
+static const struct {
+	const char *name;
+	struct static_key *key;
+} categories[] = {
+	{ "thread", &tracing_key_thread },
+	{ "isr", &tracing_key_isr },
+	{ "idle", &tracing_key_idle },
+	{ "ipc", &tracing_key_ipc },
+};
+
+static void category_set(struct static_key *key, bool enable)
+{
+	if (enable) {
+		static_key_enable(key);
+	} else {
+		static_key_disable(key);
+	}
+}
+
+int tracing_category_set(const char *name, bool enable)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(categories); i++) {
+		if (strcmp(name, categories[i].name) == 0) {
+			category_set(categories[i].key, enable);
+			return 0;
+		}
+	}
+
+	return -EINVAL;
+}
+
+void tracing_categories_set(bool enable)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(categories); i++) {
+		category_set(categories[i].key, enable);
+	}
+}
+
+#ifdef CONFIG_TRACING_SHELL
+static int categories_cmd(const struct shell *shell, size_t argc,
+			  char **argv, bool enable)
+{
+	if (argc == 1) {
+		tracing_categories_set(enable);
+		return 0;
+	}
+
+	for (size_t i = 1; i < argc; i++) {
+		if (tracing_category_set(argv[i], enable) != 0) {
+			shell_error(shell, "Unknown category: %s", argv[i]);
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+static int cmd_tracing_enable(const struct shell *shell, size_t argc,
+			      char **argv)
+{
+	return categories_cmd(shell, argc, argv, true);
+}
+
+static int cmd_tracing_disable(const struct shell *shell, size_t argc,
+			       char **argv)
+{
+	return categories_cmd(shell, argc, argv, false);
+}
+
+static int cmd_tracing_status(const struct shell *shell, size_t argc,
+			      char **argv)
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	for (size_t i = 0; i < ARRAY_SIZE(categories); i++) {
+		shell_print(shell, "%-8s %s", categories[i].name,
+			    static_key_enabled(categories[i].key) ?
+			    "enabled" : "disabled");
+	}
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_tracing,
+	SHELL_CMD_ARG(enable, NULL, "Enable categories [<category> ...].",
+		      cmd_tracing_enable, 1, 255),
+	SHELL_CMD_ARG(disable, NULL, "Disable categories [<category> ...].",
+		      cmd_tracing_disable, 1, 255),
+	SHELL_CMD(status, NULL, "Print the state of the categories.",
+		  cmd_tracing_status),
+	SHELL_SUBCMD_SET_END /* Array terminated. */
+);
+
+SHELL_CMD_REGISTER(tracing, &sub_tracing, "Tracepoint categories", NULL);
+#endif /* CONFIG_TRACING_SHELL */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr.h>
+#include <sys/printk.h>
+
+/* Measures the context switch time with and without thread runtime
+ * accounting. The main thread and a partner thread of the same priority
+ * yield to each other, every k_yield() switching context once.
+ */
+
+#define N_RUNS 10000
+#define N_SETTLE 100
+
+static K_THREAD_STACK_DEFINE(partner_stack, 1024);
+static struct k_thread partner_thread;
+
+static volatile bool done;
+
+static void partner_fn(void *arg1, void *arg2, void *arg3)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
+
+	while (!done) {
+		k_yield();
+	}
+}
+
+static uint32_t measure_switch(void)
+{
+	uint32_t start, end;
+
+	for (int i = 0; i < N_SETTLE; i++) {
+		k_yield();
+	}
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < N_RUNS; i++) {
+		k_yield();
+	}
+	end = k_cycle_get_32();
+
+	/* Each iteration switches to the partner and back */
+	return (end - start) / (2U * N_RUNS);
+}
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+static void measure_stats_get(void)
+{
+	k_thread_runtime_stats_t stats;
+	uint32_t start, end;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < N_RUNS; i++) {
+		k_thread_runtime_stats_get(k_current_get(), &stats);
+	}
+	end = k_cycle_get_32();
+
+	printk("stats_get %u cycles\n", (end - start) / N_RUNS);
+
+	k_thread_runtime_stats_get(&partner_thread, &stats);
+	printk("partner ran %u cycles\n", (uint32_t)stats.execution_cycles);
+}
+#endif
+
+void main(void)
+{
+	uint32_t cycles;
+
+	k_thread_create(&partner_thread, partner_stack,
+			K_THREAD_STACK_SIZEOF(partner_stack), partner_fn,
+			NULL, NULL, NULL, k_thread_priority_get(k_current_get()),
+			0, K_NO_WAIT);
+
+	cycles = measure_switch();
+
+	done = true;
+	k_thread_join(&partner_thread, K_FOREVER);
+
+	printk("runtime stats %s\n",
+	       IS_ENABLED(CONFIG_THREAD_RUNTIME_STATS) ? "on" : "off");
+	printk("switch %u cycles\n", cycles);
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	measure_stats_get();
+#endif
+
+	printk("fin\n");
+}
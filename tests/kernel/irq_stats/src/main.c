@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq.h>
+
+#define WAKEUPS 4
+
+static K_SEM_DEFINE(wakeup_sem, 0, 1);
+
+#if defined(CONFIG_CPU_CORTEX_M)
+#include <arch/arm/aarch32/cortex_m/cmsis.h>
+
+/* Two unused NVIC lines, pended by software. The high priority one nests
+ * in the ISR of the low priority one.
+ */
+#define LOW_PRIO 2
+#define HIGH_PRIO 1
+
+#define HIGH_ISR_US 1000
+
+static unsigned int irq_low;
+static unsigned int irq_high;
+
+static unsigned int free_nvic_line(unsigned int below)
+{
+	int i;
+
+	for (i = below - 1; i >= 0; i--) {
+		if (NVIC_GetEnableIRQ(i) == 0) {
+			/* Implemented if it can be pended */
+			NVIC_SetPendingIRQ(i);
+			if (NVIC_GetPendingIRQ(i)) {
+				NVIC_ClearPendingIRQ(i);
+				break;
+			}
+		}
+	}
+
+	zassert_true(i >= 0, "No available IRQ line");
+
+	return i;
+}
+
+static void pend_irq(unsigned int irq)
+{
+	NVIC_SetPendingIRQ(irq);
+	__DSB();
+	__ISB();
+}
+
+static void isr_high(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	k_busy_wait(HIGH_ISR_US);
+	k_sem_give(&wakeup_sem);
+}
+
+static void isr_low(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	pend_irq(irq_high);
+}
+
+static void irqs_setup(void)
+{
+	irq_low = free_nvic_line(CONFIG_NUM_IRQS);
+	irq_high = free_nvic_line(irq_low);
+
+	arch_irq_connect_dynamic(irq_low, LOW_PRIO, isr_low, NULL, 0);
+	arch_irq_connect_dynamic(irq_high, HIGH_PRIO, isr_high, NULL, 0);
+
+	irq_enable(irq_low);
+	irq_enable(irq_high);
+}
+
+/* Called with interrupts locked */
+static void trigger_wakeup(void)
+{
+	NVIC_SetPendingIRQ(irq_high);
+}
+#else
+/* The system timer interrupt, through a kernel timer */
+static void wakeup_expiry(struct k_timer *timer)
+{
+	ARG_UNUSED(timer);
+
+	k_sem_give(&wakeup_sem);
+}
+
+static K_TIMER_DEFINE(wakeup_timer, wakeup_expiry, NULL);
+
+static void irqs_setup(void)
+{
+}
+
+/* Called with interrupts locked */
+static void trigger_wakeup(void)
+{
+	k_timer_start(&wakeup_timer, K_MSEC(1), K_NO_WAIT);
+}
+#endif
+
+/**
+ * @brief Test the wakeup of a thread by an ISR
+ *
+ * The thread pends on a semaphore given by an ISR, and checks that the
+ * wakeup chain is recorded and charged to the IRQ of the ISR. Also sets up
+ * the IRQs used by the next tests.
+ */
+static void test_isr_wakeup(void)
+{
+	struct k_irq_wakeup wakeup;
+	struct irq_stats stats;
+	unsigned int key;
+	int ret;
+
+	irqs_setup();
+	k_sem_reset(&wakeup_sem);
+	irq_stats_reset();
+
+	for (int i = 0; i < WAKEUPS; i++) {
+		/* Make sure the interrupt happens once the thread pends */
+		key = irq_lock();
+		trigger_wakeup();
+		ret = k_sem_take(&wakeup_sem, K_MSEC(100));
+		irq_unlock(key);
+
+		zassert_equal(ret, 0, "thread not woken");
+	}
+
+	zassert_equal(k_thread_irq_wakeup_get(k_current_get(), &wakeup), 0,
+		      "wakeup not recorded");
+#if defined(CONFIG_CPU_CORTEX_M)
+	zassert_equal(wakeup.irq, irq_high, "wakeup charged to IRQ %u",
+		      wakeup.irq);
+#endif
+
+	zassert_equal(irq_stats_get(wakeup.irq, &stats), 0, "invalid IRQ");
+	zassert_true(stats.run.count >= WAKEUPS, "ISR runs not counted");
+	zassert_true(stats.run.min_cycles <= stats.run.max_cycles,
+		     "inconsistent run time");
+	zassert_equal(stats.wakeup.count, WAKEUPS, "wakeups not counted");
+	zassert_true(stats.wakeup.min_cycles <= stats.wakeup.max_cycles,
+		     "inconsistent wakeup latency");
+	zassert_true(wakeup.give_cycles + wakeup.run_cycles <=
+		     stats.wakeup.max_cycles, "wakeup chain longer than max");
+	zassert_true(stats.wakeup.total_cycles >= stats.wakeup.max_cycles,
+		     "inconsistent wakeup total");
+}
+
+/**
+ * @brief Test the accounting of nested interrupts
+ *
+ * The ISR of a low priority IRQ pends a high priority one, which runs
+ * nested. Its run time must not be charged to the low priority ISR.
+ */
+static void test_nesting(void)
+{
+#if defined(CONFIG_CPU_CORTEX_M)
+	struct irq_stats low;
+	struct irq_stats high;
+
+	irq_stats_reset();
+
+	pend_irq(irq_low);
+
+	zassert_equal(irq_stats_get(irq_low, &low), 0, "invalid IRQ");
+	zassert_equal(irq_stats_get(irq_high, &high), 0, "invalid IRQ");
+
+	zassert_equal(low.run.count, 1, "low priority ISR not counted");
+	zassert_equal(high.run.count, 1, "high priority ISR not counted");
+	zassert_equal(low.nested, 0, "low priority ISR counted as nested");
+	zassert_equal(high.nested, 1, "high priority ISR not nested");
+	zassert_true(irq_stats_max_nesting_get() >= 2, "nesting not seen");
+	zassert_true(low.run.max_cycles < high.run.min_cycles,
+		     "nested ISR charged to the interrupted one");
+#else
+	ztest_test_skip();
+#endif
+}
+
+static void test_invalid(void)
+{
+	struct irq_stats stats;
+	struct k_irq_wakeup wakeup;
+
+	zassert_equal(irq_stats_get(UINT_MAX, &stats), -EINVAL,
+		      "invalid IRQ accepted");
+	zassert_equal(irq_stats_get(0, NULL), -EINVAL, "NULL accepted");
+	zassert_equal(k_thread_irq_wakeup_get(NULL, &wakeup), -EINVAL,
+		      "NULL thread accepted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(irq_stats,
+			 ztest_unit_test(test_isr_wakeup),
+			 ztest_unit_test(test_nesting),
+			 ztest_unit_test(test_invalid));
+	ztest_run_test_suite(irq_stats);
+}
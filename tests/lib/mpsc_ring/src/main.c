@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <irq_offload.h>
+#include <sys/mpsc_ring.h>
+
+#define RING_POW 5
+#define RING_WORDS BIT(RING_POW)
+#define WORD_SIZE sizeof(mpsc_ring_word_t)
+
+MPSC_RING_DEFINE_POW2(ring, RING_POW);
+
+static void ring_reset(void)
+{
+	mpsc_ring_init(&ring, ring.buf, RING_WORDS * WORD_SIZE);
+	(void)mpsc_ring_dropped_get(&ring);
+}
+
+static void *alloc_fill(size_t len, uint8_t pattern)
+{
+	uint8_t *data = mpsc_ring_alloc(&ring, len);
+
+	if (data != NULL) {
+		memset(data, pattern, len);
+	}
+
+	return data;
+}
+
+static void check_fill(uint8_t *data, size_t len, uint8_t pattern)
+{
+	for (size_t i = 0; i < len; i++) {
+		zassert_equal(data[i], pattern, "Unexpected data");
+	}
+}
+
+/**
+ * @brief Test that records are claimed in reservation order with their
+ * content intact.
+ */
+static void test_mpsc_ring_order(void)
+{
+	uint8_t *data[3];
+	size_t len;
+
+	ring_reset();
+
+	zassert_is_null(mpsc_ring_claim(&ring, NULL), "Ring not empty");
+	zassert_false(mpsc_ring_is_pending(&ring), "Unexpected pending");
+
+	for (int i = 0; i < ARRAY_SIZE(data); i++) {
+		data[i] = alloc_fill(WORD_SIZE * (i + 1), i);
+		zassert_not_null(data[i], "Allocation failed");
+		zassert_equal((uintptr_t)data[i] % WORD_SIZE, 0,
+			      "Record not aligned");
+	}
+
+	/* Commit out of order, the oldest one holds back the others */
+	mpsc_ring_commit(&ring, data[2]);
+	mpsc_ring_commit(&ring, data[1]);
+	zassert_false(mpsc_ring_is_pending(&ring), "Unexpected pending");
+	zassert_is_null(mpsc_ring_claim(&ring, NULL), "Unexpected claim");
+
+	mpsc_ring_commit(&ring, data[0]);
+	zassert_true(mpsc_ring_is_pending(&ring), "Expected pending");
+
+	for (int i = 0; i < ARRAY_SIZE(data); i++) {
+		uint8_t *rec = mpsc_ring_claim(&ring, &len);
+
+		zassert_equal(rec, data[i], "Unexpected record");
+		zassert_equal(len, WORD_SIZE * (i + 1), "Unexpected length");
+		check_fill(rec, len, i);
+		mpsc_ring_free(&ring, rec);
+	}
+
+	zassert_is_null(mpsc_ring_claim(&ring, NULL), "Ring not empty");
+	zassert_equal(mpsc_ring_dropped_get(&ring), 0, "Unexpected drops");
+}
+
+/**
+ * @brief Test that a record freed before being committed is skipped.
+ */
+static void test_mpsc_ring_uncommitted_free(void)
+{
+	uint8_t *a, *b;
+
+	ring_reset();
+
+	a = alloc_fill(WORD_SIZE, 0xaa);
+	b = alloc_fill(WORD_SIZE, 0xbb);
+	zassert_true(a && b, "Allocation failed");
+
+	mpsc_ring_commit(&ring, b);
+	mpsc_ring_free(&ring, a);
+
+	zassert_equal(mpsc_ring_claim(&ring, NULL), b, "Unexpected record");
+	mpsc_ring_free(&ring, b);
+	zassert_is_null(mpsc_ring_claim(&ring, NULL), "Ring not empty");
+}
+
+/**
+ * @brief Test that space comes back only once all older records are freed
+ * and that failed allocations are counted.
+ */
+static void test_mpsc_ring_full(void)
+{
+	/* Each record takes half of the ring, header included */
+	size_t len = (RING_WORDS / 2 - 1) * WORD_SIZE;
+	uint8_t *a, *b;
+
+	ring_reset();
+
+	a = alloc_fill(len, 1);
+	b = alloc_fill(len, 2);
+	zassert_true(a && b, "Allocation failed");
+	zassert_is_null(mpsc_ring_alloc(&ring, WORD_SIZE), "Ring not full");
+	zassert_is_null(mpsc_ring_alloc(&ring, RING_WORDS * WORD_SIZE),
+			"Oversized allocation succeeded");
+	zassert_equal(mpsc_ring_dropped_get(&ring), 2, "Unexpected drops");
+
+	mpsc_ring_commit(&ring, a);
+	mpsc_ring_commit(&ring, b);
+	zassert_equal(mpsc_ring_claim(&ring, NULL), a, "Unexpected record");
+	zassert_equal(mpsc_ring_claim(&ring, NULL), b, "Unexpected record");
+
+	/* Newest freed first, space stays held by the older record */
+	mpsc_ring_free(&ring, b);
+	zassert_is_null(mpsc_ring_alloc(&ring, WORD_SIZE), "Ring not full");
+
+	mpsc_ring_free(&ring, a);
+	a = alloc_fill(len, 3);
+	b = alloc_fill(len, 4);
+	zassert_true(a && b, "Space not given back");
+
+	mpsc_ring_free(&ring, a);
+	mpsc_ring_free(&ring, b);
+	(void)mpsc_ring_dropped_get(&ring);
+}
+
+/**
+ * @brief Test that a record never wraps around the end of the ring.
+ */
+static void test_mpsc_ring_wrap(void)
+{
+	size_t len = 2 * WORD_SIZE;
+	uint8_t *rec;
+
+	ring_reset();
+
+	for (int i = 0; i < 4 * RING_WORDS; i++) {
+		rec = alloc_fill(len, i);
+		zassert_not_null(rec, "Allocation failed");
+		zassert_true(rec + len <= (uint8_t *)&ring.buf[RING_WORDS],
+			     "Record wraps");
+		mpsc_ring_commit(&ring, rec);
+
+		zassert_equal(mpsc_ring_claim(&ring, NULL), rec,
+			      "Unexpected record");
+		check_fill(rec, len, i);
+		mpsc_ring_free(&ring, rec);
+	}
+
+	zassert_equal(mpsc_ring_dropped_get(&ring), 0, "Unexpected drops");
+}
+
+static uint8_t *isr_rec;
+
+static void isr_alloc(void *arg)
+{
+	ARG_UNUSED(arg);
+
+	isr_rec = alloc_fill(WORD_SIZE, 0x55);
+	if (isr_rec != NULL) {
+		mpsc_ring_commit(&ring, isr_rec);
+	}
+}
+
+/**
+ * @brief Test that an ISR can produce while a thread holds an uncommitted
+ * record.
+ */
+static void test_mpsc_ring_isr(void)
+{
+	uint8_t *rec;
+
+	ring_reset();
+
+	rec = alloc_fill(WORD_SIZE, 0x11);
+	zassert_not_null(rec, "Allocation failed");
+
+	irq_offload(isr_alloc, NULL);
+	zassert_not_null(isr_rec, "ISR allocation failed");
+	zassert_is_null(mpsc_ring_claim(&ring, NULL), "Unexpected claim");
+
+	mpsc_ring_commit(&ring, rec);
+	zassert_equal(mpsc_ring_claim(&ring, NULL), rec, "Unexpected record");
+	zassert_equal(mpsc_ring_claim(&ring, NULL), isr_rec,
+		      "Unexpected record");
+	check_fill(isr_rec, WORD_SIZE, 0x55);
+
+	mpsc_ring_free(&ring, isr_rec);
+	mpsc_ring_free(&ring, rec);
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_mpsc_ring_api,
+			 ztest_unit_test(test_mpsc_ring_order),
+			 ztest_unit_test(test_mpsc_ring_uncommitted_free),
+			 ztest_unit_test(test_mpsc_ring_full),
+			 ztest_unit_test(test_mpsc_ring_wrap),
+			 ztest_unit_test(test_mpsc_ring_isr)
+			 );
+	ztest_run_test_suite(test_mpsc_ring_api);
+}
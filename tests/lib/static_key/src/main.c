@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <sys/static_key.h>
+
+STATIC_KEY_DEFINE(key_a);
+STATIC_KEY_DEFINE(key_b);
+
+static volatile int hits_a;
+static volatile int hits_b;
+
+/* Several branches on the same key, which must all be patched */
+static __attribute__((noinline)) bool branch_a1(void)
+{
+	if (static_branch_unlikely(&key_a)) {
+		hits_a++;
+		return true;
+	}
+
+	return false;
+}
+
+static __attribute__((noinline)) bool branch_a2(void)
+{
+	return static_branch_unlikely(&key_a);
+}
+
+static __attribute__((noinline)) bool branch_b(void)
+{
+	if (static_branch_unlikely(&key_b)) {
+		hits_b++;
+		return true;
+	}
+
+	return false;
+}
+
+static void test_default_disabled(void)
+{
+	zassert_false(static_key_enabled(&key_a), "key enabled at boot");
+	zassert_false(branch_a1(), "branch taken at boot");
+	zassert_false(branch_a2(), "branch taken at boot");
+	zassert_false(branch_b(), "branch taken at boot");
+	zassert_equal(hits_a + hits_b, 0, "conditional code ran");
+}
+
+static void test_enable_disable(void)
+{
+	hits_a = 0;
+	hits_b = 0;
+
+	static_key_enable(&key_a);
+	zassert_true(static_key_enabled(&key_a), "key not enabled");
+	zassert_true(branch_a1(), "branch not taken");
+	zassert_true(branch_a2(), "branch not taken");
+	zassert_equal(hits_a, 1, "conditional code not run");
+
+	/* Other keys are not affected */
+	zassert_false(branch_b(), "wrong key patched");
+	zassert_equal(hits_b, 0, "wrong key patched");
+
+	/* Enabling twice does not toggle the branch */
+	static_key_enable(&key_a);
+	zassert_true(branch_a1(), "branch not taken");
+
+	static_key_disable(&key_a);
+	zassert_false(static_key_enabled(&key_a), "key not disabled");
+	zassert_false(branch_a1(), "branch taken");
+	zassert_false(branch_a2(), "branch taken");
+	zassert_equal(hits_a, 2, "conditional code ran");
+
+	static_key_disable(&key_a);
+	zassert_false(branch_a1(), "branch taken");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(static_key,
+			 ztest_unit_test(test_default_disabled),
+			 ztest_unit_test(test_enable_disable));
+	ztest_run_test_suite(static_key);
+}
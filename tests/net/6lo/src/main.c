@@ -1160,9 +1160,59 @@ void test_loop(void)
 	net_pkt_print();
 }
 
+/* Every frame of the corpus is sent BENCH_ROUNDS times in a row, as a flow
+ * would be, so with CONFIG_NET_6LO_IPHC_CACHE all but the first round of
+ * each frame are served from the cache.
+ */
+#define BENCH_ROUNDS 16
+
+void test_bench(void)
+{
+	uint32_t comp_cycles = 0U;
+	uint32_t uncomp_cycles = 0U;
+	uint32_t frames = 0U;
+	struct net_pkt *pkt;
+	uint32_t start;
+	int count, round;
+
+	for (count = 0; count < ARRAY_SIZE(tests); count++) {
+		if (!tests[count].data->iphc) {
+			continue;
+		}
+
+		for (round = 0; round < BENCH_ROUNDS; round++) {
+			pkt = create_pkt(tests[count].data);
+			zassert_not_null(pkt, "failed to create buffer");
+
+			net_pkt_cursor_init(pkt);
+
+			start = k_cycle_get_32();
+			zassert_true(net_6lo_compress(pkt, true) >= 0,
+				     "compression failed");
+			comp_cycles += k_cycle_get_32() - start;
+
+			start = k_cycle_get_32();
+			zassert_true(net_6lo_uncompress(pkt),
+				     "uncompression failed");
+			uncomp_cycles += k_cycle_get_32() - start;
+
+			zassert_true(compare_pkt(pkt, tests[count].data),
+				     "%s round %d", tests[count].name, round);
+
+			net_pkt_unref(pkt);
+			frames++;
+		}
+	}
+
+	TC_PRINT("%u frames, compress %u cycles/frame, "
+		 "uncompress %u cycles/frame\n", frames,
+		 comp_cycles / frames, uncomp_cycles / frames);
+}
+
 /*test case main entry*/
 void test_main(void)
 {
-	ztest_test_suite(test_6lo, ztest_unit_test(test_loop));
+	ztest_test_suite(test_6lo, ztest_unit_test(test_loop),
+			 ztest_unit_test(test_bench));
 	ztest_run_test_suite(test_6lo);
 }
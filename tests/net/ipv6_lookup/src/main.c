@@ -0,0 +1,277 @@
+/* main.c - Application main entry point */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_IPV6_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <ztest.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+#include <tc_util.h>
+
+#include <net/dummy.h>
+#include <net/net_ip.h>
+#include <net/net_if.h>
+
+#define NET_LOG_ENABLED 1
+#include "net_private.h"
+#include "ipv6.h"
+#include "nbr.h"
+
+#define MAX_NBR CONFIG_NET_IPV6_MAX_NEIGHBORS
+#define MAX_ADDR NET_IF_MAX_IPV6_ADDR
+#define MAX_MADDR NET_IF_MAX_IPV6_MADDR
+
+#define LOOKUP_ROUNDS 20
+
+static struct net_if *iface;
+
+static struct in6_addr unknown_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 1, 0, 0, 0,
+					    0, 0, 0, 0, 0, 0, 0xff, 0xff } } };
+
+static void nbr_addr(struct in6_addr *addr, int i)
+{
+	net_ipv6_addr_create(addr, 0x2001, 0x0db8, 0, 0, 0, 0, 0x1000 + i,
+			     i * 7919);
+}
+
+static void my_addr(struct in6_addr *addr, int i)
+{
+	net_ipv6_addr_create(addr, 0x2001, 0x0db8, 0, 0xcafe, 0, 0, 0, i + 1);
+}
+
+static void my_maddr(struct in6_addr *addr, int i)
+{
+	net_ipv6_addr_create(addr, 0xff05, 0, 0, 0, 0, 0, 0, i + 1);
+}
+
+static int net_lookup_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static void net_lookup_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_ETHERNET);
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	return 0;
+}
+
+static struct dummy_api net_lookup_if_api = {
+	.iface_api.init = net_lookup_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_lookup_test, "net_lookup_test",
+		net_lookup_dev_init, device_pm_control_nop, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_lookup_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static void nbr_count_cb(struct net_nbr *nbr, void *user_data)
+{
+	int *count = user_data;
+
+	(*count)++;
+}
+
+static void test_init(void)
+{
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface is NULL");
+}
+
+static void test_nbr_add(void)
+{
+	struct net_linkaddr_storage llstorage = {
+		.addr = { 0x00, 0x00, 0x5E, 0x00, 0x00, 0x00 },
+	};
+	struct net_linkaddr lladdr = {
+		.addr = llstorage.addr,
+		.len = 6U,
+		.type = NET_LINK_ETHERNET,
+	};
+	struct in6_addr addr;
+	struct net_nbr *nbr;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < MAX_NBR; i++) {
+		nbr_addr(&addr, i);
+		llstorage.addr[5] = i;
+
+		nbr = net_ipv6_nbr_add(iface, &addr, &lladdr, false,
+				       NET_IPV6_NBR_STATE_STALE);
+		zassert_not_null(nbr, "Cannot add neighbor %d", i);
+	}
+
+	net_ipv6_nbr_foreach(nbr_count_cb, &count);
+	zassert_equal(count, MAX_NBR, "Neighbor count %d, expected %d",
+		      count, MAX_NBR);
+}
+
+static void test_nbr_lookup(void)
+{
+	struct in6_addr addr;
+	struct net_nbr *nbr;
+	int i;
+
+	for (i = 0; i < MAX_NBR; i++) {
+		nbr_addr(&addr, i);
+
+		nbr = net_ipv6_nbr_lookup(iface, &addr);
+		zassert_not_null(nbr, "Neighbor %d not found", i);
+		zassert_true(net_ipv6_addr_cmp(&net_ipv6_nbr_data(nbr)->addr,
+					       &addr), "Wrong neighbor %d", i);
+
+		zassert_equal_ptr(net_ipv6_nbr_lookup(NULL, &addr), nbr,
+				  "Neighbor %d not found on any iface", i);
+	}
+
+	zassert_is_null(net_ipv6_nbr_lookup(iface, &unknown_addr),
+			"Unknown neighbor found");
+}
+
+/* Per-packet cost of resolving the next hop with a full neighbor cache */
+static void test_nbr_lookup_perf(void)
+{
+	struct in6_addr addr[MAX_NBR];
+	uint32_t start, cycles;
+	int i, round;
+
+	for (i = 0; i < MAX_NBR; i++) {
+		nbr_addr(&addr[i], i);
+	}
+
+	start = k_cycle_get_32();
+
+	for (round = 0; round < LOOKUP_ROUNDS; round++) {
+		for (i = 0; i < MAX_NBR; i++) {
+			(void)net_ipv6_nbr_lookup(iface, &addr[i]);
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("%d neighbors, %d hash bits: %u ns per lookup\n",
+		 MAX_NBR, CONFIG_NET_IPV6_NBR_HASH_BITS,
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) /
+			    (LOOKUP_ROUNDS * MAX_NBR)));
+}
+
+static void test_nbr_rm(void)
+{
+	struct in6_addr addr;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < MAX_NBR; i += 2) {
+		nbr_addr(&addr, i);
+
+		zassert_true(net_ipv6_nbr_rm(iface, &addr),
+			     "Cannot remove neighbor %d", i);
+	}
+
+	for (i = 0; i < MAX_NBR; i++) {
+		nbr_addr(&addr, i);
+
+		if (i % 2) {
+			zassert_not_null(net_ipv6_nbr_lookup(iface, &addr),
+					 "Neighbor %d not found", i);
+		} else {
+			zassert_is_null(net_ipv6_nbr_lookup(iface, &addr),
+					"Removed neighbor %d found", i);
+		}
+	}
+
+	net_ipv6_nbr_foreach(nbr_count_cb, &count);
+	zassert_equal(count, MAX_NBR / 2, "Neighbor count %d, expected %d",
+		      count, MAX_NBR / 2);
+}
+
+static void test_addr_lookup(void)
+{
+	struct net_if_mcast_addr *ifmaddr;
+	struct net_if_addr *ifaddr;
+	struct net_if *ret;
+	struct in6_addr addr;
+	int i;
+
+	/* Some of the slots are already taken by the autoconfigured
+	 * addresses.
+	 */
+	for (i = 0; i < MAX_ADDR - 1; i++) {
+		my_addr(&addr, i);
+
+		ifaddr = net_if_ipv6_addr_add(iface, &addr, NET_ADDR_MANUAL, 0);
+		zassert_not_null(ifaddr, "Cannot add address %d", i);
+
+		ret = NULL;
+		zassert_equal_ptr(net_if_ipv6_addr_lookup(&addr, &ret), ifaddr,
+				  "Address %d not found", i);
+		zassert_equal_ptr(ret, iface, "Wrong interface");
+	}
+
+	for (i = 0; i < MAX_MADDR - 2; i++) {
+		my_maddr(&addr, i);
+
+		ifmaddr = net_if_ipv6_maddr_add(iface, &addr);
+		zassert_not_null(ifmaddr, "Cannot add multicast address %d", i);
+
+		ret = NULL;
+		zassert_equal_ptr(net_if_ipv6_maddr_lookup(&addr, &ret),
+				  ifmaddr, "Multicast address %d not found", i);
+		zassert_equal_ptr(ret, iface, "Wrong interface");
+	}
+
+	zassert_is_null(net_if_ipv6_addr_lookup(&unknown_addr, NULL),
+			"Unknown address found");
+
+	my_addr(&addr, 0);
+	zassert_true(net_if_ipv6_addr_rm(iface, &addr), "Cannot remove address");
+	zassert_is_null(net_if_ipv6_addr_lookup(&addr, NULL),
+			"Removed address found");
+
+	my_maddr(&addr, 0);
+	zassert_true(net_if_ipv6_maddr_rm(iface, &addr),
+		     "Cannot remove multicast address");
+	zassert_is_null(net_if_ipv6_maddr_lookup(&addr, NULL),
+			"Removed multicast address found");
+
+	/* The other addresses must survive the removal */
+	my_addr(&addr, 1);
+	zassert_not_null(net_if_ipv6_addr_lookup(&addr, NULL),
+			 "Address 1 not found");
+
+	my_maddr(&addr, 1);
+	zassert_not_null(net_if_ipv6_maddr_lookup(&addr, NULL),
+			 "Multicast address 1 not found");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_ipv6_lookup,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_nbr_add),
+			 ztest_unit_test(test_nbr_lookup),
+			 ztest_unit_test(test_nbr_lookup_perf),
+			 ztest_unit_test(test_nbr_rm),
+			 ztest_unit_test(test_addr_lookup)
+			 );
+
+	ztest_run_test_suite(test_ipv6_lookup);
+}
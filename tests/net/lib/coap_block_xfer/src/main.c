@@ -0,0 +1,504 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, LOG_LEVEL_WRN);
+
+#include <ztest.h>
+#include <string.h>
+#include <errno.h>
+
+#include <net/coap.h>
+#include <net/coap_block_xfer.h>
+
+#include <tc_util.h>
+
+#define WINDOW CONFIG_COAP_BLOCK_XFER_WINDOW_MAX
+#define BLOCK_SIZE COAP_BLOCK_256
+#define BLOCK_BYTES 256
+
+#define RESOURCE_LEN (32 * BLOCK_BYTES)
+#define RESOURCE_PATH "fw"
+
+#define PKT_LEN (BLOCK_BYTES + 64)
+#define QUEUE_LEN (2 * WINDOW)
+
+/* Stand-in for a CoAP server. The requests sent by the client are queued
+ * and answered one round trip at a time by server_round().
+ */
+static struct {
+	uint8_t queue[QUEUE_LEN][PKT_LEN];
+	uint16_t queue_pkt_len[QUEUE_LEN];
+	int queued;
+
+	uint8_t upload[RESOURCE_LEN];
+	size_t upload_len;
+
+	size_t resource_len;
+	uint8_t max_szx;
+	int drop_num;
+	bool reverse;
+	bool separate;
+	bool no_size2;
+	bool fail;
+
+	int requests;
+	int acks;
+	uint16_t next_id;
+} server;
+
+static uint8_t round_pkts[QUEUE_LEN][PKT_LEN];
+static uint16_t round_pkt_len[QUEUE_LEN];
+
+static uint8_t resource[RESOURCE_LEN];
+static uint8_t download[RESOURCE_LEN];
+static size_t download_len;
+
+static uint8_t xfer_buf[COAP_BLOCK_XFER_BUF_SIZE(64, BLOCK_SIZE, WINDOW)];
+static struct coap_block_xfer xfer;
+static int done_result;
+static int done_calls;
+
+static const struct coap_block_xfer_option options[] = {
+	{
+		.code = COAP_OPTION_URI_PATH,
+		.value = RESOURCE_PATH,
+		.len = sizeof(RESOURCE_PATH) - 1,
+	},
+};
+
+static void server_reset(size_t resource_len)
+{
+	memset(&server, 0, sizeof(server));
+	server.resource_len = resource_len;
+	server.max_szx = COAP_BLOCK_1024;
+	server.drop_num = -1;
+	server.next_id = 0x8000;
+
+	memset(download, 0, sizeof(download));
+	download_len = 0;
+	done_calls = 0;
+	done_result = 1;
+}
+
+static void server_reply(struct coap_packet *response)
+{
+	zassert_equal(coap_block_xfer_input(&xfer, response->data,
+					    response->offset), 0,
+		      "Response not accepted");
+}
+
+static void server_handle(uint8_t *data, uint16_t len)
+{
+	struct coap_packet request, response;
+	struct coap_option path;
+	uint8_t buf[PKT_LEN];
+	uint8_t token[8];
+	uint8_t tkl, type, code, szx;
+	const uint8_t *payload;
+	uint16_t payload_len;
+	uint16_t id, bytes;
+	size_t offset, count;
+	bool more;
+	int block;
+
+	zassert_equal(coap_packet_parse(&request, data, len, NULL, 0), 0,
+		      "Invalid request");
+
+	if (coap_header_get_type(&request) == COAP_TYPE_ACK) {
+		server.acks++;
+		return;
+	}
+
+	server.requests++;
+
+	zassert_equal(coap_find_options(&request, COAP_OPTION_URI_PATH,
+					&path, 1), 1, "No Uri-Path");
+	zassert_equal(path.len, sizeof(RESOURCE_PATH) - 1, "Wrong Uri-Path");
+
+	code = coap_header_get_code(&request);
+	block = coap_get_option_int(&request, code == COAP_METHOD_GET ?
+				    COAP_OPTION_BLOCK2 : COAP_OPTION_BLOCK1);
+	zassert_true(block >= 0, "No block option");
+
+	if (GET_BLOCK_NUM(block) == server.drop_num) {
+		server.drop_num = -1;
+		return;
+	}
+
+	offset = GET_BLOCK_NUM(block) << (GET_BLOCK_SIZE(block) + 4);
+	szx = MIN(GET_BLOCK_SIZE(block), server.max_szx);
+	bytes = coap_block_size_to_bytes(szx);
+	id = coap_header_get_id(&request);
+	tkl = coap_header_get_token(&request, token);
+	type = COAP_TYPE_ACK;
+
+	if (server.separate) {
+		coap_packet_init(&response, buf, sizeof(buf), 1, COAP_TYPE_ACK,
+				 0, NULL, COAP_CODE_EMPTY, id);
+		server_reply(&response);
+
+		type = COAP_TYPE_CON;
+		id = server.next_id++;
+	}
+
+	if (server.fail) {
+		coap_packet_init(&response, buf, sizeof(buf), 1, type, tkl,
+				 token, COAP_RESPONSE_CODE_NOT_FOUND, id);
+		zassert_equal(coap_block_xfer_input(&xfer, response.data,
+						    response.offset), -ENOMSG,
+			      "Error response accepted");
+		return;
+	}
+
+	if (code == COAP_METHOD_GET) {
+		if (offset > 0 && offset >= server.resource_len) {
+			coap_packet_init(&response, buf, sizeof(buf), 1, type,
+					 tkl, token,
+					 COAP_RESPONSE_CODE_BAD_OPTION, id);
+			server_reply(&response);
+			return;
+		}
+
+		count = MIN(bytes, server.resource_len - offset);
+		more = offset + bytes < server.resource_len;
+
+		coap_packet_init(&response, buf, sizeof(buf), 1, type, tkl,
+				 token, COAP_RESPONSE_CODE_CONTENT, id);
+		coap_append_option_int(&response, COAP_OPTION_BLOCK2,
+				       ((offset / bytes) << 4) |
+				       (more << 3) | szx);
+
+		if (!server.no_size2 &&
+		    coap_get_option_int(&request, COAP_OPTION_SIZE2) >= 0) {
+			coap_append_option_int(&response, COAP_OPTION_SIZE2,
+					       server.resource_len);
+		}
+
+		if (count > 0) {
+			coap_packet_append_payload_marker(&response);
+			coap_packet_append_payload(&response,
+						   &resource[offset], count);
+		}
+	} else {
+		payload = coap_packet_get_payload(&request, &payload_len);
+		count = MIN(payload_len, bytes);
+		more = GET_MORE(block);
+
+		zassert_true(offset + count <= sizeof(server.upload),
+			     "Upload too large");
+		memcpy(&server.upload[offset], payload, count);
+		server.upload_len = MAX(server.upload_len, offset + count);
+
+		coap_packet_init(&response, buf, sizeof(buf), 1, type, tkl,
+				 token, more ? COAP_RESPONSE_CODE_CONTINUE :
+				 COAP_RESPONSE_CODE_CHANGED, id);
+		coap_append_option_int(&response, COAP_OPTION_BLOCK1,
+				       ((offset / bytes) << 4) |
+				       (more << 3) | szx);
+	}
+
+	server_reply(&response);
+}
+
+/* Answer the requests sent during the last round trip */
+static void server_round(void)
+{
+	int count = server.queued;
+	int i;
+
+	memcpy(round_pkts, server.queue, sizeof(round_pkts));
+	memcpy(round_pkt_len, server.queue_pkt_len, sizeof(round_pkt_len));
+	server.queued = 0;
+
+	for (i = 0; i < count; i++) {
+		int n = server.reverse ? count - 1 - i : i;
+
+		server_handle(round_pkts[n], round_pkt_len[n]);
+	}
+}
+
+static int xfer_send(struct coap_block_xfer *xfer, const uint8_t *data,
+		     size_t len)
+{
+	zassert_true(server.queued < QUEUE_LEN, "Too many packets in flight");
+	zassert_true(len <= PKT_LEN, "Packet too large");
+
+	memcpy(server.queue[server.queued], data, len);
+	server.queue_pkt_len[server.queued] = len;
+	server.queued++;
+
+	return 0;
+}
+
+static int xfer_write(struct coap_block_xfer *xfer, size_t offset,
+		      const uint8_t *data, size_t len, bool last)
+{
+	zassert_equal(offset, download_len, "Block out of order");
+	zassert_true(offset + len <= sizeof(download), "Download too large");
+
+	memcpy(&download[offset], data, len);
+	download_len += len;
+
+	return 0;
+}
+
+static int xfer_read(struct coap_block_xfer *xfer, size_t offset,
+		     uint8_t *data, size_t len)
+{
+	memcpy(data, &resource[offset], len);
+
+	return len;
+}
+
+static void xfer_done(struct coap_block_xfer *xfer, int result)
+{
+	done_calls++;
+	done_result = result;
+}
+
+static const struct coap_block_xfer_cb xfer_cb = {
+	.send = xfer_send,
+	.write = xfer_write,
+	.read = xfer_read,
+	.done = xfer_done,
+};
+
+static void xfer_setup(uint8_t method, uint8_t window, size_t total_size)
+{
+	struct coap_block_xfer_config config = {
+		.cb = &xfer_cb,
+		.options = options,
+		.num_options = ARRAY_SIZE(options),
+		.buf = xfer_buf,
+		.buf_len = sizeof(xfer_buf),
+		.method = method,
+		.block_size = BLOCK_SIZE,
+		.window = window,
+		.total_size = total_size,
+	};
+
+	zassert_equal(coap_block_xfer_init(&xfer, &config), 0,
+		      "Cannot initialize transfer");
+}
+
+/* Run the transfer to completion and return the number of round trips */
+static int xfer_run(void)
+{
+	int32_t timeout;
+	int rounds = 0;
+
+	zassert_equal(coap_block_xfer_start(&xfer), 0, "Cannot start");
+
+	while (!coap_block_xfer_finished(&xfer)) {
+		if (server.queued == 0) {
+			timeout = coap_block_xfer_process(&xfer);
+			zassert_true(timeout >= 0 && timeout != INT32_MAX,
+				     "Transfer stalled");
+
+			k_msleep(timeout);
+			zassert_true(coap_block_xfer_process(&xfer) >= 0,
+				     "Retransmission failed");
+			continue;
+		}
+
+		server_round();
+		rounds++;
+	}
+
+	zassert_equal(done_calls, 1, "Done callback not called once");
+
+	return rounds;
+}
+
+static void check_download(size_t len)
+{
+	zassert_equal(done_result, 0, "Transfer failed (%d)", done_result);
+	zassert_equal(download_len, len, "Wrong download length");
+	zassert_mem_equal(download, resource, len, "Wrong download content");
+}
+
+static void test_init(void)
+{
+	struct coap_block_xfer_config config = {
+		.cb = &xfer_cb,
+		.buf = xfer_buf,
+		.buf_len = sizeof(xfer_buf),
+		.method = COAP_METHOD_GET,
+		.block_size = BLOCK_SIZE,
+		.window = WINDOW + 1,
+	};
+	size_t i;
+
+	for (i = 0; i < sizeof(resource); i++) {
+		resource[i] = (i * 7) + (i >> 8);
+	}
+
+	zassert_equal(coap_block_xfer_init(&xfer, &config), -EINVAL,
+		      "Window larger than the maximum accepted");
+
+	config.window = WINDOW;
+	config.block_size = COAP_BLOCK_1024;
+	zassert_equal(coap_block_xfer_init(&xfer, &config), -ENOMEM,
+		      "Buffer too small for the window accepted");
+
+	config.block_size = BLOCK_SIZE;
+	config.method = COAP_METHOD_DELETE;
+	zassert_equal(coap_block_xfer_init(&xfer, &config), -EINVAL,
+		      "Invalid method accepted");
+}
+
+/* Compare the round trips of stop-and-wait and windowed downloads */
+static void test_download(void)
+{
+	int stop_and_wait, windowed;
+
+	server_reset(RESOURCE_LEN);
+	xfer_setup(COAP_METHOD_GET, 1, 0);
+	stop_and_wait = xfer_run();
+	check_download(RESOURCE_LEN);
+
+	server_reset(RESOURCE_LEN);
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	windowed = xfer_run();
+	check_download(RESOURCE_LEN);
+
+	TC_PRINT("%d blocks: %d round trips stop-and-wait, %d with a window "
+		 "of %d\n", RESOURCE_LEN / BLOCK_BYTES, stop_and_wait,
+		 windowed, WINDOW);
+
+	zassert_equal(stop_and_wait, RESOURCE_LEN / BLOCK_BYTES,
+		      "Wrong number of round trips");
+	zassert_true(windowed <= 1 + (RESOURCE_LEN / BLOCK_BYTES) / WINDOW + 1,
+		     "Window not used");
+	zassert_equal(server.requests, RESOURCE_LEN / BLOCK_BYTES,
+		      "Blocks requested more than once");
+}
+
+static void test_download_reorder(void)
+{
+	server_reset(RESOURCE_LEN - 100);
+	server.reverse = true;
+
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	(void)xfer_run();
+	check_download(RESOURCE_LEN - 100);
+	zassert_equal(xfer.total_size, RESOURCE_LEN - 100,
+		      "Size2 not reported");
+}
+
+static void test_download_negotiate(void)
+{
+	server_reset(RESOURCE_LEN / 4 + 10);
+	server.max_szx = COAP_BLOCK_64;
+
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	(void)xfer_run();
+	check_download(RESOURCE_LEN / 4 + 10);
+}
+
+/* Without Size2 the window runs past the end of the resource */
+static void test_download_no_size(void)
+{
+	server_reset(5 * BLOCK_BYTES + 1);
+	server.no_size2 = true;
+
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	(void)xfer_run();
+	check_download(5 * BLOCK_BYTES + 1);
+}
+
+static void test_download_separate(void)
+{
+	server_reset(RESOURCE_LEN / 2);
+	server.separate = true;
+
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	(void)xfer_run();
+	check_download(RESOURCE_LEN / 2);
+
+	/* Deliver the acknowledgment of the last response */
+	server_round();
+
+	zassert_equal(server.acks, server.requests,
+		      "Separate responses not acknowledged");
+}
+
+static void test_download_retransmit(void)
+{
+	server_reset(8 * BLOCK_BYTES);
+	server.drop_num = 3;
+
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	(void)xfer_run();
+	check_download(8 * BLOCK_BYTES);
+
+	zassert_equal(server.requests, 8 + 1, "Block not retransmitted");
+}
+
+static void test_download_error(void)
+{
+	server_reset(RESOURCE_LEN);
+	server.fail = true;
+
+	xfer_setup(COAP_METHOD_GET, WINDOW, 0);
+	(void)xfer_run();
+
+	zassert_equal(done_result, -ENOMSG, "Error not reported");
+}
+
+static void test_upload(void)
+{
+	size_t len = RESOURCE_LEN - 33;
+	int rounds;
+
+	server_reset(0);
+
+	xfer_setup(COAP_METHOD_PUT, WINDOW, len);
+	rounds = xfer_run();
+
+	TC_PRINT("Upload of %zu bytes: %d round trips\n", len, rounds);
+
+	zassert_equal(done_result, 0, "Transfer failed (%d)", done_result);
+	zassert_equal(server.upload_len, len, "Wrong upload length");
+	zassert_mem_equal(server.upload, resource, len,
+			  "Wrong upload content");
+	zassert_equal(xfer.transferred, len, "Wrong transferred length");
+}
+
+static void test_upload_negotiate(void)
+{
+	size_t len = 10 * 64 + 5;
+
+	server_reset(0);
+	server.max_szx = COAP_BLOCK_64;
+
+	xfer_setup(COAP_METHOD_POST, WINDOW, len);
+	(void)xfer_run();
+
+	zassert_equal(done_result, 0, "Transfer failed (%d)", done_result);
+	zassert_equal(server.upload_len, len, "Wrong upload length");
+	zassert_mem_equal(server.upload, resource, len,
+			  "Wrong upload content");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(coap_block_xfer,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_download),
+			 ztest_unit_test(test_download_reorder),
+			 ztest_unit_test(test_download_negotiate),
+			 ztest_unit_test(test_download_no_size),
+			 ztest_unit_test(test_download_separate),
+			 ztest_unit_test(test_download_retransmit),
+			 ztest_unit_test(test_download_error),
+			 ztest_unit_test(test_upload),
+			 ztest_unit_test(test_upload_negotiate)
+			 );
+
+	ztest_run_test_suite(coap_block_xfer);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
+
+#include <zephyr/types.h>
+#include <string.h>
+#include <ztest.h>
+
+#include <net/net_ip.h>
+#include <net/net_stats.h>
+#include <net/dns_resolve.h>
+
+#include "dns_cache.h"
+
+#define NAME1 "one.zephyr.test"
+#define NAME2 "two.zephyr.test"
+#define NAME3 "three.zephyr.test"
+#define NAME4 "four.zephyr.test"
+
+extern struct net_stats net_stats;
+
+struct result {
+	struct dns_addrinfo addrs[CONFIG_DNS_RESOLVER_CACHE_MAX_ADDRS];
+	int count;
+	int status;
+	int calls;
+};
+
+static struct result result;
+static struct dns_addrinfo addrs[2];
+
+static void result_cb(enum dns_resolve_status status,
+		      struct dns_addrinfo *info,
+		      void *user_data)
+{
+	struct result *res = user_data;
+
+	res->calls++;
+
+	if (status == DNS_EAI_INPROGRESS) {
+		zassert_true(res->count < ARRAY_SIZE(res->addrs),
+			     "Too many addresses");
+		res->addrs[res->count++] = *info;
+		return;
+	}
+
+	zassert_is_null(info, "Info given for the last result");
+	res->status = status;
+}
+
+static bool lookup(const char *name, enum dns_query_type type)
+{
+	memset(&result, 0, sizeof(result));
+
+	return dns_cache_find(name, type, result_cb, &result);
+}
+
+static void test_init(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(addrs); i++) {
+		addrs[i].ai_family = AF_INET;
+		addrs[i].ai_addrlen = sizeof(struct sockaddr_in);
+		net_sin(&addrs[i].ai_addr)->sin_family = AF_INET;
+		net_sin(&addrs[i].ai_addr)->sin_addr.s4_addr[0] = 192;
+		net_sin(&addrs[i].ai_addr)->sin_addr.s4_addr[2] = 2;
+		net_sin(&addrs[i].ai_addr)->sin_addr.s4_addr[3] = i + 1;
+	}
+
+	dns_cache_flush();
+}
+
+static void test_cache_positive(void)
+{
+	net_stats_t hits = net_stats.dns.cache_hit;
+
+	zassert_false(lookup(NAME1, DNS_QUERY_TYPE_A), "Found in empty cache");
+
+	dns_cache_add(NAME1, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs,
+		      ARRAY_SIZE(addrs), 60);
+
+	zassert_true(lookup(NAME1, DNS_QUERY_TYPE_A), "Not found");
+	zassert_equal(result.status, DNS_EAI_ALLDONE, "Wrong status");
+	zassert_equal(result.count, ARRAY_SIZE(addrs), "Wrong count");
+	zassert_equal(result.calls, ARRAY_SIZE(addrs) + 1, "Wrong calls");
+	zassert_mem_equal(&result.addrs[1].ai_addr, &addrs[1].ai_addr,
+			  sizeof(struct sockaddr_in), "Wrong address");
+
+	/* Names are case insensitive, the query type is not */
+	zassert_true(lookup("ONE.zephyr.TEST", DNS_QUERY_TYPE_A),
+		     "Not found with different case");
+	zassert_false(lookup(NAME1, DNS_QUERY_TYPE_AAAA),
+		      "Found with wrong type");
+
+	zassert_equal(net_stats.dns.cache_hit, hits + 2, "Wrong hit count");
+}
+
+static void test_cache_negative(void)
+{
+	dns_cache_add(NAME2, DNS_QUERY_TYPE_AAAA, DNS_EAI_NODATA, NULL, 0,
+		      60);
+
+	zassert_true(lookup(NAME2, DNS_QUERY_TYPE_AAAA), "Not found");
+	zassert_equal(result.status, DNS_EAI_NODATA, "Wrong status");
+	zassert_equal(result.count, 0, "Wrong count");
+
+	/* Failures are not cached */
+	dns_cache_add(NAME3, DNS_QUERY_TYPE_A, DNS_EAI_FAIL, NULL, 0, 60);
+	zassert_false(lookup(NAME3, DNS_QUERY_TYPE_A), "Failure cached");
+}
+
+static void test_cache_ttl(void)
+{
+	/* Zero TTL must not be cached */
+	dns_cache_add(NAME3, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs, 1, 0);
+	zassert_false(lookup(NAME3, DNS_QUERY_TYPE_A), "Zero TTL cached");
+
+	dns_cache_add(NAME3, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs, 1, 1);
+	zassert_true(lookup(NAME3, DNS_QUERY_TYPE_A), "Not found");
+
+	k_sleep(K_MSEC(1100));
+
+	zassert_false(lookup(NAME3, DNS_QUERY_TYPE_A), "Expired entry found");
+}
+
+static void test_cache_full(void)
+{
+	dns_cache_flush();
+
+	dns_cache_add(NAME1, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs, 1, 30);
+	dns_cache_add(NAME2, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs, 1, 10);
+	dns_cache_add(NAME3, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs, 1, 20);
+
+	/* The entry closest to expiry is replaced */
+	dns_cache_add(NAME4, DNS_QUERY_TYPE_A, DNS_EAI_ALLDONE, addrs, 1, 40);
+
+	zassert_true(lookup(NAME1, DNS_QUERY_TYPE_A), "Entry 1 missing");
+	zassert_false(lookup(NAME2, DNS_QUERY_TYPE_A), "Entry 2 not replaced");
+	zassert_true(lookup(NAME3, DNS_QUERY_TYPE_A), "Entry 3 missing");
+	zassert_true(lookup(NAME4, DNS_QUERY_TYPE_A), "Entry 4 missing");
+}
+
+static void cache_cb(const char *name, enum dns_query_type type,
+		     enum dns_resolve_status status,
+		     const struct dns_addrinfo *addrs, int count,
+		     uint32_t ttl, void *user_data)
+{
+	int *entries = user_data;
+
+	zassert_true(ttl <= 40, "Wrong TTL %u", ttl);
+	(*entries)++;
+}
+
+static void test_cache_flush(void)
+{
+	int entries = 0;
+
+	zassert_equal(dns_cache_foreach(cache_cb, &entries), 3,
+		      "Wrong number of entries");
+	zassert_equal(entries, 3, "Callback not called");
+
+	zassert_equal(dns_cache_flush(), 3, "Wrong number of flushed entries");
+	zassert_equal(dns_cache_foreach(cache_cb, &entries), 0,
+		      "Cache not empty");
+	zassert_false(lookup(NAME1, DNS_QUERY_TYPE_A), "Flushed entry found");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(dns_cache,
+			 ztest_unit_test(test_init),
+			 ztest_unit_test(test_cache_positive),
+			 ztest_unit_test(test_cache_negative),
+			 ztest_unit_test(test_cache_ttl),
+			 ztest_unit_test(test_cache_full),
+			 ztest_unit_test(test_cache_flush));
+
+	ztest_run_test_suite(dns_cache);
+}
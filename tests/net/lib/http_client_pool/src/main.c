@@ -0,0 +1,634 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_HTTP_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+#include <net/http_client.h>
+#include <net/tls_credentials.h>
+#include <tc_util.h>
+
+#define SERVER_ADDR CONFIG_NET_CONFIG_MY_IPV4_ADDR
+#define SERVER_PORT 8080
+#define TLS_SERVER_PORT 8443
+#define PSK_TAG 1
+
+#define SERVER_STACK_SIZE 2048
+#define TLS_SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+#define REQ_TIMEOUT 3000
+#define SHORT_TIMEOUT 200
+#define PIPELINE_DEPTH 4
+#define BENCH_ROUNDS 20
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static K_THREAD_STACK_DEFINE(tls_server_stack, TLS_SERVER_STACK_SIZE);
+static struct k_thread tls_server_thread;
+
+static struct sockaddr_in server_addr;
+static int server_sock;
+static int tls_server_sock;
+
+static const unsigned char psk[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10
+};
+static const char psk_id[] = "PSK_identity";
+
+/* Number of connections accepted and requests answered by the server */
+static atomic_t accepted;
+static atomic_t served;
+
+/* Requests answered with a single send(), to exercise pipelining */
+static int server_batch = 1;
+
+/* Close the connection after each response without telling the client */
+static bool server_drop;
+
+/* Read the requests but never answer them */
+static bool server_silent;
+
+static char server_buf[1024];
+static char server_out[1024];
+
+static const struct http_client_endpoint ep = {
+	.host = SERVER_ADDR,
+	.port = SERVER_PORT,
+	.sec_tag = HTTP_CLIENT_NO_TLS,
+};
+
+static const struct http_client_endpoint tls_ep = {
+	.host = SERVER_ADDR,
+	.port = TLS_SERVER_PORT,
+	.sec_tag = PSK_TAG,
+};
+
+struct test_req {
+	struct http_request req;
+	char body[32];
+	size_t body_len;
+	bool complete;
+};
+
+static struct test_req test_reqs[PIPELINE_DEPTH];
+static uint8_t recv_buf[512];
+
+/* Parse the request at the start of buf, return its length or 0 if it is
+ * not complete yet.
+ */
+static size_t server_parse(char *buf, size_t len, char *url, size_t url_len,
+			   size_t *body_len)
+{
+	char *hdr_end, *p, *end;
+	size_t chunk_len;
+
+	hdr_end = strstr(buf, "\r\n\r\n");
+	if (!hdr_end) {
+		return 0;
+	}
+
+	hdr_end += 4;
+
+	p = strchr(buf, ' ');
+	end = p ? strchr(p + 1, ' ') : NULL;
+	zassert_not_null(end, "Invalid request line");
+	zassert_true(end - p - 1 < url_len, "URL too long");
+	memcpy(url, p + 1, end - p - 1);
+	url[end - p - 1] = '\0';
+
+	*body_len = 0;
+	p = hdr_end;
+
+	if (strstr(buf, "Transfer-Encoding: chunked") &&
+	    strstr(buf, "Transfer-Encoding: chunked") < hdr_end) {
+		do {
+			end = strstr(p, "\r\n");
+			if (!end) {
+				return 0;
+			}
+
+			chunk_len = strtoul(p, NULL, 16);
+			p = end + 2 + chunk_len + 2;
+			if (p > buf + len) {
+				return 0;
+			}
+
+			*body_len += chunk_len;
+		} while (chunk_len > 0);
+	} else if (strstr(buf, "Content-Length: ") &&
+		   strstr(buf, "Content-Length: ") < hdr_end) {
+		*body_len = strtoul(strstr(buf, "Content-Length: ") +
+				    sizeof("Content-Length: ") - 1, NULL, 10);
+		p += *body_len;
+		if (p > buf + len) {
+			return 0;
+		}
+	}
+
+	return p - buf;
+}
+
+static void server_serve(int sock)
+{
+	size_t len = 0, out_len = 0, req_len, body_len;
+	bool close_conn;
+	char url[16];
+	char body[32];
+	int count = 0;
+	int ret;
+
+	while (true) {
+		req_len = server_parse(server_buf, len, url, sizeof(url),
+				       &body_len);
+		if (req_len == 0) {
+			ret = recv(sock, server_buf + len,
+				   sizeof(server_buf) - len - 1, 0);
+			if (ret <= 0) {
+				return;
+			}
+
+			len += ret;
+			server_buf[len] = '\0';
+			continue;
+		}
+
+		close_conn = strstr(server_buf, "Connection: close") &&
+			     strstr(server_buf, "Connection: close") <
+			     server_buf + req_len;
+
+		ret = snprintk(body, sizeof(body), "%s:%zu", url, body_len);
+		out_len += snprintk(server_out + out_len,
+				    sizeof(server_out) - out_len,
+				    "HTTP/1.1 200 OK\r\n"
+				    "%s"
+				    "Content-Length: %d\r\n\r\n%s",
+				    close_conn ? "Connection: close\r\n" : "",
+				    ret, body);
+
+		memmove(server_buf, server_buf + req_len, len - req_len);
+		len -= req_len;
+		server_buf[len] = '\0';
+
+		atomic_inc(&served);
+
+		if (server_silent) {
+			out_len = 0;
+			continue;
+		}
+
+		if (++count < server_batch) {
+			continue;
+		}
+
+		zassert_equal(send(sock, server_out, out_len, 0), out_len,
+			      "send failed (%d)", errno);
+		out_len = 0;
+		count = 0;
+
+		if (close_conn || server_drop) {
+			return;
+		}
+	}
+}
+
+static void server_loop(void *p1, void *p2, void *p3)
+{
+	int listen_sock = POINTER_TO_INT(p1);
+	int sock;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		sock = accept(listen_sock, NULL, NULL);
+		if (sock < 0) {
+			return;
+		}
+
+		atomic_inc(&accepted);
+		server_serve(sock);
+		(void)close(sock);
+	}
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	struct test_req *t = CONTAINER_OF(parser, struct test_req,
+					  req.internal.parser);
+
+	zassert_true(t->body_len + length < sizeof(t->body), "Body too long");
+	memcpy(t->body + t->body_len, at, length);
+	t->body_len += length;
+	t->body[t->body_len] = '\0';
+
+	return 0;
+}
+
+static const struct http_parser_settings parser_settings = {
+	.on_body = on_body,
+};
+
+static void response_cb(struct http_response *rsp,
+			enum http_final_call final_data, void *user_data)
+{
+	struct test_req *t = CONTAINER_OF(rsp, struct test_req,
+					  req.internal.response);
+
+	if (final_data == HTTP_DATA_FINAL) {
+		t->complete = true;
+	}
+}
+
+static struct http_request *init_req(struct test_req *t,
+				     enum http_method method, const char *url)
+{
+	memset(t, 0, sizeof(*t));
+
+	t->req.method = method;
+	t->req.url = url;
+	t->req.host = SERVER_ADDR;
+	t->req.protocol = "HTTP/1.1";
+	t->req.response = response_cb;
+	t->req.http_cb = &parser_settings;
+	t->req.recv_buf = recv_buf;
+	t->req.recv_buf_len = sizeof(recv_buf);
+
+	return &t->req;
+}
+
+static void pool_get_ep(const struct http_client_endpoint *endpoint,
+			struct test_req *t, const char *url)
+{
+	int ret;
+
+	ret = http_client_pool_req(endpoint, init_req(t, HTTP_GET, url),
+				   REQ_TIMEOUT, NULL);
+	zassert_true(ret > 0, "Request failed (%d)", ret);
+	zassert_true(t->complete, "Response not complete");
+}
+
+static void pool_get(struct test_req *t, const char *url)
+{
+	pool_get_ep(&ep, t, url);
+}
+
+static void check_body(struct test_req *t, const char *expected)
+{
+	zassert_equal(strcmp(t->body, expected), 0, "Wrong body %s vs %s",
+		      t->body, expected);
+}
+
+static void test_setup(void)
+{
+	static const sec_tag_t sec_tags[] = { PSK_TAG };
+	struct sockaddr_in tls_addr;
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, SERVER_ADDR,
+				&server_addr.sin_addr), 1, "inet_pton failed");
+
+	server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(server_sock >= 0, "socket open failed");
+
+	zassert_equal(bind(server_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)), 0, "bind failed");
+	zassert_equal(listen(server_sock, 2), 0, "listen failed");
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_loop,
+			INT_TO_POINTER(server_sock), NULL, NULL,
+			SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	zassert_equal(tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK,
+					 psk, sizeof(psk)), 0,
+		      "Failed to register PSK");
+	zassert_equal(tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK_ID,
+					 psk_id, sizeof(psk_id) - 1), 0,
+		      "Failed to register PSK ID");
+
+	tls_addr = server_addr;
+	tls_addr.sin_port = htons(TLS_SERVER_PORT);
+
+	tls_server_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(tls_server_sock >= 0, "socket open failed");
+
+	zassert_equal(setsockopt(tls_server_sock, SOL_TLS, TLS_SEC_TAG_LIST,
+				 sec_tags, sizeof(sec_tags)), 0,
+		      "Failed to set sec tag list (%d)", errno);
+	zassert_equal(bind(tls_server_sock, (struct sockaddr *)&tls_addr,
+			   sizeof(tls_addr)), 0, "bind failed");
+	zassert_equal(listen(tls_server_sock, 2), 0, "listen failed");
+
+	k_thread_create(&tls_server_thread, tls_server_stack,
+			K_THREAD_STACK_SIZEOF(tls_server_stack), server_loop,
+			INT_TO_POINTER(tls_server_sock), NULL, NULL,
+			SERVER_PRIORITY, 0, K_NO_WAIT);
+}
+
+/* Consecutive requests share one connection */
+static void test_pool_reuse(void)
+{
+	atomic_val_t conns = atomic_get(&accepted);
+	int i;
+
+	for (i = 0; i < 5; i++) {
+		pool_get(&test_reqs[0], "/reuse");
+		check_body(&test_reqs[0], "/reuse:0");
+	}
+
+	zassert_equal(atomic_get(&accepted) - conns, 1,
+		      "Connection not reused");
+}
+
+/* Idle connections are closed after the idle timeout */
+static void test_pool_idle_timeout(void)
+{
+	atomic_val_t conns = atomic_get(&accepted);
+
+	k_sleep(K_MSEC(CONFIG_HTTP_CLIENT_POOL_IDLE_TIMEOUT *
+		       MSEC_PER_SEC + 100));
+
+	pool_get(&test_reqs[0], "/idle");
+	check_body(&test_reqs[0], "/idle:0");
+
+	zassert_equal(atomic_get(&accepted) - conns, 1,
+		      "Idle connection reused");
+}
+
+/* A response asking to close the connection is honoured */
+static void test_pool_connection_close(void)
+{
+	static const char *close_header[] = {
+		"Connection: close" HTTP_CRLF, NULL
+	};
+	atomic_val_t conns = atomic_get(&accepted);
+	struct http_request *req;
+
+	req = init_req(&test_reqs[0], HTTP_GET, "/close");
+	req->header_fields = close_header;
+
+	zassert_true(http_client_pool_req(&ep, req, REQ_TIMEOUT, NULL) > 0,
+		     "Request failed");
+	check_body(&test_reqs[0], "/close:0");
+
+	pool_get(&test_reqs[0], "/after");
+	check_body(&test_reqs[0], "/after:0");
+
+	zassert_equal(atomic_get(&accepted) - conns, 2,
+		      "Closed connection reused");
+}
+
+/* A connection the server dropped while idle is not used again */
+static void test_pool_server_drop(void)
+{
+	atomic_val_t conns = atomic_get(&accepted);
+
+	server_drop = true;
+	pool_get(&test_reqs[0], "/drop");
+	server_drop = false;
+
+	/* Let the FIN arrive */
+	k_sleep(K_MSEC(100));
+
+	pool_get(&test_reqs[0], "/new");
+	check_body(&test_reqs[0], "/new:0");
+
+	zassert_equal(atomic_get(&accepted) - conns, 2,
+		      "Dropped connection reused");
+}
+
+/* A request timing out closes its connection and frees its pool entry */
+static void test_pool_timeout(void)
+{
+	atomic_val_t conns = atomic_get(&accepted);
+	int sock;
+
+	server_silent = true;
+	(void)http_client_pool_req(&ep, init_req(&test_reqs[0], HTTP_GET,
+						 "/silent"),
+				   SHORT_TIMEOUT, NULL);
+	server_silent = false;
+
+	zassert_false(test_reqs[0].complete, "Unexpected response");
+	zassert_true(test_reqs[0].req.internal.timed_out, "No timeout");
+
+	/* With the other entry taken, the next request needs the entry of
+	 * the timed out one. The TLS server holds the other connection, so
+	 * the plain one is free to answer.
+	 */
+	sock = http_client_pool_get(&tls_ep);
+	zassert_true(sock >= 0, "No connection (%d)", sock);
+
+	pool_get(&test_reqs[0], "/after");
+	check_body(&test_reqs[0], "/after:0");
+
+	zassert_equal(http_client_pool_put(sock, false), 0, "Put failed");
+
+	zassert_equal(atomic_get(&accepted) - conns, 2,
+		      "Timed out connection reused");
+}
+
+/* Idle TLS connections are reused, and dropped once the server closes them.
+ * The plain connections are flushed first, the servers share their buffers.
+ */
+static void test_pool_tls(void)
+{
+	atomic_val_t conns;
+	int i;
+
+	http_client_pool_flush();
+	k_sleep(K_MSEC(100));
+
+	conns = atomic_get(&accepted);
+
+	for (i = 0; i < 3; i++) {
+		pool_get_ep(&tls_ep, &test_reqs[0], "/tls");
+		check_body(&test_reqs[0], "/tls:0");
+	}
+
+	zassert_equal(atomic_get(&accepted) - conns, 1,
+		      "TLS connection not reused");
+
+	server_drop = true;
+	pool_get_ep(&tls_ep, &test_reqs[0], "/drop");
+	server_drop = false;
+
+	/* Let the close notification arrive */
+	k_sleep(K_MSEC(100));
+
+	pool_get_ep(&tls_ep, &test_reqs[0], "/new");
+	check_body(&test_reqs[0], "/new:0");
+
+	zassert_equal(atomic_get(&accepted) - conns, 2,
+		      "Dropped TLS connection reused");
+
+	http_client_pool_flush();
+	k_sleep(K_MSEC(100));
+}
+
+/* Pipelined responses arriving in a single segment are split correctly */
+static void test_pipeline(void)
+{
+	static const char * const urls[] = { "/p0", "/p1", "/p2", "/p3" };
+	struct http_request *reqs[PIPELINE_DEPTH];
+	char expected[16];
+	int sock, i;
+
+	for (i = 0; i < PIPELINE_DEPTH; i++) {
+		reqs[i] = init_req(&test_reqs[i], HTTP_GET, urls[i]);
+	}
+
+	server_batch = PIPELINE_DEPTH;
+
+	sock = http_client_pool_get(&ep);
+	zassert_true(sock >= 0, "No connection (%d)", sock);
+
+	zassert_equal(http_client_req_pipeline(sock, reqs, PIPELINE_DEPTH,
+					       REQ_TIMEOUT, NULL),
+		      PIPELINE_DEPTH, "Missing responses");
+
+	zassert_equal(http_client_pool_put(sock, true), 0, "Put failed");
+
+	server_batch = 1;
+
+	for (i = 0; i < PIPELINE_DEPTH; i++) {
+		snprintk(expected, sizeof(expected), "%s:0", urls[i]);
+		zassert_true(test_reqs[i].complete, "Response not complete");
+		check_body(&test_reqs[i], expected);
+	}
+}
+
+static int payload_cb(int sock, struct http_request *req, void *user_data)
+{
+	static const uint8_t chunk[100];
+	int ret, total = 0;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		ret = http_client_send_chunk(sock, chunk, sizeof(chunk));
+		if (ret < 0) {
+			return ret;
+		}
+
+		total += ret;
+	}
+
+	ret = http_client_send_chunk(sock, NULL, 0);
+	if (ret < 0) {
+		return ret;
+	}
+
+	return total + ret;
+}
+
+/* A request body of unknown length is streamed in chunks */
+static void test_chunked_upload(void)
+{
+	static const char *chunked_header[] = {
+		"Transfer-Encoding: chunked" HTTP_CRLF, NULL
+	};
+	struct http_request *req;
+
+	req = init_req(&test_reqs[0], HTTP_POST, "/upload");
+	req->header_fields = chunked_header;
+	req->payload_cb = payload_cb;
+
+	zassert_true(http_client_pool_req(&ep, req, REQ_TIMEOUT, NULL) > 0,
+		     "Request failed");
+	zassert_true(test_reqs[0].complete, "Response not complete");
+	check_body(&test_reqs[0], "/upload:300");
+}
+
+/* Compare a connection per request with pooled connections */
+static void test_benchmark(void)
+{
+	uint32_t start, fresh_ms, pooled_ms;
+	atomic_val_t conns;
+	int sock, i;
+
+	conns = atomic_get(&accepted);
+	start = k_uptime_get_32();
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		zassert_true(sock >= 0, "socket open failed");
+		zassert_equal(connect(sock, (struct sockaddr *)&server_addr,
+				      sizeof(server_addr)), 0,
+			      "connect failed (%d)", errno);
+
+		zassert_true(http_client_req(sock,
+					     init_req(&test_reqs[0], HTTP_GET,
+						      "/bench"),
+					     REQ_TIMEOUT, NULL) > 0,
+			     "Request failed");
+		zassert_true(test_reqs[0].complete, "Response not complete");
+
+		zassert_equal(close(sock), 0, "close failed");
+	}
+
+	fresh_ms = k_uptime_get_32() - start;
+
+	zassert_equal(atomic_get(&accepted) - conns, BENCH_ROUNDS,
+		      "Wrong number of connections");
+
+	conns = atomic_get(&accepted);
+	start = k_uptime_get_32();
+
+	for (i = 0; i < BENCH_ROUNDS; i++) {
+		pool_get(&test_reqs[0], "/bench");
+	}
+
+	pooled_ms = k_uptime_get_32() - start;
+
+	TC_PRINT("%d requests: %u ms with a connection each, "
+		 "%u ms pooled\n", BENCH_ROUNDS, fresh_ms, pooled_ms);
+
+	zassert_true(atomic_get(&accepted) - conns <= 1,
+		     "Pooled connection not reused");
+}
+
+/* Flushing the pool closes the idle connections */
+static void test_pool_flush(void)
+{
+	atomic_val_t conns = atomic_get(&accepted);
+
+	http_client_pool_flush();
+
+	pool_get(&test_reqs[0], "/flush");
+	check_body(&test_reqs[0], "/flush:0");
+
+	zassert_equal(atomic_get(&accepted) - conns, 1,
+		      "Flushed connection reused");
+
+	zassert_equal(http_client_pool_put(server_sock, true), -ENOENT,
+		      "Unknown socket accepted");
+
+	http_client_pool_flush();
+}
+
+void test_main(void)
+{
+	ztest_test_suite(http_client_pool,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_pool_reuse),
+			 ztest_unit_test(test_pool_idle_timeout),
+			 ztest_unit_test(test_pool_connection_close),
+			 ztest_unit_test(test_pool_server_drop),
+			 ztest_unit_test(test_pool_timeout),
+			 ztest_unit_test(test_pool_tls),
+			 ztest_unit_test(test_pipeline),
+			 ztest_unit_test(test_chunked_upload),
+			 ztest_unit_test(test_benchmark),
+			 ztest_unit_test(test_pool_flush)
+			 );
+
+	ztest_run_test_suite(http_client_pool);
+}
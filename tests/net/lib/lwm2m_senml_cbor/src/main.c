@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ *  @brief SenML CBOR codec test suite
+ *
+ * The codec is included so that its internal decoding helpers can be
+ * tested on their own.
+ */
+
+#include <ztest.h>
+
+#include "lwm2m_rw_senml_cbor.c"
+
+static struct coap_packet cpkt;
+static struct lwm2m_input_context in;
+
+static void input_set(const uint8_t *data, uint16_t len)
+{
+	cpkt.data = (uint8_t *)data;
+	cpkt.offset = len;
+	cpkt.max_len = len;
+
+	in.in_cpkt = &cpkt;
+	in.offset = 0U;
+}
+
+/* Skip the item at the start of data, return the result of cbor_skip() */
+static int skip(const uint8_t *data, uint16_t len)
+{
+	input_set(data, len);
+
+	return cbor_skip(&in, 0);
+}
+
+static void test_cbor_skip(void)
+{
+	/* 100 */
+	static const uint8_t uint[] = { 0x18, 0x64 };
+	/* [1, {"a": [2, 3]}, h'0102'] followed by 7 */
+	static const uint8_t nested[] = {
+		0x83, 0x01, 0xa1, 0x61, 'a', 0x82, 0x02, 0x03,
+		0x42, 0x01, 0x02, 0x07
+	};
+	/* [_ 1, 2] */
+	static const uint8_t indef_array[] = { 0x9f, 0x01, 0x02, 0xff };
+	/* {_ "a": 1} */
+	static const uint8_t indef_map[] = { 0xbf, 0x61, 'a', 0x01, 0xff };
+	/* (_ "a", "b") */
+	static const uint8_t indef_text[] = {
+		0x7f, 0x61, 'a', 0x61, 'b', 0xff
+	};
+	/* 4([-2, 27315]) */
+	static const uint8_t decimal[] = {
+		0xc4, 0x82, 0x21, 0x19, 0x6a, 0xb3
+	};
+	/* 1.5 as a half precision float */
+	static const uint8_t half[] = { 0xf9, 0x3e, 0x00 };
+	/* [[[[1]]]], as deep as allowed */
+	static const uint8_t deep[] = { 0x81, 0x81, 0x81, 0x81, 0x01 };
+
+	zassert_equal(skip(uint, sizeof(uint)), 0, "uint not skipped");
+	zassert_equal(in.offset, sizeof(uint), "Wrong offset");
+
+	zassert_equal(skip(nested, sizeof(nested)), 0, "nested not skipped");
+	zassert_equal(in.offset, sizeof(nested) - 1, "Wrong offset");
+
+	zassert_equal(skip(indef_array, sizeof(indef_array)), 0,
+		      "indefinite array not skipped");
+	zassert_equal(in.offset, sizeof(indef_array), "Wrong offset");
+
+	zassert_equal(skip(indef_map, sizeof(indef_map)), 0,
+		      "indefinite map not skipped");
+	zassert_equal(in.offset, sizeof(indef_map), "Wrong offset");
+
+	zassert_equal(skip(indef_text, sizeof(indef_text)), 0,
+		      "indefinite text not skipped");
+	zassert_equal(in.offset, sizeof(indef_text), "Wrong offset");
+
+	zassert_equal(skip(decimal, sizeof(decimal)), 0,
+		      "decimal fraction not skipped");
+	zassert_equal(in.offset, sizeof(decimal), "Wrong offset");
+
+	zassert_equal(skip(half, sizeof(half)), 0, "float not skipped");
+	zassert_equal(in.offset, sizeof(half), "Wrong offset");
+
+	zassert_equal(skip(deep, sizeof(deep)), 0, "nested array not skipped");
+	zassert_equal(in.offset, sizeof(deep), "Wrong offset");
+}
+
+static void test_cbor_skip_malformed(void)
+{
+	/* [[[[[1]]]]], nested too deep */
+	static const uint8_t too_deep[] = {
+		0x81, 0x81, 0x81, 0x81, 0x81, 0x01
+	};
+	/* 4(4(4(4(4(1))))), nested too deep */
+	static const uint8_t tags[] = { 0xc4, 0xc4, 0xc4, 0xc4, 0xc4, 0x01 };
+	/* reserved additional information */
+	static const uint8_t reserved[] = { 0x1c };
+	/* [1, 2] missing its last item */
+	static const uint8_t short_array[] = { 0x82, 0x01 };
+	/* 32 bit integer missing bytes */
+	static const uint8_t short_head[] = { 0x1a, 0x01, 0x02 };
+	/* text string of 5 bytes with only 2 */
+	static const uint8_t short_text[] = { 0x65, 'a', 'b' };
+	/* [_ 1, 2 without the break */
+	static const uint8_t no_break[] = { 0x9f, 0x01, 0x02 };
+	/* {"a": without the value */
+	static const uint8_t short_map[] = { 0xa1, 0x61, 'a' };
+
+	zassert_equal(skip(too_deep, sizeof(too_deep)), -EINVAL,
+		      "too deep array accepted");
+	zassert_equal(skip(tags, sizeof(tags)), -EINVAL,
+		      "too deep tags accepted");
+	zassert_equal(skip(reserved, sizeof(reserved)), -EINVAL,
+		      "reserved value accepted");
+	zassert_equal(skip(short_array, sizeof(short_array)), -ENODATA,
+		      "short array accepted");
+	zassert_equal(skip(short_head, sizeof(short_head)), -ENODATA,
+		      "short head accepted");
+	zassert_equal(skip(short_text, sizeof(short_text)), -ENOMEM,
+		      "short text accepted");
+	zassert_equal(skip(no_break, sizeof(no_break)), -ENODATA,
+		      "missing break accepted");
+	zassert_equal(skip(short_map, sizeof(short_map)), -ENODATA,
+		      "short map accepted");
+	zassert_equal(skip(NULL, 0), -ENODATA, "empty input accepted");
+}
+
+/* Convert a float given by its CBOR additional information and bits */
+static int to_decimal(uint8_t info, uint64_t bits, int64_t *mantissa,
+		      int *exponent)
+{
+	struct cbor_item item = {
+		.value = bits,
+		.major = CBOR_SIMPLE,
+		.info = info,
+	};
+
+	return float_to_decimal(&item, mantissa, exponent);
+}
+
+static void check_decimal(uint8_t info, uint64_t bits, int64_t exp_mantissa,
+			  int exp_exponent)
+{
+	int64_t mantissa;
+	int exponent;
+
+	zassert_equal(to_decimal(info, bits, &mantissa, &exponent), 0,
+		      "Float not converted");
+	zassert_equal(mantissa, exp_mantissa, "Wrong mantissa");
+	zassert_equal(exponent, exp_exponent, "Wrong exponent");
+}
+
+static void test_float_to_decimal(void)
+{
+	int64_t mantissa;
+	int exponent;
+
+	/* 1.5, 0.25, -2.5 and 100 */
+	check_decimal(CBOR_FLOAT16, 0x3e00, 15, -1);
+	check_decimal(CBOR_FLOAT32, 0x3e800000, 25, -2);
+	check_decimal(CBOR_FLOAT64, 0xc004000000000000, -25, -1);
+	check_decimal(CBOR_FLOAT64, 0x4059000000000000, 100, 0);
+
+	/* zero, and the smallest half precision subnormal */
+	check_decimal(CBOR_FLOAT32, 0x00000000, 0, 0);
+	check_decimal(CBOR_FLOAT16, 0x0001, 59, -9);
+
+	/* 0.1 is not exact, only 9 fractional digits are kept */
+	check_decimal(CBOR_FLOAT32, 0x3dcccccd, 100000001, -9);
+
+	/* infinity, NaN and 1e300 */
+	zassert_equal(to_decimal(CBOR_FLOAT32, 0x7f800000, &mantissa,
+				 &exponent), -ERANGE, "infinity accepted");
+	zassert_equal(to_decimal(CBOR_FLOAT16, 0x7e00, &mantissa,
+				 &exponent), -ERANGE, "NaN accepted");
+	zassert_equal(to_decimal(CBOR_FLOAT64, 0x7e37e43c8800759c, &mantissa,
+				 &exponent), -ERANGE, "1e300 accepted");
+
+	/* simple values which are not floats */
+	zassert_equal(to_decimal(CBOR_TRUE, 0, &mantissa, &exponent), -EINVAL,
+		      "true accepted");
+}
+
+static void check_fixed(int64_t mantissa, int exponent, int digits,
+			int64_t exp_val1, int64_t exp_val2)
+{
+	int64_t val1, val2;
+
+	zassert_equal(decimal_to_fixed(mantissa, exponent, digits, &val1,
+				       &val2), 0, "Decimal not converted");
+	zassert_equal(val1, exp_val1, "Wrong integer part");
+	zassert_equal(val2, exp_val2, "Wrong fractional part");
+}
+
+static void test_decimal_to_fixed(void)
+{
+	int64_t val1, val2;
+
+	check_fixed(27315, -2, 6, 273, 150000);
+	check_fixed(-15, -1, 6, -1, -500000);
+	check_fixed(5, 3, 6, 5000, 0);
+	check_fixed(1234567891, -9, 6, 1, 234567);
+	check_fixed(1234567891, -9, 9, 1, 234567891);
+	check_fixed(15, -1, 0, 1, 0);
+
+	/* digits beyond the table are dropped */
+	check_fixed(1, -40, 9, 0, 0);
+	check_fixed(123, -20, 9, 0, 0);
+
+	/* largest values */
+	check_fixed(9, POW10_MAX, 6, 9000000000000000000LL, 0);
+	check_fixed(-9, POW10_MAX, 6, -9000000000000000000LL, 0);
+	check_fixed(INT64_MAX, 0, 6, INT64_MAX, 0);
+
+	zassert_equal(decimal_to_fixed(10, POW10_MAX, 6, &val1, &val2),
+		      -ERANGE, "overflow accepted");
+	zassert_equal(decimal_to_fixed(-10, POW10_MAX, 6, &val1, &val2),
+		      -ERANGE, "underflow accepted");
+	zassert_equal(decimal_to_fixed(INT64_MAX, 1, 6, &val1, &val2),
+		      -ERANGE, "overflow accepted");
+	zassert_equal(decimal_to_fixed(1, POW10_MAX + 1, 6, &val1, &val2),
+		      -ERANGE, "exponent out of the table accepted");
+}
+
+static void check_path(const char *name, uint8_t level, uint16_t obj_id,
+		       uint16_t obj_inst_id, uint16_t res_id,
+		       uint16_t res_inst_id)
+{
+	struct lwm2m_obj_path path;
+
+	zassert_equal(parse_path(name, &path), 0, "%s not parsed", name);
+	zassert_equal(path.level, level, "%s: wrong level", name);
+	zassert_equal(path.obj_id, obj_id, "%s: wrong object", name);
+	zassert_equal(path.obj_inst_id, obj_inst_id, "%s: wrong instance",
+		      name);
+	zassert_equal(path.res_id, res_id, "%s: wrong resource", name);
+	zassert_equal(path.res_inst_id, res_inst_id,
+		      "%s: wrong resource instance", name);
+}
+
+static void test_parse_path(void)
+{
+	static const char * const invalid[] = {
+		"", "3/0", "//", "/3//0", "/3/0//", "/3/a", "/3/0x", "/-1",
+		"/65536", "/1/2/3/4/5",
+	};
+	struct lwm2m_obj_path path;
+
+	check_path("/", 0, 0, 0, 0, 0);
+	check_path("/3", 1, 3, 0, 0, 0);
+	check_path("/3/0/", 2, 3, 0, 0, 0);
+	check_path("/3/0/1", 3, 3, 0, 1, 0);
+	check_path("/3303/0/5700/1", 4, 3303, 0, 5700, 1);
+	check_path("/65535/65535/65535/65535", 4, 65535, 65535, 65535, 65535);
+	check_path("/1/2/3/4/", 4, 1, 2, 3, 4);
+
+	for (int i = 0; i < ARRAY_SIZE(invalid); i++) {
+		zassert_equal(parse_path(invalid[i], &path), -EINVAL,
+			      "%s accepted", invalid[i]);
+	}
+}
+
+/* A record that does not fit must fail the pack, not emit it headless */
+static void test_writer_overflow(void)
+{
+	struct lwm2m_obj_path path = {
+		.obj_id = 3303, .obj_inst_id = 0, .res_id = 5700, .level = 3,
+	};
+	struct cbor_out_formatter_data fd;
+	struct lwm2m_output_context out;
+	uint8_t buf[24];
+	uint16_t len;
+
+	(void)memset(&fd, 0, sizeof(fd));
+	cpkt.data = buf;
+	cpkt.offset = 0U;
+	cpkt.max_len = sizeof(buf);
+
+	out.writer = &senml_cbor_writer;
+	out.out_cpkt = &cpkt;
+	engine_set_out_user_data(&out, &fd);
+
+	put_begin(&out, &path);
+	put_s32(&out, &path, 1);
+	zassert_equal(fd.err, 0, "First record failed");
+
+	put_s32(&out, &path, 2);
+	zassert_equal(fd.err, -ENOMEM, "Overflow not reported");
+
+	len = cpkt.offset;
+	zassert_equal(put_end(&out, &path), 0, "Array header written");
+	zassert_equal(cpkt.offset, len, "Array header inserted");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(lwm2m_senml_cbor,
+			 ztest_unit_test(test_cbor_skip),
+			 ztest_unit_test(test_cbor_skip_malformed),
+			 ztest_unit_test(test_float_to_decimal),
+			 ztest_unit_test(test_decimal_to_fixed),
+			 ztest_unit_test(test_parse_path),
+			 ztest_unit_test(test_writer_overflow));
+	ztest_run_test_suite(lwm2m_senml_cbor);
+}
@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, LOG_LEVEL_WRN);
+
+#include <ztest.h>
+#include <net/socket.h>
+#include <net/mqtt.h>
+#include <tc_util.h>
+
+#include <string.h>
+#include <errno.h>
+
+#define SERVER_PORT 1883
+#define CLIENT_ID "inflight_test"
+#define TOPIC "sensors"
+
+#define WINDOW_SIZE CONFIG_MQTT_INFLIGHT_WINDOW_SIZE
+#define THROUGHPUT_MSGS 128
+#define PAYLOAD_SIZE 64
+
+#define BROKER_STACK_SIZE 2048
+#define BROKER_PRIORITY K_PRIO_PREEMPT(8)
+
+#define IO_TIMEOUT_MS 5000
+
+#define PKT_CONNECT    0x10
+#define PKT_CONNACK    0x20
+#define PKT_PUBLISH    0x30
+#define PKT_PUBACK     0x40
+#define PKT_PUBREC     0x50
+#define PKT_PUBREL     0x60
+#define PKT_PUBCOMP    0x70
+#define PKT_DISCONNECT 0xe0
+
+/* Minimal stand-in for a broker: acknowledges everything it is sent unless
+ * told to withhold the acknowledgements, and counts what it has seen. With
+ * puback_only set it answers every publish with a PUBACK, whatever its QoS.
+ */
+static struct {
+	int sock;
+	uint8_t session_present;
+	bool withhold_acks;
+	bool puback_only;
+	atomic_t publishes;
+	atomic_t duplicates;
+	atomic_t releases;
+} broker_ctx;
+
+static K_THREAD_STACK_DEFINE(broker_stack, BROKER_STACK_SIZE);
+static struct k_thread broker_thread;
+
+static uint8_t rx_buffer[256];
+static uint8_t tx_buffer[1024];
+static uint8_t payload[PAYLOAD_SIZE];
+static struct mqtt_client client_ctx;
+static struct sockaddr_in broker_addr;
+static struct mqtt_publish_param params[THROUGHPUT_MSGS];
+static uint16_t next_message_id = 1U;
+static bool connected;
+static int pubacks;
+
+static struct {
+	int add;
+	int update;
+	int remove;
+} store_calls;
+
+static int broker_recv_all(int sock, uint8_t *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = recv(sock, buf, len, 0);
+		if (ret <= 0) {
+			return -ENOTCONN;
+		}
+
+		buf += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static int broker_recv_packet(int sock, uint8_t *type, uint8_t *buf,
+			      size_t size)
+{
+	uint32_t length = 0U;
+	uint8_t byte;
+	int shift = 0;
+
+	if (broker_recv_all(sock, type, 1) < 0) {
+		return -ENOTCONN;
+	}
+
+	do {
+		if (broker_recv_all(sock, &byte, 1) < 0) {
+			return -ENOTCONN;
+		}
+
+		length |= (byte & 0x7f) << shift;
+		shift += 7;
+	} while (byte & 0x80);
+
+	if (length > size) {
+		return -EMSGSIZE;
+	}
+
+	if (broker_recv_all(sock, buf, length) < 0) {
+		return -ENOTCONN;
+	}
+
+	return length;
+}
+
+static void broker_reply(int sock, uint8_t type, const uint8_t *id)
+{
+	uint8_t reply[4] = { type, 2U };
+
+	if (id != NULL) {
+		reply[2] = id[0];
+		reply[3] = id[1];
+	} else {
+		reply[3] = 0U;
+	}
+
+	(void)send(sock, reply, sizeof(reply), 0);
+}
+
+static void broker_session(int sock)
+{
+	uint8_t buf[256];
+	uint8_t session[2];
+	uint16_t topic_len;
+	uint8_t type, qos;
+	int len;
+
+	while (true) {
+		len = broker_recv_packet(sock, &type, buf, sizeof(buf));
+		if (len < 0) {
+			return;
+		}
+
+		switch (type >> 4) {
+		case PKT_CONNECT >> 4:
+			session[0] = broker_ctx.session_present;
+			session[1] = 0U;
+			broker_reply(sock, PKT_CONNACK, session);
+			break;
+
+		case PKT_PUBLISH >> 4:
+			atomic_inc(&broker_ctx.publishes);
+			if (type & 0x08) {
+				atomic_inc(&broker_ctx.duplicates);
+			}
+
+			qos = (type >> 1) & 0x03;
+			topic_len = (buf[0] << 8) | buf[1];
+
+			if (qos == MQTT_QOS_0_AT_MOST_ONCE ||
+			    broker_ctx.withhold_acks) {
+				break;
+			}
+
+			broker_reply(sock, qos == MQTT_QOS_1_AT_LEAST_ONCE ||
+				     broker_ctx.puback_only ?
+				     PKT_PUBACK : PKT_PUBREC,
+				     &buf[2 + topic_len]);
+			break;
+
+		case PKT_PUBREL >> 4:
+			atomic_inc(&broker_ctx.releases);
+			if (!broker_ctx.withhold_acks) {
+				broker_reply(sock, PKT_PUBCOMP, buf);
+			}
+
+			break;
+
+		case PKT_DISCONNECT >> 4:
+			return;
+
+		default:
+			break;
+		}
+	}
+}
+
+static void broker_loop(void *p1, void *p2, void *p3)
+{
+	int sock;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		sock = accept(broker_ctx.sock, NULL, NULL);
+		if (sock < 0) {
+			return;
+		}
+
+		broker_session(sock);
+
+		(void)close(sock);
+	}
+}
+
+static void session_store_cb(struct mqtt_client *client,
+			     const struct mqtt_inflight *entry,
+			     enum mqtt_session_store_op op)
+{
+	switch (op) {
+	case MQTT_SESSION_STORE_ADD:
+		store_calls.add++;
+		break;
+	case MQTT_SESSION_STORE_UPDATE:
+		store_calls.update++;
+		break;
+	case MQTT_SESSION_STORE_REMOVE:
+		store_calls.remove++;
+		break;
+	}
+}
+
+static void mqtt_evt_handler(struct mqtt_client *const client,
+			     const struct mqtt_evt *evt)
+{
+	struct mqtt_pubrel_param rel_param;
+	int err;
+
+	switch (evt->type) {
+	case MQTT_EVT_CONNACK:
+		connected = (evt->result == 0);
+		break;
+
+	case MQTT_EVT_DISCONNECT:
+		connected = false;
+		break;
+
+	case MQTT_EVT_PUBACK:
+		pubacks++;
+		break;
+
+	case MQTT_EVT_PUBREC:
+		if (evt->result != 0) {
+			break;
+		}
+
+		rel_param.message_id = evt->param.pubrec.message_id;
+
+		err = mqtt_publish_qos2_release(client, &rel_param);
+		zassert_equal(err, 0, "Failed to send PUBREL (%d)", err);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/* Feed the client with whatever the broker sent until the condition holds. */
+static bool input_until(bool (*cond)(void))
+{
+	struct pollfd fds = {
+		.fd = client_ctx.transport.tcp.sock,
+		.events = ZSOCK_POLLIN,
+	};
+	int64_t timeout = k_uptime_get() + IO_TIMEOUT_MS;
+
+	while (!cond()) {
+		if (k_uptime_get() > timeout) {
+			return false;
+		}
+
+		if (poll(&fds, 1, 100) > 0) {
+			(void)mqtt_input(&client_ctx);
+		}
+	}
+
+	return true;
+}
+
+static bool is_connected(void)
+{
+	return connected;
+}
+
+static bool puback_received(void)
+{
+	return pubacks > 0;
+}
+
+static bool window_empty(void)
+{
+	return mqtt_inflight_count(&client_ctx) == 0;
+}
+
+static bool window_not_full(void)
+{
+	return mqtt_inflight_count(&client_ctx) < WINDOW_SIZE;
+}
+
+static void client_connect(void)
+{
+	zassert_equal(mqtt_connect(&client_ctx), 0, "mqtt_connect failed");
+	zassert_true(input_until(is_connected), "No CONNACK");
+}
+
+static void prepare_params(enum mqtt_qos qos, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++) {
+		memset(&params[i], 0, sizeof(params[i]));
+		params[i].message.topic.qos = qos;
+		params[i].message.topic.topic.utf8 = (uint8_t *)TOPIC;
+		params[i].message.topic.topic.size = strlen(TOPIC);
+		params[i].message.payload.data = payload;
+		params[i].message.payload.len = sizeof(payload);
+		params[i].message_id = next_message_id++;
+	}
+}
+
+static void test_setup(void)
+{
+	broker_addr.sin_family = AF_INET;
+	broker_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&broker_addr.sin_addr), 1, "inet_pton failed");
+
+	broker_ctx.sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(broker_ctx.sock >= 0, "socket open failed");
+	zassert_equal(bind(broker_ctx.sock, (struct sockaddr *)&broker_addr,
+			   sizeof(broker_addr)), 0, "bind failed");
+	zassert_equal(listen(broker_ctx.sock, 1), 0, "listen failed");
+
+	k_thread_create(&broker_thread, broker_stack,
+			K_THREAD_STACK_SIZEOF(broker_stack), broker_loop,
+			NULL, NULL, NULL, BROKER_PRIORITY, 0, K_NO_WAIT);
+
+	mqtt_client_init(&client_ctx);
+
+	client_ctx.broker = &broker_addr;
+	client_ctx.evt_cb = mqtt_evt_handler;
+	client_ctx.session_store = session_store_cb;
+	client_ctx.client_id.utf8 = (uint8_t *)CLIENT_ID;
+	client_ctx.client_id.size = strlen(CLIENT_ID);
+	client_ctx.clean_session = 0U;
+	client_ctx.transport.type = MQTT_TRANSPORT_NON_SECURE;
+	client_ctx.rx_buf = rx_buffer;
+	client_ctx.rx_buf_size = sizeof(rx_buffer);
+	client_ctx.tx_buf = tx_buffer;
+	client_ctx.tx_buf_size = sizeof(tx_buffer);
+
+	client_connect();
+}
+
+static void test_publish_invalid(void)
+{
+	prepare_params(MQTT_QOS_1_AT_LEAST_ONCE, 2);
+	params[1].message_id = params[0].message_id;
+
+	zassert_equal(mqtt_publish_batch(&client_ctx, params, 2), -EBUSY,
+		      "Duplicate message id accepted");
+
+	params[1].message_id = 0U;
+
+	zassert_equal(mqtt_publish_batch(&client_ctx, params, 2), -EINVAL,
+		      "Message id 0 accepted");
+	zassert_equal(mqtt_inflight_count(&client_ctx), 0,
+		      "Rejected batch left messages in flight");
+}
+
+/* Publish QoS 1 messages as fast as the window allows, one call per message
+ * or one call per window, and return the throughput in messages per second.
+ */
+static uint32_t publish_throughput(bool batch)
+{
+	uint32_t start, elapsed;
+	int sent = 0;
+	int count;
+	int ret;
+
+	prepare_params(MQTT_QOS_1_AT_LEAST_ONCE, THROUGHPUT_MSGS);
+
+	start = k_uptime_get_32();
+
+	while (sent < THROUGHPUT_MSGS) {
+		zassert_true(input_until(window_not_full), "Window stuck");
+
+		if (batch) {
+			count = MIN(WINDOW_SIZE - mqtt_inflight_count(&client_ctx),
+				    THROUGHPUT_MSGS - sent);
+			ret = mqtt_publish_batch(&client_ctx, &params[sent],
+						 count);
+		} else {
+			count = 1;
+			ret = mqtt_publish(&client_ctx, &params[sent]);
+		}
+
+		zassert_equal(ret, 0, "Publish failed (%d)", ret);
+		sent += count;
+	}
+
+	zassert_true(input_until(window_empty), "Messages not acknowledged");
+
+	elapsed = MAX(k_uptime_get_32() - start, 1U);
+
+	return THROUGHPUT_MSGS * MSEC_PER_SEC / elapsed;
+}
+
+static void test_throughput(void)
+{
+	uint32_t single, batched;
+
+	memset(&store_calls, 0, sizeof(store_calls));
+
+	single = publish_throughput(false);
+	batched = publish_throughput(true);
+
+	TC_PRINT("%d QoS 1 messages, window %d: %u msg/s single, "
+		 "%u msg/s batched\n", THROUGHPUT_MSGS, WINDOW_SIZE,
+		 single, batched);
+
+	zassert_equal(store_calls.add, 2 * THROUGHPUT_MSGS,
+		      "Wrong number of stored messages");
+	zassert_equal(store_calls.remove, 2 * THROUGHPUT_MSGS,
+		      "Wrong number of removed messages");
+}
+
+static void test_qos2(void)
+{
+	int releases = atomic_get(&broker_ctx.releases);
+
+	memset(&store_calls, 0, sizeof(store_calls));
+
+	prepare_params(MQTT_QOS_2_EXACTLY_ONCE, 1);
+
+	zassert_equal(mqtt_publish(&client_ctx, &params[0]), 0,
+		      "Publish failed");
+	zassert_true(input_until(window_empty), "PUBCOMP not handled");
+
+	zassert_equal(atomic_get(&broker_ctx.releases) - releases, 1,
+		      "PUBREL not sent");
+	zassert_equal(store_calls.add, 1, "Message not stored");
+	zassert_equal(store_calls.update, 1, "PUBREC not stored");
+	zassert_equal(store_calls.remove, 1, "Message not removed");
+}
+
+/* A PUBACK does not release a QoS 2 message, only its PUBCOMP does. */
+static void test_qos2_puback(void)
+{
+	broker_ctx.puback_only = true;
+	pubacks = 0;
+
+	prepare_params(MQTT_QOS_2_EXACTLY_ONCE, 1);
+
+	zassert_equal(mqtt_publish(&client_ctx, &params[0]), 0,
+		      "Publish failed");
+	zassert_true(input_until(puback_received), "PUBACK not received");
+	zassert_equal(mqtt_inflight_count(&client_ctx), 1,
+		      "QoS 2 message released by a PUBACK");
+
+	/* Resend it to a broker that acknowledges it properly. */
+	broker_ctx.puback_only = false;
+
+	zassert_equal(mqtt_abort(&client_ctx), 0, "mqtt_abort failed");
+
+	client_connect();
+
+	zassert_true(input_until(window_empty), "PUBCOMP not handled");
+}
+
+static void test_window_full(void)
+{
+	broker_ctx.withhold_acks = true;
+
+	prepare_params(MQTT_QOS_1_AT_LEAST_ONCE, WINDOW_SIZE + 1);
+
+	zassert_equal(mqtt_publish_batch(&client_ctx, params, WINDOW_SIZE), 0,
+		      "Publish failed");
+	zassert_equal(mqtt_inflight_count(&client_ctx), WINDOW_SIZE,
+		      "Wrong in-flight count");
+
+	zassert_equal(mqtt_publish(&client_ctx, &params[WINDOW_SIZE]), -EAGAIN,
+		      "Publish with a full window accepted");
+
+	/* QoS 0 messages do not take a slot in the window. */
+	params[WINDOW_SIZE].message.topic.qos = MQTT_QOS_0_AT_MOST_ONCE;
+	zassert_equal(mqtt_publish(&client_ctx, &params[WINDOW_SIZE]), 0,
+		      "QoS 0 publish failed");
+}
+
+/* The unacknowledged messages of test_window_full are retransmitted with the
+ * DUP flag once the session is resumed.
+ */
+static void test_reconnect_resend(void)
+{
+	int publishes, duplicates;
+
+	zassert_equal(mqtt_abort(&client_ctx), 0, "mqtt_abort failed");
+	zassert_false(connected, "Still connected");
+	zassert_equal(mqtt_inflight_count(&client_ctx), WINDOW_SIZE,
+		      "Window lost on disconnect");
+
+	broker_ctx.withhold_acks = false;
+	broker_ctx.session_present = 1U;
+
+	publishes = atomic_get(&broker_ctx.publishes);
+	duplicates = atomic_get(&broker_ctx.duplicates);
+
+	client_connect();
+
+	zassert_true(input_until(window_empty), "Messages not retransmitted");
+
+	zassert_equal(atomic_get(&broker_ctx.publishes) - publishes,
+		      WINDOW_SIZE, "Wrong number of retransmissions");
+	zassert_equal(atomic_get(&broker_ctx.duplicates) - duplicates,
+		      WINDOW_SIZE, "Retransmissions without DUP flag");
+}
+
+static void test_disconnect(void)
+{
+	zassert_equal(mqtt_disconnect(&client_ctx), 0, "mqtt_disconnect failed");
+	zassert_equal(close(broker_ctx.sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	memset(payload, 0xa5, sizeof(payload));
+
+	ztest_test_suite(mqtt_inflight,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_publish_invalid),
+			 ztest_unit_test(test_throughput),
+			 ztest_unit_test(test_qos2),
+			 ztest_unit_test(test_qos2_puback),
+			 ztest_unit_test(test_window_full),
+			 ztest_unit_test(test_reconnect_resend),
+			 ztest_unit_test(test_disconnect)
+			 );
+
+	ztest_run_test_suite(mqtt_inflight);
+}
@@ -785,6 +785,62 @@ void test_net_pkt_clone(void)
 	net_pkt_unref(cloned_pkt);
 }
 
+#if defined(CONFIG_NET_PKT_RESERVE)
+NET_PKT_RESERVE_DEFINE(test_reserve, 2, 4);
+
+static void test_net_pkt_reserve(void)
+{
+	struct net_pkt *pkt[3];
+	int i;
+
+	net_pkt_reserve_attach_iface(eth_if, &test_reserve);
+
+	for (i = 0; i < ARRAY_SIZE(pkt); i++) {
+		pkt[i] = net_pkt_rx_alloc_with_buffer(eth_if, 64, AF_UNSPEC,
+						      0, K_NO_WAIT);
+		zassert_true(pkt[i] != NULL, "Pkt not allocated");
+	}
+
+	/* Reserved packets come first, the last one is borrowed */
+	zassert_equal(pkt[0]->slab, &test_reserve_slab, "Pkt not reserved");
+	zassert_equal(pkt[1]->slab, &test_reserve_slab, "Pkt not reserved");
+	zassert_not_equal(pkt[2]->slab, &test_reserve_slab, "Pkt reserved");
+
+	for (i = 0; i < ARRAY_SIZE(pkt); i++) {
+		zassert_equal(net_buf_pool_get(pkt[i]->buffer->pool_id),
+			      &test_reserve_pool, "Buffer not reserved");
+	}
+
+	zassert_equal(atomic_get(&test_reserve.stats.pkt_alloc), 2,
+		      "Wrong reserved pkt count");
+	zassert_equal(atomic_get(&test_reserve.stats.pkt_borrow), 1,
+		      "Wrong borrowed pkt count");
+	zassert_equal(atomic_get(&test_reserve.stats.buf_alloc), 3,
+		      "Wrong reserved buf count");
+
+	for (i = 0; i < ARRAY_SIZE(pkt); i++) {
+		net_pkt_unref(pkt[i]);
+	}
+
+	zassert_equal(k_mem_slab_num_free_get(&test_reserve_slab), 2,
+		      "Reserved pkt not returned");
+
+	net_pkt_reserve_attach_iface(eth_if, NULL);
+
+	pkt[0] = net_pkt_rx_alloc_with_buffer(eth_if, 64, AF_UNSPEC,
+					      0, K_NO_WAIT);
+	zassert_true(pkt[0] != NULL, "Pkt not allocated");
+	zassert_not_equal(pkt[0]->slab, &test_reserve_slab, "Pkt reserved");
+
+	net_pkt_unref(pkt[0]);
+}
+#else
+static void test_net_pkt_reserve(void)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_NET_PKT_RESERVE */
+
 void test_main(void)
 {
 	eth_if = net_if_get_default();
@@ -797,7 +853,8 @@ void test_main(void)
 			 ztest_unit_test(test_net_pkt_easier_rw_usage),
 			 ztest_unit_test(test_net_pkt_copy),
 			 ztest_unit_test(test_net_pkt_pull),
-			 ztest_unit_test(test_net_pkt_clone)
+			 ztest_unit_test(test_net_pkt_clone),
+			 ztest_unit_test(test_net_pkt_reserve)
 		);
 
 	ztest_run_test_suite(net_pkt_tests);
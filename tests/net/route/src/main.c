@@ -473,6 +473,49 @@ static void test_route_del_many(void)
 	}
 }
 
+static void test_route_lookup_longest_prefix(void)
+{
+	/* 2001:db8::1:0:0:0/64 and 2001:db8::beef:0:0/96 */
+	struct in6_addr prefix64 = { { { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0,
+					 0, 0x1, 0, 0, 0, 0, 0, 0 } } };
+	struct in6_addr in96 = generic_addr;
+	struct in6_addr in64 = prefix64;
+	struct in6_addr outside = prefix64;
+	struct net_route_entry *route64, *route96;
+
+	in96.s6_addr[15] = 0x42;
+	in64.s6_addr[9] = 0x2;
+	outside.s6_addr[5] = 0x1;
+
+	route96 = net_route_add(my_iface, &generic_addr, 96, &peer_addr);
+	zassert_not_null(route96, "Route add failed");
+
+	route64 = net_route_add(my_iface, &prefix64, 64, &peer_addr);
+	zassert_not_null(route64, "Route add failed");
+	zassert_not_equal(route64, route96, "Routes should differ");
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &in96), route96,
+			  "Longest prefix not found");
+	zassert_equal_ptr(net_route_lookup(NULL, &in96), route96,
+			  "Longest prefix not found on any interface");
+	zassert_equal_ptr(net_route_lookup(my_iface, &in64), route64,
+			  "Shorter prefix not found");
+	zassert_is_null(net_route_lookup(my_iface, &outside),
+			"Route found for outside address");
+	zassert_is_null(net_route_lookup(peer_iface, &in96),
+			"Route found on wrong interface");
+
+	zassert_false(net_route_del(route96), "Route del failed");
+
+	zassert_equal_ptr(net_route_lookup(my_iface, &in96), route64,
+			  "Covering prefix not found");
+
+	zassert_false(net_route_del(route64), "Route del failed");
+
+	zassert_is_null(net_route_lookup(my_iface, &in96),
+			"Deleted route found");
+}
+
 /*test case main entry*/
 void test_main(void)
 {
@@ -492,6 +535,7 @@ void test_main(void)
 			ztest_unit_test(test_route_del_nexthop_again),
 			ztest_unit_test(test_populate_nbr_cache),
 			ztest_unit_test(test_route_add_many),
-			ztest_unit_test(test_route_del_many));
+			ztest_unit_test(test_route_del_many),
+			ztest_unit_test(test_route_lookup_longest_prefix));
 	ztest_run_test_suite(test_route);
 }
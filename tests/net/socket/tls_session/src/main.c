@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+#include <net/tls_credentials.h>
+#include <tc_util.h>
+
+#if !defined(CONFIG_MBEDTLS_CFG_FILE)
+#include "mbedtls/config.h"
+#else
+#include CONFIG_MBEDTLS_CFG_FILE
+#endif
+
+#define SERVER_PORT 4242
+#define PSK_TAG 1
+#define HOSTNAME "localhost"
+
+#define HANDSHAKE_ROUNDS 8
+
+#define SERVER_STACK_SIZE 4096
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+static const unsigned char psk[] = {
+	0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+	0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10
+};
+static const char psk_id[] = "PSK_identity";
+
+static const sec_tag_t sec_tags[] = { PSK_TAG };
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+
+static struct sockaddr_in server_addr;
+static int server_sock;
+
+static int tls_socket(int session_cache)
+{
+	int sock;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TLS_1_2);
+	zassert_true(sock >= 0, "socket open failed");
+
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SEC_TAG_LIST,
+				 sec_tags, sizeof(sec_tags)), 0,
+		      "Failed to set sec tag list (%d)", errno);
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &session_cache, sizeof(session_cache)), 0,
+		      "Failed to set session cache (%d)", errno);
+
+	return sock;
+}
+
+static void get_stats(struct tls_session_stats *stats)
+{
+	socklen_t optlen = sizeof(*stats);
+
+	zassert_equal(getsockopt(server_sock, SOL_TLS, TLS_SESSION_STATS,
+				 stats, &optlen), 0,
+		      "Failed to get session stats (%d)", errno);
+}
+
+static void server_loop(void *p1, void *p2, void *p3)
+{
+	int count = POINTER_TO_INT(p1);
+	int sock;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (count--) {
+		sock = accept(server_sock, NULL, NULL);
+		zassert_true(sock >= 0, "accept failed (%d)", errno);
+
+		zassert_equal(close(sock), 0, "close failed");
+	}
+}
+
+static void test_setup(void)
+{
+	zassert_equal(tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK,
+					 psk, sizeof(psk)), 0,
+		      "Failed to register PSK");
+	zassert_equal(tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK_ID,
+					 psk_id, sizeof(psk_id) - 1), 0,
+		      "Failed to register PSK ID");
+
+	server_addr.sin_family = AF_INET;
+	server_addr.sin_port = htons(SERVER_PORT);
+	zassert_equal(inet_pton(AF_INET, CONFIG_NET_CONFIG_MY_IPV4_ADDR,
+				&server_addr.sin_addr), 1, "inet_pton failed");
+
+	server_sock = tls_socket(TLS_SESSION_CACHE_ENABLED);
+
+	zassert_equal(bind(server_sock, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)), 0, "bind failed");
+	zassert_equal(listen(server_sock, 1), 0, "listen failed");
+}
+
+static void test_session_cache_options(void)
+{
+	socklen_t optlen = sizeof(int);
+	int optval = 2;
+	int sock;
+
+	sock = tls_socket(TLS_SESSION_CACHE_DISABLED);
+
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &optval, sizeof(optval)), -1,
+		      "Invalid value accepted");
+	zassert_equal(errno, EINVAL, "Wrong errno %d", errno);
+
+	optval = TLS_SESSION_CACHE_ENABLED;
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &optval, sizeof(optval)), 0,
+		      "Failed to set session cache (%d)", errno);
+
+	optval = TLS_SESSION_CACHE_DISABLED;
+	zassert_equal(getsockopt(sock, SOL_TLS, TLS_SESSION_CACHE,
+				 &optval, &optlen), 0,
+		      "Failed to get session cache (%d)", errno);
+	zassert_equal(optval, TLS_SESSION_CACHE_ENABLED,
+		      "Wrong option value");
+
+	zassert_equal(close(sock), 0, "close failed");
+}
+
+/* Connect to the local server and return the handshake time in ms. */
+static uint32_t connect_once(int session_cache)
+{
+	uint32_t start, elapsed;
+	int sock;
+
+	sock = tls_socket(session_cache);
+
+	zassert_equal(setsockopt(sock, SOL_TLS, TLS_HOSTNAME,
+				 HOSTNAME, sizeof(HOSTNAME)), 0,
+		      "Failed to set hostname (%d)", errno);
+
+	start = k_uptime_get_32();
+
+	zassert_equal(connect(sock, (struct sockaddr *)&server_addr,
+			      sizeof(server_addr)), 0,
+		      "connect failed (%d)", errno);
+
+	elapsed = k_uptime_get_32() - start;
+
+	zassert_equal(close(sock), 0, "close failed");
+
+	return elapsed;
+}
+
+/* Compare the handshake time of full and resumed handshakes */
+static void test_session_resumption(void)
+{
+	struct tls_session_stats before, after;
+	uint32_t full_ms = 0, resumed_ms = 0;
+	int i;
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack), server_loop,
+			INT_TO_POINTER(2 * HANDSHAKE_ROUNDS + 1), NULL, NULL,
+			SERVER_PRIORITY, 0, K_NO_WAIT);
+
+	get_stats(&before);
+
+	for (i = 0; i < HANDSHAKE_ROUNDS; i++) {
+		full_ms += connect_once(TLS_SESSION_CACHE_DISABLED);
+	}
+
+	/* The first connection populates the cache */
+	(void)connect_once(TLS_SESSION_CACHE_ENABLED);
+
+	for (i = 0; i < HANDSHAKE_ROUNDS; i++) {
+		resumed_ms += connect_once(TLS_SESSION_CACHE_ENABLED);
+	}
+
+	zassert_equal(k_thread_join(&server_thread, K_SECONDS(10)), 0,
+		      "Server thread did not finish");
+
+	get_stats(&after);
+
+	TC_PRINT("%d handshakes: full %u ms, resumed %u ms\n",
+		 HANDSHAKE_ROUNDS, full_ms, resumed_ms);
+
+	zassert_equal(after.client_handshakes - before.client_handshakes,
+		      2 * HANDSHAKE_ROUNDS + 1, "Wrong client handshakes");
+	zassert_equal(after.server_handshakes - before.server_handshakes,
+		      2 * HANDSHAKE_ROUNDS + 1, "Wrong server handshakes");
+	zassert_equal(after.client_cached, 1, "Session not cached");
+
+#if defined(MBEDTLS_SSL_CACHE_C)
+	zassert_equal(after.client_resumed - before.client_resumed,
+		      HANDSHAKE_ROUNDS, "Sessions not resumed");
+	zassert_equal(after.server_resumed - before.server_resumed,
+		      HANDSHAKE_ROUNDS, "Sessions not resumed");
+#endif
+}
+
+static void test_session_cache_purge(void)
+{
+	struct tls_session_stats stats;
+
+	zassert_equal(setsockopt(server_sock, SOL_TLS, TLS_SESSION_CACHE_PURGE,
+				 NULL, 0), 0,
+		      "Failed to purge session cache (%d)", errno);
+
+	get_stats(&stats);
+	zassert_equal(stats.client_cached, 0, "Session cache not purged");
+
+	zassert_equal(close(server_sock), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_tls_session,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_session_cache_options),
+			 ztest_unit_test(test_session_resumption),
+			 ztest_unit_test(test_session_cache_purge)
+			 );
+
+	ztest_run_test_suite(socket_tls_session);
+}
@@ -703,6 +703,128 @@ void test_v6_sendmsg_recvfrom_connected(void)
 	zassert_equal(rv, 0, "close failed");
 }
 
+#define MMSG_COUNT 4
+#define MMSG_ROUNDS 128
+
+void test_v4_sendmmsg_recvmmsg(void)
+{
+	int rv;
+	int i;
+	int client_sock;
+	int server_sock;
+	struct sockaddr_in client_addr;
+	struct sockaddr_in server_addr;
+	struct sockaddr_in src_addr[MMSG_COUNT];
+	struct mmsghdr msgs[MMSG_COUNT];
+	struct iovec io_vector[MMSG_COUNT];
+	char bufs[MMSG_COUNT][sizeof(TEST_STR_SMALL)];
+	uint32_t start, single_ms, batch_ms;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &client_sock, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server_sock, &server_addr);
+
+	rv = bind(server_sock,
+		  (struct sockaddr *)&server_addr,
+		  sizeof(server_addr));
+	zassert_equal(rv, 0, "server bind failed");
+
+	rv = bind(client_sock,
+		  (struct sockaddr *)&client_addr,
+		  sizeof(client_addr));
+	zassert_equal(rv, 0, "client bind failed");
+
+	memset(msgs, 0, sizeof(msgs));
+
+	/* Send one datagram less than the receiver asks for */
+	for (i = 0; i < MMSG_COUNT - 1; i++) {
+		io_vector[i].iov_base = TEST_STR_SMALL;
+		io_vector[i].iov_len = i + 1;
+		msgs[i].msg_hdr.msg_iov = &io_vector[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &server_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+	}
+
+	rv = sendmmsg(client_sock, msgs, MMSG_COUNT - 1, 0);
+	zassert_equal(rv, MMSG_COUNT - 1, "sendmmsg failed");
+
+	for (i = 0; i < MMSG_COUNT - 1; i++) {
+		zassert_equal(msgs[i].msg_len, i + 1, "invalid send len");
+	}
+
+	memset(msgs, 0, sizeof(msgs));
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		io_vector[i].iov_base = bufs[i];
+		io_vector[i].iov_len = sizeof(bufs[i]);
+		msgs[i].msg_hdr.msg_iov = &io_vector[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_name = &src_addr[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(src_addr[i]);
+	}
+
+	/* The timeout covers the whole batch */
+	rv = zsock_recvmmsg(server_sock, msgs, MMSG_COUNT, 0, 100);
+	zassert_equal(rv, MMSG_COUNT - 1, "recvmmsg failed");
+
+	for (i = 0; i < MMSG_COUNT - 1; i++) {
+		zassert_equal(msgs[i].msg_len, i + 1, "invalid recv len");
+		zassert_mem_equal(bufs[i], TEST_STR_SMALL, i + 1,
+				  "wrong data");
+		zassert_equal(msgs[i].msg_hdr.msg_namelen,
+			      sizeof(struct sockaddr_in), "wrong addrlen");
+		zassert_equal(src_addr[i].sin_port, htons(CLIENT_PORT),
+			      "wrong port");
+	}
+
+	rv = zsock_recvmmsg(server_sock, msgs, MMSG_COUNT, MSG_DONTWAIT, -1);
+	zassert_equal(rv, -1, "recvmmsg should fail");
+	zassert_equal(errno, EAGAIN, "wrong errno");
+
+	/* Compare the datagram rate of single and batched calls */
+	start = k_uptime_get_32();
+
+	for (i = 0; i < MMSG_ROUNDS * MMSG_COUNT; i++) {
+		rv = sendto(client_sock, BUF_AND_SIZE(TEST_STR_SMALL), 0,
+			    (struct sockaddr *)&server_addr,
+			    sizeof(server_addr));
+		zassert_equal(rv, STRLEN(TEST_STR_SMALL), "send failed");
+
+		rv = recv(server_sock, bufs[0], sizeof(bufs[0]), 0);
+		zassert_equal(rv, STRLEN(TEST_STR_SMALL), "recv failed");
+	}
+
+	single_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	for (i = 0; i < MMSG_COUNT; i++) {
+		msgs[i].msg_hdr.msg_name = &server_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(server_addr);
+	}
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < MMSG_ROUNDS; i++) {
+		rv = sendmmsg(client_sock, msgs, MMSG_COUNT, 0);
+		zassert_equal(rv, MMSG_COUNT, "sendmmsg failed");
+
+		rv = zsock_recvmmsg(server_sock, msgs, MMSG_COUNT, 0, 1000);
+		zassert_equal(rv, MMSG_COUNT, "recvmmsg failed");
+	}
+
+	batch_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	TC_PRINT("single calls %u packets/s, batches of %d %u packets/s\n",
+		 MMSG_ROUNDS * MMSG_COUNT * 1000U / single_ms, MMSG_COUNT,
+		 MMSG_ROUNDS * MMSG_COUNT * 1000U / batch_ms);
+
+	rv = close(client_sock);
+	zassert_equal(rv, 0, "close failed");
+	rv = close(server_sock);
+	zassert_equal(rv, 0, "close failed");
+}
+
 void test_so_txtime(void)
 {
 	struct sockaddr_in bind_addr4;
@@ -976,6 +1098,8 @@ void test_main(void)
 			 ztest_user_unit_test(test_v4_sendmsg_recvfrom_connected),
 			 ztest_unit_test(test_v6_sendmsg_recvfrom_connected),
 			 ztest_user_unit_test(test_v6_sendmsg_recvfrom_connected),
+			 ztest_unit_test(test_v4_sendmmsg_recvmmsg),
+			 ztest_user_unit_test(test_v4_sendmmsg_recvmmsg),
 			 ztest_unit_test(test_setup_eth),
 			 ztest_unit_test(test_v6_sendmsg_with_txtime),
 			 ztest_user_unit_test(test_v6_sendmsg_with_txtime)
@@ -0,0 +1,528 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_WEBSOCKET_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <stdio.h>
+
+#include <net/socket.h>
+#include <net/websocket.h>
+#include <sys/base64.h>
+#include <sys/byteorder.h>
+#include <mbedtls/sha1.h>
+
+#include "websocket_internal.h"
+
+#define SERVER_STACK_SIZE 2048
+#define SERVER_PRIORITY K_PRIO_PREEMPT(8)
+
+/* Client to server benchmark */
+#define SEND_ROUNDS 256
+#define SEND_LEN 1024
+
+/* Server to client benchmark */
+#define RECV_ROUNDS 1024
+#define RECV_FRAME_LEN 64
+#define RECV_BATCH 16
+
+typedef int (*server_fn_t)(void);
+
+K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread;
+static int server_result;
+
+/* sv[0] is the client end used by the websocket, sv[1] the server end */
+static int sv[2];
+static int ws_sock = -1;
+
+static uint8_t temp_buf[1024];
+static uint8_t server_buf[SEND_LEN + MAX_HEADER_LEN];
+static uint8_t tx_buf[SEND_LEN + 1];
+static uint8_t rx_buf[RECV_BATCH * RECV_FRAME_LEN];
+static uint8_t part_buf[RECV_FRAME_LEN];
+
+/* Odd sizes so that the masking goes through the unaligned head and tail
+ * handling, and all three payload length encodings are used.
+ */
+static const size_t iov_sizes[] = { 1, 3, 7, 125, 126, 257, 1021 };
+
+static uint8_t pattern(size_t i, size_t len)
+{
+	return (uint8_t)(i * 7 + len);
+}
+
+static void server_entry(void *p1, void *p2, void *p3)
+{
+	server_fn_t fn = p1;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	server_result = fn();
+}
+
+static void server_start(server_fn_t fn)
+{
+	server_result = -EINPROGRESS;
+
+	k_thread_create(&server_thread, server_stack,
+			K_THREAD_STACK_SIZEOF(server_stack),
+			server_entry, fn, NULL, NULL,
+			SERVER_PRIORITY, 0, K_NO_WAIT);
+}
+
+static void server_stop(void)
+{
+	int ret;
+
+	ret = k_thread_join(&server_thread, K_SECONDS(10));
+	zassert_equal(ret, 0, "Server did not finish (%d)", ret);
+	zassert_equal(server_result, 0, "Server failed (%d)", server_result);
+}
+
+static int server_recv_all(uint8_t *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = recv(sv[1], buf, len, 0);
+		if (ret <= 0) {
+			return -EIO;
+		}
+
+		buf += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static int server_send_all(const uint8_t *buf, size_t len)
+{
+	ssize_t ret;
+
+	while (len > 0) {
+		ret = send(sv[1], buf, len, 0);
+		if (ret < 0) {
+			return -EIO;
+		}
+
+		buf += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+/* Read one masked client frame and unmask it with a plain byte loop so that
+ * the result does not depend on the code under test.
+ */
+static int server_recv_frame(uint8_t *buf, size_t buf_len, size_t *len)
+{
+	uint8_t hdr[4];
+	uint8_t key[4];
+	size_t i;
+	int ret;
+
+	ret = server_recv_all(hdr, 2);
+	if (ret < 0) {
+		return ret;
+	}
+
+	*len = hdr[1] & 0x7f;
+	if (*len == 126) {
+		ret = server_recv_all(&hdr[2], 2);
+		if (ret < 0) {
+			return ret;
+		}
+
+		*len = sys_get_be16(&hdr[2]);
+	}
+
+	if (*len == 127 || *len > buf_len) {
+		return -EMSGSIZE;
+	}
+
+	if (!(hdr[1] & BIT(7))) {
+		return -EINVAL;
+	}
+
+	ret = server_recv_all(key, sizeof(key));
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = server_recv_all(buf, *len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	for (i = 0; i < *len; i++) {
+		buf[i] ^= key[i % sizeof(key)];
+	}
+
+	return 0;
+}
+
+static int server_handshake(void)
+{
+	static char req[512];
+	static char rsp[256];
+	uint8_t key_accept[32 + sizeof(WS_MAGIC)];
+	uint8_t sha1[WS_SHA1_OUTPUT_LEN];
+	char accept[32];
+	char *key, *end;
+	size_t len = 0;
+	size_t olen;
+	ssize_t ret;
+
+	do {
+		ret = recv(sv[1], &req[len], sizeof(req) - 1 - len, 0);
+		if (ret <= 0) {
+			return -EIO;
+		}
+
+		len += ret;
+		req[len] = '\0';
+	} while (strstr(req, "\r\n\r\n") == NULL);
+
+	key = strstr(req, "Sec-WebSocket-Key: ");
+	if (key == NULL) {
+		return -EINVAL;
+	}
+
+	key += sizeof("Sec-WebSocket-Key: ") - 1;
+
+	end = strstr(key, "\r\n");
+	if (end == NULL || end - key > 32) {
+		return -EMSGSIZE;
+	}
+
+	memcpy(key_accept, key, end - key);
+	memcpy(key_accept + (end - key), WS_MAGIC, sizeof(WS_MAGIC) - 1);
+
+	mbedtls_sha1_ret(key_accept, (end - key) + sizeof(WS_MAGIC) - 1, sha1);
+
+	if (base64_encode((uint8_t *)accept, sizeof(accept) - 1, &olen, sha1,
+			  sizeof(sha1)) < 0) {
+		return -EINVAL;
+	}
+
+	accept[olen] = '\0';
+
+	len = snprintf(rsp, sizeof(rsp),
+		       "HTTP/1.1 101 Switching Protocols\r\n"
+		       "Upgrade: websocket\r\n"
+		       "Connection: Upgrade\r\n"
+		       "Sec-WebSocket-Accept: %s\r\n\r\n", accept);
+
+	return server_send_all((uint8_t *)rsp, len);
+}
+
+static void test_connect(void)
+{
+	struct websocket_request req;
+	int ret;
+
+	ret = socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+	zassert_equal(ret, 0, "socketpair failed (%d)", errno);
+
+	server_start(server_handshake);
+
+	memset(&req, 0, sizeof(req));
+
+	req.host = "localhost";
+	req.url = "/";
+	req.tmp_buf = temp_buf;
+	req.tmp_buf_len = sizeof(temp_buf);
+
+	ws_sock = websocket_connect(sv[0], &req, SYS_FOREVER_MS, NULL);
+	zassert_true(ws_sock >= 0, "Cannot connect (%d)", ws_sock);
+
+	server_stop();
+}
+
+static int server_check_iov(void)
+{
+	size_t len;
+	int i, j;
+	int ret;
+
+	for (i = 0; i < ARRAY_SIZE(iov_sizes); i++) {
+		ret = server_recv_frame(server_buf, sizeof(server_buf), &len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (len != iov_sizes[i]) {
+			return -EMSGSIZE;
+		}
+
+		for (j = 0; j < len; j++) {
+			if (server_buf[j] != pattern(j, len)) {
+				return -EBADMSG;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static void test_send_iov_masked(void)
+{
+	struct iovec iov[3];
+	size_t len;
+	int i, j;
+	int ret;
+
+	server_start(server_check_iov);
+
+	for (i = 0; i < ARRAY_SIZE(iov_sizes); i++) {
+		len = iov_sizes[i];
+
+		/* Start from an odd address to exercise unaligned masking */
+		for (j = 0; j < len; j++) {
+			tx_buf[1 + j] = pattern(j, len);
+		}
+
+		iov[0].iov_base = &tx_buf[1];
+		iov[0].iov_len = len / 3;
+		iov[1].iov_base = &tx_buf[1 + len / 3];
+		iov[1].iov_len = len / 2 - len / 3;
+		iov[2].iov_base = &tx_buf[1 + len / 2];
+		iov[2].iov_len = len - len / 2;
+
+		ret = websocket_send_msg_iov(ws_sock, iov, ARRAY_SIZE(iov),
+					     WEBSOCKET_OPCODE_DATA_BINARY,
+					     true, true, SYS_FOREVER_MS);
+		zassert_equal(ret, len, "Sent %d bytes instead of %zd",
+			      ret, len);
+	}
+
+	server_stop();
+}
+
+static int server_drain(void)
+{
+	size_t len;
+	int i, j;
+	int ret;
+
+	for (i = 0; i < 2 * SEND_ROUNDS; i++) {
+		ret = server_recv_frame(server_buf, sizeof(server_buf), &len);
+		if (ret < 0) {
+			return ret;
+		}
+
+		if (len != SEND_LEN) {
+			return -EMSGSIZE;
+		}
+
+		/* The zero-copy round masks the sender buffer in place, so
+		 * only the copying round has a known payload.
+		 */
+		for (j = 0; i < SEND_ROUNDS && j < len; j++) {
+			if (server_buf[j] != pattern(j, len)) {
+				return -EBADMSG;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static void test_send_throughput(void)
+{
+	uint32_t copy_ms, iov_ms, start;
+	struct iovec iov;
+	int i, ret;
+
+	for (i = 0; i < SEND_LEN; i++) {
+		tx_buf[i] = pattern(i, SEND_LEN);
+	}
+
+	server_start(server_drain);
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < SEND_ROUNDS; i++) {
+		ret = websocket_send_msg(ws_sock, tx_buf, SEND_LEN,
+					 WEBSOCKET_OPCODE_DATA_BINARY,
+					 true, true, SYS_FOREVER_MS);
+		zassert_equal(ret, SEND_LEN, "Send failed (%d)", ret);
+	}
+
+	copy_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < SEND_ROUNDS; i++) {
+		iov.iov_base = tx_buf;
+		iov.iov_len = SEND_LEN;
+
+		ret = websocket_send_msg_iov(ws_sock, &iov, 1,
+					     WEBSOCKET_OPCODE_DATA_BINARY,
+					     true, true, SYS_FOREVER_MS);
+		zassert_equal(ret, SEND_LEN, "Send failed (%d)", ret);
+	}
+
+	iov_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	server_stop();
+
+	TC_PRINT("send %d x %d bytes: copy %u ms (%u kB/s), "
+		 "in-place %u ms (%u kB/s)\n",
+		 SEND_ROUNDS, SEND_LEN,
+		 copy_ms, SEND_ROUNDS * SEND_LEN / copy_ms,
+		 iov_ms, SEND_ROUNDS * SEND_LEN / iov_ms);
+}
+
+static int server_send_frames(void)
+{
+	static uint8_t frames[RECV_BATCH * (2 + RECV_FRAME_LEN)];
+	uint8_t *frame;
+	int i, j;
+	int ret;
+
+	/* Both client rounds read RECV_ROUNDS frames */
+	for (i = 0; i < 2 * RECV_ROUNDS; i += RECV_BATCH) {
+		for (j = 0; j < RECV_BATCH; j++) {
+			frame = &frames[j * (2 + RECV_FRAME_LEN)];
+
+			frame[0] = BIT(7) | WEBSOCKET_OPCODE_DATA_BINARY;
+			frame[1] = RECV_FRAME_LEN;
+			memset(&frame[2], (uint8_t)(i + j), RECV_FRAME_LEN);
+		}
+
+		ret = server_send_all(frames, sizeof(frames));
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static void check_frame(const uint8_t *data, size_t len, int seq)
+{
+	int i;
+
+	zassert_equal(len, RECV_FRAME_LEN, "Frame %d has length %zd",
+		      seq, len);
+
+	for (i = 0; i < len; i++) {
+		zassert_equal(data[i], (uint8_t)seq, "Frame %d corrupted",
+			      seq);
+	}
+}
+
+static void test_recv_throughput(void)
+{
+	struct websocket_frame frames[RECV_BATCH];
+	uint32_t msg_ms, frames_ms, start;
+	uint32_t message_type;
+	uint64_t remaining;
+	size_t len = 0;
+	int seq = 0;
+	int calls = 0;
+	int i, ret;
+
+	server_start(server_send_frames);
+
+	start = k_uptime_get_32();
+
+	while (seq < RECV_ROUNDS) {
+		ret = websocket_recv_msg(ws_sock, &rx_buf[len],
+					 sizeof(rx_buf) - len, &message_type,
+					 &remaining, SYS_FOREVER_MS);
+		if (ret == -EAGAIN) {
+			continue;
+		}
+
+		zassert_true(ret > 0, "Recv failed (%d)", ret);
+
+		len += ret;
+
+		if (remaining == 0) {
+			check_frame(rx_buf, len, seq++);
+			len = 0;
+		}
+	}
+
+	msg_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	start = k_uptime_get_32();
+
+	len = 0;
+
+	while (seq < 2 * RECV_ROUNDS) {
+		ret = websocket_recv_frames(ws_sock, rx_buf, sizeof(rx_buf),
+					    frames, ARRAY_SIZE(frames),
+					    SYS_FOREVER_MS);
+		zassert_true(ret > 0, "Recv failed (%d)", ret);
+
+		calls++;
+
+		for (i = 0; i < ret; i++) {
+			zassert_true(frames[i].message_type &
+				     WEBSOCKET_FLAG_BINARY,
+				     "Invalid message type 0x%x",
+				     frames[i].message_type);
+
+			if (frames[i].remaining == 0 && len == 0) {
+				check_frame(frames[i].data, frames[i].len,
+					    seq++);
+				continue;
+			}
+
+			/* The last frame of a batch can be returned
+			 * partially if the server write was split.
+			 */
+			zassert_true(len + frames[i].len <= sizeof(part_buf),
+				     "Frame %d too long", seq);
+			memcpy(&part_buf[len], frames[i].data, frames[i].len);
+			len += frames[i].len;
+
+			if (frames[i].remaining == 0) {
+				check_frame(part_buf, len, seq++);
+				len = 0;
+			}
+		}
+	}
+
+	frames_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	server_stop();
+
+	TC_PRINT("recv %d x %d byte frames: one per call %u ms, "
+		 "batched %u ms (%d calls)\n",
+		 RECV_ROUNDS, RECV_FRAME_LEN, msg_ms, frames_ms, calls);
+}
+
+static void test_disconnect(void)
+{
+	int ret;
+
+	ret = websocket_disconnect(ws_sock);
+	zassert_equal(ret, 0, "Disconnect failed (%d)", ret);
+
+	(void)close(sv[1]);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(websocket_perf,
+			 ztest_unit_test(test_connect),
+			 ztest_unit_test(test_send_iov_masked),
+			 ztest_unit_test(test_send_throughput),
+			 ztest_unit_test(test_recv_throughput),
+			 ztest_unit_test(test_disconnect)
+		);
+
+	ztest_run_test_suite(websocket_perf);
+}
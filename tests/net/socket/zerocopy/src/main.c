@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <ztest_assert.h>
+#include <net/socket.h>
+#include <net/buf.h>
+#include <tc_util.h>
+
+#include "../../socket_helpers.h"
+
+#define SERVER_PORT 4242
+#define CLIENT_PORT 9898
+
+#define TEST_FRAG_LEN 64
+#define TEST_FRAGS 4
+
+#define THROUGHPUT_LEN 1024
+#define THROUGHPUT_ROUNDS 500
+
+#define TCP_TEARDOWN_TIMEOUT K_SECONDS(1)
+
+NET_BUF_POOL_DEFINE(test_pool, TEST_FRAGS * 2, THROUGHPUT_LEN, 0, NULL);
+
+static uint8_t tx_data[THROUGHPUT_LEN];
+static uint8_t rx_data[THROUGHPUT_LEN];
+
+static struct net_buf *prepare_chain(size_t frags, size_t frag_len)
+{
+	struct net_buf *head = NULL;
+	size_t i;
+
+	for (i = 0; i < frags; i++) {
+		struct net_buf *frag;
+
+		frag = net_buf_alloc(&test_pool, K_NO_WAIT);
+		zassert_not_null(frag, "Cannot allocate a fragment");
+
+		net_buf_add_mem(frag, tx_data + i * frag_len, frag_len);
+
+		if (head) {
+			net_buf_frag_add(head, frag);
+		} else {
+			head = frag;
+		}
+	}
+
+	return head;
+}
+
+static void verify_chain(struct net_buf *frags, size_t len)
+{
+	size_t off = 0;
+
+	for (; frags; frags = frags->frags) {
+		zassert_true(off + frags->len <= len, "Too much data");
+		zassert_mem_equal(frags->data, tx_data + off, frags->len,
+				  "Data mismatch at %zu", off);
+		off += frags->len;
+	}
+
+	zassert_equal(off, len, "Data missing");
+}
+
+static void prepare_udp_pair(int *server, int *client,
+			     struct sockaddr_in *server_addr)
+{
+	struct sockaddr_in client_addr;
+
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    client, &client_addr);
+	prepare_sock_udp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    server, server_addr);
+
+	zassert_equal(bind(*server, (struct sockaddr *)server_addr,
+			   sizeof(*server_addr)), 0, "bind failed");
+	zassert_equal(bind(*client, (struct sockaddr *)&client_addr,
+			   sizeof(client_addr)), 0, "bind failed");
+}
+
+static void test_setup(void)
+{
+	size_t i;
+
+	for (i = 0; i < sizeof(tx_data); i++) {
+		tx_data[i] = i;
+	}
+}
+
+static void test_udp_zerocopy(void)
+{
+	struct sockaddr_in server_addr, src_addr;
+	socklen_t addrlen = sizeof(src_addr);
+	struct net_buf *frags;
+	int server, client;
+	ssize_t ret;
+
+	prepare_udp_pair(&server, &client, &server_addr);
+
+	frags = prepare_chain(TEST_FRAGS, TEST_FRAG_LEN);
+
+	ret = zsock_send_buf(client, frags, 0, (struct sockaddr *)&server_addr,
+			     sizeof(server_addr));
+	zassert_equal(ret, TEST_FRAGS * TEST_FRAG_LEN, "send failed (%d)",
+		      errno);
+
+	ret = zsock_recv_buf(server, &frags, SIZE_MAX, 0,
+			     (struct sockaddr *)&src_addr, &addrlen);
+	zassert_equal(ret, TEST_FRAGS * TEST_FRAG_LEN, "recv failed (%d)",
+		      errno);
+	zassert_equal(addrlen, sizeof(struct sockaddr_in), "Wrong addrlen");
+	zassert_equal(src_addr.sin_port, htons(CLIENT_PORT), "Wrong port");
+
+	verify_chain(frags, ret);
+	net_buf_unref(frags);
+
+	zassert_equal(close(client), 0, "close failed");
+	zassert_equal(close(server), 0, "close failed");
+}
+
+static void test_udp_zerocopy_too_small(void)
+{
+	struct sockaddr_in server_addr;
+	struct net_buf *frags;
+	int server, client;
+	ssize_t ret;
+
+	prepare_udp_pair(&server, &client, &server_addr);
+
+	ret = sendto(client, tx_data, TEST_FRAG_LEN, 0,
+		     (struct sockaddr *)&server_addr, sizeof(server_addr));
+	zassert_equal(ret, TEST_FRAG_LEN, "send failed");
+
+	/* The datagram does not fit, it has to stay queued */
+	ret = zsock_recv_buf(server, &frags, TEST_FRAG_LEN - 1, 0, NULL, NULL);
+	zassert_equal(ret, -1, "recv succeeded");
+	zassert_equal(errno, EMSGSIZE, "Wrong errno %d", errno);
+
+	ret = recv(server, rx_data, sizeof(rx_data), 0);
+	zassert_equal(ret, TEST_FRAG_LEN, "Datagram lost");
+	zassert_mem_equal(rx_data, tx_data, TEST_FRAG_LEN, "Data mismatch");
+
+	/* Peeking is not supported */
+	ret = zsock_recv_buf(server, &frags, SIZE_MAX,
+			     MSG_PEEK | MSG_DONTWAIT, NULL, NULL);
+	zassert_equal(ret, -1, "peek succeeded");
+	zassert_equal(errno, EINVAL, "Wrong errno %d", errno);
+
+	zassert_equal(close(client), 0, "close failed");
+	zassert_equal(close(server), 0, "close failed");
+}
+
+static void test_tcp_zerocopy(void)
+{
+	struct sockaddr_in server_addr, client_addr;
+	socklen_t addrlen = sizeof(client_addr);
+	struct net_buf *frags;
+	int server, client, conn;
+	size_t received = 0;
+	ssize_t ret;
+
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, SERVER_PORT,
+			    &server, &server_addr);
+	prepare_sock_tcp_v4(CONFIG_NET_CONFIG_MY_IPV4_ADDR, CLIENT_PORT,
+			    &client, &client_addr);
+
+	zassert_equal(bind(server, (struct sockaddr *)&server_addr,
+			   sizeof(server_addr)), 0, "bind failed");
+	zassert_equal(listen(server, 1), 0, "listen failed");
+	zassert_equal(connect(client, (struct sockaddr *)&server_addr,
+			      sizeof(server_addr)), 0, "connect failed");
+
+	conn = accept(server, (struct sockaddr *)&client_addr, &addrlen);
+	zassert_true(conn >= 0, "accept failed");
+
+	frags = prepare_chain(TEST_FRAGS, TEST_FRAG_LEN);
+
+	ret = zsock_send_buf(client, frags, 0, NULL, 0);
+	zassert_equal(ret, TEST_FRAGS * TEST_FRAG_LEN, "send failed (%d)",
+		      errno);
+
+	while (received < TEST_FRAGS * TEST_FRAG_LEN) {
+		struct net_buf *frag;
+
+		ret = zsock_recv_buf(conn, &frags, SIZE_MAX, 0, NULL, NULL);
+		zassert_true(ret > 0, "recv failed (%d)", errno);
+
+		for (frag = frags; frag; frag = frag->frags) {
+			zassert_mem_equal(frag->data, tx_data + received,
+					  frag->len, "Data mismatch");
+			received += frag->len;
+		}
+
+		net_buf_unref(frags);
+	}
+
+	zassert_equal(received, TEST_FRAGS * TEST_FRAG_LEN, "Too much data");
+
+	zassert_equal(close(client), 0, "close failed");
+	zassert_equal(close(conn), 0, "close failed");
+	zassert_equal(close(server), 0, "close failed");
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+/* Compare the loopback UDP throughput of the copying and zero-copy API */
+static void test_udp_throughput(void)
+{
+	struct sockaddr_in server_addr;
+	uint32_t start, copy_ms, zerocopy_ms;
+	struct net_buf *frags;
+	int server, client;
+	ssize_t ret;
+	int i;
+
+	prepare_udp_pair(&server, &client, &server_addr);
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < THROUGHPUT_ROUNDS; i++) {
+		ret = sendto(client, tx_data, THROUGHPUT_LEN, 0,
+			     (struct sockaddr *)&server_addr,
+			     sizeof(server_addr));
+		zassert_equal(ret, THROUGHPUT_LEN, "send failed");
+
+		ret = recv(server, rx_data, sizeof(rx_data), 0);
+		zassert_equal(ret, THROUGHPUT_LEN, "recv failed");
+	}
+
+	copy_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	start = k_uptime_get_32();
+
+	for (i = 0; i < THROUGHPUT_ROUNDS; i++) {
+		frags = net_buf_alloc(&test_pool, K_NO_WAIT);
+		zassert_not_null(frags, "Cannot allocate a fragment");
+
+		/* The application produces its data in place */
+		net_buf_add(frags, THROUGHPUT_LEN);
+
+		ret = zsock_send_buf(client, frags, 0,
+				     (struct sockaddr *)&server_addr,
+				     sizeof(server_addr));
+		zassert_equal(ret, THROUGHPUT_LEN, "send failed");
+
+		ret = zsock_recv_buf(server, &frags, SIZE_MAX, 0, NULL, NULL);
+		zassert_equal(ret, THROUGHPUT_LEN, "recv failed");
+
+		net_buf_unref(frags);
+	}
+
+	zerocopy_ms = MAX(k_uptime_get_32() - start, 1U);
+
+	TC_PRINT("%d x %d bytes: copy %u ms (%u kB/s), "
+		 "zero-copy %u ms (%u kB/s)\n",
+		 THROUGHPUT_ROUNDS, THROUGHPUT_LEN,
+		 copy_ms, THROUGHPUT_ROUNDS * THROUGHPUT_LEN / copy_ms,
+		 zerocopy_ms, THROUGHPUT_ROUNDS * THROUGHPUT_LEN / zerocopy_ms);
+
+	zassert_equal(close(client), 0, "close failed");
+	zassert_equal(close(server), 0, "close failed");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(socket_zerocopy,
+			 ztest_unit_test(test_setup),
+			 ztest_unit_test(test_udp_zerocopy),
+			 ztest_unit_test(test_udp_zerocopy_too_small),
+			 ztest_unit_test(test_tcp_zerocopy),
+			 ztest_unit_test(test_udp_throughput)
+			 );
+
+	ztest_run_test_suite(socket_zerocopy);
+}
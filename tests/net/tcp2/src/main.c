@@ -94,6 +94,8 @@ static void handle_server_test(sa_family_t af, struct tcphdr *th);
 static void handle_syn_resend(void);
 static void handle_client_fin_wait_2_test(sa_family_t af, struct tcphdr *th);
 static void handle_client_closing_test(sa_family_t af, struct tcphdr *th);
+static void handle_client_fast_retransmit_test(struct net_pkt *pkt,
+					       struct tcphdr *th);
 
 static void verify_flags(struct tcphdr *th, uint8_t flags,
 			 const char *fun, int line)
@@ -180,6 +182,16 @@ static uint8_t tcp_options[20] = {
 	0x01, /* NOP */
 	0x03, 0x03, 0x07 /* Win scale*/ };
 
+static uint8_t tcp_syn_ack_options[12] = {
+	0x02, 0x04, 0x00, 0x64, /* Max segment of 100 bytes */
+	0x01, 0x01, 0x04, 0x02, /* SACK permitted */
+	0x01, 0x03, 0x03, 0x08 /* Win scale */ };
+
+/* Options of the next packet built by tester_prepare_tcp_pkt() */
+static uint8_t *tester_options;
+static size_t tester_options_len;
+static uint16_t tester_window = NET_IPV6_MTU;
+
 static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 					      uint16_t src_port, uint16_t dst_port,
 					      uint8_t flags, uint8_t *data,
@@ -192,9 +204,12 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 	int ret = -EINVAL;
 
 	if ((test_case_no == 4U) && (flags & SYN)) {
-		opts_len = sizeof(tcp_options);
+		tester_options = tcp_options;
+		tester_options_len = sizeof(tcp_options);
 	}
 
+	opts_len = tester_options_len;
+
 	/* Allocate buffer */
 	pkt = net_pkt_alloc_with_buffer(iface,
 					sizeof(struct tcphdr) + len + opts_len,
@@ -227,14 +242,10 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 	th->th_sport = src_port;
 	th->th_dport = dst_port;
 
-	if ((test_case_no == 4U) && (flags & SYN)) {
-		th->th_off = 10U;
-	} else {
-		th->th_off = 5U;
-	}
+	th->th_off = 5U + opts_len / 4U;
 
 	th->th_flags = flags;
-	th->th_win = NET_IPV6_MTU;
+	th->th_win = tester_window;
 	th->th_seq = htonl(seq);
 
 	if (ACK & flags) {
@@ -246,9 +257,11 @@ static struct net_pkt *tester_prepare_tcp_pkt(sa_family_t af,
 		goto fail;
 	}
 
-	if ((test_case_no == 4U) && (flags & SYN)) {
+	if (opts_len) {
 		/* Add TCP Options */
-		ret = net_pkt_write(pkt, tcp_options, opts_len);
+		ret = net_pkt_write(pkt, tester_options, opts_len);
+		tester_options = NULL;
+		tester_options_len = 0;
 		if (ret < 0) {
 			goto fail;
 		}
@@ -375,6 +388,9 @@ static int tester_send(struct device *dev, struct net_pkt *pkt)
 	case 8:
 		handle_client_closing_test(net_pkt_family(pkt), &th);
 		break;
+	case 9:
+		handle_client_fast_retransmit_test(pkt, &th);
+		break;
 	default:
 		zassert_true(false, "Undefined test case");
 	}
@@ -1165,6 +1181,175 @@ static void test_client_closing_ipv6(void)
 	k_sleep(K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY));
 }
 
+#define FR_SEGMENT_LEN 100
+#define FR_SEGMENTS 4
+
+static uint32_t fr_first_seq;
+static int fr_segments;
+
+static void handle_client_fast_retransmit_test(struct net_pkt *pkt,
+					       struct tcphdr *th)
+{
+	sa_family_t af = net_pkt_family(pkt);
+	uint8_t sack[12] = { 0x01, 0x01, 0x05, 0x0a };
+	struct net_pkt *reply;
+	size_t len;
+	int ret;
+
+	switch (t_state) {
+	case T_SYN:
+		test_verify_flags(th, SYN);
+		zassert_true(th->th_off > 5U, "SYN without options");
+		seq = 0U;
+		ack = ntohl(th->th_seq) + 1U;
+		tester_options = tcp_syn_ack_options;
+		tester_options_len = sizeof(tcp_syn_ack_options);
+		reply = prepare_syn_ack_packet(af, htons(MY_PORT),
+					       th->th_sport);
+		t_state = T_SYN_ACK;
+		break;
+	case T_SYN_ACK:
+		test_verify_flags(th, ACK);
+		seq++;
+		t_state = T_DATA;
+		fr_first_seq = ack;
+		fr_segments = 0;
+		test_sem_give();
+		return;
+	case T_DATA:
+		test_verify_flags(th, PSH | ACK);
+		len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+			net_pkt_ip_opts_len(pkt) - th->th_off * 4U;
+		zassert_equal(len, FR_SEGMENT_LEN, "Segment not of MSS size");
+
+		fr_segments++;
+
+		if (fr_segments == 1) {
+			/* Lose the first segment */
+			return;
+		}
+
+		if (fr_segments > FR_SEGMENTS) {
+			zassert_equal(ntohl(th->th_seq), fr_first_seq,
+				      "Unexpected retransmission");
+			ack = fr_first_seq + FR_SEGMENTS * FR_SEGMENT_LEN;
+			reply = prepare_ack_packet(af, htons(MY_PORT),
+						   th->th_sport);
+			t_state = T_FIN;
+			test_sem_give();
+			break;
+		}
+
+		/* Duplicate ACK reporting the received data with SACK */
+		UNALIGNED_PUT(htonl(fr_first_seq + FR_SEGMENT_LEN),
+			      (uint32_t *)(sack + 4));
+		UNALIGNED_PUT(htonl(ntohl(th->th_seq) + FR_SEGMENT_LEN),
+			      (uint32_t *)(sack + 8));
+		tester_options = sack;
+		tester_options_len = sizeof(sack);
+		reply = prepare_ack_packet(af, htons(MY_PORT), th->th_sport);
+		break;
+	case T_FIN:
+		test_verify_flags(th, FIN | ACK);
+		ack = ntohl(th->th_seq) + 1U;
+		t_state = T_FIN_ACK;
+		reply = prepare_fin_ack_packet(af, htons(MY_PORT),
+					       th->th_sport);
+		break;
+	case T_FIN_ACK:
+		test_verify_flags(th, ACK);
+		test_sem_give();
+		return;
+	default:
+		zassert_true(false, "%s unexpected state", __func__);
+		return;
+	}
+
+	ret = net_recv_data(iface, reply);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	return;
+fail:
+	zassert_true(false, "%s failed", __func__);
+}
+
+/* Test case scenario IPv4
+ *   send SYN with window scale and SACK permitted options,
+ *   expect SYN ACK with MSS, window scale and SACK permitted,
+ *   send ACK,
+ *   send four data segments, the first one is lost,
+ *   expect three duplicate ACKs with SACK,
+ *   send the first segment again before the retransmission timeout,
+ *   expect ACK,
+ *   send FIN,
+ *   expect FIN ACK,
+ *   send ACK.
+ *   any failures cause test case to fail.
+ */
+static void test_client_fast_retransmit_ipv4(void)
+{
+	uint8_t data[FR_SEGMENTS * FR_SEGMENT_LEN];
+	struct net_context *ctx;
+	int ret;
+
+	t_state = T_SYN;
+	test_case_no = 9;
+	seq = ack = 0;
+
+	memset(data, 0x41, sizeof(data));
+
+	/* The window of SYN ACK is not scaled, let it cover all the data */
+	tester_window = htons(sizeof(data));
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &ctx);
+	if (ret < 0) {
+		zassert_true(false, "Failed to get net_context");
+	}
+
+	net_context_ref(ctx);
+
+	ret = net_context_connect(ctx, (struct sockaddr *)&peer_addr_s,
+				  sizeof(struct sockaddr_in),
+				  NULL,
+				  K_MSEC(100), NULL);
+	if (ret < 0) {
+		zassert_true(false, "Failed to connect to peer");
+	}
+
+	/* Peer will release the semaphone after it receives
+	 * proper ACK to SYN | ACK
+	 */
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	ret = net_context_send(ctx, data, sizeof(data), NULL, K_NO_WAIT, NULL);
+	if (ret < 0) {
+		zassert_true(false, "Failed to send data to peer");
+	}
+
+	/* Peer will release the semaphone after it receives the lost
+	 * segment, this has to happen before the retransmission timer
+	 * (CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT) expires.
+	 */
+	test_sem_take(K_MSEC(CONFIG_NET_TCP_INIT_RETRANSMISSION_TIMEOUT / 2),
+		      __LINE__);
+
+	net_tcp_put(ctx);
+
+	/* Peer will release the semaphone after it receives
+	 * proper ACK to FIN | ACK
+	 */
+	test_sem_take(K_MSEC(100), __LINE__);
+
+	tester_window = NET_IPV6_MTU;
+
+	/* Connection is in TIME_WAIT state, context will be released
+	 * after K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY), so wait for it.
+	 */
+	k_sleep(K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY));
+}
+
 /** Test case main entry */
 void test_main(void)
 {
@@ -1177,7 +1362,8 @@ void test_main(void)
 			 ztest_unit_test(test_server_ipv6),
 			 ztest_unit_test(test_client_syn_resend),
 			 ztest_unit_test(test_client_fin_wait_2_ipv4),
-			 ztest_unit_test(test_client_closing_ipv6)
+			 ztest_unit_test(test_client_closing_ipv6),
+			 ztest_unit_test(test_client_fast_retransmit_ipv4)
 			 );
 
 	ztest_run_test_suite(test_tcp_fn);
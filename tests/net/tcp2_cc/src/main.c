@@ -0,0 +1,546 @@
+/* main.c - TCP congestion control goodput tests */
+
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TCP_LOG_LEVEL);
+
+#include <errno.h>
+#include <zephyr/types.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/printk.h>
+#include <sys/atomic.h>
+#include <tc_util.h>
+
+#include <net/ethernet.h>
+#include <net/dummy.h>
+#include <net/net_pkt.h>
+
+#include "ipv4.h"
+#include "tcp2.h"
+#include "tcp2_priv.h"
+
+#include <ztest.h>
+
+#define MY_PORT 4242
+#define PEER_PORT 4242
+
+/* The emulated path: 400 kbit/s bottleneck, 40 ms RTT and a tail drop
+ * queue of 8 segments, i.e. twice the bandwidth-delay product.
+ */
+#define LINK_BYTES_PER_MS 50U
+#define LINK_RTT_MS 40U
+#define LINK_MSS 500U
+#define LINK_QUEUE_LIMIT (8U * LINK_MSS)
+
+#define TRANSFER_LEN 48000U
+#define TRANSFER_CHUNK 1000U
+/* How much data the application keeps queued ahead of the receiver */
+#define TRANSFER_AHEAD (16U * LINK_MSS)
+#define TRANSFER_TIMEOUT_MS 20000U
+
+/* Minimal goodput, in percents of the bottleneck rate */
+#define GOODPUT_MIN_PERCENT 25U
+
+#define EVENTS_MAX 32
+
+static struct in_addr my_addr  = { { { 192, 0, 2, 1 } } };
+static struct in_addr peer_addr  = { { { 192, 0, 2, 2 } } };
+static struct sockaddr_in peer_addr_s = {
+	.sin_family = AF_INET,
+	.sin_port = htons(PEER_PORT),
+	.sin_addr = { { { 192, 0, 2, 2 } } },
+};
+
+static struct net_if *iface;
+
+static K_SEM_DEFINE(test_sem, 0, 1);
+
+enum test_state {
+	T_SYN = 0,
+	T_SYN_ACK,
+	T_DATA,
+	T_FIN,
+	T_FIN_ACK,
+};
+
+static enum test_state t_state;
+
+/* MSS of 500 bytes and window scale of 4 */
+static uint8_t syn_ack_options[8] = {
+	0x02, 0x04, 0x01, 0xf4,
+	0x01, 0x03, 0x03, 0x04 };
+
+/* A segment which has left the bottleneck, acked at the due time */
+struct link_event {
+	uint32_t due;
+	uint32_t seq;
+	uint16_t len;
+};
+
+static struct link {
+	struct k_spinlock lock;
+	struct link_event events[EVENTS_MAX];
+	uint8_t head;
+	uint8_t count;
+	uint32_t busy_until;
+	uint16_t sport;
+	uint32_t drops;
+} link;
+
+static struct k_delayed_work link_work;
+
+/* Receiver state */
+static uint32_t isn;
+static uint32_t peer_seq;
+static uint32_t rcv_nxt;
+static atomic_t delivered;
+static uint8_t rcv_map[TRANSFER_LEN / 8U];
+
+static uint8_t data[TRANSFER_CHUNK];
+
+static int tester_send(struct device *dev, struct net_pkt *pkt);
+
+struct net_tcp_context {
+	uint8_t mac_addr[sizeof(struct net_eth_addr)];
+	struct net_linkaddr ll_addr;
+};
+
+static int net_tcp_dev_init(struct device *dev)
+{
+	return 0;
+}
+
+static uint8_t *net_tcp_get_mac(struct device *dev)
+{
+	struct net_tcp_context *context = dev->driver_data;
+
+	if (context->mac_addr[2] == 0x00) {
+		/* 00-00-5E-00-53-xx Documentation RFC 7042 */
+		context->mac_addr[0] = 0x00;
+		context->mac_addr[1] = 0x00;
+		context->mac_addr[2] = 0x5E;
+		context->mac_addr[3] = 0x00;
+		context->mac_addr[4] = 0x53;
+		context->mac_addr[5] = 0x01;
+	}
+
+	return context->mac_addr;
+}
+
+static void net_tcp_iface_init(struct net_if *iface)
+{
+	uint8_t *mac = net_tcp_get_mac(net_if_get_device(iface));
+
+	net_if_set_link_addr(iface, mac, 6, NET_LINK_ETHERNET);
+}
+
+struct net_tcp_context net_tcp_context_data;
+
+static struct dummy_api net_tcp_if_api = {
+	.iface_api.init = net_tcp_iface_init,
+	.send = tester_send,
+};
+
+NET_DEVICE_INIT(net_tcp_cc_test, "net_tcp_cc_test",
+		net_tcp_dev_init, device_pm_control_nop,
+		&net_tcp_context_data, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+		&net_tcp_if_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), 127);
+
+static struct net_pkt *tester_prepare_tcp_pkt(uint16_t dst_port, uint8_t flags,
+					      uint32_t ack, uint16_t win,
+					      uint8_t *options,
+					      size_t options_len)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(tcp_access, struct tcphdr);
+	struct net_pkt *pkt;
+	struct tcphdr *th;
+	int ret;
+
+	pkt = net_pkt_alloc_with_buffer(iface,
+					sizeof(struct tcphdr) + options_len,
+					AF_INET, IPPROTO_TCP, K_NO_WAIT);
+	if (!pkt) {
+		return NULL;
+	}
+
+	ret = net_ipv4_create(pkt, &peer_addr, &my_addr);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	th = (struct tcphdr *)net_pkt_get_data(pkt, &tcp_access);
+	if (!th) {
+		goto fail;
+	}
+
+	memset(th, 0U, sizeof(struct tcphdr));
+
+	th->th_sport = htons(MY_PORT);
+	th->th_dport = dst_port;
+	th->th_off = 5U + options_len / 4U;
+	th->th_flags = flags;
+	th->th_win = htons(win);
+	th->th_seq = htonl(peer_seq);
+	th->th_ack = htonl(ack);
+
+	ret = net_pkt_set_data(pkt, &tcp_access);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	if (options_len) {
+		ret = net_pkt_write(pkt, options, options_len);
+		if (ret < 0) {
+			goto fail;
+		}
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	ret = net_ipv4_finalize(pkt, IPPROTO_TCP);
+	if (ret < 0) {
+		goto fail;
+	}
+
+	return pkt;
+fail:
+	net_pkt_unref(pkt);
+	return NULL;
+}
+
+static void tester_reply(uint16_t dst_port, uint8_t flags, uint32_t ack,
+			 uint8_t *options, size_t options_len)
+{
+	struct net_pkt *reply;
+
+	/* The window of SYN is never scaled, the others are by 1 << 4 */
+	reply = tester_prepare_tcp_pkt(dst_port, flags, ack,
+				       (flags & SYN) ? UINT16_MAX :
+				       TRANSFER_LEN >> 4,
+				       options, options_len);
+	if (!reply) {
+		zassert_true(false, "Failed to prepare a reply");
+		return;
+	}
+
+	if (net_recv_data(iface, reply) < 0) {
+		net_pkt_unref(reply);
+		zassert_true(false, "Failed to receive a reply");
+	}
+}
+
+/* Mark the segment as received and return the cumulative ACK */
+static uint32_t receiver_input(uint32_t seq, uint16_t len)
+{
+	uint32_t off = seq - isn;
+	uint32_t i;
+
+	for (i = off; i < off + len && i < TRANSFER_LEN; i++) {
+		rcv_map[i / 8U] |= BIT(i % 8U);
+	}
+
+	while (rcv_nxt < TRANSFER_LEN &&
+	       (rcv_map[rcv_nxt / 8U] & BIT(rcv_nxt % 8U))) {
+		rcv_nxt++;
+	}
+
+	atomic_set(&delivered, rcv_nxt);
+
+	return isn + rcv_nxt;
+}
+
+static void link_work_handler(struct k_work *work)
+{
+	struct link_event ev;
+	k_spinlock_key_t key;
+	uint32_t now;
+
+	while (true) {
+		now = k_uptime_get_32();
+
+		key = k_spin_lock(&link.lock);
+
+		if (!link.count) {
+			k_spin_unlock(&link.lock, key);
+			return;
+		}
+
+		ev = link.events[link.head];
+
+		if ((int32_t)(ev.due - now) > 0) {
+			k_delayed_work_submit(&link_work,
+					      K_MSEC(ev.due - now));
+			k_spin_unlock(&link.lock, key);
+			return;
+		}
+
+		link.head = (link.head + 1U) % EVENTS_MAX;
+		link.count--;
+
+		k_spin_unlock(&link.lock, key);
+
+		tester_reply(link.sport, ACK, receiver_input(ev.seq, ev.len),
+			     NULL, 0);
+	}
+}
+
+/* Pass the segment through the bottleneck, or drop it when the queue
+ * in front of the bottleneck is full.
+ */
+static void link_input(uint32_t seq, uint16_t len)
+{
+	k_spinlock_key_t key;
+	struct link_event *ev;
+	uint32_t now = k_uptime_get_32();
+	uint32_t start;
+
+	key = k_spin_lock(&link.lock);
+
+	start = (int32_t)(link.busy_until - now) > 0 ? link.busy_until : now;
+
+	if ((start - now) * LINK_BYTES_PER_MS + len > LINK_QUEUE_LIMIT ||
+	    link.count == EVENTS_MAX) {
+		link.drops++;
+		k_spin_unlock(&link.lock, key);
+		return;
+	}
+
+	link.busy_until = start +
+		(len + LINK_BYTES_PER_MS - 1U) / LINK_BYTES_PER_MS;
+
+	ev = &link.events[(link.head + link.count) % EVENTS_MAX];
+	ev->due = link.busy_until + LINK_RTT_MS;
+	ev->seq = seq;
+	ev->len = len;
+
+	if (!link.count) {
+		k_delayed_work_submit(&link_work, K_MSEC(ev->due - now));
+	}
+
+	link.count++;
+
+	k_spin_unlock(&link.lock, key);
+}
+
+static int read_tcp_header(struct net_pkt *pkt, struct tcphdr *th)
+{
+	int ret;
+
+	net_pkt_cursor_init(pkt);
+	net_pkt_set_overwrite(pkt, true);
+
+	ret = net_pkt_skip(pkt, net_pkt_ip_hdr_len(pkt) +
+			   net_pkt_ip_opts_len(pkt));
+	if (ret < 0) {
+		return -EINVAL;
+	}
+
+	ret = net_pkt_read(pkt, th, sizeof(struct tcphdr));
+	if (ret < 0) {
+		return -EINVAL;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	return 0;
+}
+
+static int tester_send(struct device *dev, struct net_pkt *pkt)
+{
+	struct tcphdr th;
+	size_t len;
+
+	if (read_tcp_header(pkt, &th) < 0) {
+		zassert_true(false, "%s failed", __func__);
+		return -EINVAL;
+	}
+
+	len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		net_pkt_ip_opts_len(pkt) - th.th_off * 4U;
+
+	switch (t_state) {
+	case T_SYN:
+		zassert_equal(th.th_flags, SYN, "Unexpected flags");
+		isn = ntohl(th.th_seq) + 1U;
+		link.sport = th.th_sport;
+		peer_seq = 0U;
+		t_state = T_SYN_ACK;
+		tester_reply(th.th_sport, SYN | ACK, isn, syn_ack_options,
+			     sizeof(syn_ack_options));
+		peer_seq++;
+		break;
+	case T_SYN_ACK:
+		zassert_equal(th.th_flags, ACK, "Unexpected flags");
+		t_state = T_DATA;
+		k_sem_give(&test_sem);
+		break;
+	case T_DATA:
+		if (len) {
+			link_input(ntohl(th.th_seq), len);
+		}
+		break;
+	case T_FIN:
+		zassert_equal(th.th_flags, FIN | ACK, "Unexpected flags");
+		t_state = T_FIN_ACK;
+		tester_reply(th.th_sport, FIN | ACK, ntohl(th.th_seq) + 1U,
+			     NULL, 0);
+		break;
+	case T_FIN_ACK:
+		zassert_equal(th.th_flags, ACK, "Unexpected flags");
+		k_sem_give(&test_sem);
+		break;
+	}
+
+	return 0;
+}
+
+static void test_presetup(void)
+{
+	struct net_if_addr *ifaddr;
+
+	iface = net_if_get_default();
+	zassert_not_null(iface, "Interface not available");
+
+	ifaddr = net_if_ipv4_addr_add(iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Failed to add IPv4 address");
+
+	k_delayed_work_init(&link_work, link_work_handler);
+
+	memset(data, 0x41, sizeof(data));
+}
+
+/* Transfer TRANSFER_LEN bytes over the emulated path with the given
+ * congestion control and check the goodput against the bottleneck rate.
+ */
+static void goodput_test(const char *cc)
+{
+	struct net_context *ctx;
+	uint32_t start, elapsed, goodput;
+	uint32_t sent = 0U;
+	char name[16];
+	size_t len = sizeof(name);
+	int ret;
+
+	t_state = T_SYN;
+	rcv_nxt = 0U;
+	atomic_set(&delivered, 0);
+	memset(rcv_map, 0, sizeof(rcv_map));
+	link.head = link.count = 0U;
+	link.busy_until = k_uptime_get_32();
+	link.drops = 0U;
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &ctx);
+	zassert_equal(ret, 0, "Failed to get net_context");
+
+	net_context_ref(ctx);
+
+	ret = net_context_set_option(ctx, NET_OPT_TCP_CONGESTION, cc,
+				     strlen(cc));
+	zassert_equal(ret, 0, "Failed to set %s", cc);
+
+	ret = net_context_get_option(ctx, NET_OPT_TCP_CONGESTION, name, &len);
+	zassert_equal(ret, 0, "Failed to get the congestion control");
+	zassert_true(strcmp(name, cc) == 0, "Congestion control mismatch");
+
+	ret = net_context_connect(ctx, (struct sockaddr *)&peer_addr_s,
+				  sizeof(struct sockaddr_in), NULL,
+				  K_MSEC(100), NULL);
+	zassert_equal(ret, 0, "Failed to connect to peer");
+
+	zassert_equal(k_sem_take(&test_sem, K_MSEC(100)), 0,
+		      "Handshake timed out");
+
+	start = k_uptime_get_32();
+
+	while ((uint32_t)atomic_get(&delivered) < TRANSFER_LEN) {
+		zassert_true(k_uptime_get_32() - start < TRANSFER_TIMEOUT_MS,
+			     "%s: transfer timed out at %u bytes", cc,
+			     (uint32_t)atomic_get(&delivered));
+
+		if (sent < TRANSFER_LEN &&
+		    sent - (uint32_t)atomic_get(&delivered) < TRANSFER_AHEAD) {
+			ret = net_context_send(ctx, data, TRANSFER_CHUNK, NULL,
+					       K_NO_WAIT, NULL);
+			if (ret >= 0) {
+				sent += TRANSFER_CHUNK;
+				continue;
+			}
+		}
+
+		k_sleep(K_MSEC(1));
+	}
+
+	elapsed = MAX(k_uptime_get_32() - start, 1U);
+	goodput = TRANSFER_LEN / elapsed;
+
+	TC_PRINT("%s: %u bytes in %u ms, goodput %u kbit/s "
+		 "(bottleneck %u kbit/s), %u drops\n", cc, TRANSFER_LEN,
+		 elapsed, goodput * 8U, LINK_BYTES_PER_MS * 8U, link.drops);
+
+	zassert_true(goodput * 100U >=
+		     LINK_BYTES_PER_MS * GOODPUT_MIN_PERCENT,
+		     "%s: goodput too low", cc);
+
+	t_state = T_FIN;
+
+	net_tcp_put(ctx);
+
+	zassert_equal(k_sem_take(&test_sem, K_MSEC(100)), 0,
+		      "Close timed out");
+
+	/* Connection is in TIME_WAIT state, context will be released
+	 * after K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY), so wait for it.
+	 */
+	k_sleep(K_MSEC(CONFIG_NET_TCP_TIME_WAIT_DELAY));
+}
+
+static void test_unknown_algorithm(void)
+{
+	struct net_context *ctx;
+	int ret;
+
+	ret = net_context_get(AF_INET, SOCK_STREAM, IPPROTO_TCP, &ctx);
+	zassert_equal(ret, 0, "Failed to get net_context");
+
+	ret = net_context_set_option(ctx, NET_OPT_TCP_CONGESTION, "reno2",
+				     sizeof("reno2"));
+	zassert_equal(ret, -ENOENT, "Unknown algorithm accepted");
+
+	net_context_put(ctx);
+}
+
+static void test_goodput_newreno(void)
+{
+	goodput_test("newreno");
+}
+
+static void test_goodput_cubic(void)
+{
+	goodput_test("cubic");
+}
+
+static void test_goodput_vegas(void)
+{
+	goodput_test("vegas");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(test_tcp_cc_fn,
+			 ztest_unit_test(test_presetup),
+			 ztest_unit_test(test_unknown_algorithm),
+			 ztest_unit_test(test_goodput_newreno),
+			 ztest_unit_test(test_goodput_cubic),
+			 ztest_unit_test(test_goodput_vegas)
+			 );
+
+	ztest_run_test_suite(test_tcp_cc_fn);
+}
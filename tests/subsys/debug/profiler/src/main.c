@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <debug/profiler.h>
+
+#define SAMPLE_PERIOD K_MSEC(1)
+#define BUSY_TIME_US 200000
+
+struct samples {
+	uint32_t total;
+	uint32_t own;
+};
+
+static void count_cb(const struct profiler_stack *stack, uint8_t cpu,
+		     void *user_data)
+{
+	struct samples *samples = user_data;
+
+	zassert_true(stack->depth >= 1U, "empty stack");
+	zassert_true(stack->depth <= CONFIG_PROFILER_STACK_DEPTH,
+		     "stack too deep");
+
+	samples->total += stack->count;
+	if (stack->thread == k_current_get()) {
+		samples->own += stack->count;
+	}
+}
+
+static struct samples samples_get(void)
+{
+	struct samples samples = { 0 };
+
+	profiler_foreach(count_cb, &samples);
+
+	return samples;
+}
+
+/**
+ * @brief Test that a busy thread is sampled
+ */
+void test_profiler_sample(void)
+{
+	struct samples samples;
+
+	profiler_reset();
+
+	zassert_equal(profiler_start(SAMPLE_PERIOD), 0, "start failed");
+	k_busy_wait(BUSY_TIME_US);
+	zassert_equal(profiler_stop(), 0, "stop failed");
+
+	samples = samples_get();
+	zassert_true(samples.own > 0U, "current thread not sampled");
+	zassert_true(samples.own <= samples.total, "bad sample count");
+	zassert_equal(profiler_lost_get(), 0, "samples lost");
+}
+
+/**
+ * @brief Test start, stop and reset
+ */
+void test_profiler_control(void)
+{
+	struct samples before, after;
+
+	zassert_equal(profiler_stop(), -EALREADY, "stopped twice");
+
+	zassert_equal(profiler_start(SAMPLE_PERIOD), 0, "start failed");
+	zassert_equal(profiler_start(SAMPLE_PERIOD), -EALREADY,
+		      "started twice");
+	k_busy_wait(BUSY_TIME_US / 10);
+	zassert_equal(profiler_stop(), 0, "stop failed");
+
+	/* No samples are taken once stopped */
+	before = samples_get();
+	k_busy_wait(BUSY_TIME_US / 10);
+	after = samples_get();
+	zassert_equal(before.total, after.total, "sampled after stop");
+
+	profiler_reset();
+	after = samples_get();
+	zassert_equal(after.total, 0, "samples not discarded");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_profiler,
+			 ztest_unit_test(test_profiler_sample),
+			 ztest_unit_test(test_profiler_control)
+			 );
+	ztest_run_test_suite(test_profiler);
+}
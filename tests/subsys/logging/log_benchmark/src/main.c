@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Log message creation benchmark
+ *
+ * Checks that messages carry the expected arguments, strings and data, then
+ * measures the cost of creating messages and how many fit in the log buffer.
+ * The same test runs with the message pool and with packaged messages.
+ */
+
+#include <tc_util.h>
+#include <zephyr.h>
+#include <ztest.h>
+#include <logging/log_backend.h>
+#include <logging/log_ctrl.h>
+#include <logging/log.h>
+
+#define LOG_MODULE_NAME test
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+#define BENCH_ROUNDS 64
+#define HEXDUMP_LEN 32
+
+struct backend_cb {
+	uint32_t counter;
+	uint32_t total_drops;
+	uint32_t exp_nargs;
+	const char *exp_str;
+	const uint8_t *exp_data;
+	uint32_t exp_len;
+};
+
+static struct backend_cb backend_cb;
+static uint8_t hexdump_buf[HEXDUMP_LEN];
+
+static void put(struct log_backend const *const backend,
+		struct log_msg *msg)
+{
+	struct backend_cb *cb = (struct backend_cb *)backend->cb->ctx;
+
+	log_msg_get(msg);
+
+	if (log_msg_is_std(msg)) {
+		uint32_t nargs = log_msg_nargs_get(msg);
+
+		zassert_equal(nargs, cb->exp_nargs, "Unexpected nargs");
+
+		if (cb->exp_str != NULL) {
+			zassert_equal(strcmp((const char *)
+					     log_msg_arg_get(msg, 0),
+					     cb->exp_str), 0,
+				      "Unexpected string argument");
+		} else {
+			/* Arguments are fixed, 1,2,3,4,5,... */
+			for (int i = 0; i < nargs; i++) {
+				zassert_equal(log_msg_arg_get(msg, i), i + 1,
+					      "Unexpected argument");
+			}
+		}
+	} else {
+		uint8_t data[HEXDUMP_LEN];
+		size_t len = sizeof(data);
+
+		log_msg_hexdump_data_get(msg, data, &len, 0);
+		zassert_equal(len, cb->exp_len, "Unexpected length");
+		zassert_equal(memcmp(data, cb->exp_data, len), 0,
+			      "Unexpected data");
+	}
+
+	cb->counter++;
+	log_msg_put(msg);
+}
+
+static void dropped(struct log_backend const *const backend, uint32_t cnt)
+{
+	struct backend_cb *cb = (struct backend_cb *)backend->cb->ctx;
+
+	cb->total_drops += cnt;
+}
+
+const struct log_backend_api log_backend_test_api = {
+	.put = put,
+	.dropped = dropped,
+};
+
+LOG_BACKEND_DEFINE(backend, log_backend_test_api, false);
+
+static void log_setup(void)
+{
+	log_init();
+
+	memset(&backend_cb, 0, sizeof(backend_cb));
+	log_backend_enable(&backend, &backend_cb, LOG_LEVEL_DBG);
+
+	for (int i = 0; i < sizeof(hexdump_buf); i++) {
+		hexdump_buf[i] = i;
+	}
+}
+
+static void flush(void)
+{
+	while (log_process(false)) {
+	}
+}
+
+static void test_log_args(void)
+{
+	log_setup();
+
+	backend_cb.exp_nargs = 0;
+	LOG_INF("test");
+	flush();
+
+	backend_cb.exp_nargs = 1;
+	LOG_INF("test %d", 1);
+	flush();
+
+	backend_cb.exp_nargs = 3;
+	LOG_INF("test %d %d %d", 1, 2, 3);
+	flush();
+
+	backend_cb.exp_nargs = 6;
+	LOG_INF("test %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6);
+	flush();
+
+	zassert_equal(backend_cb.counter, 4, "Unexpected message count");
+	zassert_equal(backend_cb.total_drops, 0, "Unexpected drops");
+}
+
+static void test_log_strdup(void)
+{
+	char str[] = "transient";
+
+	log_setup();
+
+	backend_cb.exp_nargs = 1;
+	backend_cb.exp_str = "transient";
+	LOG_INF("%s", log_strdup(str));
+
+	/* Message must not depend on the caller's copy */
+	str[0] = 'X';
+	flush();
+
+	zassert_equal(backend_cb.counter, 1, "Unexpected message count");
+}
+
+static void test_log_hexdump(void)
+{
+	log_setup();
+
+	backend_cb.exp_data = hexdump_buf;
+	backend_cb.exp_len = sizeof(hexdump_buf);
+	LOG_HEXDUMP_INF(hexdump_buf, sizeof(hexdump_buf), "data");
+	flush();
+
+	zassert_equal(backend_cb.counter, 1, "Unexpected message count");
+}
+
+#define BENCH(name, ...)						\
+	do {								\
+		uint32_t start = k_cycle_get_32();			\
+									\
+		for (int i = 0; i < BENCH_ROUNDS; i++) {		\
+			__VA_ARGS__;					\
+		}							\
+		TC_PRINT("%-8s %u cycles/msg\n", name,			\
+			 (k_cycle_get_32() - start) / BENCH_ROUNDS);	\
+		flush();						\
+	} while (false)
+
+static void test_log_benchmark(void)
+{
+	uint32_t cnt = 0;
+
+	log_setup();
+
+	backend_cb.exp_nargs = 0;
+	BENCH("log_0", LOG_INF("test"));
+	backend_cb.exp_nargs = 3;
+	BENCH("log_3", LOG_INF("test %d %d %d", 1, 2, 3));
+	backend_cb.exp_nargs = 6;
+	BENCH("log_n", LOG_INF("test %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6));
+	backend_cb.exp_data = hexdump_buf;
+	backend_cb.exp_len = sizeof(hexdump_buf);
+	BENCH("hexdump", LOG_HEXDUMP_INF(hexdump_buf, sizeof(hexdump_buf),
+					 "data"));
+
+	zassert_equal(backend_cb.total_drops, 0, "Unexpected drops");
+
+	/* Buffer capacity, in messages, before the first drop */
+	backend_cb.exp_nargs = 3;
+	while (log_buffered_cnt() == cnt) {
+		cnt++;
+		LOG_INF("test %d %d %d", 1, 2, 3);
+	}
+	flush();
+	TC_PRINT("capacity %u messages\n", cnt - 1);
+
+	zassert_true(cnt > 1, "No message buffered");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_log_benchmark,
+			 ztest_unit_test(test_log_args),
+			 ztest_unit_test(test_log_strdup),
+			 ztest_unit_test(test_log_hexdump),
+			 ztest_unit_test(test_log_benchmark));
+	ztest_run_test_suite(test_log_benchmark);
+}
@@ -28,6 +28,8 @@ typedef void (*custom_put_callback_t)(struct log_backend const *const backend,
 
 static bool in_panic;
 
+static uint32_t test_source_id;
+
 struct backend_cb {
 	size_t counter;
 	bool panic;
@@ -42,6 +44,8 @@ struct backend_cb {
 	bool exp_strdup[100];
 	custom_put_callback_t callback;
 	uint32_t total_drops;
+	uint32_t filter_changes;
+	uint32_t filter_level;
 };
 
 static void put(struct log_backend const *const backend,
@@ -108,10 +112,22 @@ static void dropped(struct log_backend const *const backend, uint32_t cnt)
 	cb->total_drops += cnt;
 }
 
+static void filter_changed(struct log_backend const *const backend,
+			   uint32_t src_id, uint32_t level)
+{
+	struct backend_cb *cb = (struct backend_cb *)backend->cb->ctx;
+
+	if (src_id == test_source_id) {
+		cb->filter_changes++;
+		cb->filter_level = level;
+	}
+}
+
 const struct log_backend_api log_backend_test_api = {
 	.put = put,
 	.panic = panic,
 	.dropped = dropped,
+	.filter_changed = filter_changed,
 };
 
 LOG_BACKEND_DEFINE(backend1, log_backend_test_api, false);
@@ -122,8 +138,6 @@ struct backend_cb backend2_cb;
 
 static uint32_t stamp;
 
-static uint32_t test_source_id;
-
 static uint32_t timestamp_get(void)
 {
 	return stamp++;
@@ -217,6 +231,43 @@ static void test_log_backend_runtime_filtering(void)
 		      "Unexpected amount of messages received by the backend.");
 }
 
+/*
+ * Backends are notified when their filter for a source changes, and only then.
+ */
+static void test_log_backend_filter_changed(void)
+{
+	log_setup(true);
+
+	backend1_cb.filter_changes = 0U;
+	backend2_cb.filter_changes = 0U;
+
+	log_filter_set(&backend2, CONFIG_LOG_DOMAIN_ID, test_source_id,
+		       LOG_LEVEL_WRN);
+
+	zassert_equal(0, backend1_cb.filter_changes,
+		      "Unchanged backend notified.");
+	zassert_equal(1, backend2_cb.filter_changes,
+		      "Backend not notified.");
+	zassert_equal(LOG_LEVEL_WRN, backend2_cb.filter_level,
+		      "Unexpected level.");
+
+	log_filter_set(&backend2, CONFIG_LOG_DOMAIN_ID, test_source_id,
+		       LOG_LEVEL_WRN);
+
+	zassert_equal(1, backend2_cb.filter_changes,
+		      "Backend notified without a change.");
+
+	log_filter_set(NULL, CONFIG_LOG_DOMAIN_ID, test_source_id,
+		       LOG_LEVEL_DBG);
+
+	zassert_equal(0, backend1_cb.filter_changes,
+		      "Unchanged backend notified.");
+	zassert_equal(2, backend2_cb.filter_changes,
+		      "Backend not notified.");
+	zassert_equal(LOG_LEVEL_DBG, backend2_cb.filter_level,
+		      "Unexpected level.");
+}
+
 /*
  * When LOG_MOVE_OVERFLOW is enabled, logger should discard oldest messages when
  * there is no room. However, if after discarding all messages there is still no
@@ -531,6 +582,7 @@ void test_main(void)
 {
 	ztest_test_suite(test_log_list,
 			 ztest_unit_test(test_log_backend_runtime_filtering),
+			 ztest_unit_test(test_log_backend_filter_changed),
 			 ztest_unit_test(test_log_overflow),
 			 ztest_unit_test(test_log_arguments),
 			 ztest_unit_test(test_log_from_declared_module),
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Test dictionary based log output
+ */
+
+#include <logging/log.h>
+#include <logging/log_output.h>
+#include <logging/log_output_dict.h>
+
+#include <tc_util.h>
+#include <stdbool.h>
+#include <zephyr.h>
+#include <ztest.h>
+
+#define LOG_MODULE_NAME test
+LOG_MODULE_REGISTER(LOG_MODULE_NAME);
+
+static uint8_t mock_buffer[512];
+static uint8_t log_output_buf[8];
+static uint32_t mock_len;
+static uint32_t mock_pos;
+
+static const char fmt_args[] = "test %d %s";
+static const char fmt_wide_args[] = "wide %lld %f %hd %Lf %s";
+static const char fmt_ro_str[] = "rodata";
+static const char fmt_size[] = "Sensor %d reading %d out of range";
+
+static void setup(void)
+{
+	mock_len = 0U;
+	mock_pos = 0U;
+	memset(mock_buffer, 0, sizeof(mock_buffer));
+}
+
+static void teardown(void)
+{
+
+}
+
+static int mock_output_func(uint8_t *buf, size_t size, void *ctx)
+{
+	memcpy(&mock_buffer[mock_len], buf, size);
+	mock_len += size;
+
+	return size;
+}
+
+LOG_OUTPUT_DEFINE(log_output, mock_output_func,
+		  log_output_buf, sizeof(log_output_buf));
+
+static void mock_read(void *data, size_t len)
+{
+	zassert_true(mock_pos + len <= mock_len, "Output too short");
+	memcpy(data, &mock_buffer[mock_pos], len);
+	mock_pos += len;
+}
+
+/* Sync record precedes the first record and is repeated periodically */
+static void skip_sync(void)
+{
+	struct log_dict_sync sync;
+
+	if (mock_buffer[0] != LOG_DICT_TYPE_SYNC) {
+		return;
+	}
+
+	mock_read(&sync, sizeof(sync));
+	zassert_equal(memcmp(sync.magic, LOG_DICT_MAGIC, sizeof(sync.magic)),
+		      0, "Unexpected magic");
+	zassert_equal(sync.version, LOG_DICT_VERSION, "Unexpected version");
+	zassert_equal(sync.ptr_size, sizeof(void *), "Unexpected ptr size");
+	zassert_equal(sync.arg_size, sizeof(log_arg_t),
+		      "Unexpected arg size");
+}
+
+static void validate_hdr(uint8_t type, struct log_msg_ids src_level,
+			 uint32_t timestamp)
+{
+	struct log_dict_hdr hdr;
+
+	mock_read(&hdr, sizeof(hdr));
+	zassert_equal(hdr.type, type | (src_level.level << 4),
+		      "Unexpected type");
+	zassert_equal(hdr.domain_id, src_level.domain_id,
+		      "Unexpected domain");
+	zassert_equal(hdr.source_id, src_level.source_id,
+		      "Unexpected source");
+	zassert_equal(hdr.timestamp, timestamp, "Unexpected timestamp");
+}
+
+/* String arguments which are not in read only memory are sent inline */
+static void validate_str(const char *exp, bool inline_str)
+{
+	const char *addr;
+
+	mock_read(&addr, sizeof(addr));
+
+	if (!inline_str) {
+		zassert_equal(addr, exp, "Unexpected string address");
+		return;
+	}
+
+	zassert_is_null(addr, "Inline string expected");
+	zassert_equal(strcmp((const char *)&mock_buffer[mock_pos], exp), 0,
+		      "Unexpected string");
+	mock_pos += strlen(exp) + 1;
+}
+
+static void log_output_string_varg(const struct log_output *log_output,
+		       struct log_msg_ids src_level, uint32_t timestamp,
+		       uint32_t flags, const char *fmt, ...)
+{
+	va_list ap;
+
+	va_start(ap, fmt);
+
+	log_output_string(log_output, src_level, timestamp, fmt, ap, flags);
+
+	va_end(ap);
+}
+
+static void test_log_output_dict_string(void)
+{
+	char str[] = "stack";
+	struct log_msg_ids src_level = {
+		.level = LOG_LEVEL_INF,
+		.domain_id = 0,
+		.source_id = 3,
+	};
+	const char *fmt;
+	log_arg_t arg;
+	uint8_t nargs;
+
+	log_output_string_varg(&log_output, src_level, 1234,
+			       LOG_OUTPUT_FLAG_FORMAT_DICT, fmt_args, -2, str);
+	log_output_string_varg(&log_output, src_level, 1235,
+			       LOG_OUTPUT_FLAG_FORMAT_DICT, fmt_args, 7,
+			       fmt_ro_str);
+
+	skip_sync();
+	validate_hdr(LOG_DICT_TYPE_STD, src_level, 1234);
+	mock_read(&nargs, sizeof(nargs));
+	zassert_equal(nargs, 2, "Unexpected nargs");
+	mock_read(&fmt, sizeof(fmt));
+	zassert_equal(fmt, fmt_args, "Unexpected format string address");
+	mock_read(&arg, sizeof(arg));
+	zassert_equal((int)arg, -2, "Unexpected argument");
+	validate_str(str, true);
+
+	validate_hdr(LOG_DICT_TYPE_STD, src_level, 1235);
+	mock_read(&nargs, sizeof(nargs));
+	mock_read(&fmt, sizeof(fmt));
+	mock_read(&arg, sizeof(arg));
+	zassert_equal(arg, 7, "Unexpected argument");
+	validate_str(fmt_ro_str, !IS_ENABLED(CONFIG_ARM) &&
+				 !IS_ENABLED(CONFIG_ARC) &&
+				 !IS_ENABLED(CONFIG_X86) &&
+				 !IS_ENABLED(CONFIG_NIOS2) &&
+				 !IS_ENABLED(CONFIG_RISCV) &&
+				 !IS_ENABLED(CONFIG_XTENSA));
+
+	zassert_equal(mock_pos, mock_len, "Unexpected trailing data");
+}
+
+/* Arguments wider than an int are read with their type, floats are not
+ * encoded.
+ */
+static void test_log_output_dict_wide_args(void)
+{
+	char str[] = "stack";
+	struct log_msg_ids src_level = {
+		.level = LOG_LEVEL_INF,
+		.domain_id = 0,
+		.source_id = 3,
+	};
+	const char *fmt;
+	log_arg_t arg;
+	uint8_t nargs;
+
+	log_output_string_varg(&log_output, src_level, 1234,
+			       LOG_OUTPUT_FLAG_FORMAT_DICT, fmt_wide_args,
+			       (long long)0x100000005LL, 1.5, (short)-3,
+			       (long double)2.5, str);
+
+	skip_sync();
+	validate_hdr(LOG_DICT_TYPE_STD, src_level, 1234);
+	mock_read(&nargs, sizeof(nargs));
+	zassert_equal(nargs, 5, "Unexpected nargs");
+	mock_read(&fmt, sizeof(fmt));
+	zassert_equal(fmt, fmt_wide_args, "Unexpected format string address");
+	mock_read(&arg, sizeof(arg));
+	zassert_equal(arg, (log_arg_t)0x100000005LL, "Unexpected argument");
+	mock_read(&arg, sizeof(arg));
+	zassert_equal(arg, 0, "Float encoded");
+	mock_read(&arg, sizeof(arg));
+	zassert_equal((int)arg, -3, "Unexpected argument");
+	mock_read(&arg, sizeof(arg));
+	zassert_equal(arg, 0, "Float encoded");
+	validate_str(str, true);
+
+	zassert_equal(mock_pos, mock_len, "Unexpected trailing data");
+}
+
+static void test_log_output_dict_hexdump(void)
+{
+	static const uint8_t data[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+	char metadata[] = "meta";
+	struct log_msg_ids src_level = {
+		.level = LOG_LEVEL_DBG,
+		.domain_id = 0,
+		.source_id = 1,
+	};
+	uint8_t buf[sizeof(data)];
+	uint16_t len;
+
+	log_output_hexdump(&log_output, src_level, 99, metadata,
+			   data, sizeof(data), LOG_OUTPUT_FLAG_FORMAT_DICT);
+
+	skip_sync();
+	validate_hdr(LOG_DICT_TYPE_HEXDUMP, src_level, 99);
+	validate_str(metadata, true);
+	mock_read(&len, sizeof(len));
+	zassert_equal(len, sizeof(data), "Unexpected length");
+	mock_read(buf, len);
+	zassert_equal(memcmp(buf, data, len), 0, "Unexpected data");
+
+	zassert_equal(mock_pos, mock_len, "Unexpected trailing data");
+}
+
+static void test_log_output_dict_dropped(void)
+{
+	struct log_dict_dropped dropped;
+
+	log_output_dropped_dict_process(&log_output, 100000);
+
+	skip_sync();
+	mock_read(&dropped, sizeof(dropped));
+	zassert_equal(dropped.type, LOG_DICT_TYPE_DROPPED, "Unexpected type");
+	zassert_equal(dropped.cnt, UINT16_MAX, "Count not saturated");
+}
+
+/* Size of the same message as a dictionary record and as formatted text */
+static void test_log_output_dict_size(void)
+{
+	struct log_msg_ids src_level = {
+		.level = LOG_LEVEL_INF,
+		.source_id = log_const_source_id(
+				&LOG_ITEM_CONST_DATA(LOG_MODULE_NAME)),
+		.domain_id = CONFIG_LOG_DOMAIN_ID,
+	};
+	uint32_t flags = LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_TIMESTAMP;
+	uint32_t dict_len, text_len;
+
+	log_output_string_varg(&log_output, src_level, 1234,
+			       flags | LOG_OUTPUT_FLAG_FORMAT_DICT, fmt_size,
+			       1, 42);
+	skip_sync();
+	dict_len = mock_len - mock_pos;
+
+	setup();
+	log_output_string_varg(&log_output, src_level, 1234, flags, fmt_size,
+			       1, 42);
+	text_len = mock_len;
+
+	TC_PRINT("Dictionary record %u bytes, text output %u bytes\n",
+		 dict_len, text_len);
+
+	zassert_equal(dict_len, sizeof(struct log_dict_hdr) + 1 +
+		      sizeof(const char *) + 2 * sizeof(log_arg_t),
+		      "Unexpected record size");
+	zassert_true(dict_len < text_len, "Record not smaller than text");
+}
+
+/*test case main entry*/
+void test_main(void)
+{
+	ztest_test_suite(test_log_output_dict,
+		ztest_unit_test_setup_teardown(test_log_output_dict_string,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_wide_args,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_hexdump,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_dropped,
+					       setup, teardown),
+		ztest_unit_test_setup_teardown(test_log_output_dict_size,
+					       setup, teardown));
+	ztest_run_test_suite(test_log_output_dict);
+}
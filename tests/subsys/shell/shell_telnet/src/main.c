@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ *  @brief Telnet shell backend test suite
+ *
+ * A client connected over the loopback interface checks the output queued
+ * by the backend and drained from the work queue.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <stdio.h>
+#include <net/socket.h>
+#include <shell/shell_telnet.h>
+
+#define SERVER_ADDR "192.0.2.1"
+
+/* Enough lines to overflow the output buffer several times */
+#define LINES 64
+#define LINE_FMT "line %04d abcdefghijklmnopqrstuvwxyz"
+#define LINE_LEN 40
+
+#define RECV_TIMEOUT_MS 500
+
+/* Telnet "Abort Output" command */
+#define TELNET_IAC 255
+#define TELNET_AO 245
+
+static char rx_buf[LINES * (LINE_LEN + 64)];
+
+static int client_connect(void)
+{
+	struct sockaddr_in addr = {
+		.sin_family = AF_INET,
+		.sin_port = htons(CONFIG_SHELL_TELNET_PORT),
+	};
+	int sock;
+	int ret;
+
+	zassert_equal(inet_pton(AF_INET, SERVER_ADDR, &addr.sin_addr), 1,
+		      "inet_pton failed");
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(sock >= 0, "socket failed (%d)", errno);
+
+	ret = connect(sock, (struct sockaddr *)&addr, sizeof(addr));
+	zassert_equal(ret, 0, "connect failed (%d)", errno);
+
+	/* Let the backend set up the client before printing */
+	k_msleep(100);
+
+	return sock;
+}
+
+/* Receive until the peer is silent for RECV_TIMEOUT_MS */
+static size_t client_recv(int sock)
+{
+	struct pollfd fds = {
+		.fd = sock,
+		.events = POLLIN,
+	};
+	size_t total = 0;
+	ssize_t len;
+
+	while (total < sizeof(rx_buf) - 1) {
+		if (poll(&fds, 1, RECV_TIMEOUT_MS) <= 0) {
+			break;
+		}
+
+		len = recv(sock, rx_buf + total, sizeof(rx_buf) - 1 - total,
+			   0);
+		if (len <= 0) {
+			break;
+		}
+
+		total += len;
+	}
+
+	rx_buf[total] = '\0';
+
+	return total;
+}
+
+static void lines_print(const struct shell *shell, int first, int count)
+{
+	for (int i = first; i < first + count; i++) {
+		shell_print(shell, LINE_FMT, i);
+	}
+}
+
+/**
+ * @brief Test that queued output reaches the client in order
+ *
+ * The output is larger than the backend buffer, so the shell waits for the
+ * work to drain it while printing.
+ */
+static void test_output(void)
+{
+	const struct shell *shell = shell_backend_telnet_get_ptr();
+	char line[LINE_LEN + 1];
+	const char *pos;
+	int sock;
+
+	sock = client_connect();
+
+	lines_print(shell, 0, LINES);
+	zassert_true(client_recv(sock) > LINES * LINE_LEN, "output lost");
+
+	/* The shell may add its prompt, every line must come in order */
+	pos = rx_buf;
+	for (int i = 0; i < LINES; i++) {
+		snprintf(line, sizeof(line), LINE_FMT, i);
+		pos = strstr(pos, line);
+		zassert_not_null(pos, "line %d missing or out of order", i);
+	}
+
+	zassert_equal(close(sock), 0, "close failed");
+	k_msleep(100);
+}
+
+/**
+ * @brief Test the telnet Abort Output command
+ *
+ * Once the client aborts the output, nothing is sent until it reconnects,
+ * and output queued before is not sent to the next client.
+ */
+static void test_abort_output(void)
+{
+	const struct shell *shell = shell_backend_telnet_get_ptr();
+	const uint8_t ao[] = { TELNET_IAC, TELNET_AO };
+	char line[LINE_LEN + 1];
+	int sock;
+
+	sock = client_connect();
+
+	zassert_equal(send(sock, ao, sizeof(ao), 0), sizeof(ao),
+		      "send failed");
+	k_msleep(100);
+
+	lines_print(shell, 0, LINES);
+	zassert_equal(client_recv(sock), 0, "output not aborted");
+
+	zassert_equal(close(sock), 0, "close failed");
+	k_msleep(100);
+
+	sock = client_connect();
+
+	lines_print(shell, LINES, 1);
+	zassert_true(client_recv(sock) > 0, "output still aborted");
+
+	snprintf(line, sizeof(line), LINE_FMT, LINES);
+	zassert_not_null(strstr(rx_buf, line), "new output missing");
+	snprintf(line, sizeof(line), LINE_FMT, 0);
+	zassert_is_null(strstr(rx_buf, line), "old output sent");
+
+	zassert_equal(close(sock), 0, "close failed");
+	k_msleep(100);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(shell_telnet,
+			 ztest_unit_test(test_output),
+			 ztest_unit_test(test_abort_output));
+	ztest_run_test_suite(shell_telnet);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <ztest.h>
+#include <stats/stats.h>
+
+#define N_INCS 100000
+#define STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACKSIZE)
+
+STATS_SECT_START(test_stats)
+STATS_SECT_ENTRY32(events)
+STATS_SECT_ENTRY32(bytes)
+STATS_SECT_ENTRY32(errors)
+STATS_SECT_END;
+
+STATS_NAME_START(test_stats)
+STATS_NAME(test_stats, events)
+STATS_NAME(test_stats, bytes)
+STATS_NAME(test_stats, errors)
+STATS_NAME_END(test_stats);
+
+STATS_SECT_DECL(test_stats) test_stats;
+
+static K_THREAD_STACK_DEFINE(partner_stack, STACK_SIZE);
+static struct k_thread partner_thread;
+
+static void test_inc_get(void)
+{
+	stats_reset(&test_stats.s_hdr);
+
+	STATS_INC(test_stats, events);
+	STATS_INCN(test_stats, bytes, 40);
+	STATS_INCN(test_stats, bytes, 2);
+
+	zassert_equal(STATS_GET(test_stats, events), 1, "wrong events");
+	zassert_equal(STATS_GET(test_stats, bytes), 42, "wrong bytes");
+	zassert_equal(STATS_GET(test_stats, errors), 0, "wrong errors");
+}
+
+static void test_set_clear(void)
+{
+	stats_reset(&test_stats.s_hdr);
+
+	STATS_INCN(test_stats, errors, 5);
+	STATS_SET(test_stats, errors, 3);
+	zassert_equal(STATS_GET(test_stats, errors), 3, "set failed");
+
+	STATS_INC(test_stats, errors);
+	zassert_equal(STATS_GET(test_stats, errors), 4, "inc after set failed");
+
+	STATS_CLEAR(test_stats, errors);
+	zassert_equal(STATS_GET(test_stats, errors), 0, "clear failed");
+}
+
+static void test_wrap(void)
+{
+	stats_reset(&test_stats.s_hdr);
+
+	/* The sum wraps around like a single 32-bit counter */
+	STATS_SET(test_stats, bytes, UINT32_MAX);
+	STATS_INCN(test_stats, bytes, 2);
+
+	zassert_equal(STATS_GET(test_stats, bytes), 1, "wrong wrap around");
+}
+
+static int entry_check(struct stats_hdr *hdr, void *arg, const char *name,
+		       uint16_t off)
+{
+	uint64_t *values = arg;
+	uint32_t val = *(uint32_t *)((uint8_t *)hdr + off);
+
+	if (strcmp(name, "events") == 0) {
+		zassert_equal(val, values[0], "wrong events in walk");
+	} else if (strcmp(name, "bytes") == 0) {
+		zassert_equal(val, values[1], "wrong bytes in walk");
+	} else if (strcmp(name, "errors") == 0) {
+		zassert_equal(val, values[2], "wrong errors in walk");
+	} else {
+		zassert_unreachable("unknown entry %s", name);
+	}
+
+	return 0;
+}
+
+static void test_snapshot(void)
+{
+	uint64_t values[4];
+	int cnt;
+
+	stats_reset(&test_stats.s_hdr);
+
+	STATS_INCN(test_stats, events, 7);
+	STATS_INCN(test_stats, bytes, 700);
+	STATS_INC(test_stats, errors);
+
+	cnt = stats_snapshot(&test_stats.s_hdr, values, ARRAY_SIZE(values));
+	zassert_equal(cnt, 3, "wrong number of entries");
+	zassert_equal(values[0], 7, "wrong events");
+	zassert_equal(values[1], 700, "wrong bytes");
+	zassert_equal(values[2], 1, "wrong errors");
+
+	cnt = stats_snapshot(&test_stats.s_hdr, values, 1);
+	zassert_equal(cnt, 1, "buffer size not respected");
+
+	/* Walk callbacks read the entries at the reported offsets */
+	zassert_equal(stats_walk(&test_stats.s_hdr, entry_check, values), 0,
+		      "walk failed");
+}
+
+static void partner_fn(void *arg1, void *arg2, void *arg3)
+{
+	ARG_UNUSED(arg1);
+	ARG_UNUSED(arg2);
+	ARG_UNUSED(arg3);
+
+	for (int i = 0; i < N_INCS; i++) {
+		STATS_INC(test_stats, events);
+	}
+}
+
+static void test_concurrent_inc(void)
+{
+	stats_reset(&test_stats.s_hdr);
+
+	k_thread_create(&partner_thread, partner_stack,
+			K_THREAD_STACK_SIZEOF(partner_stack), partner_fn,
+			NULL, NULL, NULL, k_thread_priority_get(k_current_get()),
+			0, K_NO_WAIT);
+
+	for (int i = 0; i < N_INCS; i++) {
+		STATS_INC(test_stats, events);
+	}
+
+	k_thread_join(&partner_thread, K_FOREVER);
+
+	zassert_equal(STATS_GET(test_stats, events), 2 * N_INCS,
+		      "increments lost");
+}
+
+void test_main(void)
+{
+	zassert_equal(STATS_INIT_AND_REG(test_stats, STATS_SIZE_32,
+					 "test_stats"), 0,
+		      "register failed");
+
+	ztest_test_suite(stats,
+			 ztest_unit_test(test_inc_get),
+			 ztest_unit_test(test_set_clear),
+			 ztest_unit_test(test_wrap),
+			 ztest_unit_test(test_snapshot),
+			 ztest_unit_test(test_concurrent_inc));
+	ztest_run_test_suite(stats);
+}
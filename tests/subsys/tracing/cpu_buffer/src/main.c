@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ *  @brief Per CPU tracing buffer test suite
+ *
+ * Events are put and packets drained directly, the tracing subsystem is
+ * not enabled.
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <tracing_buffer.h>
+
+#define PACKET_SIZE CONFIG_TRACING_CTF_PACKET_SIZE
+#define PACKET_SLOTS (CONFIG_TRACING_BUFFER_SIZE / PACKET_SIZE)
+#define HDR_SIZE sizeof(struct tracing_ctf_packet_hdr)
+
+#define CTF_MAGIC 0xC1FC1FC1
+
+struct test_event {
+	uint32_t id;
+	uint32_t inv_id;
+} __packed;
+
+#define EVENTS_PER_PACKET \
+	((PACKET_SIZE - HDR_SIZE) / sizeof(struct test_event))
+
+/* Id of the next event expected while draining */
+static uint32_t next_id;
+
+static bool event_put(uint32_t id, bool *packet_done)
+{
+	struct test_event event = {
+		.id = id,
+		.inv_id = ~id,
+	};
+
+	/* The id doubles as timestamp */
+	return tracing_cpu_buffer_put((uint8_t *)&event, sizeof(event), id,
+				      packet_done);
+}
+
+/* Claim the next packet, check its header and events, and release it.
+ * Return the number of events it held, or 0 if no packet is ready.
+ */
+static uint32_t packet_check(uint32_t exp_discarded)
+{
+	struct tracing_ctf_packet_hdr *hdr;
+	struct test_event *events;
+	uint8_t *data;
+	uint32_t size, count;
+
+	size = tracing_cpu_buffer_get_claim(&data);
+	if (size == 0U) {
+		return 0;
+	}
+
+	hdr = (struct tracing_ctf_packet_hdr *)data;
+	events = (struct test_event *)(data + HDR_SIZE);
+	count = (size - HDR_SIZE) / sizeof(struct test_event);
+
+	zassert_equal(hdr->magic, CTF_MAGIC, "Wrong magic");
+	zassert_equal(hdr->cpu_id, _current_cpu->id, "Wrong CPU id");
+	zassert_equal(hdr->content_size, size * 8U, "Wrong content size");
+	zassert_equal(hdr->packet_size, hdr->content_size,
+		      "Wrong packet size");
+	zassert_equal(size, HDR_SIZE + count * sizeof(struct test_event),
+		      "Partial event in packet");
+	zassert_true(count > 0, "Empty packet");
+	zassert_equal(hdr->events_discarded, exp_discarded,
+		      "Wrong discarded count");
+
+	zassert_equal(hdr->timestamp_begin, events[0].id,
+		      "Wrong begin timestamp");
+	zassert_equal(hdr->timestamp_end, events[count - 1].id,
+		      "Wrong end timestamp");
+
+	for (int i = 0; i < count; i++) {
+		zassert_equal(events[i].id, next_id, "Event %u out of order",
+			      events[i].id);
+		zassert_equal(events[i].inv_id, ~next_id, "Event corrupted");
+		next_id++;
+	}
+
+	tracing_cpu_buffer_get_finish();
+
+	return count;
+}
+
+static void buffer_setup(void)
+{
+	tracing_cpu_buffer_init();
+	next_id = 0U;
+
+	zassert_true(tracing_cpu_buffer_is_empty(), "Buffer not empty");
+}
+
+/**
+ * @brief Test that events are grouped in packets and come out in order
+ */
+static void test_packets(void)
+{
+	const uint32_t total = 2U * EVENTS_PER_PACKET + 2U;
+	bool packet_done;
+	uint8_t *data;
+
+	buffer_setup();
+
+	for (uint32_t id = 0U; id < total; id++) {
+		zassert_true(event_put(id, &packet_done), "Event %u dropped",
+			     id);
+		zassert_equal(packet_done,
+			      id != 0U && (id % EVENTS_PER_PACKET) == 0U,
+			      "Packet closed at the wrong event %u", id);
+	}
+
+	zassert_false(tracing_cpu_buffer_is_empty(), "Events lost");
+
+	/* Only the two full packets are ready until flushed */
+	zassert_equal(packet_check(0U), EVENTS_PER_PACKET, "Wrong packet");
+	zassert_equal(packet_check(0U), EVENTS_PER_PACKET, "Wrong packet");
+	zassert_equal(tracing_cpu_buffer_get_claim(&data), 0U,
+		      "Open packet claimed");
+	zassert_false(tracing_cpu_buffer_is_empty(), "Open packet lost");
+
+	tracing_cpu_buffer_flush();
+
+	zassert_equal(packet_check(0U), 2U, "Wrong last packet");
+	zassert_equal(next_id, total, "Events missing");
+	zassert_true(tracing_cpu_buffer_is_empty(), "Buffer not drained");
+	zassert_equal(tracing_cpu_buffer_get_claim(&data), 0U,
+		      "Packet claimed from an empty buffer");
+}
+
+/**
+ * @brief Test that events are discarded once all packets wait for output
+ *
+ * The number of discarded events is reported in the header of the next
+ * packet.
+ */
+static void test_discard(void)
+{
+	const uint32_t fit = PACKET_SLOTS * EVENTS_PER_PACKET;
+	bool packet_done;
+	uint32_t id, count = 0U;
+
+	buffer_setup();
+
+	for (id = 0U; id < fit; id++) {
+		zassert_true(event_put(id, &packet_done), "Event %u dropped",
+			     id);
+	}
+
+	zassert_false(event_put(id, &packet_done), "Event not dropped");
+	zassert_true(packet_done, "Last packet not closed");
+	zassert_false(event_put(id + 1U, &packet_done), "Event not dropped");
+	zassert_false(packet_done, "Packet closed twice");
+
+	/* Draining one packet makes room for the next events */
+	zassert_equal(packet_check(0U), EVENTS_PER_PACKET, "Wrong packet");
+
+	zassert_true(event_put(fit + 2U, &packet_done), "Event dropped");
+
+	for (int i = 1; i < PACKET_SLOTS; i++) {
+		count += packet_check(0U);
+	}
+
+	zassert_equal(count, fit - EVENTS_PER_PACKET, "Events missing");
+
+	tracing_cpu_buffer_flush();
+
+	/* Skip the two discarded events */
+	next_id = fit + 2U;
+	zassert_equal(packet_check(2U), 1U, "Wrong last packet");
+	zassert_true(tracing_cpu_buffer_is_empty(), "Buffer not drained");
+}
+
+/**
+ * @brief Test that events larger than a packet are rejected
+ */
+static void test_oversize(void)
+{
+	uint8_t event[PACKET_SIZE] = { 0 };
+	bool packet_done;
+	uint8_t *data;
+
+	buffer_setup();
+
+	zassert_false(tracing_cpu_buffer_put(event, PACKET_SIZE - HDR_SIZE + 1U,
+					     0U, &packet_done),
+		      "Oversized event buffered");
+	zassert_true(tracing_cpu_buffer_put(event, PACKET_SIZE - HDR_SIZE, 0U,
+					    &packet_done),
+		      "Event filling a packet dropped");
+
+	tracing_cpu_buffer_flush();
+
+	zassert_equal(tracing_cpu_buffer_get_claim(&data), PACKET_SIZE,
+		      "Wrong packet size");
+	tracing_cpu_buffer_get_finish();
+	zassert_true(tracing_cpu_buffer_is_empty(), "Buffer not drained");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(tracing_cpu_buffer,
+			 ztest_unit_test(test_packets),
+			 ztest_unit_test(test_discard),
+			 ztest_unit_test(test_oversize));
+	ztest_run_test_suite(tracing_cpu_buffer);
+}